@@ -0,0 +1,123 @@
+#include <modules/sdk.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_ROWS 16384
+#define BYTES_PER_ROUND (64u << 20) ///< Every frame size is built about this many bytes in total
+
+
+// Stub
+ABI_MODULE_FUNCTIONS module_init(ABI_SERVER_CORE_FUNCTIONS server_functions,
+                                 const char               *json_configuration) {
+    return (ABI_MODULE_FUNCTIONS){0};
+}
+
+
+// Server with compression
+static uint32_t get_abi_version(const ABI_MODULE_CONTEXT *context) {
+    return 2 | ABI_CAPABILITY_COMPRESSION;
+}
+
+
+static size_t sink; // Keeps the compiler from dropping the work
+
+
+static double now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+
+// Process table of `rows` processes, as a module of process statistics makes it
+static const ABI_MODULE_MDTP_DATA *make_frame(IModule *module, MdtpBuilder *builder, int rows) {
+    static const char *commands[] = {"/usr/bin/worker", "/usr/sbin/sshd", "/usr/lib/systemd"};
+    char               name[16];
+
+    for (int i = 0; i < rows; ++i) {
+        uint64_t state = (uint64_t)i * 0x9E3779B97F4A7C15ull;
+
+        snprintf(name, sizeof(name), "%d", 1000 + i);
+        sdk_mdtp_builder_begin_container(builder, name);
+        sdk_mdtp_builder_add_value(builder, "command", commands[i % 3], "");
+        sdk_mdtp_builder_add_value_u64(builder, "rss", (state >> 40) * 4096, "bytes");
+        sdk_mdtp_builder_add_value_u64(builder, "threads", 1 + (state >> 60), "");
+        sdk_mdtp_builder_add_value_f64(builder, "cpu", (double)(state >> 54) / 10, 1, "%");
+        sdk_mdtp_builder_end_container(builder);
+    }
+
+    return sdk_mdtp_builder_finish(builder, module);
+}
+
+
+int main(void) {
+    ABI_SERVER_CORE_FUNCTIONS server = {.abi_get_abi_version = get_abi_version};
+    IModule                  *module = sdk_imodule_create("bench", "bench", server, 0, 1);
+    MdtpBuilder              *builder = sdk_mdtp_builder_create();
+
+    printf("%8s %10s %10s %6s %12s %12s %12s %10s\n",
+           "rows",
+           "raw B",
+           "sent B",
+           "ratio",
+           "build us",
+           "compress us",
+           "decode us",
+           "MB/s");
+
+    for (int rows = 16; rows <= MAX_ROWS; rows *= 4) {
+        size_t raw_size = make_frame(module, builder, rows)->size;
+        int    rounds = (int)(BYTES_PER_ROUND / raw_size) + 1;
+        double start;
+        double build;
+        double compress;
+        double decode;
+
+        // Raw frame only
+        sdk_mdtp_compression_disable(module);
+        start = now();
+        for (int round = 0; round < rounds; ++round) {
+            sink += make_frame(module, builder, rows)->size;
+        }
+        build = (now() - start) / rounds;
+
+        // The same frame compressed
+        sdk_mdtp_compression_enable(module, 0);
+        start = now();
+        for (int round = 0; round < rounds; ++round) {
+            make_frame(module, builder, rows);
+            sink += sdk_mdtp_compression_emit(module)->size;
+        }
+        compress = (now() - start) / rounds - build;
+
+        ABI_MODULE_MDTP_DATA sent = *sdk_mdtp_compression_emit(module);
+
+        // What the server does with it
+        start = now();
+        for (int round = 0; round < rounds; ++round) {
+            size_t size;
+            void  *frame = sdk_mdtp_compression_decompress(sent.data, sent.size, &size);
+
+            sink += size;
+            free(frame);
+        }
+        decode = (now() - start) / rounds;
+
+        printf("%8d %10zu %10u %6.2f %12.1f %12.1f %12.1f %10.1f\n",
+               rows,
+               raw_size,
+               sent.size,
+               (double)raw_size / sent.size,
+               build * 1e6,
+               compress * 1e6,
+               decode * 1e6,
+               (double)raw_size / compress / 1e6);
+    }
+
+    sdk_mdtp_builder_destroy(builder);
+    sdk_imodule_destroy(module);
+
+    return sink == 0;
+}
@@ -0,0 +1,61 @@
+#include <modules/sdk.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_SIZE (1u << 20)
+#define BYTES_PER_ROUND (256u << 20) ///< Every size is hashed about this many bytes in total
+
+
+// Stub
+ABI_MODULE_FUNCTIONS module_init(ABI_SERVER_CORE_FUNCTIONS server_functions,
+                                 const char               *json_configuration) {
+    return (ABI_MODULE_FUNCTIONS){0};
+}
+
+
+static uint32_t sink; // Keeps the compiler from dropping the work
+
+
+static double now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+
+int main(void) {
+    uint8_t *bytes = malloc(MAX_SIZE);
+
+    if (bytes == NULL) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < MAX_SIZE; ++i) {
+        bytes[i] = (uint8_t)(i * 131 + (i >> 7));
+    }
+
+    printf("%10s %12s %10s %10s\n", "size B", "ns/frame", "ns/KB", "GB/s");
+
+    for (size_t size = 64; size <= MAX_SIZE; size *= 4) {
+        int    rounds = (int)(BYTES_PER_ROUND / size) + 1;
+        double start = now();
+
+        for (int round = 0; round < rounds; ++round) {
+            sink ^= sdk_mdtp_crc32c(0, bytes, size);
+        }
+
+        double elapsed = (now() - start) / rounds;
+
+        printf("%10zu %12.1f %10.2f %10.2f\n",
+               size,
+               elapsed * 1e9,
+               elapsed * 1e9 * 1024 / (double)size,
+               (double)size / elapsed / 1e9);
+    }
+
+    free(bytes);
+
+    return sink == 0;
+}
@@ -0,0 +1,125 @@
+#include <inttypes.h>
+#include <modules/sdk.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define VALUES_COUNT 4096
+#define ROUNDS 256
+
+
+// Stub
+ABI_MODULE_FUNCTIONS module_init(ABI_SERVER_CORE_FUNCTIONS server_functions,
+                                 const char               *json_configuration) {
+    return (ABI_MODULE_FUNCTIONS){0};
+}
+
+
+static double   doubles[VALUES_COUNT];
+static uint64_t integers[VALUES_COUNT];
+static size_t   sink; // Keeps the compiler from dropping the formatting
+
+
+static double now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+
+static void report(const char *name, double start, size_t bytes) {
+    double seconds = now() - start;
+    double calls = (double)VALUES_COUNT * ROUNDS;
+
+    printf("%-28s %8.1f ns/value %8.2f bytes/value\n",
+           name,
+           seconds * 1e9 / calls,
+           (double)bytes / calls);
+}
+
+
+int main(void) {
+    char     buffer[MDTP_F64_MAX_LENGTH + 1];
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+
+    // Gauge-like values: load averages, temperatures, ratios and counters
+    for (size_t i = 0; i < VALUES_COUNT; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        switch (i % 4) {
+        case 0: doubles[i] = (double)(state % 1000) / 100; break;
+        case 1: doubles[i] = 20.0 + (double)(state % 100000) / 1000; break;
+        case 2: doubles[i] = (double)(state >> 11) / (double)(1ull << 53); break;
+        default: doubles[i] = (double)(state % 100000000); break;
+        }
+
+        integers[i] = state >> (state % 64);
+    }
+
+    double start;
+    size_t bytes;
+
+    start = now();
+    bytes = 0;
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (size_t i = 0; i < VALUES_COUNT; ++i) {
+            bytes += (size_t)snprintf(buffer, sizeof(buffer), "%.17g", doubles[i]);
+        }
+    }
+    report("snprintf %.17g", start, bytes);
+    sink += bytes;
+
+    start = now();
+    bytes = 0;
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (size_t i = 0; i < VALUES_COUNT; ++i) {
+            bytes += sdk_mdtp_format_f64(buffer, doubles[i], MDTP_F64_SHORTEST);
+        }
+    }
+    report("sdk_mdtp_format_f64 shortest", start, bytes);
+    sink += bytes;
+
+    start = now();
+    bytes = 0;
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (size_t i = 0; i < VALUES_COUNT; ++i) {
+            bytes += (size_t)snprintf(buffer, sizeof(buffer), "%.2f", doubles[i]);
+        }
+    }
+    report("snprintf %.2f", start, bytes);
+    sink += bytes;
+
+    start = now();
+    bytes = 0;
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (size_t i = 0; i < VALUES_COUNT; ++i) {
+            bytes += sdk_mdtp_format_f64(buffer, doubles[i], 2);
+        }
+    }
+    report("sdk_mdtp_format_f64 fixed 2", start, bytes);
+    sink += bytes;
+
+    start = now();
+    bytes = 0;
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (size_t i = 0; i < VALUES_COUNT; ++i) {
+            bytes += (size_t)snprintf(buffer, sizeof(buffer), "%" PRIu64, integers[i]);
+        }
+    }
+    report("snprintf PRIu64", start, bytes);
+    sink += bytes;
+
+    start = now();
+    bytes = 0;
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (size_t i = 0; i < VALUES_COUNT; ++i) {
+            bytes += sdk_mdtp_format_u64(buffer, integers[i]);
+        }
+    }
+    report("sdk_mdtp_format_u64", start, bytes);
+    sink += bytes;
+
+    return sink == 0;
+}
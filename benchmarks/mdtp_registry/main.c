@@ -0,0 +1,105 @@
+#include <modules/sdk.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <time.h>
+
+#define MAX_THREADS 8
+#define UPDATES_PER_THREAD (1u << 23)
+
+
+// Stub
+ABI_MODULE_FUNCTIONS module_init(ABI_SERVER_CORE_FUNCTIONS server_functions,
+                                 const char               *json_configuration) {
+    return (ABI_MODULE_FUNCTIONS){0};
+}
+
+
+static uint32_t get_abi_version(const ABI_MODULE_CONTEXT *context) {
+    return 2;
+}
+
+
+static MdtpMetric      *counter;
+static _Atomic uint64_t shared;  // One counter all threads update
+static uint64_t         guarded; // Counter behind a mutex, as modules did before the registry
+static pthread_mutex_t  mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+static double now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+
+static void *update_registry(void *argument) {
+    for (uint32_t i = 0; i < UPDATES_PER_THREAD; ++i) {
+        sdk_mdtp_metric_add(counter, 1);
+    }
+
+    return NULL;
+}
+
+
+static void *update_shared(void *argument) {
+    for (uint32_t i = 0; i < UPDATES_PER_THREAD; ++i) {
+        atomic_fetch_add_explicit(&shared, 1, memory_order_relaxed);
+    }
+
+    return NULL;
+}
+
+
+static void *update_guarded(void *argument) {
+    for (uint32_t i = 0; i < UPDATES_PER_THREAD; ++i) {
+        pthread_mutex_lock(&mutex);
+        ++guarded;
+        pthread_mutex_unlock(&mutex);
+    }
+
+    return NULL;
+}
+
+
+// Wall time per update of one thread while `threads` threads update at once
+static double measure(size_t threads, void *(*update)(void *)) {
+    pthread_t workers[MAX_THREADS];
+    double    start = now();
+
+    for (size_t i = 0; i < threads; ++i) {
+        pthread_create(&workers[i], NULL, update, NULL);
+    }
+
+    for (size_t i = 0; i < threads; ++i) {
+        pthread_join(workers[i], NULL);
+    }
+
+    return (now() - start) / UPDATES_PER_THREAD;
+}
+
+
+int main(void) {
+    ABI_SERVER_CORE_FUNCTIONS server = {.abi_get_abi_version = get_abi_version};
+    IModule                  *module = sdk_imodule_create("bench", "bench", server, 0, 1);
+
+    counter = sdk_mdtp_registry_counter(module, "requests", "");
+
+    if (counter == NULL) {
+        return 1;
+    }
+
+    printf("%8s %14s %14s %14s\n", "threads", "ns registry", "ns atomic", "ns mutex");
+
+    for (size_t threads = 1; threads <= MAX_THREADS; threads *= 2) {
+        printf("%8zu %14.2f %14.2f %14.2f\n",
+               threads,
+               measure(threads, update_registry) * 1e9,
+               measure(threads, update_shared) * 1e9,
+               measure(threads, update_guarded) * 1e9);
+    }
+
+    sdk_imodule_destroy(module);
+
+    return 0;
+}
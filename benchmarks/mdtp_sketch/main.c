@@ -0,0 +1,76 @@
+#include <modules/sdk.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+#define MAX_THREADS 8
+#define VALUES_PER_THREAD (1u << 22)
+
+
+// Stub
+ABI_MODULE_FUNCTIONS module_init(ABI_SERVER_CORE_FUNCTIONS server_functions,
+                                 const char               *json_configuration) {
+    return (ABI_MODULE_FUNCTIONS){0};
+}
+
+
+static double now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+
+// Record latencies from 1 us to about 1 ms
+static void *record(void *sketch) {
+    uint32_t state = (uint32_t)(size_t)&state;
+
+    for (uint32_t i = 0; i < VALUES_PER_THREAD; ++i) {
+        state = state * 1664525u + 1013904223u;
+        sdk_mdtp_sketch_record(sketch, 1e-6 + (double)(state >> 22) * 1e-6);
+    }
+
+    return NULL;
+}
+
+
+// Average time of one record while `threads` threads record at once
+static double measure(size_t threads, size_t shards) {
+    MdtpSketch *sketch = sdk_mdtp_sketch_create(1e-6, 100, MDTP_SKETCH_DEFAULT_PRECISION, shards);
+    pthread_t   workers[MAX_THREADS];
+
+    if (sketch == NULL) {
+        return 0;
+    }
+
+    double start = now();
+
+    for (size_t i = 0; i < threads; ++i) {
+        pthread_create(&workers[i], NULL, record, sketch);
+    }
+
+    for (size_t i = 0; i < threads; ++i) {
+        pthread_join(workers[i], NULL);
+    }
+
+    double elapsed = now() - start;
+
+    sdk_mdtp_sketch_destroy(sketch);
+
+    // Wall time per record of one thread, the same as the single-threaded cost if it scales
+    return elapsed / VALUES_PER_THREAD;
+}
+
+
+int main(void) {
+    printf("%8s %18s %18s\n", "threads", "ns/insert sharded", "ns/insert 1 shard");
+
+    for (size_t threads = 1; threads <= MAX_THREADS; threads *= 2) {
+        printf("%8zu %18.2f %18.2f\n",
+               threads,
+               measure(threads, MDTP_SKETCH_DEFAULT_SHARDS) * 1e9,
+               measure(threads, 1) * 1e9);
+    }
+
+    return 0;
+}
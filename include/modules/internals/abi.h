@@ -14,6 +14,63 @@ extern "C" {
 #endif
 
 
+#define ABI_VERSION_MASK 0x0000FFFFu ///< Bits of the ABI version word holding the version itself
+
+/**
+ * @brief The server accepts delta frames (MDTP frames with `MDTP_FLAG_DELTA`), see
+ * `modules/internals/mdtp_delta.h`
+ */
+#define ABI_CAPABILITY_DELTA_FRAMES (1u << 16)
+
+/**
+ * @brief The server accepts frames with dictionary strings (MDTP frames with
+ * `MDTP_FLAG_DICTIONARY`), see `modules/internals/mdtp_dictionary.h`
+ */
+#define ABI_CAPABILITY_DICTIONARY (1u << 17)
+
+/**
+ * @brief The server accepts MDTP v2 frames (`MDTP_VERSION_2`), see
+ * `sdk_utils_server_mdtp_version`
+ */
+#define ABI_CAPABILITY_MDTP_V2 (1u << 18)
+
+/**
+ * @brief The server accepts compressed frames (MDTP frames with `MDTP_FLAG_COMPRESSED`), see
+ * `modules/internals/mdtp_compression.h`
+ */
+#define ABI_CAPABILITY_COMPRESSION (1u << 19)
+
+/**
+ * @brief The server accepts frames with a CRC32C trailer (MDTP frames with `MDTP_FLAG_CRC`), see
+ * `modules/internals/mdtp_crc.h`
+ */
+#define ABI_CAPABILITY_CRC (1u << 20)
+
+/**
+ * @brief The server accepts chunked frames (MDTP parts with `MDTP_FLAG_CHUNK`) and fetches the
+ * parts after the first one with `module_get_data_chunk`, see `modules/internals/mdtp_chunk.h`
+ */
+#define ABI_CAPABILITY_CHUNKED_FRAMES (1u << 21)
+
+/**
+ * @brief The server reads table nodes (`MDTP_NODE_TABLE`), see
+ * `modules/internals/mdtp_reader.h`
+ */
+#define ABI_CAPABILITY_TABLES (1u << 22)
+
+/**
+ * @brief The server reads numeric array nodes (`MDTP_NODE_ARRAY`), see
+ * `modules/internals/mdtp_reader.h`
+ */
+#define ABI_CAPABILITY_ARRAYS (1u << 23)
+
+/**
+ * @brief The server reads histogram nodes (`MDTP_NODE_HISTOGRAM`), see
+ * `modules/internals/mdtp_reader.h`
+ */
+#define ABI_CAPABILITY_HISTOGRAMS (1u << 24)
+
+
 /**
  * @brief Struct to storing MDTP data. See documentation for MDTP protocol.
  * @note This is a **packaged** structure.
@@ -24,6 +81,16 @@ typedef struct ABI_MODULE_MDTP_DATA {
 } ABI_MODULE_MDTP_DATA;
 
 
+/**
+ * @brief Identity of the MDTP data stored in the module. See `module_get_data_info`.
+ * @note This is a **packaged** structure.
+ */
+typedef struct ABI_MODULE_DATA_INFO {
+    uint64_t hash;       ///< 64-bit hash of the bytes of the stored frame
+    uint64_t generation; ///< Incremented only when the stored frame changes, `0` - no frame yet
+} ABI_MODULE_DATA_INFO;
+
+
 /**
  * @brief Context of module
  *
@@ -49,7 +116,8 @@ typedef struct ABI_SERVER_CORE_FUNCTIONS {
     /**
      * @brief Get ABI version
      * @param context Module context. See `ABI_MODULE_CONTEXT`
-     * @return ABI version
+     * @return ABI version in the lower 16 bits (`ABI_VERSION_MASK`), optional features the server
+     * supports in the upper 16 bits (`ABI_CAPABILITY_*`)
      */
     uint32_t (*abi_get_abi_version)(const ABI_MODULE_CONTEXT *context);
 
@@ -99,6 +167,22 @@ typedef struct ABI_MODULE_FUNCTIONS {
     void (*module_set_poll_ratio)(uint32_t poll_ratio); ///< Set the poll ratio of module
 
     uint32_t (*module_get_poll_ratio)(void); ///< Get poll ratio of module
+
+    /**
+     * @brief Get identity of the data returned by the last `module_get_data`. If the generation
+     * did not change since the previous poll, the frame is byte-identical to the previous one and
+     * the server may skip decoding it.
+     * @note Since ABI version 2. May be `NULL` if the module does not provide it.
+     */
+    const ABI_MODULE_DATA_INFO *(*module_get_data_info)(void);
+
+    /**
+     * @brief Get part `sequence` of the chunked frame returned by the last `module_get_data`.
+     * Called for parts `1` to `count - 1` after `module_get_data` returned part `0`. Returns
+     * `NULL` if there is no such part.
+     * @note Since ABI version 2. May be `NULL` if the module does not provide it.
+     */
+    const ABI_MODULE_MDTP_DATA *(*module_get_data_chunk)(uint32_t sequence);
 } ABI_MODULE_FUNCTIONS;
 
 
@@ -14,6 +14,12 @@
 extern "C" {
 #endif
 
+/**
+ * @brief Polls between checks of the frame buffer size of a new module, see
+ * `sdk_imodule_set_mdtp_shrink_polls`
+ */
+#define IMODULE_DEFAULT_SHRINK_POLLS 64
+
 /**
  * @brief A pseudo-base "class" for a module. Stores unique internal data for that module.
  */
@@ -66,6 +72,37 @@ SDK_EXPORT void sdk_imodule_set_context(IModule *module, ABI_MODULE_CONTEXT cont
  */
 SDK_EXPORT const ABI_MODULE_MDTP_DATA *sdk_imodule_get_mdtp_data(const IModule *module);
 
+/**
+ * @brief Get hash and generation of the frame stored in the module
+ *
+ * The frame stored in the module (by `sdk_imodule_commit_mdtp_data`, `sdk_imodule_set_mdtp_data`
+ * or anything built on them) is hashed by this function, once per stored frame, so producers that
+ * patch a few bytes of the frame do not pay for hashing all of it unless the info is used. The
+ * generation is incremented only if the hash or the size differs from the frame described last. A
+ * frame built in chunks is hashed as the frame its parts make up. A module may compare
+ * generations to skip work that depends on its own data, and `module_get_data_info` lets the
+ * server skip decoding unchanged frames:
+ *
+ * @code{.c}
+ * // Example usage:
+ * static const ABI_MODULE_DATA_INFO *get_data_info(void) {
+ *     return sdk_imodule_get_mdtp_data_info(module);
+ * }
+ *
+ * // In module_init:
+ * sdk_module_register_get_data_info(module, get_data_info);
+ * @endcode
+ *
+ * @param module Not-null pointer to `IModule`
+ * @return Pointer to `ABI_MODULE_DATA_INFO`, updated by the next call after a frame was stored
+ * @note Delta frames returned by `sdk_mdtp_delta_emit` are not stored frames: the info describes
+ * the full frame they encode
+ * @warning The info is updated by the call, so it must be called from the thread that stores the
+ * frames of the module. While a sampler runs or a time budget is set, frames are stored by the
+ * thread of the SDK: use `sdk_mdtp_sampler_get_data_info` or `sdk_mdtp_deadline_get_data_info`.
+ */
+SDK_EXPORT const ABI_MODULE_DATA_INFO *sdk_imodule_get_mdtp_data_info(IModule *module);
+
 /**
  * @brief Set MDTP data of the module using pointer to `IModule`
  * @param module Not-null pointer to `IModule`
@@ -75,6 +112,47 @@ SDK_EXPORT const ABI_MODULE_MDTP_DATA *sdk_imodule_get_mdtp_data(const IModule *
  */
 SDK_EXPORT void sdk_imodule_set_mdtp_data(IModule *module, ABI_MODULE_MDTP_DATA data);
 
+/**
+ * @brief Get the frame buffer of the module to write a new MDTP frame in place
+ *
+ * The module keeps one frame buffer for its whole life. It grows geometrically and is rewritten
+ * on every poll, so once the module has warmed up, producing a frame makes no allocations. Write
+ * the frame into the returned buffer and publish it via `sdk_imodule_commit_mdtp_data`.
+ *
+ * @param module Not-null pointer to `IModule`
+ * @param size Count of bytes the frame needs
+ * @return Pointer to a buffer of at least `size` bytes or `NULL` if allocation failed. The buffer
+ * still holds the current frame, so its contents are preserved if it had to grow.
+ * @warning The returned pointer is invalidated by the next call of `sdk_imodule_reserve_mdtp_data`,
+ * `sdk_imodule_commit_mdtp_data` or `sdk_imodule_set_mdtp_data`
+ */
+SDK_EXPORT void *sdk_imodule_reserve_mdtp_data(IModule *module, uint32_t size);
+
+/**
+ * @brief Publish the first `size` bytes of the frame buffer as MDTP data of the module
+ * @param module Not-null pointer to `IModule`
+ * @param size Count of bytes of the complete MDTP frame written into the buffer returned by
+ * `sdk_imodule_reserve_mdtp_data`
+ * @return Pointer to `ABI_MODULE_MDTP_DATA` or `NULL` if `size` exceeds the reserved buffer
+ */
+SDK_EXPORT const ABI_MODULE_MDTP_DATA *sdk_imodule_commit_mdtp_data(IModule *module,
+                                                                    uint32_t size);
+
+/**
+ * @brief Set when the frame buffer of the module is shrunk
+ *
+ * If `polls` is not `0`, every `polls` commits the module checks the largest frame committed
+ * during these polls (the high-water mark) and shrinks the buffer to it when it occupies less than
+ * a half of the buffer. A builder that swaps its buffer with the module (see
+ * `sdk_mdtp_builder_finish`) gets its buffer shrunk at the same time, so one oversized frame does
+ * not pin memory for the lifetime of the module.
+ *
+ * @param module Not-null pointer to `IModule`
+ * @param polls Count of polls between checks (`0` - never shrink). New modules check every
+ * `IMODULE_DEFAULT_SHRINK_POLLS` polls.
+ */
+SDK_EXPORT void sdk_imodule_set_mdtp_shrink_polls(IModule *module, uint32_t polls);
+
 /**
  * @brief Get poll ratio of the module using pointer to `IModule`
  * @param module Not-null pointer to `IModule`
@@ -158,6 +236,28 @@ SDK_EXPORT void sdk_module_register_get_configuration(IModule *module,
 SDK_EXPORT void sdk_module_register_get_data(IModule *module,
                                              const ABI_MODULE_MDTP_DATA *(*callback)(void));
 
+/**
+ * @brief Registers a module function that returns hash and generation of the MDTP data and will be
+ * called by the server core. See `sdk_imodule_get_mdtp_data_info`.
+ * @param module Not-null pointer to `IModule`. If `NULL`, no effect.
+ * @param callback Not-null pointer to function with signature `const ABI_MODULE_DATA_INFO *(void)`.
+ * If `NULL`, no effect.
+ * @note Do not block thread in this function
+ */
+SDK_EXPORT void sdk_module_register_get_data_info(IModule *module,
+                                                  const ABI_MODULE_DATA_INFO *(*callback)(void));
+
+/**
+ * @brief Registers a module function that returns parts of a chunked frame and will be called by
+ * the server core. See `sdk_mdtp_chunk_get`.
+ * @param module Not-null pointer to `IModule`. If `NULL`, no effect.
+ * @param callback Not-null pointer to function with signature
+ * `const ABI_MODULE_MDTP_DATA *(uint32_t)`. If `NULL`, no effect.
+ * @note Do not block thread in this function
+ */
+SDK_EXPORT void sdk_module_register_get_data_chunk(
+    IModule *module, const ABI_MODULE_MDTP_DATA *(*callback)(uint32_t sequence));
+
 /**
  * @brief Registers a module function that enables the module and will be called by the
  * server core
@@ -7,7 +7,18 @@
 
 #pragma once
 
-#define MDTP_VERSION 1 ///< MDTP version
+#include "mdtp_format.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define MDTP_VERSION 1            ///< MDTP version
+#define MDTP_VERSION_2 2          ///< Compact MDTP version, see `sdk_mdtp_builder_set_version`
+#define MDTP_VERSION_MASK 0x07    ///< Bits of the first byte of a frame holding the MDTP version
+#define MDTP_FLAG_DELTA 0x08      ///< Flag in the first byte of a delta frame, see `mdtp_delta.h`
+#define MDTP_FLAG_DICTIONARY 0x10 ///< Flag of a frame with dictionary strings
+#define MDTP_FLAG_COMPRESSED 0x20 ///< Flag of a compressed frame, see `mdtp_compression.h`
+#define MDTP_FLAG_CRC 0x40        ///< Flag of a frame with a CRC32C trailer, see `mdtp_crc.h`
+#define MDTP_FLAG_CHUNK 0x80      ///< Flag of a part of a chunked frame, see `mdtp_chunk.h`
 
 #ifdef __cplusplus
 extern "C" {
@@ -46,8 +57,176 @@ typedef struct ABI_MODULE_MDTP_DATA ABI_MODULE_MDTP_DATA; ///< Forward declarati
 void *sdk_mdtp_make_value(const char *value_name, const char *value, const char *value_units);
 
 /**
- * @brief Frees memory allocated for value node via `sdk_mdtp_make_value`
- * @param value_node Pointer to value node
+ * @brief Creates a value node from strings with explicit lengths.
+ *
+ * Same as `sdk_mdtp_make_value`, but the strings do not have to be zero-terminated, so slices of
+ * a read buffer (for example, tokens of a `/proc` file) can be passed directly without copying
+ * them into temporary strings.
+ *
+ * @param value_name Name of the value (non-NULL)
+ * @param value_name_length Count of bytes of `value_name`
+ * @param value Value string (non-NULL)
+ * @param value_length Count of bytes of `value`
+ * @param value_units Units string (non-NULL)
+ * @param value_units_length Count of bytes of `value_units`
+ *
+ * @return `void*` Pointer to the created value node or `NULL` on error (`NULL` string or length
+ * exceeding `UINT32_MAX`). Ownership rules are the same as for `sdk_mdtp_make_value`.
+ *
+ * @code{.c}
+ * // Example usage:
+ * const char *line = "MemTotal:       16314788 kB";
+ * void *val = sdk_mdtp_make_value_n(line, 8, line + 16, 8, line + 25, 2);
+ * @endcode
+ */
+void *sdk_mdtp_make_value_n(const char *value_name,
+                            size_t      value_name_length,
+                            const char *value,
+                            size_t      value_length,
+                            const char *value_units,
+                            size_t      value_units_length);
+
+/**
+ * @brief Creates a value node holding an unsigned integer.
+ *
+ * The value is written as decimal text (same bytes as `printf("%" PRIu64)`), so the node is a
+ * regular MDTP v1 value node. The text is formatted directly into the node buffer, without a
+ * temporary string.
+ *
+ * @param value_name Name of the value (non-NULL, zero-terminated string)
+ * @param value Value
+ * @param value_units Units string (non-NULL, zero-terminated string)
+ *
+ * @return `void*` Pointer to the created value node or `NULL` on error. Ownership rules are the
+ * same as for `sdk_mdtp_make_value`.
+ *
+ * @code{.c}
+ * // Example usage:
+ * void *val = sdk_mdtp_make_value_u64("RAM", 1234, "MB"); // Same as "1234"
+ * @endcode
+ */
+void *sdk_mdtp_make_value_u64(const char *value_name, uint64_t value, const char *value_units);
+
+/**
+ * @brief Creates a value node holding a signed integer.
+ *
+ * Same as `sdk_mdtp_make_value_u64`, the text is the same as `printf("%" PRId64)`.
+ *
+ * @param value_name Name of the value (non-NULL, zero-terminated string)
+ * @param value Value
+ * @param value_units Units string (non-NULL, zero-terminated string)
+ *
+ * @return `void*` Pointer to the created value node or `NULL` on error. Ownership rules are the
+ * same as for `sdk_mdtp_make_value`.
+ */
+void *sdk_mdtp_make_value_i64(const char *value_name, int64_t value, const char *value_units);
+
+/**
+ * @brief Creates a value node holding a floating point number.
+ *
+ * With `precision` from `0` to `MDTP_F64_MAX_PRECISION` the text is the same as
+ * `printf("%.*f", precision, value)`. With `MDTP_F64_SHORTEST` the shortest text that reads back
+ * as exactly `value` is written. See `sdk_mdtp_format_f64` for details.
+ *
+ * @param value_name Name of the value (non-NULL, zero-terminated string)
+ * @param value Value
+ * @param precision Count of fractional digits or `MDTP_F64_SHORTEST`
+ * @param value_units Units string (non-NULL, zero-terminated string)
+ *
+ * @return `void*` Pointer to the created value node or `NULL` on error. Ownership rules are the
+ * same as for `sdk_mdtp_make_value`.
+ *
+ * @code{.c}
+ * // Example usage:
+ * void *val = sdk_mdtp_make_value_f64("temperature", 41.25, 1, "C"); // Same as "41.2"
+ * @endcode
+ */
+void *sdk_mdtp_make_value_f64(const char *value_name,
+                              double      value,
+                              int         precision,
+                              const char *value_units);
+
+/**
+ * @brief Creates a numeric array node of floating point numbers.
+ *
+ * An array node (see `MDTP_NODE_ARRAY`) holds one name and units and all elements packed as
+ * 8-byte Big Endian numbers, instead of a value node with decimal text for every element. The
+ * elements are written in one byte-swapping pass.
+ *
+ * Send arrays only to servers reporting `ABI_CAPABILITY_ARRAYS`.
+ *
+ * @param value_name Name of the array (non-NULL, zero-terminated string)
+ * @param values Array of `count` elements (non-NULL unless `count` is `0`)
+ * @param count Count of elements, at most `UINT32_MAX / 8`
+ * @param value_units Units of the elements (non-NULL, zero-terminated string)
+ *
+ * @return `void*` Pointer to the created array node or `NULL` on error. Ownership rules are the
+ * same as for `sdk_mdtp_make_value`.
+ *
+ * @code{.c}
+ * // Example usage:
+ * void *usage = sdk_mdtp_make_array_f64("core_usage", core_usage, core_count, "%");
+ * @endcode
+ */
+void *sdk_mdtp_make_array_f64(const char   *value_name,
+                              const double *values,
+                              size_t        count,
+                              const char   *value_units);
+
+/**
+ * @brief Creates a numeric array node of unsigned integers, see `sdk_mdtp_make_array_f64`
+ *
+ * @param value_name Name of the array (non-NULL, zero-terminated string)
+ * @param values Array of `count` elements (non-NULL unless `count` is `0`)
+ * @param count Count of elements, at most `UINT32_MAX / 8`
+ * @param value_units Units of the elements (non-NULL, zero-terminated string)
+ *
+ * @return `void*` Pointer to the created array node or `NULL` on error. Ownership rules are the
+ * same as for `sdk_mdtp_make_value`.
+ */
+void *sdk_mdtp_make_array_u64(const char     *value_name,
+                              const uint64_t *values,
+                              size_t          count,
+                              const char     *value_units);
+
+/**
+ * @brief Creates a histogram node.
+ *
+ * A histogram node (see `MDTP_NODE_HISTOGRAM`) holds the bucket bounds, the count of observations
+ * of every bucket and their sum, instead of a value node for every bucket. See
+ * `modules/internals/mdtp_histogram.h` to record observations from several threads.
+ *
+ * Send histograms only to servers reporting `ABI_CAPABILITY_HISTOGRAMS`.
+ *
+ * @param value_name Name of the histogram (non-NULL, zero-terminated string)
+ * @param bounds Increasing upper bounds (inclusive) of all buckets but the last (non-NULL unless
+ * `bound_count` is `0`)
+ * @param bound_count Count of elements of `bounds`, at most `MDTP_HISTOGRAM_MAX_BOUNDS`
+ * @param counts Counts of observations of the `bound_count + 1` buckets (non-NULL)
+ * @param sum Sum of the observations
+ * @param value_units Units of the observations (non-NULL, zero-terminated string)
+ *
+ * @return `void*` Pointer to the created histogram node or `NULL` on error. Ownership rules are
+ * the same as for `sdk_mdtp_make_value`.
+ *
+ * @code{.c}
+ * // Example usage:
+ * static const double bounds[] = {0.005, 0.01, 0.05, 0.1, 0.5, 1};
+ * uint64_t counts[7] = {...};
+ * void *latency = sdk_mdtp_make_histogram("latency", bounds, 6, counts, sum, "s");
+ * @endcode
+ */
+void *sdk_mdtp_make_histogram(const char     *value_name,
+                              const double   *bounds,
+                              size_t          bound_count,
+                              const uint64_t *counts,
+                              double          sum,
+                              const char     *value_units);
+
+/**
+ * @brief Frees memory allocated for value node via `sdk_mdtp_make_value`, for array node via
+ * `sdk_mdtp_make_array_f64` or for histogram node via `sdk_mdtp_make_histogram`
+ * @param value_node Pointer to value, array or histogram node
  * @note If a node of a **other type** is passed, there will be no effect
  */
 void sdk_mdtp_free_value(void *value_node);
@@ -86,6 +265,21 @@ void sdk_mdtp_free_value(void *value_node);
  */
 void *sdk_mdtp_make_container(const char *name, void *first, ...);
 
+/**
+ * @brief Creates a container node from a name with explicit length.
+ *
+ * Same as `sdk_mdtp_make_container`, but the name does not have to be zero-terminated.
+ *
+ * @param name Name of the container (non-NULL)
+ * @param name_length Count of bytes of `name`
+ * @param first Pointer to the first nested node (container or value).
+ * @param ... Additional nested nodes. The list must always be terminated with `NULL`.
+ *
+ * @return `void*` Pointer to the created container node or `NULL` on error. Ownership rules are
+ * the same as for `sdk_mdtp_make_container`.
+ */
+void *sdk_mdtp_make_container_n(const char *name, size_t name_length, void *first, ...);
+
 /**
  * @brief Frees memory allocated for container node via `MDTP_UTILS::make_container`
  * @param value_node Pointer to container node
@@ -121,6 +315,52 @@ void sdk_mdtp_free_container(void *container_node);
  */
 const ABI_MODULE_MDTP_DATA *sdk_mdtp_make_root(IModule *module, void *first, ...);
 
+/**
+ * @brief Creates a container node from an array of nodes.
+ *
+ * Same as `sdk_mdtp_make_container`, but for containers whose count of children is only known at
+ * runtime (CPU cores, disks, processes). The payload size is computed in one pass over the array.
+ *
+ * @param name Name of the container (non-NULL, zero-terminated string)
+ * @param nodes Array of `count` non-NULL nodes (containers or values). May be `NULL` if `count` is
+ * `0`.
+ * @param count Count of nodes in `nodes`. `0` creates an empty container.
+ *
+ * @warning On success the function takes ownership of the nodes and frees them. The array itself
+ * is not freed. On failure the nodes stay owned by the caller.
+ *
+ * @return `void*` Pointer to the created container node or `NULL` on error (including a `NULL`
+ * element in `nodes` or a payload exceeding `UINT32_MAX` bytes)
+ *
+ * @code{.c}
+ * // Example usage:
+ * void *cores[64];
+ * for (size_t i = 0; i < cores_count; ++i) {
+ *     cores[i] = sdk_mdtp_make_value(core_names[i], core_usages[i], "%");
+ * }
+ * void *cpu = sdk_mdtp_make_container_v("cpu", cores, cores_count);
+ * @endcode
+ */
+void *sdk_mdtp_make_container_v(const char *name, void **nodes, size_t count);
+
+/**
+ * @brief Generates a valid MDTP frame from an array of nodes.
+ *
+ * Same as `sdk_mdtp_make_root`, but takes the top-level nodes as an array.
+ *
+ * @param module The module in which the data will be saved
+ * @param nodes Array of `count` non-NULL nodes (containers or values). May be `NULL` if `count` is
+ * `0`.
+ * @param count Count of nodes in `nodes`. `0` creates a frame with empty payload.
+ *
+ * @warning On success the function takes ownership of the nodes and frees them. The array itself
+ * is not freed. On failure the nodes stay owned by the caller.
+ *
+ * @return Pointer to a valid `ABI_MODULE_MDTP_DATA` frame or `NULL` on error. **Do not free it, as
+ * this will happen automatically when the module terminates!**
+ */
+const ABI_MODULE_MDTP_DATA *sdk_mdtp_make_root_v(IModule *module, void **nodes, size_t count);
+
 
 #ifdef __cplusplus
 }
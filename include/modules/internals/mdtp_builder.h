@@ -0,0 +1,461 @@
+/**
+ * @file modules/internals/mdtp_builder.h
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#pragma once
+
+#include "../../general/sdk_status.h"
+#include "macro.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Maximum nesting depth of containers the builder can keep open at the same time
+ */
+#define MDTP_MAX_DEPTH 64
+
+typedef struct IModule              IModule;              ///< Forward declaration
+typedef struct ABI_MODULE_MDTP_DATA ABI_MODULE_MDTP_DATA; ///< Forward declaration
+
+/**
+ * @brief Single-pass MDTP frame builder.
+ *
+ * Unlike `sdk_mdtp_make_container` / `sdk_mdtp_make_root`, which allocate every node separately
+ * and copy the whole subtree again at every nesting level, the builder writes each byte exactly
+ * once into one growing frame buffer. The payload size of a container is back-patched when the
+ * container is closed.
+ *
+ * The builder keeps its buffer between frames, so a builder reused across polls stops allocating
+ * once it has grown to the size of the largest frame.
+ *
+ * If any call fails, the error is remembered: all further calls return the same status and
+ * `sdk_mdtp_builder_finish` returns `NULL`. This way you only need to check the result of
+ * `sdk_mdtp_builder_finish`.
+ *
+ * By default the builder writes MDTP v1 frames. After `sdk_mdtp_builder_set_version` with
+ * `MDTP_VERSION_2` it writes compact MDTP v2 frames (see `modules/internals/mdtp_reader.h`), in
+ * which numbers are stored as typed values instead of decimal text. They are read only by servers
+ * reporting `ABI_CAPABILITY_MDTP_V2`, `sdk_mdtp_builder_finish` fails for other servers.
+ */
+typedef struct MdtpBuilder MdtpBuilder;
+
+/**
+ * @brief Allocates and initializes a builder ready to write a new frame
+ * @return Pointer to `MdtpBuilder` or `NULL` if allocation failed
+ */
+SDK_EXPORT MdtpBuilder *sdk_mdtp_builder_create(void);
+
+/**
+ * @brief Destroys the builder and its buffer
+ * @param builder Pointer to `MdtpBuilder`. If `NULL`, no effect.
+ */
+SDK_EXPORT void sdk_mdtp_builder_destroy(MdtpBuilder *builder);
+
+/**
+ * @brief Discards everything written so far and starts a new frame. The buffer is kept.
+ * @param builder Not-null pointer to `MdtpBuilder`
+ */
+SDK_EXPORT void sdk_mdtp_builder_reset(MdtpBuilder *builder);
+
+/**
+ * @brief Selects the MDTP version of the frames written by the builder and starts a new frame.
+ * The version is kept until it is changed again.
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param version `MDTP_VERSION` or `MDTP_VERSION_2`. Use `sdk_utils_server_mdtp_version` to pick
+ * the newest version the server reads.
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if the version is unknown
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_set_version(MdtpBuilder *builder, uint8_t version);
+
+/**
+ * @brief Makes the builder write frames into chunks of `chunk_size` bytes instead of one growing
+ * buffer, and starts a new frame.
+ *
+ * A frame of several megabytes then never needs one large allocation. If the module has chunked
+ * frames enabled (see `sdk_mdtp_chunk_enable`), `sdk_mdtp_builder_finish` hands the chunks to the
+ * module as the parts to send, without copying them and without the other encodings. Otherwise,
+ * or if the frame fits one chunk, the chunks are joined into the frame buffer of the module.
+ *
+ * The bytes of a node are never split between chunks while they are written, so a chunk may end a
+ * little earlier, and a single value larger than `chunk_size` gets a chunk of its own size. Such
+ * chunks are split into parts of `chunk_size` bytes when the frame is handed to the module, so no
+ * part sent is larger than `chunk_size`. MDTP v2 containers reserve 5 bytes for their payload
+ * size.
+ *
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param chunk_size Count of frame bytes of a chunk, at least `MDTP_CHUNK_MIN_SIZE`. Use the
+ * `chunk_size` of the module. `0` returns to one growing buffer.
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if `chunk_size` is too small
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_set_chunk_size(MdtpBuilder *builder, size_t chunk_size);
+
+/**
+ * @brief Opens a container node. All nodes added until the matching
+ * `sdk_mdtp_builder_end_container` call become its children.
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param name Name of the container (non-NULL, zero-terminated string)
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if `name` is `NULL`, a table is open or more
+ * than `MDTP_MAX_DEPTH` containers are open, `SDK_ALLOCATION_ERROR` if the buffer could not grow
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_begin_container(MdtpBuilder *builder, const char *name);
+
+/**
+ * @brief Same as `sdk_mdtp_builder_begin_container`, but the name does not have to be
+ * zero-terminated
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param name Name of the container (non-NULL)
+ * @param name_length Count of bytes of `name`
+ * @return See `sdk_mdtp_builder_begin_container`. `SDK_INVALID_ARGUMENT` is also returned if
+ * `name_length` exceeds `UINT32_MAX`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_begin_container_n(MdtpBuilder *builder,
+                                                        const char  *name,
+                                                        size_t       name_length);
+
+/**
+ * @brief Appends a value node to the innermost open container (or to the root if no container is
+ * open)
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param value_name Name of the value (non-NULL, zero-terminated string)
+ * @param value Value string (non-NULL, zero-terminated string)
+ * @param value_units Units string (non-NULL, zero-terminated string)
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if any string is `NULL` or a table is open,
+ * `SDK_ALLOCATION_ERROR` if the buffer could not grow
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_add_value(MdtpBuilder *builder,
+                                                const char  *value_name,
+                                                const char  *value,
+                                                const char  *value_units);
+
+/**
+ * @brief Same as `sdk_mdtp_builder_add_value`, but the strings do not have to be zero-terminated,
+ * so slices of a read buffer can be passed directly
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param value_name Name of the value (non-NULL)
+ * @param value_name_length Count of bytes of `value_name`
+ * @param value Value string (non-NULL)
+ * @param value_length Count of bytes of `value`
+ * @param value_units Units string (non-NULL)
+ * @param value_units_length Count of bytes of `value_units`
+ * @return See `sdk_mdtp_builder_add_value`. `SDK_INVALID_ARGUMENT` is also returned if any length
+ * exceeds `UINT32_MAX`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_add_value_n(MdtpBuilder *builder,
+                                                  const char  *value_name,
+                                                  size_t       value_name_length,
+                                                  const char  *value,
+                                                  size_t       value_length,
+                                                  const char  *value_units,
+                                                  size_t       value_units_length);
+
+/**
+ * @brief Appends a value node holding an unsigned integer. The decimal text is written directly
+ * into the frame buffer, see `sdk_mdtp_make_value_u64`. MDTP v2 frames store `MDTP_VALUE_U64`.
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param value_name Name of the value (non-NULL, zero-terminated string)
+ * @param value Value
+ * @param value_units Units string (non-NULL, zero-terminated string)
+ * @return See `sdk_mdtp_builder_add_value`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_add_value_u64(MdtpBuilder *builder,
+                                                    const char  *value_name,
+                                                    uint64_t     value,
+                                                    const char  *value_units);
+
+/**
+ * @brief Appends a value node holding a signed integer, see `sdk_mdtp_make_value_i64`. MDTP v2
+ * frames store `MDTP_VALUE_I64`.
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param value_name Name of the value (non-NULL, zero-terminated string)
+ * @param value Value
+ * @param value_units Units string (non-NULL, zero-terminated string)
+ * @return See `sdk_mdtp_builder_add_value`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_add_value_i64(MdtpBuilder *builder,
+                                                    const char  *value_name,
+                                                    int64_t      value,
+                                                    const char  *value_units);
+
+/**
+ * @brief Appends a value node holding a floating point number, see `sdk_mdtp_make_value_f64`.
+ * MDTP v2 frames store `MDTP_VALUE_F64` with all bits of the value.
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param value_name Name of the value (non-NULL, zero-terminated string)
+ * @param value Value
+ * @param precision Count of fractional digits or `MDTP_F64_SHORTEST`. Ignored in MDTP v2 frames.
+ * @param value_units Units string (non-NULL, zero-terminated string)
+ * @return See `sdk_mdtp_builder_add_value`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_add_value_f64(MdtpBuilder *builder,
+                                                    const char  *value_name,
+                                                    double       value,
+                                                    int          precision,
+                                                    const char  *value_units);
+
+/**
+ * @brief Appends a value node holding a boolean. MDTP v1 frames store the text `true` or `false`,
+ * MDTP v2 frames store `MDTP_VALUE_BOOL`.
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param value_name Name of the value (non-NULL, zero-terminated string)
+ * @param value Value, any non-zero value is `true`
+ * @param value_units Units string (non-NULL, zero-terminated string)
+ * @return See `sdk_mdtp_builder_add_value`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_add_value_bool(MdtpBuilder *builder,
+                                                     const char  *value_name,
+                                                     int          value,
+                                                     const char  *value_units);
+
+/**
+ * @brief Appends a value node holding raw bytes. MDTP v1 frames store the bytes as the value
+ * string, MDTP v2 frames store `MDTP_VALUE_BYTES`.
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param value_name Name of the value (non-NULL, zero-terminated string)
+ * @param value Bytes (non-NULL unless `value_length` is `0`)
+ * @param value_length Count of bytes of `value`
+ * @param value_units Units string (non-NULL, zero-terminated string)
+ * @return See `sdk_mdtp_builder_add_value`. `SDK_INVALID_ARGUMENT` is also returned if
+ * `value_length` exceeds `UINT32_MAX`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_add_value_bytes(MdtpBuilder *builder,
+                                                      const char  *value_name,
+                                                      const void  *value,
+                                                      size_t       value_length,
+                                                      const char  *value_units);
+
+/**
+ * @brief Appends an array node (see `MDTP_NODE_ARRAY`) of unsigned integers. The elements are
+ * written in one byte-swapping pass, without formatting.
+ *
+ * Arrays are read only by servers reporting `ABI_CAPABILITY_ARRAYS`, `sdk_mdtp_builder_finish`
+ * fails for other servers.
+ *
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param value_name Name of the array (non-NULL, zero-terminated string)
+ * @param values Array of `count` elements (non-NULL unless `count` is `0`)
+ * @param count Count of elements
+ * @param value_units Units of the elements (non-NULL, zero-terminated string)
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if an argument is `NULL`, `count` exceeds
+ * `UINT32_MAX / 8` or a table is open, `SDK_ALLOCATION_ERROR` if the buffer could not grow
+ *
+ * @code{.c}
+ * // Example usage:
+ * sdk_mdtp_builder_add_array_f64(builder, "core_usage", usage, core_count, "%");
+ * @endcode
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_add_array_u64(MdtpBuilder    *builder,
+                                                    const char     *value_name,
+                                                    const uint64_t *values,
+                                                    size_t          count,
+                                                    const char     *value_units);
+
+/**
+ * @brief Appends an array node of floating point numbers, see `sdk_mdtp_builder_add_array_u64`.
+ * All bits of the elements are kept.
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param value_name Name of the array (non-NULL, zero-terminated string)
+ * @param values Array of `count` elements (non-NULL unless `count` is `0`)
+ * @param count Count of elements
+ * @param value_units Units of the elements (non-NULL, zero-terminated string)
+ * @return See `sdk_mdtp_builder_add_array_u64`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_add_array_f64(MdtpBuilder  *builder,
+                                                    const char   *value_name,
+                                                    const double *values,
+                                                    size_t        count,
+                                                    const char   *value_units);
+
+/**
+ * @brief Appends a histogram node (see `MDTP_NODE_HISTOGRAM`). In MDTP v2 frames every count is a
+ * varint, so empty buckets take one byte. See `modules/internals/mdtp_histogram.h` to record
+ * observations from several threads.
+ *
+ * Histograms are read only by servers reporting `ABI_CAPABILITY_HISTOGRAMS`,
+ * `sdk_mdtp_builder_finish` fails for other servers.
+ *
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param value_name Name of the histogram (non-NULL, zero-terminated string)
+ * @param bounds Increasing upper bounds (inclusive) of all buckets but the last (non-NULL unless
+ * `bound_count` is `0`)
+ * @param bound_count Count of elements of `bounds`
+ * @param counts Counts of observations of the `bound_count + 1` buckets (non-NULL)
+ * @param sum Sum of the observations
+ * @param value_units Units of the observations (non-NULL, zero-terminated string)
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if an argument is `NULL`, `bound_count`
+ * exceeds `MDTP_HISTOGRAM_MAX_BOUNDS`, the bounds are not increasing or a table is open,
+ * `SDK_ALLOCATION_ERROR` if the buffer could not grow
+ *
+ * @code{.c}
+ * // Example usage:
+ * static const double bounds[] = {0.005, 0.01, 0.05, 0.1, 0.5, 1};
+ * sdk_mdtp_builder_add_histogram(builder, "latency", bounds, 6, counts, sum, "s");
+ * @endcode
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_add_histogram(MdtpBuilder    *builder,
+                                                    const char     *value_name,
+                                                    const double   *bounds,
+                                                    size_t          bound_count,
+                                                    const uint64_t *counts,
+                                                    double          sum,
+                                                    const char     *value_units);
+
+/**
+ * @brief Closes the innermost open container and writes its payload size
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if no container is open or a table is open,
+ * `SDK_OTHER_ERROR` if the payload exceeds `UINT32_MAX` bytes
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_end_container(MdtpBuilder *builder);
+
+/**
+ * @brief Opens a table node (see `MDTP_NODE_TABLE`) in the innermost open container. Its cells are
+ * added with `sdk_mdtp_builder_add_row` or one by one with `sdk_mdtp_builder_add_cell` and others,
+ * row after row, until `sdk_mdtp_builder_end_table`. No other nodes can be added in between.
+ *
+ * Tables are read only by servers reporting `ABI_CAPABILITY_TABLES`, `sdk_mdtp_builder_finish`
+ * fails for other servers.
+ *
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param name Name of the table (non-NULL, zero-terminated string)
+ * @param columns Array of `count` column names (non-NULL, zero-terminated strings)
+ * @param units Array of `count` column units (non-NULL, zero-terminated strings), or `NULL` if the
+ * columns have no units
+ * @param count Count of columns, at least `1`
+ * @param layout `MDTP_TABLE_ROWS` or `MDTP_TABLE_COLUMNS`. Column-major cells compress better, but
+ * are reordered when the table ends. Tables built in chunks are always `MDTP_TABLE_ROWS`.
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if an argument is invalid, a table is
+ * already open or more than `MDTP_MAX_DEPTH` nodes are open, `SDK_ALLOCATION_ERROR` if the
+ * buffer could not grow
+ *
+ * @code{.c}
+ * // Example usage:
+ * static const char *const columns[] = {"pid", "rss", "cpu"};
+ * static const char *const units[] = {"", "bytes", "%"};
+ *
+ * sdk_mdtp_builder_begin_table(builder, "processes", columns, units, 3, MDTP_TABLE_ROWS);
+ *
+ * for (size_t i = 0; i < count; ++i) {
+ *     sdk_mdtp_builder_add_row_u64(builder, (uint64_t[]){pid[i], rss[i], cpu[i]});
+ * }
+ *
+ * sdk_mdtp_builder_end_table(builder);
+ * @endcode
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_begin_table(MdtpBuilder       *builder,
+                                                  const char        *name,
+                                                  const char *const *columns,
+                                                  const char *const *units,
+                                                  uint32_t           count,
+                                                  uint8_t            layout);
+
+/**
+ * @brief Appends a row of text cells to the open table
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param values Array of one value per column (non-NULL, zero-terminated strings)
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if no table is open, a row is partly added or
+ * a value is `NULL`, `SDK_ALLOCATION_ERROR` if the buffer could not grow
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_add_row(MdtpBuilder *builder, const char *const *values);
+
+/**
+ * @brief Appends a row of unsigned integer cells to the open table in one write. The cells are
+ * decimal text in MDTP v1 frames and `MDTP_VALUE_U64` in MDTP v2 frames.
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param values Not-null array of one value per column
+ * @return See `sdk_mdtp_builder_add_row`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_add_row_u64(MdtpBuilder *builder, const uint64_t *values);
+
+/**
+ * @brief Appends a text cell to the open table, in the column after the previous cell
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param value Value string (non-NULL, zero-terminated string)
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if no table is open or `value` is `NULL`,
+ * `SDK_ALLOCATION_ERROR` if the buffer could not grow
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_add_cell(MdtpBuilder *builder, const char *value);
+
+/**
+ * @brief Same as `sdk_mdtp_builder_add_cell`, but the value does not have to be zero-terminated
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param value Value string (non-NULL)
+ * @param value_length Count of bytes of `value`
+ * @return See `sdk_mdtp_builder_add_cell`. `SDK_INVALID_ARGUMENT` is also returned if
+ * `value_length` exceeds `UINT32_MAX`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_add_cell_n(MdtpBuilder *builder,
+                                                 const char  *value,
+                                                 size_t       value_length);
+
+/**
+ * @brief Appends a cell holding an unsigned integer, see `sdk_mdtp_builder_add_value_u64`
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param value Value
+ * @return See `sdk_mdtp_builder_add_cell`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_add_cell_u64(MdtpBuilder *builder, uint64_t value);
+
+/**
+ * @brief Appends a cell holding a signed integer, see `sdk_mdtp_builder_add_value_i64`
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param value Value
+ * @return See `sdk_mdtp_builder_add_cell`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_add_cell_i64(MdtpBuilder *builder, int64_t value);
+
+/**
+ * @brief Appends a cell holding a floating point number, see `sdk_mdtp_builder_add_value_f64`
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param value Value
+ * @param precision Count of fractional digits or `MDTP_F64_SHORTEST`. Ignored in MDTP v2 frames.
+ * @return See `sdk_mdtp_builder_add_cell`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_add_cell_f64(MdtpBuilder *builder,
+                                                   double       value,
+                                                   int          precision);
+
+/**
+ * @brief Closes the open table and writes its row count and payload size
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if no table is open or the last row is
+ * incomplete, `SDK_ALLOCATION_ERROR` if column-major cells could not be reordered,
+ * `SDK_OTHER_ERROR` if the payload exceeds `UINT32_MAX` bytes
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_builder_end_table(MdtpBuilder *builder);
+
+/**
+ * @brief Completes the frame, writes the MDTP header and stores the frame in the module.
+ *
+ * The builder is reset afterwards and can be used for the next frame immediately.
+ *
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param module The module in which the data will be saved
+ * @return Pointer to a valid `ABI_MODULE_MDTP_DATA` frame or `NULL` if an earlier call failed, a
+ * container or a table is still open, the frame exceeds `UINT32_MAX` bytes, or the frame is an
+ * MDTP v2 frame or has a table, an array or a histogram and the server does not report
+ * `ABI_CAPABILITY_MDTP_V2`, `ABI_CAPABILITY_TABLES`, `ABI_CAPABILITY_ARRAYS` or
+ * `ABI_CAPABILITY_HISTOGRAMS`. **Do not free it, as this will happen
+ * automatically when the module terminates!**
+ *
+ * @code{.c}
+ * // Example usage:
+ * sdk_mdtp_builder_begin_container(builder, "ram");
+ * sdk_mdtp_builder_add_value(builder, "usage", "12", "gb");
+ * sdk_mdtp_builder_end_container(builder);
+ * const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_builder_finish(builder, module);
+ * @endcode
+ */
+SDK_EXPORT const ABI_MODULE_MDTP_DATA *sdk_mdtp_builder_finish(MdtpBuilder *builder,
+                                                               IModule     *module);
+
+
+#ifdef __cplusplus
+}
+#endif
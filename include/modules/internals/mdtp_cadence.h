@@ -0,0 +1,117 @@
+/**
+ * @file modules/internals/mdtp_cadence.h
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#pragma once
+
+#include "../../general/sdk_status.h"
+#include "macro.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct IModule     IModule;     ///< Forward declaration
+typedef struct MdtpBuilder MdtpBuilder; ///< Forward declaration
+
+/*
+ * Per-subtree refresh cadence.
+ *
+ * The poll ratio of a module applies to all of its data, but a module often mixes cheap values
+ * that change on every poll (CPU usage) with expensive ones that rarely change (SMART attributes,
+ * installed packages). Each part can be written by its own subtree collector with its own refresh
+ * interval.
+ *
+ * `sdk_mdtp_cadence_add` writes the nodes of every collector into the builder. A collector whose
+ * interval has passed writes its nodes again, and the SDK keeps a copy of their bytes. The nodes
+ * of the other collectors are spliced in from the copy with one `memcpy`, without calling them. So
+ * an expensive subtree costs nothing on most polls.
+ *
+ * The copy is made before the frame is finished, so delta frames, dictionary strings,
+ * compression, CRC32C trailers and chunked frames apply to the whole frame as usual. A builder
+ * switched to another MDTP version makes every collector write its nodes again.
+ *
+ * Collectors are registered and `sdk_mdtp_cadence_add` is called from the thread that builds the
+ * frames of the module (the thread of the server, or the sampler or worker thread if the module
+ * has one).
+ */
+
+/**
+ * @brief Registers a subtree collector in the module
+ * @param module Not-null pointer to `IModule`
+ * @param collect Not-null collector with signature `void (MdtpBuilder *builder)`. It writes
+ * complete nodes into the builder, into the container open when `sdk_mdtp_cadence_add` is called.
+ * Errors are remembered by the builder as usual.
+ * @param interval_ms Milliseconds the nodes written by the collector are reused for. `0` - the
+ * collector is called on every `sdk_mdtp_cadence_add` and its nodes are not copied.
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if `collect` is `NULL` or already
+ * registered, `SDK_ALLOCATION_ERROR` if memory could not be allocated
+ *
+ * @code{.c}
+ * // Example usage:
+ * static void collect_cpu(MdtpBuilder *builder) {
+ *     sdk_mdtp_builder_add_value_f64(builder, "usage", cpu_usage(), 1, "%");
+ * }
+ *
+ * static void collect_packages(MdtpBuilder *builder) {
+ *     // Slow: reads the package database
+ *     sdk_mdtp_builder_begin_container(builder, "packages");
+ *     ...
+ *     sdk_mdtp_builder_end_container(builder);
+ * }
+ *
+ * // In module_init:
+ * sdk_mdtp_cadence_register(module, collect_cpu, 0);
+ * sdk_mdtp_cadence_register(module, collect_packages, 10 * 60 * 1000);
+ *
+ * // In get_data:
+ * sdk_mdtp_builder_begin_container(builder, "system");
+ * sdk_mdtp_cadence_add(module, builder);
+ * sdk_mdtp_builder_end_container(builder);
+ * return sdk_mdtp_builder_finish(builder, module);
+ * @endcode
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_cadence_register(IModule *module,
+                                               void (*collect)(MdtpBuilder *builder),
+                                               uint32_t interval_ms);
+
+/**
+ * @brief Makes the collector write its nodes again on the next `sdk_mdtp_cadence_add`, whether
+ * its interval has passed or not (for example, after a package was installed)
+ * @param module Not-null pointer to `IModule`
+ * @param collect Registered collector
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if the collector is not registered
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_cadence_refresh(IModule *module,
+                                              void (*collect)(MdtpBuilder *builder));
+
+/**
+ * @brief Writes the nodes of every collector of the module into the builder, in the order of
+ * registration. Collectors whose interval has passed are called, the nodes of the others are
+ * copied from their last call.
+ * @param module Not-null pointer to `IModule`
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if a table is open or a collector left a
+ * container or a table open or closed a container it did not open, `SDK_ALLOCATION_ERROR` if the
+ * buffer of the builder could not grow, or the status of the builder if an earlier call or a
+ * collector failed. The builder remembers the error, and collectors called by the failed call are
+ * called again next time.
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_cadence_add(IModule *module, MdtpBuilder *builder);
+
+/**
+ * @brief Get count of collectors registered in the module
+ * @param module Not-null pointer to `IModule`
+ * @return Count of collectors
+ */
+SDK_EXPORT size_t sdk_mdtp_cadence_size(const IModule *module);
+
+
+#ifdef __cplusplus
+}
+#endif
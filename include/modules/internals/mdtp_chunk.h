@@ -0,0 +1,148 @@
+/**
+ * @file modules/internals/mdtp_chunk.h
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#pragma once
+
+#include "../../general/sdk_status.h"
+#include "macro.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct IModule              IModule;              ///< Forward declaration
+typedef struct ABI_MODULE_MDTP_DATA ABI_MODULE_MDTP_DATA; ///< Forward declaration
+
+/*
+ * Chunked frames.
+ *
+ * A frame of several megabytes is a latency spike and a memory peak on both sides. With chunked
+ * frames enabled, frames larger than `chunk_size` bytes are sent as parts of at most
+ * `chunk_size` bytes of the frame each. `module_get_data` returns part `0`, and the server fetches
+ * the others with `module_get_data_chunk`, so it can consume the frame part by part. A part is:
+ *
+ * `[1 version | MDTP_FLAG_CHUNK] [4 payload size] [4 sequence] [4 count] [bytes]`
+ *
+ * `version` is the MDTP version of the frame, `sequence` is the number of the part (from `0`),
+ * `count` is the count of parts of the frame and `bytes` is the next slice of the frame. The
+ * `bytes` of all parts in order are the frame, header included, so the other flags belong to it.
+ *
+ * Splitting is the last step, after the CRC32C trailer. `MdtpBuilder` can also build a frame in
+ * chunks directly (see `sdk_mdtp_builder_set_chunk_size`), then the frame never exists in one
+ * piece and is sent without the other encodings.
+ */
+
+#define MDTP_CHUNK_HEADER_SIZE 13           ///< [1 version] [4 payload size] [4 sequence] [4 count]
+#define MDTP_CHUNK_MIN_SIZE 64              ///< Smallest count of frame bytes of a part
+#define MDTP_CHUNK_DEFAULT_SIZE (64 * 1024) ///< Part size that keeps the server latency flat
+
+/**
+ * @brief Part of a chunked frame, see `sdk_mdtp_chunk_parse`
+ */
+typedef struct MdtpChunk {
+    uint32_t    sequence; ///< Number of the part, from `0`
+    uint32_t    count;    ///< Count of parts of the frame
+    const void *bytes;    ///< Slice of the frame carried by the part
+    size_t      size;     ///< Count of bytes of `bytes`
+} MdtpChunk;
+
+/**
+ * @brief Enables chunked frames for the module
+ * @param module Not-null pointer to `IModule`
+ * @param chunk_size Largest count of frame bytes of a part, at least `MDTP_CHUNK_MIN_SIZE`. See
+ * `MDTP_CHUNK_DEFAULT_SIZE`.
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if `chunk_size` is too small,
+ * `SDK_OTHER_ERROR` if the server does not report `ABI_CAPABILITY_CHUNKED_FRAMES`,
+ * `SDK_ALLOCATION_ERROR` if memory could not be allocated
+ *
+ * @code{.c}
+ * // Example usage:
+ * static const ABI_MODULE_MDTP_DATA *get_data_chunk(uint32_t sequence) {
+ *     return sdk_mdtp_chunk_get(module, sequence);
+ * }
+ *
+ * // In module_init:
+ * sdk_mdtp_chunk_enable(module, MDTP_CHUNK_DEFAULT_SIZE);
+ * sdk_module_register_get_data_chunk(module, get_data_chunk);
+ *
+ * // In get_data, `sdk_mdtp_make_root` splits the frame by itself:
+ * return sdk_mdtp_make_root(module, ...);
+ *
+ * // Other producers need the explicit call:
+ * sdk_mdtp_template_emit(mdtp_template, module);
+ * return sdk_mdtp_chunk_emit(module);
+ * @endcode
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_chunk_enable(IModule *module, uint32_t chunk_size);
+
+/**
+ * @brief Disables chunked frames. `sdk_mdtp_chunk_emit` returns frames as they are.
+ * @param module Not-null pointer to `IModule`
+ */
+SDK_EXPORT void sdk_mdtp_chunk_disable(IModule *module);
+
+/**
+ * @brief Splits the last frame stored in the module or made by the other encodings into parts.
+ *
+ * If chunked frames are not enabled or the frame is not larger than `chunk_size`, the frame is
+ * returned as is. If the frame is already split or was built in chunks, its first part is
+ * returned again. If memory could not be allocated, the frame is returned as is.
+ *
+ * The frame stored in the module is not changed. The part buffers are kept between calls.
+ *
+ * @param module Not-null pointer to `IModule`
+ * @return Pointer to `ABI_MODULE_MDTP_DATA` to return from `get_data`. **Do not free it, as this
+ * will happen automatically when the module terminates!**
+ */
+SDK_EXPORT const ABI_MODULE_MDTP_DATA *sdk_mdtp_chunk_emit(IModule *module);
+
+/**
+ * @brief Get a part of the chunked frame to send
+ * @param module Not-null pointer to `IModule`
+ * @param sequence Number of the part, from `0`
+ * @return Pointer to `ABI_MODULE_MDTP_DATA` of the part, or `NULL` if the frame to send is not
+ * chunked or has no such part. **Do not free it!**
+ */
+SDK_EXPORT const ABI_MODULE_MDTP_DATA *sdk_mdtp_chunk_get(const IModule *module, uint32_t sequence);
+
+/**
+ * @brief Reads the header of a received part without copying it
+ * @param part Received part
+ * @param part_size Count of bytes of `part`
+ * @param chunk Not-null pointer where the part is described. `bytes` points into `part`.
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if `part` is not a part (`MDTP_FLAG_CHUNK`
+ * is not set), `SDK_ARGUMENT_PROCESSING_ERROR` if the part is malformed
+ *
+ * @code{.c}
+ * // Example usage. Consume a chunked frame part by part:
+ * MdtpChunk chunk;
+ * for (uint32_t i = 0; sdk_mdtp_chunk_parse(part->data, part->size, &chunk) == SDK_OK; ) {
+ *     consume(chunk.bytes, chunk.size);
+ *     if (++i == chunk.count) break;
+ *     part = functions->module_get_data_chunk(i);
+ * }
+ * @endcode
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_chunk_parse(const void *part, size_t part_size, MdtpChunk *chunk);
+
+/**
+ * @brief Joins received parts into the original frame, as the server does
+ * @param parts Array of `count` received parts in order. A single frame without
+ * `MDTP_FLAG_CHUNK` is copied.
+ * @param count Count of elements of `parts`
+ * @param size Not-null pointer where count of bytes of the result is stored
+ * @return Original frame allocated via `malloc` (must be freed with `free`), or `NULL` if the
+ * parts are malformed, out of order or incomplete, or memory could not be allocated
+ */
+SDK_EXPORT void *sdk_mdtp_chunk_join(const ABI_MODULE_MDTP_DATA *parts, size_t count, size_t *size);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,107 @@
+/**
+ * @file modules/internals/mdtp_compression.h
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#pragma once
+
+#include "../../general/sdk_status.h"
+#include "macro.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct IModule              IModule;              ///< Forward declaration
+typedef struct ABI_MODULE_MDTP_DATA ABI_MODULE_MDTP_DATA; ///< Forward declaration
+
+/*
+ * Compressed frames.
+ *
+ * Large frames (process tables, per-cgroup statistics) are mostly repeated names, units and
+ * digits. With compression enabled, frames of at least `threshold` bytes are compressed before
+ * they are sent. A compressed frame has the usual header, with `MDTP_FLAG_COMPRESSED` added to
+ * the first byte of the original frame (so the version and the other flags are kept), and its
+ * payload is:
+ *
+ * `[varint size] [block]`
+ *
+ * `size` is the payload size of the original frame (see `write_varint`) and `block` is the
+ * original payload compressed into the LZ4 block format, so the server may decode it with any
+ * LZ4 implementation. Frames the compression does not make smaller are sent as they are.
+ *
+ * Compression comes after delta and dictionary encoding: the frame of a delta or a dictionary
+ * encoding is compressed, not the other way round. Only the CRC32C trailer (see `mdtp_crc.h`)
+ * is appended after it.
+ */
+
+#define MDTP_COMPRESSION_DEFAULT_THRESHOLD 4096 ///< Frames smaller than this are rarely worth it
+
+/**
+ * @brief Enables compression of the frames of the module
+ * @param module Not-null pointer to `IModule`
+ * @param threshold Frames smaller than `threshold` bytes are sent as they are. See
+ * `MDTP_COMPRESSION_DEFAULT_THRESHOLD`.
+ * @return `SDK_OK` on success, `SDK_OTHER_ERROR` if the server does not report
+ * `ABI_CAPABILITY_COMPRESSION`, `SDK_ALLOCATION_ERROR` if memory could not be allocated
+ *
+ * @code{.c}
+ * // Example usage. In module_init:
+ * sdk_mdtp_compression_enable(module, MDTP_COMPRESSION_DEFAULT_THRESHOLD);
+ *
+ * // In get_data, `sdk_mdtp_make_root` compresses the frame by itself:
+ * return sdk_mdtp_make_root(module, ...);
+ *
+ * // Other producers and other encodings need the explicit call:
+ * sdk_mdtp_template_emit(mdtp_template, module);
+ * sdk_mdtp_delta_emit(module);
+ * return sdk_mdtp_compression_emit(module);
+ * @endcode
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_compression_enable(IModule *module, uint32_t threshold);
+
+/**
+ * @brief Disables compression. `sdk_mdtp_compression_emit` returns frames as they are.
+ * @param module Not-null pointer to `IModule`
+ */
+SDK_EXPORT void sdk_mdtp_compression_disable(IModule *module);
+
+/**
+ * @brief Compresses the last frame stored in the module or made by `sdk_mdtp_delta_emit` or
+ * `sdk_mdtp_dictionary_emit`.
+ *
+ * If compression is not enabled, the frame is smaller than the threshold or the compressed frame
+ * would not be smaller, the frame is returned as is. If the frame is already compressed, it is
+ * returned again.
+ *
+ * The frame stored in the module is not changed, so templates and trees keep patching it in place.
+ * The compression state and buffers are kept between calls, so a module compressing every poll
+ * stops allocating once the buffers have grown to the size of the largest frame.
+ *
+ * @param module Not-null pointer to `IModule`
+ * @return Pointer to `ABI_MODULE_MDTP_DATA` to return from `get_data`. **Do not free it, as this
+ * will happen automatically when the module terminates!**
+ */
+SDK_EXPORT const ABI_MODULE_MDTP_DATA *sdk_mdtp_compression_emit(IModule *module);
+
+/**
+ * @brief Turns a received frame into the original frame, as the server does
+ * @param frame Received frame. Frames without `MDTP_FLAG_COMPRESSED` are copied.
+ * @param frame_size Count of bytes of `frame`
+ * @param size Not-null pointer where count of bytes of the result is stored
+ * @return Original frame allocated via `malloc` (must be freed with `free`), or `NULL` if `frame`
+ * is malformed or memory could not be allocated. Only the compression is checked: the result may
+ * still be a delta frame or a frame with dictionary strings.
+ */
+SDK_EXPORT void *sdk_mdtp_compression_decompress(const void *frame,
+                                                 size_t      frame_size,
+                                                 size_t     *size);
+
+
+#ifdef __cplusplus
+}
+#endif
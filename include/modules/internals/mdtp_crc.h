@@ -0,0 +1,122 @@
+/**
+ * @file modules/internals/mdtp_crc.h
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#pragma once
+
+#include "../../general/sdk_status.h"
+#include "macro.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct IModule              IModule;              ///< Forward declaration
+typedef struct ABI_MODULE_MDTP_DATA ABI_MODULE_MDTP_DATA; ///< Forward declaration
+
+/*
+ * CRC32C trailers.
+ *
+ * With trailers enabled, every frame sent gets the CRC32C (Castagnoli) of its bytes appended, so
+ * the server can reject a corrupted frame without validating it. A frame with a trailer has
+ * `MDTP_FLAG_CRC` added to the first byte of the original frame, its payload size counts the
+ * trailer too, and its last 4 bytes are:
+ *
+ * `[4 crc]`
+ *
+ * `crc` is the big-endian `sdk_mdtp_crc32c` of all bytes before it, the header with the flag
+ * included.
+ *
+ * The CRC is computed with the CRC32 instructions of SSE4.2 (x86-64) or ARMv8 if the processor
+ * has them, and with a slicing-by-8 table otherwise. The choice is made at runtime.
+ *
+ * The trailer is the last step: it covers the frame after delta and dictionary encoding and
+ * compression.
+ */
+
+/**
+ * @brief Continues CRC32C of bytes
+ * @param crc CRC32C of the previous bytes, `0` to start
+ * @param bytes Bytes (non-NULL unless `size` is `0`)
+ * @param size Count of bytes
+ * @return CRC32C of the previous bytes followed by `bytes`
+ *
+ * @code{.c}
+ * // Example usage:
+ * uint32_t crc = sdk_mdtp_crc32c(0, "123456789", 9); // 0xE3069283
+ * @endcode
+ */
+SDK_EXPORT uint32_t sdk_mdtp_crc32c(uint32_t crc, const void *bytes, size_t size);
+
+/**
+ * @brief Enables CRC32C trailers for the module
+ * @param module Not-null pointer to `IModule`
+ * @return `SDK_OK` on success, `SDK_OTHER_ERROR` if the server does not report
+ * `ABI_CAPABILITY_CRC`, `SDK_ALLOCATION_ERROR` if memory could not be allocated
+ *
+ * @code{.c}
+ * // Example usage. In module_init:
+ * sdk_mdtp_crc_enable(module);
+ *
+ * // In get_data, `sdk_mdtp_make_root` appends the trailer by itself:
+ * return sdk_mdtp_make_root(module, ...);
+ *
+ * // Other producers and other encodings need the explicit call:
+ * sdk_mdtp_template_emit(mdtp_template, module);
+ * sdk_mdtp_compression_emit(module);
+ * return sdk_mdtp_crc_emit(module);
+ * @endcode
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_crc_enable(IModule *module);
+
+/**
+ * @brief Disables CRC32C trailers. `sdk_mdtp_crc_emit` returns frames as they are.
+ * @param module Not-null pointer to `IModule`
+ */
+SDK_EXPORT void sdk_mdtp_crc_disable(IModule *module);
+
+/**
+ * @brief Appends the CRC32C trailer to the last frame stored in the module or made by
+ * `sdk_mdtp_delta_emit`, `sdk_mdtp_dictionary_emit` or `sdk_mdtp_compression_emit`.
+ *
+ * If trailers are not enabled, the frame is returned as is. If the frame already has a trailer,
+ * it is returned again. If memory could not be allocated, the frame is returned without a
+ * trailer.
+ *
+ * The frame stored in the module is not changed, so templates and trees keep patching it in place.
+ *
+ * @param module Not-null pointer to `IModule`
+ * @return Pointer to `ABI_MODULE_MDTP_DATA` to return from `get_data`. **Do not free it, as this
+ * will happen automatically when the module terminates!**
+ */
+SDK_EXPORT const ABI_MODULE_MDTP_DATA *sdk_mdtp_crc_emit(IModule *module);
+
+/**
+ * @brief Checks the CRC32C trailer of a received frame
+ * @param frame Received frame
+ * @param frame_size Count of bytes of `frame`
+ * @return `SDK_OK` if the trailer matches the frame, `SDK_INVALID_ARGUMENT` if the frame has no
+ * trailer (`MDTP_FLAG_CRC` is not set), `SDK_ARGUMENT_PROCESSING_ERROR` if the frame is corrupted
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_crc_verify(const void *frame, size_t frame_size);
+
+/**
+ * @brief Checks the CRC32C trailer of a received frame and turns it into the original frame, as
+ * the server does
+ * @param frame Received frame. Frames without `MDTP_FLAG_CRC` are copied.
+ * @param frame_size Count of bytes of `frame`
+ * @param size Not-null pointer where count of bytes of the result is stored
+ * @return Original frame allocated via `malloc` (must be freed with `free`), or `NULL` if `frame`
+ * is corrupted or memory could not be allocated
+ */
+SDK_EXPORT void *sdk_mdtp_crc_strip(const void *frame, size_t frame_size, size_t *size);
+
+
+#ifdef __cplusplus
+}
+#endif
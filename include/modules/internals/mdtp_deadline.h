@@ -0,0 +1,116 @@
+/**
+ * @file modules/internals/mdtp_deadline.h
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#pragma once
+
+#include "../../general/sdk_status.h"
+#include "macro.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct IModule              IModule;              ///< Forward declaration
+typedef struct ABI_MODULE_MDTP_DATA ABI_MODULE_MDTP_DATA; ///< Forward declaration
+typedef struct ABI_MODULE_DATA_INFO ABI_MODULE_DATA_INFO; ///< Forward declaration
+
+/*
+ * Deadline-bounded data collection.
+ *
+ * A stalled collector (a hung `statfs` on NFS, a slow sysfs read) stalls the poll loop of the
+ * server with it. With a time budget the collect routine of the module runs on a worker thread of
+ * the SDK, and `sdk_mdtp_deadline_get_data` waits for it at most `budget_ms` milliseconds. If the
+ * collection is late, the last good frame is returned instead and marked stale (see
+ * `sdk_mdtp_deadline_is_stale`), and the collection finishes in the background: its frame is
+ * returned by the next poll unless a newer collection finishes in time. A late collection is
+ * never started twice.
+ *
+ * The first late poll of an incident logs a warning through `sdk_utils_log`, the next ones do
+ * not. The incident ends when a collection finishes in time.
+ *
+ * Unlike `sdk_mdtp_sampler_start`, collections still follow the polls of the server. For the same
+ * reasons, delta frames, dictionary strings and chunked frames cannot be used, and a module
+ * cannot have both a sampler and a budget.
+ */
+
+/**
+ * @brief Sets a time budget for the collect routine of the module
+ * @param module Not-null pointer to `IModule`
+ * @param collect Not-null collect routine with signature `const ABI_MODULE_MDTP_DATA *(void)`. It
+ * runs on the worker thread. A `NULL` frame counts as a failed collection: the last good frame
+ * stays.
+ * @param budget_ms Milliseconds `sdk_mdtp_deadline_get_data` waits for a collection, at least `1`
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if an argument is invalid, a budget is
+ * already set, the sampler of the module runs, or delta frames, dictionary strings or chunked
+ * frames are enabled, `SDK_ALLOCATION_ERROR` if memory could not be allocated, `SDK_OTHER_ERROR` if
+ * the worker thread could not be started
+ *
+ * @code{.c}
+ * // Example usage:
+ * static const ABI_MODULE_MDTP_DATA *collect(void) {
+ *     // Collection that may stall, as get_data did before
+ *     return sdk_mdtp_builder_finish(builder, module);
+ * }
+ *
+ * static const ABI_MODULE_MDTP_DATA *get_data(void) {
+ *     return sdk_mdtp_deadline_get_data(module);
+ * }
+ *
+ * // In module_init:
+ * sdk_module_register_get_data(module, get_data);
+ * sdk_mdtp_deadline_enable(module, collect, 50);
+ * @endcode
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_deadline_enable(IModule *module,
+                                              const ABI_MODULE_MDTP_DATA *(*collect)(void),
+                                              uint32_t budget_ms);
+
+/**
+ * @brief Removes the time budget and stops the worker thread. The last good frame stays available
+ * through `sdk_mdtp_deadline_get_data` until the module is destroyed. `sdk_imodule_destroy`
+ * removes the budget by itself, waiting for the collection in progress however late it is.
+ * @param module Not-null pointer to `IModule`. If no budget is set, no effect.
+ * @warning Waits for the collection in progress at most the budget. A collection still running
+ * after that is abandoned: the worker thread drops its frame once the collect routine returns, and
+ * exits. `sdk_imodule_destroy` waits for it, so the module and the state the routine uses stay
+ * valid until the module is destroyed. A module has at most one abandoned collection: while it
+ * runs, the next call waits for the collection in progress however late it is.
+ */
+SDK_EXPORT void sdk_mdtp_deadline_disable(IModule *module);
+
+/**
+ * @brief Collects a frame within the time budget of the module
+ * @param module Not-null pointer to `IModule`
+ * @return Pointer to `ABI_MODULE_MDTP_DATA` with the collected frame or, if the collection is late
+ * or failed, the last good frame. `NULL` if there is no good frame yet. The pointer is valid
+ * until the next call.
+ * @note Must be called from one thread at a time (the thread of the server). Without a budget
+ * returns the last good frame without collecting.
+ */
+SDK_EXPORT const ABI_MODULE_MDTP_DATA *sdk_mdtp_deadline_get_data(IModule *module);
+
+/**
+ * @brief Get hash and generation of the frame returned by the last `sdk_mdtp_deadline_get_data`,
+ * see `sdk_imodule_get_mdtp_data_info`. A stale frame keeps its generation.
+ * @param module Not-null pointer to `IModule`
+ * @return Pointer to `ABI_MODULE_DATA_INFO` or `NULL` if no frame was returned yet
+ */
+SDK_EXPORT const ABI_MODULE_DATA_INFO *sdk_mdtp_deadline_get_data_info(const IModule *module);
+
+/**
+ * @brief Check if the frame returned by the last `sdk_mdtp_deadline_get_data` is stale
+ * @param module Not-null pointer to `IModule`
+ * @return `1` if the collection of the last poll was late or failed, otherwise `0`
+ */
+SDK_EXPORT uint8_t sdk_mdtp_deadline_is_stale(const IModule *module);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,117 @@
+/**
+ * @file modules/internals/mdtp_delta.h
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#pragma once
+
+#include "../../general/sdk_status.h"
+#include "macro.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct IModule              IModule;              ///< Forward declaration
+typedef struct ABI_MODULE_MDTP_DATA ABI_MODULE_MDTP_DATA; ///< Forward declaration
+
+/*
+ * Delta frames.
+ *
+ * In delta mode the SDK remembers the last frame sent to the server and sends only what changed
+ * since then. A delta frame has the usual header, with `MDTP_FLAG_DELTA` set in the first byte,
+ * and its payload is a list of operations applied to the children of the root of the previous
+ * frame in order:
+ *
+ * - `MDTP_DELTA_KEEP` `[1 type] [4 count]` - keep the next `count` children unchanged
+ * - `MDTP_DELTA_REMOVE` `[1 type] [4 count]` - remove the next `count` children
+ * - a container or a value node - insert the node before the next child
+ * - `MDTP_DELTA_REPLACE` `[1 type] [node]` - replace the next child with the node
+ * - `MDTP_DELTA_MERGE` `[1 type] [4 size] [operations]` - apply `size` bytes of operations to the
+ *   children of the next child, which is a container, and keep it
+ *
+ * Children left after the last operation are kept. An empty payload means that nothing changed.
+ *
+ * Every `keyframe_interval` frames, and whenever a delta would not be smaller than the frame
+ * itself, the full frame (a keyframe) is sent instead. Deltas are made between MDTP v1 frames
+ * only, MDTP v2 frames are always sent as keyframes.
+ */
+
+#define MDTP_DELTA_REPLACE 0x7C ///< Delta operation: replace the next child with a node
+#define MDTP_DELTA_KEEP 0x7D    ///< Delta operation: keep the next children
+#define MDTP_DELTA_MERGE 0x7E   ///< Delta operation: apply operations to the next container
+#define MDTP_DELTA_REMOVE 0x7F  ///< Delta operation: remove the next children
+
+/**
+ * @brief Enables delta frames for the module
+ * @param module Not-null pointer to `IModule`
+ * @param keyframe_interval Count of frames between keyframes, `1` sends only keyframes
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if `keyframe_interval` is `0`,
+ * `SDK_OTHER_ERROR` if the server does not report `ABI_CAPABILITY_DELTA_FRAMES`,
+ * `SDK_ALLOCATION_ERROR` if memory could not be allocated
+ *
+ * @code{.c}
+ * // Example usage. In module_init:
+ * if (sdk_mdtp_delta_enable(module, 60) != SDK_OK) {
+ *     // Full frames are sent, nothing else changes
+ * }
+ *
+ * // In get_data:
+ * sdk_mdtp_make_root(module, ...);
+ * return sdk_mdtp_delta_emit(module);
+ * @endcode
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_delta_enable(IModule *module, uint32_t keyframe_interval);
+
+/**
+ * @brief Disables delta frames for the module. `sdk_mdtp_delta_emit` returns full frames.
+ * @param module Not-null pointer to `IModule`
+ */
+SDK_EXPORT void sdk_mdtp_delta_disable(IModule *module);
+
+/**
+ * @brief Makes the next `sdk_mdtp_delta_emit` send a keyframe, for example if the server may have
+ * lost the previous frames
+ * @param module Not-null pointer to `IModule`
+ */
+SDK_EXPORT void sdk_mdtp_delta_request_keyframe(IModule *module);
+
+/**
+ * @brief Turns the last frame stored in the module (by `sdk_mdtp_make_root`, a template, a tree or
+ * a builder) into the frame to send: a delta against the previously sent frame or a keyframe.
+ *
+ * If delta frames are not enabled, the stored frame is returned as is. If no new frame was stored
+ * since the previous call, the delta is empty.
+ *
+ * The frame stored in the module is not changed, so templates and trees keep patching it in place.
+ *
+ * @param module Not-null pointer to `IModule`
+ * @return Pointer to `ABI_MODULE_MDTP_DATA` to return from `get_data`, or `NULL` on allocation
+ * error. **Do not free it, as this will happen automatically when the module terminates!**
+ */
+SDK_EXPORT const ABI_MODULE_MDTP_DATA *sdk_mdtp_delta_emit(IModule *module);
+
+/**
+ * @brief Applies a frame received from a module to the previous full frame, as the server does
+ * @param base Previous full frame or `NULL` if there is none
+ * @param base_size Count of bytes of `base`
+ * @param frame Received frame: a delta or a keyframe
+ * @param frame_size Count of bytes of `frame`
+ * @param size Not-null pointer where count of bytes of the result is stored
+ * @return New full frame allocated via `malloc` (must be freed with `free`), or `NULL` if `frame`
+ * is malformed, does not fit `base` or memory could not be allocated
+ */
+SDK_EXPORT void *sdk_mdtp_delta_apply(const void *base,
+                                      size_t      base_size,
+                                      const void *frame,
+                                      size_t      frame_size,
+                                      size_t     *size);
+
+
+#ifdef __cplusplus
+}
+#endif
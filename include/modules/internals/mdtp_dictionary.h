@@ -0,0 +1,137 @@
+/**
+ * @file modules/internals/mdtp_dictionary.h
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#pragma once
+
+#include "../../general/sdk_status.h"
+#include "macro.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct IModule              IModule;              ///< Forward declaration
+typedef struct ABI_MODULE_MDTP_DATA ABI_MODULE_MDTP_DATA; ///< Forward declaration
+
+/*
+ * Dictionary strings.
+ *
+ * Names and units repeat in every frame. With the dictionary enabled the module sends every such
+ * string once, the server remembers it under the next id, and later frames refer to it by id.
+ * The dictionary lives as long as the session: until it is reset by the module.
+ *
+ * A frame with dictionary strings has the usual header, with `MDTP_FLAG_DICTIONARY` set in the
+ * first byte, and its payload is:
+ *
+ * `[varint known] [nodes]`
+ *
+ * `known` is the count of dictionary entries the frame relies on. The receiver drops entries
+ * defined after them, so a frame sent twice defines its strings once, and `0` starts a new
+ * dictionary. Nodes have the usual layout, except that names and units are strings in one of the
+ * forms (all varints are described in `write_varint`):
+ *
+ * - `[varint (id << 1) | 1]` - the dictionary entry `id`
+ * - `[varint (length << 2)] [string]` - the string, which becomes the next dictionary entry
+ * - `[varint (length << 2) | 2] [string]` - the string, which is not added to the dictionary
+ *
+ * Values, elements of arrays, buckets of histograms, payload sizes of containers and whole
+ * payloads of tables are written as in plain frames.
+ */
+
+#define MDTP_DICTIONARY_MAX_ENTRIES 4096 ///< Maximum count of strings in a dictionary
+#define MDTP_DICTIONARY_MAX_STRING 255   ///< Longer strings are never added to a dictionary
+
+/**
+ * @brief Decoder of frames with dictionary strings, keeping the dictionary of one module.
+ */
+typedef struct MdtpDictionaryDecoder MdtpDictionaryDecoder;
+
+/**
+ * @brief Enables dictionary strings for the module
+ * @param module Not-null pointer to `IModule`
+ * @return `SDK_OK` on success, `SDK_OTHER_ERROR` if the server does not report
+ * `ABI_CAPABILITY_DICTIONARY`, `SDK_ALLOCATION_ERROR` if memory could not be allocated
+ *
+ * @code{.c}
+ * // Example usage. In module_init:
+ * sdk_mdtp_dictionary_enable(module);
+ *
+ * // In get_data:
+ * sdk_mdtp_make_root(module, ...);
+ * return sdk_mdtp_dictionary_emit(module);
+ * @endcode
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_dictionary_enable(IModule *module);
+
+/**
+ * @brief Disables dictionary strings for the module. `sdk_mdtp_dictionary_emit` returns frames as
+ * they are.
+ * @param module Not-null pointer to `IModule`
+ */
+SDK_EXPORT void sdk_mdtp_dictionary_disable(IModule *module);
+
+/**
+ * @brief Makes the next `sdk_mdtp_dictionary_emit` start a new dictionary, for example if the
+ * server may have lost the previous frames
+ * @param module Not-null pointer to `IModule`
+ */
+SDK_EXPORT void sdk_mdtp_dictionary_reset(IModule *module);
+
+/**
+ * @brief Turns the last frame stored in the module (by `sdk_mdtp_make_root`, a template, a tree,
+ * a builder or `sdk_mdtp_delta_emit`) into a frame with dictionary strings.
+ *
+ * If the dictionary is not enabled, the frame is returned as is. Delta frames and MDTP v2 frames
+ * are returned as is too. If no new frame was stored since the previous call, the previous result
+ * is returned again.
+ *
+ * The frame stored in the module is not changed, so templates and trees keep patching it in place.
+ *
+ * If the frame could not be encoded (memory could not be allocated), it is returned as is and
+ * the next frame starts a new dictionary.
+ *
+ * @param module Not-null pointer to `IModule`
+ * @return Pointer to `ABI_MODULE_MDTP_DATA` to return from `get_data`. **Do not free it, as this
+ * will happen automatically when the module terminates!**
+ */
+SDK_EXPORT const ABI_MODULE_MDTP_DATA *sdk_mdtp_dictionary_emit(IModule *module);
+
+/**
+ * @brief Allocates a decoder with an empty dictionary, as the server keeps for every module
+ * @return Pointer to `MdtpDictionaryDecoder` or `NULL` if allocation failed. Must be freed with
+ * `sdk_mdtp_dictionary_decoder_destroy`.
+ */
+SDK_EXPORT MdtpDictionaryDecoder *sdk_mdtp_dictionary_decoder_create(void);
+
+/**
+ * @brief Destroys the decoder
+ * @param decoder Pointer to `MdtpDictionaryDecoder`. If `NULL`, no effect.
+ */
+SDK_EXPORT void sdk_mdtp_dictionary_decoder_destroy(MdtpDictionaryDecoder *decoder);
+
+/**
+ * @brief Turns a received frame into a plain frame, updating the dictionary of the decoder
+ * @param decoder Not-null pointer to `MdtpDictionaryDecoder`
+ * @param frame Received frame. Frames without `MDTP_FLAG_DICTIONARY` are copied.
+ * @param frame_size Count of bytes of `frame`
+ * @param size Not-null pointer where count of bytes of the result is stored
+ * @return Plain frame allocated via `malloc` (must be freed with `free`), or `NULL` if `frame` is
+ * malformed, relies on entries the decoder does not have or memory could not be allocated. On
+ * error the dictionary of the decoder is emptied, so it decodes frames again after the module
+ * resets its dictionary.
+ */
+SDK_EXPORT void *sdk_mdtp_dictionary_decode(MdtpDictionaryDecoder *decoder,
+                                            const void            *frame,
+                                            size_t                 frame_size,
+                                            size_t                *size);
+
+
+#ifdef __cplusplus
+}
+#endif
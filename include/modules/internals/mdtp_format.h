@@ -0,0 +1,78 @@
+/**
+ * @file modules/internals/mdtp_format.h
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#pragma once
+
+#include "macro.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MDTP_U64_MAX_LENGTH 20     ///< Max count of chars written by `sdk_mdtp_format_u64`
+#define MDTP_I64_MAX_LENGTH 20     ///< Max count of chars written by `sdk_mdtp_format_i64`
+#define MDTP_F64_MAX_LENGTH 330    ///< Max count of chars written by `sdk_mdtp_format_f64`
+#define MDTP_F64_MAX_PRECISION 17  ///< Max count of fractional digits in the fixed mode
+#define MDTP_F64_SHORTEST (-1)     ///< Precision that selects the shortest round-trip text
+
+/**
+ * @brief Get count of chars `sdk_mdtp_format_u64` writes for `value`
+ * @param value Value
+ * @return Count of decimal digits of `value`
+ */
+SDK_EXPORT size_t sdk_mdtp_format_u64_length(uint64_t value);
+
+/**
+ * @brief Writes `value` as decimal text. The output is the same as `printf("%" PRIu64)`.
+ *
+ * Digits are produced two at a time from a lookup table, without division by 10 for every digit
+ * and without allocations.
+ *
+ * @param buffer Not-null buffer of at least `MDTP_U64_MAX_LENGTH` chars. No `\0` is written.
+ * @param value Value to write
+ * @return Count of chars written
+ */
+SDK_EXPORT size_t sdk_mdtp_format_u64(char *buffer, uint64_t value);
+
+/**
+ * @brief Writes `value` as decimal text. The output is the same as `printf("%" PRId64)`.
+ * @param buffer Not-null buffer of at least `MDTP_I64_MAX_LENGTH` chars. No `\0` is written.
+ * @param value Value to write
+ * @return Count of chars written
+ */
+SDK_EXPORT size_t sdk_mdtp_format_i64(char *buffer, int64_t value);
+
+/**
+ * @brief Writes `value` as decimal text
+ *
+ * With `precision` from `0` to `MDTP_F64_MAX_PRECISION` the output is the same as
+ * `printf("%.*f", precision, value)` in the "C" locale. Values whose scaled integer part fits
+ * into 53 bits are formatted without `printf`, others fall back to it.
+ *
+ * With `MDTP_F64_SHORTEST` (or any negative precision) the output is the shortest text that reads
+ * back as exactly `value` (the Ryu algorithm, no `printf` involved). If several texts of that
+ * length read back as `value`, the closest one to `value` is written. It uses the fixed notation
+ * for decimal exponents from `-5` to `16` and `d.ddde±XX` otherwise, like `printf("%.17g")`
+ * without the noise digits. `nan` and `inf` are written as `nan`, `-nan`, `inf` and `-inf`.
+ *
+ * The decimal point is always `.`, regardless of the current locale.
+ *
+ * Precision above `MDTP_F64_MAX_PRECISION` is treated as `MDTP_F64_MAX_PRECISION`.
+ *
+ * @param buffer Not-null buffer of at least `MDTP_F64_MAX_LENGTH` chars. No `\0` is written.
+ * @param value Value to write
+ * @param precision Count of fractional digits or `MDTP_F64_SHORTEST`
+ * @return Count of chars written
+ */
+SDK_EXPORT size_t sdk_mdtp_format_f64(char *buffer, double value, int precision);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,172 @@
+/**
+ * @file modules/internals/mdtp_histogram.h
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#pragma once
+
+#include "../../general/sdk_status.h"
+#include "macro.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct MdtpBuilder MdtpBuilder; ///< Forward declaration
+
+/**
+ * @brief Histogram accumulator.
+ *
+ * Counts observations (request latencies, I/O sizes) in buckets with fixed upper bounds between
+ * polls. Any thread may record observations with `sdk_mdtp_histogram_observe`, which only does
+ * atomic increments and never blocks or allocates. In `get_data` the histogram is snapshotted
+ * into a histogram node (see `MDTP_NODE_HISTOGRAM`).
+ *
+ * The counts are cumulative over the life of the histogram, like the counters of the server.
+ * After `sdk_mdtp_histogram_set_cumulative` with `0`, every node holds only the observations
+ * since the previous one: the snapshot takes them out of the histogram bucket by bucket, so an
+ * observation recorded meanwhile is never lost, and a snapshot that could not be written puts them
+ * back.
+ *
+ * A snapshot taken while other threads record is not atomic as a whole: an observation may be in
+ * its bucket but not yet in the sum. Every count is exact.
+ */
+typedef struct MdtpHistogram MdtpHistogram;
+
+/**
+ * @brief Creates a histogram with the given bucket bounds
+ * @param bounds Increasing, finite upper bounds (inclusive) of all buckets but the last, which
+ * counts the observations above `bounds[count - 1]`. The bounds are copied.
+ * @param count Count of elements of `bounds`, from `1` to `MDTP_HISTOGRAM_MAX_BOUNDS`
+ * @return Pointer to `MdtpHistogram` or `NULL` if the bounds are invalid or memory could not be
+ * allocated. Must be freed with `sdk_mdtp_histogram_destroy`.
+ *
+ * @code{.c}
+ * // Example usage:
+ * static const double bounds[] = {0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1};
+ * MdtpHistogram *latency = sdk_mdtp_histogram_create(bounds, 8);
+ *
+ * // In a worker thread:
+ * sdk_mdtp_histogram_observe(latency, elapsed_seconds);
+ *
+ * // In get_data:
+ * sdk_mdtp_builder_begin_container(builder, "http");
+ * sdk_mdtp_histogram_add(latency, builder, "latency", "s");
+ * sdk_mdtp_builder_end_container(builder);
+ * return sdk_mdtp_builder_finish(builder, module);
+ * @endcode
+ */
+SDK_EXPORT MdtpHistogram *sdk_mdtp_histogram_create(const double *bounds, size_t count);
+
+/**
+ * @brief Creates a histogram with `count` bounds `start`, `start + width`, `start + 2 * width`...
+ * @param start First bound
+ * @param width Distance between bounds, greater than `0`
+ * @param count Count of bounds, from `1` to `MDTP_HISTOGRAM_MAX_BOUNDS`
+ * @return See `sdk_mdtp_histogram_create`
+ */
+SDK_EXPORT MdtpHistogram *sdk_mdtp_histogram_create_linear(double start,
+                                                           double width,
+                                                           size_t count);
+
+/**
+ * @brief Creates a histogram with `count` bounds `start`, `start * factor`,
+ * `start * factor * factor`... Suits latencies and sizes, which span orders of magnitude.
+ * @param start First bound, greater than `0`
+ * @param factor Ratio between bounds, greater than `1`
+ * @param count Count of bounds, from `1` to `MDTP_HISTOGRAM_MAX_BOUNDS`
+ * @return See `sdk_mdtp_histogram_create`
+ *
+ * @code{.c}
+ * // Example usage. 1 us to about 8 s:
+ * MdtpHistogram *latency = sdk_mdtp_histogram_create_exponential(1e-6, 2, 24);
+ * @endcode
+ */
+SDK_EXPORT MdtpHistogram *sdk_mdtp_histogram_create_exponential(double start,
+                                                                double factor,
+                                                                size_t count);
+
+/**
+ * @brief Destroys a histogram. No thread may record into it anymore.
+ * @param histogram Pointer to `MdtpHistogram`. If `NULL`, no effect.
+ */
+SDK_EXPORT void sdk_mdtp_histogram_destroy(MdtpHistogram *histogram);
+
+/**
+ * @brief Records an observation. Thread-safe and lock-free.
+ * @param histogram Not-null pointer to `MdtpHistogram`
+ * @param value Observed value. `NaN` is ignored.
+ */
+SDK_EXPORT void sdk_mdtp_histogram_observe(MdtpHistogram *histogram, double value);
+
+/**
+ * @brief Sets all counts and the sum to `0`. Observations recorded concurrently may be kept or
+ * dropped: to send every observation once, use `sdk_mdtp_histogram_set_cumulative` instead of a
+ * snapshot followed by a reset.
+ * @param histogram Not-null pointer to `MdtpHistogram`
+ */
+SDK_EXPORT void sdk_mdtp_histogram_reset(MdtpHistogram *histogram);
+
+/**
+ * @brief Selects whether the nodes made by `sdk_mdtp_histogram_make` and `sdk_mdtp_histogram_add`
+ * hold the observations since the histogram was created (the default) or since the previous node
+ * @param histogram Not-null pointer to `MdtpHistogram`
+ * @param cumulative `1` - counts are kept, `0` - every node takes the observations out of the
+ * histogram. `sdk_mdtp_histogram_snapshot` never takes them out.
+ */
+SDK_EXPORT void sdk_mdtp_histogram_set_cumulative(MdtpHistogram *histogram, uint8_t cumulative);
+
+/**
+ * @brief Get the bucket bounds of a histogram
+ * @param histogram Not-null pointer to `MdtpHistogram`
+ * @param count Not-null pointer where count of bounds is stored. There is one bucket more.
+ * @return Pointer to the bounds, valid until the histogram is destroyed
+ */
+SDK_EXPORT const double *sdk_mdtp_histogram_bounds(const MdtpHistogram *histogram, size_t *count);
+
+/**
+ * @brief Copies the counts and the sum of a histogram
+ * @param histogram Not-null pointer to `MdtpHistogram`
+ * @param counts Array of at least count of bounds plus one elements. May be `NULL`.
+ * @param sum Pointer where the sum of the observations is stored. May be `NULL`.
+ * @return Count of observations
+ */
+SDK_EXPORT uint64_t sdk_mdtp_histogram_snapshot(const MdtpHistogram *histogram,
+                                                uint64_t            *counts,
+                                                double              *sum);
+
+/**
+ * @brief Snapshots a histogram into a histogram node, see `sdk_mdtp_make_histogram`
+ * @param histogram Not-null pointer to `MdtpHistogram`
+ * @param value_name Name of the node (non-NULL, zero-terminated string)
+ * @param value_units Units of the observations (non-NULL, zero-terminated string)
+ * @return `void*` Pointer to the created node or `NULL` on error. Ownership rules are the same as
+ * for `sdk_mdtp_make_value`.
+ * @note Snapshots of one histogram must not be taken from several threads at the same time
+ */
+SDK_EXPORT void *sdk_mdtp_histogram_make(MdtpHistogram *histogram,
+                                         const char    *value_name,
+                                         const char    *value_units);
+
+/**
+ * @brief Snapshots a histogram into the frame being built, see `sdk_mdtp_builder_add_histogram`
+ * @param histogram Not-null pointer to `MdtpHistogram`
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param value_name Name of the node (non-NULL, zero-terminated string)
+ * @param value_units Units of the observations (non-NULL, zero-terminated string)
+ * @return See `sdk_mdtp_builder_add_histogram`
+ * @note Snapshots of one histogram must not be taken from several threads at the same time
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_histogram_add(MdtpHistogram *histogram,
+                                            MdtpBuilder   *builder,
+                                            const char    *value_name,
+                                            const char    *value_units);
+
+
+#ifdef __cplusplus
+}
+#endif
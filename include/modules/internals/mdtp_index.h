@@ -0,0 +1,128 @@
+/**
+ * @file modules/internals/mdtp_index.h
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#pragma once
+
+#include "../../general/sdk_status.h"
+#include "macro.h"
+#include "mdtp_reader.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Hash index from paths to nodes of an existing MDTP frame.
+ *
+ * Building the index walks the frame once. After that, a lookup by path (names separated by `/`,
+ * e.g. `"cpu/total/usage"`) hashes the path and compares names along the path with the frame,
+ * without walking or parsing the rest of the frame.
+ *
+ * The index does not copy the frame: it keeps offsets of nodes, and lookups return readers
+ * pointing into the frame. The frame must stay alive and unchanged while the index is used with
+ * it.
+ *
+ * The index keeps its memory between builds, so an index rebuilt for every new frame stops
+ * allocating once it has grown to the largest frame.
+ */
+typedef struct MdtpIndex MdtpIndex;
+
+/**
+ * @brief Allocates an empty index
+ * @return Pointer to `MdtpIndex` or `NULL` if allocation failed. Must be freed with
+ * `sdk_mdtp_index_destroy`.
+ */
+SDK_EXPORT MdtpIndex *sdk_mdtp_index_create(void);
+
+/**
+ * @brief Destroys the index
+ * @param index Pointer to `MdtpIndex`. If `NULL`, no effect.
+ */
+SDK_EXPORT void sdk_mdtp_index_destroy(MdtpIndex *index);
+
+/**
+ * @brief Indexes all nodes of the frame. The previous contents of the index are discarded.
+ * @param index Not-null pointer to `MdtpIndex`
+ * @param frame Pointer to the frame (header included)
+ * @param size Count of bytes of the frame
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if `frame` is `NULL`,
+ * `SDK_ARGUMENT_PROCESSING_ERROR` if the frame is malformed (see `sdk_mdtp_validate`),
+ * `SDK_ALLOCATION_ERROR` if memory could not be allocated. On error the index is empty.
+ *
+ * @code{.c}
+ * // Example usage:
+ * MdtpIndex *index = sdk_mdtp_index_create();
+ * MdtpReader usage;
+ *
+ * if (sdk_mdtp_index_build(index, data->data, data->size) == SDK_OK &&
+ *     sdk_mdtp_index_lookup(index, "cpu/total/usage", &usage) == SDK_OK) {
+ *     size_t      length;
+ *     const char *value = sdk_mdtp_reader_value(&usage, &length);
+ * }
+ * @endcode
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_index_build(MdtpIndex *index, const void *frame, size_t size);
+
+/**
+ * @brief Points the index to another frame with the same layout without walking it.
+ *
+ * Frames emitted by a template keep every node at the same offset while
+ * `sdk_mdtp_template_layout` of the template does not change. For such frames rebinding replaces
+ * rebuilding:
+ *
+ * @code{.c}
+ * // Example usage:
+ * const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_template_emit(cpu_template, module);
+ * uint64_t                    layout = sdk_mdtp_template_layout(cpu_template);
+ *
+ * if (layout == indexed_layout) {
+ *     sdk_mdtp_index_rebind(index, data->data, data->size);
+ * } else {
+ *     sdk_mdtp_index_build(index, data->data, data->size);
+ *     indexed_layout = layout;
+ * }
+ * @endcode
+ *
+ * Lookups check names and bounds against the new frame, so rebinding to a frame with another
+ * layout never reads outside of it: paths that moved are just not found.
+ *
+ * @param index Not-null pointer to `MdtpIndex`
+ * @param frame Pointer to the frame (header included)
+ * @param size Count of bytes of the frame
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if `frame` is `NULL`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_index_rebind(MdtpIndex *index, const void *frame, size_t size);
+
+/**
+ * @brief Get count of nodes in the index
+ * @param index Not-null pointer to `MdtpIndex`
+ * @return Count of indexed nodes (values and containers)
+ */
+SDK_EXPORT size_t sdk_mdtp_index_size(const MdtpIndex *index);
+
+/**
+ * @brief Finds the node at `path`
+ * @param index Not-null pointer to `MdtpIndex`
+ * @param path Not-null path of names separated by `/`. If several nodes of a container have the
+ * same name, the first one is found.
+ * @param node Not-null pointer to `MdtpReader`. On success it is positioned on the node, so
+ * `sdk_mdtp_reader_name`, `sdk_mdtp_reader_value`, `sdk_mdtp_reader_enter_container` and other
+ * accessors can be used with it, and `sdk_mdtp_reader_next` moves to the next node of the same
+ * container.
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if `path` is `NULL` or there is no node at
+ * `path`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_index_lookup(const MdtpIndex *index,
+                                           const char      *path,
+                                           MdtpReader      *node);
+
+
+#ifdef __cplusplus
+}
+#endif
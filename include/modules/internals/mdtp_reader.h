@@ -0,0 +1,446 @@
+/**
+ * @file modules/internals/mdtp_reader.h
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#pragma once
+
+#include "../../general/sdk_status.h"
+#include "macro.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Cursor over the nodes of one level of an MDTP frame.
+ *
+ * Frames of both `MDTP_VERSION` and `MDTP_VERSION_2` are read. Typed values of v2 frames are read
+ * with `sdk_mdtp_reader_value_u64` and others, which also parse text values, so the same code
+ * reads frames of both versions.
+ *
+ * The reader does not allocate and does not copy: names, units and values are returned as
+ * pointers into the frame, which must stay alive while the reader is used. Every length field is
+ * checked against the bounds of the enclosing container before it is used, so a malformed frame
+ * never makes the reader access memory outside of it.
+ *
+ * A reader walks the nodes of one container (or of the root). To walk the nodes of a nested
+ * container, create another reader with `sdk_mdtp_reader_enter_container`; the outer reader stays
+ * valid and continues after the container. The cells of a table are walked the same way with a
+ * reader made by `sdk_mdtp_reader_enter_table`.
+ *
+ * @note Fields are private, the structure is public only so that readers can live on the stack.
+ *
+ * @code{.c}
+ * // Example usage:
+ * MdtpReader reader;
+ *
+ * if (sdk_mdtp_reader_init(&reader, data->data, data->size) != SDK_OK) {
+ *     return;
+ * }
+ *
+ * while (sdk_mdtp_reader_next(&reader)) {
+ *     size_t      name_length;
+ *     const char *name = sdk_mdtp_reader_name(&reader, &name_length);
+ *
+ *     if (sdk_mdtp_reader_type(&reader) == MDTP_NODE_CONTAINER) {
+ *         MdtpReader child;
+ *         sdk_mdtp_reader_enter_container(&reader, &child);
+ *         // ...
+ *     }
+ * }
+ *
+ * if (sdk_mdtp_reader_status(&reader) != SDK_OK) {
+ *     // Malformed frame
+ * }
+ * @endcode
+ */
+typedef struct MdtpReader {
+    const uint8_t *data;         ///< Frame
+    size_t         offset;       ///< Offset of the next node
+    size_t         end;          ///< End of the payload of the current level
+    size_t         node;         ///< Offset of the current node
+    size_t         node_end;     ///< End of the current node
+    size_t         name;         ///< Offset of the name of the current node
+    size_t         units;        ///< Offset of the units of the current value node
+    size_t         value;        ///< Offset of the value (payload for containers) of the node
+    uint32_t       name_length;  ///< Count of bytes of the name
+    uint32_t       units_length; ///< Count of bytes of the units
+    uint32_t       value_length; ///< Count of bytes of the value (payload for containers)
+    uint8_t        type;         ///< Type of the current node
+    uint8_t        value_type;   ///< Type of the value of the current value node
+    uint8_t        version;      ///< MDTP version of the frame
+    SDKStatus      status;       ///< `SDK_OK` or the error that stopped the reader
+    uint8_t        table;        ///< `1` if the reader walks the cells of a table
+    uint8_t        layout;       ///< Layout of the table
+    uint32_t       rows;         ///< Count of rows of the table
+    uint32_t       columns;      ///< Count of columns of the table
+    uint64_t       cell;         ///< Count of cells read
+    size_t         first_column; ///< Offset of the definition of the first column
+    size_t         next_column;  ///< Offset of the definition after the column of the current cell
+} MdtpReader;
+
+/**
+ * @brief Type of a container node
+ */
+#define MDTP_NODE_CONTAINER 0
+
+/**
+ * @brief Type of a value node
+ */
+#define MDTP_NODE_VALUE 1
+
+/**
+ * @brief Type of a table node.
+ *
+ * Per-process, per-disk or per-interface metrics are a table: the same values for every entity.
+ * A table node declares the names and units of its columns once and then holds only the cells,
+ * instead of a container per entity repeating every name and units. The node is framed like a
+ * container, and its payload is:
+ *
+ * `[1 layout] [4 row count] [4 column count] [columns] [cells]`
+ *
+ * Every column is `[4 name length] [name] [4 units length] [units]`, every cell is
+ * `[4 value length] [value]`. The cells go row after row (`MDTP_TABLE_ROWS`) or column after
+ * column (`MDTP_TABLE_COLUMNS`), which puts similar values next to each other for compression.
+ *
+ * In MDTP v2 frames all lengths and counts are varints (the row count is padded to 5 bytes), and
+ * every cell is `[1 value type] [value]` like the end of a value node.
+ *
+ * Send tables only to servers reporting `ABI_CAPABILITY_TABLES`.
+ */
+#define MDTP_NODE_TABLE 2
+
+#define MDTP_TABLE_ROWS 0    ///< Table layout: cells of a row are stored together
+#define MDTP_TABLE_COLUMNS 1 ///< Table layout: cells of a column are stored together
+
+/**
+ * @brief Type of a numeric array node.
+ *
+ * Per-core utilization, per-queue counters or bucket counts are arrays of numbers. An array node
+ * has one name and units and then the packed elements:
+ *
+ * `[1 type] [4 name length] [name] [4 units length] [units] [1 element type] [4 count] [elements]`
+ *
+ * The element type is `MDTP_VALUE_U64` or `MDTP_VALUE_F64`, and every element is 8 bytes in
+ * **Big Endian** order (`write_uint64_be_array`). In MDTP v2 frames the lengths and the count are
+ * varints.
+ *
+ * Send arrays only to servers reporting `ABI_CAPABILITY_ARRAYS`.
+ */
+#define MDTP_NODE_ARRAY 3
+
+/**
+ * @brief Type of a histogram node.
+ *
+ * Latency and size distributions are a histogram: counts of observations in buckets with fixed
+ * upper bounds, and the sum of the observations. A histogram node is:
+ *
+ * `[1 type] [4 name length] [name] [4 units length] [units] [4 bound count] [bounds] [counts]
+ * [8 sum]`
+ *
+ * `bounds` are the increasing upper bounds (inclusive) of all buckets but the last, as 8-byte
+ * **Big Endian** IEEE 754 doubles. The last bucket has no upper bound, so there is one count more
+ * than bounds. Counts are per bucket (not cumulative), 8-byte **Big Endian** unsigned integers. The
+ * count of observations is the sum of the counts. `sum` is an 8-byte **Big Endian** double.
+ *
+ * In MDTP v2 frames the lengths, the bound count and the counts are varints, so empty and sparse
+ * buckets take one byte.
+ *
+ * Send histograms only to servers reporting `ABI_CAPABILITY_HISTOGRAMS`.
+ */
+#define MDTP_NODE_HISTOGRAM 4
+
+#define MDTP_HISTOGRAM_MAX_BOUNDS 4096 ///< Largest count of bounds of a histogram node
+
+#define MDTP_VALUE_TEXT 0  ///< Value type: text, the only type of MDTP v1 values
+#define MDTP_VALUE_U64 1   ///< Value type (v2): unsigned integer, `[varint value]`
+#define MDTP_VALUE_I64 2   ///< Value type (v2): signed integer, `[varint zigzag(value)]`
+#define MDTP_VALUE_F64 3   ///< Value type (v2): IEEE 754 double, `[8 bits of value]`
+#define MDTP_VALUE_BOOL 4  ///< Value type (v2): boolean, `[1 value]` (`0` or `1`)
+#define MDTP_VALUE_BYTES 5 ///< Value type (v2): bytes, `[varint length] [bytes]`
+
+/**
+ * @brief Checks all length fields of the frame in one linear pass without recursion.
+ *
+ * After a frame passed the validation, readers over it never fail.
+ *
+ * @param frame Pointer to the frame (header included)
+ * @param size Count of bytes of the frame
+ * @return `SDK_OK` if the frame is well-formed, `SDK_INVALID_ARGUMENT` if `frame` is `NULL`,
+ * `SDK_ARGUMENT_PROCESSING_ERROR` if the frame is malformed: the header is missing or has an
+ * unknown version, payload size does not match `size`, a node or a value has an unknown type, a
+ * length field goes beyond the enclosing container, containers are nested deeper than
+ * `MDTP_MAX_DEPTH` or a table does not hold exactly its count of cells
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_validate(const void *frame, size_t size);
+
+/**
+ * @brief Initializes a reader over the root nodes of a frame. The reader is positioned before the
+ * first node.
+ * @param reader Not-null pointer to `MdtpReader`
+ * @param frame Pointer to the frame (header included)
+ * @param size Count of bytes of the frame
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if `frame` is `NULL`,
+ * `SDK_ARGUMENT_PROCESSING_ERROR` if the header is missing or has an unknown version or the payload
+ * size does not match `size`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_reader_init(MdtpReader *reader, const void *frame, size_t size);
+
+/**
+ * @brief Moves the reader to the next node of its level
+ * @param reader Not-null pointer to `MdtpReader`
+ * @return `1` if the reader is positioned on a node, `0` if there are no more nodes or the node
+ * is malformed. In the second case `sdk_mdtp_reader_status` tells which one happened.
+ */
+SDK_EXPORT int sdk_mdtp_reader_next(MdtpReader *reader);
+
+/**
+ * @brief Get status of the reader
+ * @param reader Not-null pointer to `MdtpReader`
+ * @return `SDK_OK` if no error occurred, `SDK_ARGUMENT_PROCESSING_ERROR` if a malformed node was
+ * found
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_reader_status(const MdtpReader *reader);
+
+/**
+ * @brief Initializes `child` as a reader over the nodes of the current container
+ * @param reader Not-null pointer to `MdtpReader` positioned on a container
+ * @param child Not-null pointer to `MdtpReader` to initialize
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if the reader is not positioned on a
+ * container
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_reader_enter_container(const MdtpReader *reader, MdtpReader *child);
+
+/**
+ * @brief Initializes `cells` as a reader over the cells of the current table.
+ *
+ * The cells are read in the order they are stored, see `sdk_mdtp_reader_table_layout`. Every cell
+ * reads as a value node named after its column: `sdk_mdtp_reader_name`, `sdk_mdtp_reader_units`,
+ * `sdk_mdtp_reader_value` and the typed accessors work as for values.
+ *
+ * @param reader Not-null pointer to `MdtpReader` positioned on a table
+ * @param cells Not-null pointer to `MdtpReader` to initialize
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if the reader is not positioned on a table,
+ * `SDK_ARGUMENT_PROCESSING_ERROR` if the layout or the columns of the table are malformed
+ *
+ * @code{.c}
+ * // Example usage:
+ * MdtpReader cells;
+ *
+ * if (sdk_mdtp_reader_enter_table(&reader, &cells) == SDK_OK) {
+ *     while (sdk_mdtp_reader_next(&cells)) {
+ *         uint32_t row = sdk_mdtp_reader_cell_row(&cells);
+ *         uint32_t column = sdk_mdtp_reader_cell_column(&cells);
+ *         // ...
+ *     }
+ * }
+ * @endcode
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_reader_enter_table(const MdtpReader *reader, MdtpReader *cells);
+
+/**
+ * @brief Get count of rows of the table
+ * @param cells Not-null pointer to `MdtpReader` made by `sdk_mdtp_reader_enter_table`
+ * @return Count of rows
+ */
+SDK_EXPORT uint32_t sdk_mdtp_reader_table_rows(const MdtpReader *cells);
+
+/**
+ * @brief Get count of columns of the table
+ * @param cells Not-null pointer to `MdtpReader` made by `sdk_mdtp_reader_enter_table`
+ * @return Count of columns
+ */
+SDK_EXPORT uint32_t sdk_mdtp_reader_table_columns(const MdtpReader *cells);
+
+/**
+ * @brief Get layout of the table
+ * @param cells Not-null pointer to `MdtpReader` made by `sdk_mdtp_reader_enter_table`
+ * @return `MDTP_TABLE_ROWS` or `MDTP_TABLE_COLUMNS`
+ */
+SDK_EXPORT uint8_t sdk_mdtp_reader_table_layout(const MdtpReader *cells);
+
+/**
+ * @brief Get name and units of a column of the table
+ * @param cells Not-null pointer to `MdtpReader` made by `sdk_mdtp_reader_enter_table`
+ * @param column Number of the column, from `0`
+ * @param name Not-null pointer where the name is stored (**not zero-terminated**)
+ * @param name_length Not-null pointer where count of bytes of the name is stored
+ * @param units Not-null pointer where the units are stored (**not zero-terminated**)
+ * @param units_length Not-null pointer where count of bytes of the units is stored
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if there is no such column
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_reader_table_column(const MdtpReader *cells,
+                                                  uint32_t          column,
+                                                  const char      **name,
+                                                  size_t           *name_length,
+                                                  const char      **units,
+                                                  size_t           *units_length);
+
+/**
+ * @brief Get row of the current cell
+ * @param cells Not-null pointer to `MdtpReader` made by `sdk_mdtp_reader_enter_table` and
+ * positioned on a cell
+ * @return Number of the row, from `0`
+ */
+SDK_EXPORT uint32_t sdk_mdtp_reader_cell_row(const MdtpReader *cells);
+
+/**
+ * @brief Get column of the current cell
+ * @param cells Not-null pointer to `MdtpReader` made by `sdk_mdtp_reader_enter_table` and
+ * positioned on a cell
+ * @return Number of the column, from `0`
+ */
+SDK_EXPORT uint32_t sdk_mdtp_reader_cell_column(const MdtpReader *cells);
+
+/**
+ * @brief Get MDTP version of the frame
+ * @param reader Not-null pointer to initialized `MdtpReader`
+ * @return `MDTP_VERSION` or `MDTP_VERSION_2`
+ */
+SDK_EXPORT uint8_t sdk_mdtp_reader_version(const MdtpReader *reader);
+
+/**
+ * @brief Get type of the current node
+ * @param reader Not-null pointer to `MdtpReader` positioned on a node
+ * @return `MDTP_NODE_CONTAINER`, `MDTP_NODE_VALUE`, `MDTP_NODE_TABLE` or `MDTP_NODE_ARRAY`. Cells
+ * of a table are `MDTP_NODE_VALUE`.
+ */
+SDK_EXPORT uint8_t sdk_mdtp_reader_type(const MdtpReader *reader);
+
+/**
+ * @brief Get type of the value of the current value node
+ * @param reader Not-null pointer to `MdtpReader` positioned on a node
+ * @return One of `MDTP_VALUE_*`, always `MDTP_VALUE_TEXT` for values of MDTP v1 frames. For arrays
+ * this is the type of the elements.
+ */
+SDK_EXPORT uint8_t sdk_mdtp_reader_value_type(const MdtpReader *reader);
+
+/**
+ * @brief Get name of the current node
+ * @param reader Not-null pointer to `MdtpReader` positioned on a node
+ * @param length Not-null pointer where count of bytes of the name is stored
+ * @return Pointer to the name in the frame. **Not zero-terminated.**
+ */
+SDK_EXPORT const char *sdk_mdtp_reader_name(const MdtpReader *reader, size_t *length);
+
+/**
+ * @brief Get units of the current value or array node
+ * @param reader Not-null pointer to `MdtpReader` positioned on a node
+ * @param length Not-null pointer where count of bytes of the units is stored
+ * @return Pointer to the units in the frame (**not zero-terminated**) or `NULL` if the node is a
+ * container or a table
+ */
+SDK_EXPORT const char *sdk_mdtp_reader_units(const MdtpReader *reader, size_t *length);
+
+/**
+ * @brief Get value of the current value node
+ * @param reader Not-null pointer to `MdtpReader` positioned on a node
+ * @param length Not-null pointer where count of bytes of the value is stored
+ * @return Pointer to the value in the frame (**not zero-terminated**) or `NULL` if the node is a
+ * container or a table. For numbers and booleans of MDTP v2 frames this is their encoding
+ * described at `MDTP_VALUE_*`.
+ */
+SDK_EXPORT const char *sdk_mdtp_reader_value(const MdtpReader *reader, size_t *length);
+
+/**
+ * @brief Get value of the current value node as an unsigned integer
+ * @param reader Not-null pointer to `MdtpReader` positioned on a node
+ * @param value Not-null pointer where the value is stored
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if the value is not `MDTP_VALUE_U64`, a
+ * non-negative `MDTP_VALUE_I64` or a text of decimal digits that fits
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_reader_value_u64(const MdtpReader *reader, uint64_t *value);
+
+/**
+ * @brief Get value of the current value node as a signed integer
+ * @param reader Not-null pointer to `MdtpReader` positioned on a node
+ * @param value Not-null pointer where the value is stored
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if the value is not `MDTP_VALUE_I64`,
+ * `MDTP_VALUE_U64` that fits or a text of decimal digits (with optional `-`) that fits
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_reader_value_i64(const MdtpReader *reader, int64_t *value);
+
+/**
+ * @brief Get value of the current value node as a floating point number
+ * @param reader Not-null pointer to `MdtpReader` positioned on a node
+ * @param value Not-null pointer where the value is stored
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if the value is not a number or a text
+ * holding a number
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_reader_value_f64(const MdtpReader *reader, double *value);
+
+/**
+ * @brief Get value of the current value node as a boolean
+ * @param reader Not-null pointer to `MdtpReader` positioned on a node
+ * @param value Not-null pointer where `0` or `1` is stored
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if the value is not `MDTP_VALUE_BOOL` or one
+ * of texts `true`, `false`, `1`, `0`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_reader_value_bool(const MdtpReader *reader, uint8_t *value);
+
+/**
+ * @brief Get count of elements of the current array node
+ * @param reader Not-null pointer to `MdtpReader` positioned on a node
+ * @return Count of elements, `0` if the node is not an array
+ */
+SDK_EXPORT size_t sdk_mdtp_reader_array_length(const MdtpReader *reader);
+
+/**
+ * @brief Copies the elements of the current array node of `MDTP_VALUE_U64` elements
+ * @param reader Not-null pointer to `MdtpReader` positioned on a node
+ * @param values Array of at least `sdk_mdtp_reader_array_length` elements
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if the node is not an array of
+ * `MDTP_VALUE_U64` elements
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_reader_array_u64(const MdtpReader *reader, uint64_t *values);
+
+/**
+ * @brief Copies the elements of the current array node as floating point numbers
+ * @param reader Not-null pointer to `MdtpReader` positioned on a node
+ * @param values Array of at least `sdk_mdtp_reader_array_length` elements
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if the node is not an array
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_reader_array_f64(const MdtpReader *reader, double *values);
+
+/**
+ * @brief Get count of buckets of the current histogram node
+ * @param reader Not-null pointer to `MdtpReader` positioned on a node
+ * @return Count of buckets (count of bounds plus one), `0` if the node is not a histogram
+ */
+SDK_EXPORT size_t sdk_mdtp_reader_histogram_buckets(const MdtpReader *reader);
+
+/**
+ * @brief Copies the current histogram node
+ * @param reader Not-null pointer to `MdtpReader` positioned on a node
+ * @param bounds Array of at least `sdk_mdtp_reader_histogram_buckets` elements where the upper
+ * bounds of the buckets are stored, the last one is `INFINITY`. May be `NULL`.
+ * @param counts Array of at least `sdk_mdtp_reader_histogram_buckets` elements where the counts
+ * of the buckets are stored. May be `NULL`.
+ * @param sum Pointer where the sum of the observations is stored. May be `NULL`.
+ * @param count Pointer where the count of the observations is stored. May be `NULL`.
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if the node is not a histogram
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_reader_histogram(const MdtpReader *reader,
+                                               double           *bounds,
+                                               uint64_t         *counts,
+                                               double           *sum,
+                                               uint64_t         *count);
+
+/**
+ * @brief Get serialized bytes of the current node (with the whole subtree for containers), for
+ * example to copy the node into another frame
+ * @param reader Not-null pointer to `MdtpReader` positioned on a node
+ * @param size Not-null pointer where count of bytes of the node is stored
+ * @return Pointer to the first byte (type) of the node in the frame
+ */
+SDK_EXPORT const void *sdk_mdtp_reader_node(const MdtpReader *reader, size_t *size);
+
+
+#ifdef __cplusplus
+}
+#endif
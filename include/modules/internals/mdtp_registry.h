@@ -0,0 +1,172 @@
+/**
+ * @file modules/internals/mdtp_registry.h
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#pragma once
+
+#include "../../general/sdk_status.h"
+#include "macro.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct IModule     IModule;     ///< Forward declaration
+typedef struct MdtpBuilder MdtpBuilder; ///< Forward declaration
+
+/*
+ * Metric registry of a module.
+ *
+ * Worker threads of a module update metrics, `get_data` writes them into the frame. A metric is
+ * registered once and updated through its handle:
+ *
+ * - a counter only grows (requests served, bytes sent);
+ * - an up/down counter grows and shrinks (open connections, queued jobs);
+ * - a gauge holds the last value set (temperature, configured limit).
+ *
+ * Counters are split into shards, each on its own cache line: one for every processor configured
+ * in the system, rounded up to a power of two and at most `MDTP_REGISTRY_MAX_SHARDS`. The count is
+ * taken when the registry is created. A thread always updates the same shard with a relaxed
+ * atomic addition, so threads on different cores do not bounce a cache line between them and never
+ * wait for each other. Reading a counter sums its shards. A gauge is one atomic value, as
+ * concurrent sets keep only the last one anyway.
+ *
+ * Metrics are registered from the thread that calls `get_data` (or from `module_init`) and live
+ * until the module is destroyed. Updates may come from any thread.
+ */
+
+typedef struct MdtpMetric MdtpMetric; ///< Metric of a registry
+
+#define MDTP_REGISTRY_MAX_SHARDS 256 ///< Most shards of a counter, a power of two
+
+#define MDTP_METRIC_COUNTER 0 ///< Unsigned counter that only grows
+#define MDTP_METRIC_UPDOWN 1  ///< Signed counter that grows and shrinks
+#define MDTP_METRIC_GAUGE 2   ///< Floating point value set as a whole
+
+/**
+ * @brief Registers a counter in the registry of the module
+ * @param module Not-null pointer to `IModule`
+ * @param name Name of the value node (non-NULL, zero-terminated string)
+ * @param units Units of the value node (non-NULL, zero-terminated string)
+ * @return Handle of the counter or `NULL` if an argument is `NULL`, a metric of another kind has
+ * the same name or memory could not be allocated. Registering a name again returns the same
+ * handle.
+ *
+ * @code{.c}
+ * // Example usage. In module_init:
+ * requests = sdk_mdtp_registry_counter(module, "requests", "");
+ * connections = sdk_mdtp_registry_updown(module, "connections", "");
+ *
+ * // In worker threads:
+ * sdk_mdtp_metric_add(requests, 1);
+ * sdk_mdtp_metric_add_i64(connections, -1);
+ *
+ * // In get_data:
+ * sdk_mdtp_registry_add(module, builder);
+ * return sdk_mdtp_builder_finish(builder, module);
+ * @endcode
+ */
+SDK_EXPORT MdtpMetric *sdk_mdtp_registry_counter(IModule    *module,
+                                                 const char *name,
+                                                 const char *units);
+
+/**
+ * @brief Registers an up/down counter in the registry of the module
+ * @param module Not-null pointer to `IModule`
+ * @param name Name of the value node (non-NULL, zero-terminated string)
+ * @param units Units of the value node (non-NULL, zero-terminated string)
+ * @return See `sdk_mdtp_registry_counter`
+ */
+SDK_EXPORT MdtpMetric *sdk_mdtp_registry_updown(IModule    *module,
+                                                const char *name,
+                                                const char *units);
+
+/**
+ * @brief Registers a gauge in the registry of the module. Its value is `0` until set.
+ * @param module Not-null pointer to `IModule`
+ * @param name Name of the value node (non-NULL, zero-terminated string)
+ * @param precision Count of fractional digits or `MDTP_F64_SHORTEST`, see
+ * `sdk_mdtp_builder_add_value_f64`
+ * @param units Units of the value node (non-NULL, zero-terminated string)
+ * @return See `sdk_mdtp_registry_counter`
+ */
+SDK_EXPORT MdtpMetric *sdk_mdtp_registry_gauge(IModule    *module,
+                                               const char *name,
+                                               int         precision,
+                                               const char *units);
+
+/**
+ * @brief Get count of metrics registered in the module
+ * @param module Not-null pointer to `IModule`
+ * @return Count of metrics
+ */
+SDK_EXPORT size_t sdk_mdtp_registry_size(const IModule *module);
+
+/**
+ * @brief Writes every metric of the module as a value node into the frame being built, in the
+ * order of registration. Counters are written as `u64`, up/down counters as `i64`, gauges as
+ * `f64`.
+ * @param module Not-null pointer to `IModule`
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @return See `sdk_mdtp_builder_add_value`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_registry_add(const IModule *module, MdtpBuilder *builder);
+
+/**
+ * @brief Adds to a counter. Thread-safe and lock-free.
+ * @param metric Not-null handle of a counter
+ * @param value Value to add
+ */
+SDK_EXPORT void sdk_mdtp_metric_add(MdtpMetric *metric, uint64_t value);
+
+/**
+ * @brief Adds to an up/down counter. Thread-safe and lock-free.
+ * @param metric Not-null handle of an up/down counter
+ * @param value Value to add, negative to subtract
+ */
+SDK_EXPORT void sdk_mdtp_metric_add_i64(MdtpMetric *metric, int64_t value);
+
+/**
+ * @brief Sets a gauge. Thread-safe and lock-free.
+ * @param metric Not-null handle of a gauge
+ * @param value Value
+ */
+SDK_EXPORT void sdk_mdtp_metric_set(MdtpMetric *metric, double value);
+
+/**
+ * @brief Get value of a counter
+ * @param metric Not-null handle of a counter
+ * @return Sum of the shards. Additions made concurrently may be missed.
+ */
+SDK_EXPORT uint64_t sdk_mdtp_metric_u64(const MdtpMetric *metric);
+
+/**
+ * @brief Get value of an up/down counter
+ * @param metric Not-null handle of an up/down counter
+ * @return Sum of the shards. Additions made concurrently may be missed.
+ */
+SDK_EXPORT int64_t sdk_mdtp_metric_i64(const MdtpMetric *metric);
+
+/**
+ * @brief Get value of a gauge
+ * @param metric Not-null handle of a gauge
+ * @return Value last set
+ */
+SDK_EXPORT double sdk_mdtp_metric_f64(const MdtpMetric *metric);
+
+/**
+ * @brief Get kind of a metric
+ * @param metric Not-null handle of a metric
+ * @return `MDTP_METRIC_COUNTER`, `MDTP_METRIC_UPDOWN` or `MDTP_METRIC_GAUGE`
+ */
+SDK_EXPORT uint8_t sdk_mdtp_metric_kind(const MdtpMetric *metric);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,126 @@
+/**
+ * @file modules/internals/mdtp_sampler.h
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#pragma once
+
+#include "../../general/sdk_status.h"
+#include "macro.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct IModule              IModule;              ///< Forward declaration
+typedef struct ABI_MODULE_MDTP_DATA ABI_MODULE_MDTP_DATA; ///< Forward declaration
+typedef struct ABI_MODULE_DATA_INFO ABI_MODULE_DATA_INFO; ///< Forward declaration
+
+/*
+ * Background sampler.
+ *
+ * Callbacks of a module must not block the poll loop of the server, but collecting data (walking
+ * `/proc`, `statfs` on network mounts) may take milliseconds. A sampler runs the collect routine
+ * of the module on its own thread every `interval_ms` milliseconds and publishes the frames it
+ * returns. `get_data` then returns the latest published frame in constant time, without locks.
+ *
+ * The collect routine is the function that would otherwise be registered as `get_data`: it
+ * produces a frame the usual way (`sdk_mdtp_builder_finish`, `sdk_mdtp_make_root`,
+ * `sdk_mdtp_tree_emit`...) and returns it. While the sampler runs, only the sampler thread
+ * produces frames of the module.
+ *
+ * Frames are published through three buffers: the sampler writes into one, the latest complete
+ * frame waits in another, and the server reads the third. Publishing and taking a frame are one
+ * atomic exchange each, so neither side ever waits for the other, and a frame being read is never
+ * overwritten.
+ *
+ * The server gets only the latest frame and may skip frames published between polls. Encodings
+ * that rely on the server seeing every frame (delta frames and dictionary strings), and chunked
+ * frames, cannot be used with a sampler. Compression and CRC32C trailers can.
+ */
+
+/**
+ * @brief Starts the sampler of the module. The first frame is collected before the function
+ * returns, so `sdk_mdtp_sampler_get_data` has a frame from the start.
+ * @param module Not-null pointer to `IModule`
+ * @param collect Not-null collect routine with signature `const ABI_MODULE_MDTP_DATA *(void)`. It
+ * runs on the sampler thread. A `NULL` frame is not published, the previous frame stays.
+ * @param interval_ms Milliseconds between the starts of collections, at least `1`. If a
+ * collection takes longer, the next one starts right after it.
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if an argument is invalid, the sampler is
+ * already running, the module has a time budget (see `sdk_mdtp_deadline_enable`), or delta
+ * frames, dictionary strings or chunked frames are enabled, `SDK_ALLOCATION_ERROR` if memory could
+ * not be allocated, `SDK_OTHER_ERROR` if the thread could not be started
+ *
+ * @code{.c}
+ * // Example usage:
+ * static const ABI_MODULE_MDTP_DATA *collect(void) {
+ *     // Slow collection, as get_data did before
+ *     return sdk_mdtp_builder_finish(builder, module);
+ * }
+ *
+ * static const ABI_MODULE_MDTP_DATA *get_data(void) {
+ *     return sdk_mdtp_sampler_get_data(module);
+ * }
+ *
+ * static const ABI_MODULE_DATA_INFO *get_data_info(void) {
+ *     return sdk_mdtp_sampler_get_data_info(module);
+ * }
+ *
+ * // In module_init:
+ * sdk_module_register_get_data(module, get_data);
+ * sdk_module_register_get_data_info(module, get_data_info);
+ * sdk_mdtp_sampler_start(module, collect, 1000);
+ *
+ * // In module_destroy, before the state collect uses is freed:
+ * sdk_mdtp_sampler_stop(module);
+ * @endcode
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_sampler_start(IModule *module,
+                                            const ABI_MODULE_MDTP_DATA *(*collect)(void),
+                                            uint32_t interval_ms);
+
+/**
+ * @brief Stops the sampler of the module and waits for the collection in progress. The latest
+ * frame stays available through `sdk_mdtp_sampler_get_data` until the module is destroyed.
+ * `sdk_imodule_destroy` stops the sampler by itself.
+ * @param module Not-null pointer to `IModule`. If the sampler is not running, no effect.
+ * @warning Must not be called from the collect routine
+ */
+SDK_EXPORT void sdk_mdtp_sampler_stop(IModule *module);
+
+/**
+ * @brief Get the latest frame published by the sampler. Lock-free and constant time.
+ * @param module Not-null pointer to `IModule`
+ * @return Pointer to `ABI_MODULE_MDTP_DATA`, valid until the next call, or `NULL` if the sampler
+ * was never started or has not published a frame yet
+ * @note Must be called from one thread at a time (the thread of the server)
+ */
+SDK_EXPORT const ABI_MODULE_MDTP_DATA *sdk_mdtp_sampler_get_data(IModule *module);
+
+/**
+ * @brief Get hash and generation of the frame returned by the last `sdk_mdtp_sampler_get_data`,
+ * see `sdk_imodule_get_mdtp_data_info`. Does not take a newer frame, so the frame the server holds
+ * stays valid.
+ * @param module Not-null pointer to `IModule`
+ * @return Pointer to `ABI_MODULE_DATA_INFO` or `NULL` if no frame was returned yet
+ * @note Use it instead of `sdk_imodule_get_mdtp_data_info` while the sampler runs, which describes
+ * the frame the sampler thread may be producing
+ */
+SDK_EXPORT const ABI_MODULE_DATA_INFO *sdk_mdtp_sampler_get_data_info(const IModule *module);
+
+/**
+ * @brief Get count of frames published by the sampler of the module since it was created
+ * @param module Not-null pointer to `IModule`
+ * @return Count of frames
+ */
+SDK_EXPORT uint64_t sdk_mdtp_sampler_published(const IModule *module);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,163 @@
+/**
+ * @file modules/internals/mdtp_sketch.h
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#pragma once
+
+#include "../../general/sdk_status.h"
+#include "macro.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct MdtpBuilder MdtpBuilder; ///< Forward declaration
+
+/**
+ * @brief Quantile sketch.
+ *
+ * Modules that watch request logs or sockets see millions of events between polls. A sketch
+ * counts them in logarithmic buckets (like DDSketch), so any quantile is known with a bounded
+ * **relative** error: with `precision` bits every power of two is split into `2^precision`
+ * buckets, and a quantile is off by at most `2^-(precision + 1)` of its value (0.4% for `7`).
+ *
+ * The memory is fixed at creation: values from `min` to `max` get their own buckets, smaller and
+ * larger values are counted as `min` and `max`. The bucket of a value is taken from the bits of
+ * the double, without logarithms.
+ *
+ * Recording is lock-free and scales with threads: every thread records into one of `shards`
+ * copies of the buckets with a relaxed atomic increment. Each copy is aligned to and padded to
+ * whole cache lines, so threads recording into different copies do not share cache lines.
+ * The shards are summed when quantiles are read. Sketches with the same parameters can be merged.
+ *
+ * `sdk_mdtp_sketch_add` writes the usual quantiles in `get_data` and starts the next interval
+ * without losing observations recorded meanwhile.
+ */
+typedef struct MdtpSketch MdtpSketch;
+
+#define MDTP_SKETCH_MAX_PRECISION 10        ///< Largest `precision` of a sketch
+#define MDTP_SKETCH_MAX_BUCKETS (1u << 20)  ///< Largest count of buckets of a shard
+#define MDTP_SKETCH_DEFAULT_PRECISION 7     ///< Relative error of 0.4%
+#define MDTP_SKETCH_DEFAULT_SHARDS 16       ///< Shards for typical worker thread counts
+
+/**
+ * @brief Creates a sketch
+ * @param min Smallest value with its own bucket, greater than `0`. Smaller values (zero and
+ * negatives included) are counted as `min`.
+ * @param max Largest value with its own bucket, greater than `min` and finite. Larger values are
+ * counted as `max`.
+ * @param precision Count of bits of the mantissa that select the bucket, from `1` to
+ * `MDTP_SKETCH_MAX_PRECISION`. See `MDTP_SKETCH_DEFAULT_PRECISION`.
+ * @param shards Count of copies of the buckets threads record into, at least `1`. See
+ * `MDTP_SKETCH_DEFAULT_SHARDS`.
+ * @return Pointer to `MdtpSketch` or `NULL` if an argument is invalid, the range needs more than
+ * `MDTP_SKETCH_MAX_BUCKETS` buckets or memory could not be allocated. Must be freed with
+ * `sdk_mdtp_sketch_destroy`. A shard takes 8 bytes for each of about
+ * `log2(max / min) * 2^precision` buckets.
+ *
+ * @code{.c}
+ * // Example usage. Latencies from 1 us to 100 s:
+ * MdtpSketch *latency = sdk_mdtp_sketch_create(1e-6, 100, MDTP_SKETCH_DEFAULT_PRECISION,
+ *                                              MDTP_SKETCH_DEFAULT_SHARDS);
+ *
+ * // In a worker thread:
+ * sdk_mdtp_sketch_record(latency, elapsed_seconds);
+ *
+ * // In get_data:
+ * sdk_mdtp_sketch_add(latency, builder, "latency", 6, "s");
+ * return sdk_mdtp_builder_finish(builder, module);
+ * @endcode
+ */
+SDK_EXPORT MdtpSketch *sdk_mdtp_sketch_create(double min, double max, int precision, size_t shards);
+
+/**
+ * @brief Destroys a sketch. No thread may record into it anymore.
+ * @param sketch Pointer to `MdtpSketch`. If `NULL`, no effect.
+ */
+SDK_EXPORT void sdk_mdtp_sketch_destroy(MdtpSketch *sketch);
+
+/**
+ * @brief Records a value. Thread-safe and lock-free.
+ * @param sketch Not-null pointer to `MdtpSketch`
+ * @param value Value. `NaN` is ignored.
+ */
+SDK_EXPORT void sdk_mdtp_sketch_record(MdtpSketch *sketch, double value);
+
+/**
+ * @brief Adds the counts of `source` to `destination`. Thread-safe for both sketches, but values
+ * recorded into `source` meanwhile may be missed.
+ * @param destination Not-null pointer to `MdtpSketch`
+ * @param source Not-null pointer to `MdtpSketch` created with the same `min`, `max` and
+ * `precision`
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if the sketches have different buckets
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_sketch_merge(MdtpSketch *destination, const MdtpSketch *source);
+
+/**
+ * @brief Sets all counts to `0`. Values recorded concurrently may be kept or dropped.
+ * @param sketch Not-null pointer to `MdtpSketch`
+ */
+SDK_EXPORT void sdk_mdtp_sketch_reset(MdtpSketch *sketch);
+
+/**
+ * @brief Estimates quantiles of the recorded values
+ * @param sketch Not-null pointer to `MdtpSketch`
+ * @param quantiles Array of `count` quantiles from `0` to `1` (`0.5` is the median)
+ * @param values Array of `count` elements where the estimates are stored. If nothing was
+ * recorded, the estimates are `0`.
+ * @param count Count of elements of `quantiles` and `values`
+ * @return Count of recorded values
+ * @note Quantiles of one sketch must not be read from several threads at the same time
+ */
+SDK_EXPORT uint64_t sdk_mdtp_sketch_quantiles(MdtpSketch   *sketch,
+                                              const double *quantiles,
+                                              double       *values,
+                                              size_t        count);
+
+/**
+ * @brief Writes the values recorded since the previous call into the frame being built, and
+ * starts the next interval. Values recorded concurrently go to one interval or the other, none is
+ * lost.
+ *
+ * Writes a container named `name` with value nodes `count` (count of values), `p50`, `p90`,
+ * `p99` and `p999`.
+ *
+ * @param sketch Not-null pointer to `MdtpSketch`
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param name Name of the container (non-NULL, zero-terminated string)
+ * @param precision Count of fractional digits of the quantiles or `MDTP_F64_SHORTEST`, see
+ * `sdk_mdtp_builder_add_value_f64`
+ * @param units Units of the quantiles (non-NULL, zero-terminated string)
+ * @return See `sdk_mdtp_builder_add_value`
+ * @note Quantiles of one sketch must not be read from several threads at the same time
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_sketch_add(MdtpSketch  *sketch,
+                                         MdtpBuilder *builder,
+                                         const char  *name,
+                                         int          precision,
+                                         const char  *units);
+
+/**
+ * @brief Same as `sdk_mdtp_sketch_add`, but makes a container node, see
+ * `sdk_mdtp_make_container`
+ * @param sketch Not-null pointer to `MdtpSketch`
+ * @param name Name of the container (non-NULL, zero-terminated string)
+ * @param precision Count of fractional digits of the quantiles or `MDTP_F64_SHORTEST`
+ * @param units Units of the quantiles (non-NULL, zero-terminated string)
+ * @return `void*` Pointer to the created container node or `NULL` on error. Ownership rules are
+ * the same as for `sdk_mdtp_make_container`. On error the values stay in the sketch.
+ */
+SDK_EXPORT void *sdk_mdtp_sketch_make(MdtpSketch *sketch,
+                                      const char *name,
+                                      int         precision,
+                                      const char *units);
+
+
+#ifdef __cplusplus
+}
+#endif
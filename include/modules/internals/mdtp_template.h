@@ -0,0 +1,188 @@
+/**
+ * @file modules/internals/mdtp_template.h
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#pragma once
+
+#include "../../general/sdk_status.h"
+#include "macro.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct IModule              IModule;              ///< Forward declaration
+typedef struct ABI_MODULE_MDTP_DATA ABI_MODULE_MDTP_DATA; ///< Forward declaration
+
+/**
+ * @brief Precompiled MDTP frame.
+ *
+ * Most modules send frames of the same shape on every poll: the same containers, names and units,
+ * only values change. A template keeps such a frame serialized once. Every value node of the frame
+ * becomes a slot that can be changed via `sdk_mdtp_template_set*`, and `sdk_mdtp_template_emit`
+ * stores the frame in the module.
+ *
+ * If the module still holds the previous frame of the template and no value changed its length,
+ * emit only rewrites the bytes of changed values in the frame of the module. Otherwise the frame
+ * is rewritten once, with payload sizes of containers around resized values adjusted.
+ */
+typedef struct MdtpTemplate MdtpTemplate;
+
+/**
+ * @brief Value of a template. The pointer is valid until the template is destroyed.
+ */
+typedef struct MdtpTemplateSlot MdtpTemplateSlot;
+
+/**
+ * @brief Compiles a template from nodes.
+ *
+ * Takes the same arguments as `sdk_mdtp_make_root`. Values of the nodes become initial values
+ * of the slots.
+ *
+ * @param first Pointer to the first node (container or value). Must not be `NULL`.
+ * @param ... Additional nodes. The list must always be terminated with `NULL`.
+ *
+ * @warning The function takes ownership of passed nodes, even if it fails.
+ *
+ * @return Pointer to `MdtpTemplate` or `NULL` on error. Must be freed with
+ * `sdk_mdtp_template_destroy`.
+ *
+ * @code{.c}
+ * // Example usage:
+ * MdtpTemplate *ram_template = sdk_mdtp_template_compile(
+ *     sdk_mdtp_make_container("ram",
+ *         sdk_mdtp_make_value("usage", "0", "%"),
+ *         sdk_mdtp_make_value("free", "0", "MB"),
+ *         NULL),
+ *     NULL);
+ * MdtpTemplateSlot *usage = sdk_mdtp_template_slot(ram_template, "ram/usage");
+ *
+ * // In get_data:
+ * sdk_mdtp_template_set_u64(usage, read_ram_usage());
+ * return sdk_mdtp_template_emit(ram_template, module);
+ * @endcode
+ */
+SDK_EXPORT MdtpTemplate *sdk_mdtp_template_compile(void *first, ...);
+
+/**
+ * @brief Compiles a template from an array of nodes
+ * @param nodes Array of `count` non-NULL nodes (containers or values)
+ * @param count Count of nodes in `nodes`
+ * @warning The function takes ownership of the nodes and frees them, even if it fails. The array
+ * itself is not freed.
+ * @return Pointer to `MdtpTemplate` or `NULL` on error
+ */
+SDK_EXPORT MdtpTemplate *sdk_mdtp_template_compile_v(void **nodes, size_t count);
+
+/**
+ * @brief Destroys the template and its slots
+ * @param mdtp_template Pointer to `MdtpTemplate`. If `NULL`, no effect.
+ */
+SDK_EXPORT void sdk_mdtp_template_destroy(MdtpTemplate *mdtp_template);
+
+/**
+ * @brief Get count of slots (value nodes) of the template
+ * @param mdtp_template Not-null pointer to `MdtpTemplate`
+ * @return Count of slots
+ */
+SDK_EXPORT size_t sdk_mdtp_template_slot_count(const MdtpTemplate *mdtp_template);
+
+/**
+ * @brief Get layout generation of the template. It changes whenever a value of a new length moves
+ * nodes of the frame, so while it stays the same, every node of the frame stays at the same offset.
+ *
+ * Use it to keep an `MdtpIndex` over the frames of the template without rebuilding it, see
+ * `sdk_mdtp_index_rebind`.
+ *
+ * @param mdtp_template Not-null pointer to `MdtpTemplate`
+ * @return Layout generation
+ */
+SDK_EXPORT uint64_t sdk_mdtp_template_layout(const MdtpTemplate *mdtp_template);
+
+/**
+ * @brief Get slot by its index. Slots are numbered in the order value nodes appear in the frame.
+ * @param mdtp_template Not-null pointer to `MdtpTemplate`
+ * @param index Index of the slot
+ * @return Pointer to the slot or `NULL` if `index` is out of range
+ */
+SDK_EXPORT MdtpTemplateSlot *sdk_mdtp_template_slot_at(MdtpTemplate *mdtp_template,
+                                                      size_t        index);
+
+/**
+ * @brief Get slot by path of names separated by `/`, e.g. `"cpu/core0/usage"`
+ * @param mdtp_template Not-null pointer to `MdtpTemplate`
+ * @param path Not-null path. The last name must be a name of a value node.
+ * @return Pointer to the slot or `NULL` if there is no such value. If several nodes of a container
+ * have the same name, the first one is used.
+ */
+SDK_EXPORT MdtpTemplateSlot *sdk_mdtp_template_slot(MdtpTemplate *mdtp_template,
+                                                   const char   *path);
+
+/**
+ * @brief Sets the value of the slot. It is written to the frame on the next
+ * `sdk_mdtp_template_emit`.
+ * @param slot Not-null pointer to `MdtpTemplateSlot`
+ * @param value Not-null zero-terminated value string
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if `value` is `NULL`,
+ * `SDK_ALLOCATION_ERROR` if memory for a value of a new length could not be allocated
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_template_set(MdtpTemplateSlot *slot, const char *value);
+
+/**
+ * @brief Same as `sdk_mdtp_template_set`, but the value does not have to be zero-terminated
+ * @param slot Not-null pointer to `MdtpTemplateSlot`
+ * @param value Not-null value string
+ * @param value_length Count of bytes of `value`
+ * @return See `sdk_mdtp_template_set`. `SDK_INVALID_ARGUMENT` is also returned if `value_length`
+ * exceeds `UINT32_MAX`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_template_set_n(MdtpTemplateSlot *slot,
+                                             const char       *value,
+                                             size_t            value_length);
+
+/**
+ * @brief Sets the value of the slot to an unsigned integer, see `sdk_mdtp_make_value_u64`
+ * @param slot Not-null pointer to `MdtpTemplateSlot`
+ * @param value Value
+ * @return See `sdk_mdtp_template_set`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_template_set_u64(MdtpTemplateSlot *slot, uint64_t value);
+
+/**
+ * @brief Sets the value of the slot to a signed integer, see `sdk_mdtp_make_value_i64`
+ * @param slot Not-null pointer to `MdtpTemplateSlot`
+ * @param value Value
+ * @return See `sdk_mdtp_template_set`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_template_set_i64(MdtpTemplateSlot *slot, int64_t value);
+
+/**
+ * @brief Sets the value of the slot to a floating point number, see `sdk_mdtp_make_value_f64`
+ * @param slot Not-null pointer to `MdtpTemplateSlot`
+ * @param value Value
+ * @param precision Count of fractional digits or `MDTP_F64_SHORTEST`
+ * @return See `sdk_mdtp_template_set`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_template_set_f64(MdtpTemplateSlot *slot,
+                                               double            value,
+                                               int               precision);
+
+/**
+ * @brief Stores the current frame of the template in the module
+ * @param mdtp_template Not-null pointer to `MdtpTemplate`
+ * @param module The module in which the data will be saved
+ * @return Pointer to a valid `ABI_MODULE_MDTP_DATA` frame or `NULL` on allocation error. **Do not
+ * free it, as this will happen automatically when the module terminates!**
+ */
+SDK_EXPORT const ABI_MODULE_MDTP_DATA *sdk_mdtp_template_emit(MdtpTemplate *mdtp_template,
+                                                              IModule      *module);
+
+
+#ifdef __cplusplus
+}
+#endif
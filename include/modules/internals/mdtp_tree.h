@@ -0,0 +1,134 @@
+/**
+ * @file modules/internals/mdtp_tree.h
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#pragma once
+
+#include "../../general/sdk_status.h"
+#include "macro.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct IModule              IModule;              ///< Forward declaration
+typedef struct ABI_MODULE_MDTP_DATA ABI_MODULE_MDTP_DATA; ///< Forward declaration
+
+/*
+ * Persistent MDTP tree of a module.
+ *
+ * For modules whose shape changes slowly (process lists, mounted filesystems, network
+ * interfaces) the module keeps an MDTP tree between polls. Values are addressed by paths of names
+ * separated by `/`: `"net/eth0/rx_bytes"` is the value `rx_bytes` in the container `eth0` in the
+ * container `net`. Containers on the path are created on demand, nodes keep the order in which
+ * they were created.
+ *
+ * Paths are looked up in a hash index, so updating a value does not walk the tree. On
+ * `sdk_mdtp_tree_emit` only subtrees changed since the previous emit are serialized again, the
+ * bytes of unchanged subtrees are copied from the previous frame of the module.
+ *
+ * The tree is destroyed together with the module.
+ */
+
+/**
+ * @brief Sets the value at `path`, creating the value and missing containers on the path
+ * @param module Not-null pointer to `IModule`
+ * @param path Not-null path of the value, e.g. `"net/eth0/rx_bytes"`
+ * @param value Not-null zero-terminated value string
+ * @param units Not-null zero-terminated units string
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if an argument is `NULL`, the path has an
+ * empty name, `path` is a container or a name on the path (except the last one) is a value,
+ * `SDK_ALLOCATION_ERROR` if memory could not be allocated
+ *
+ * @code{.c}
+ * // Example usage:
+ * sdk_mdtp_tree_set(module, "net/eth0/rx_bytes", "1024", "B");
+ * sdk_mdtp_tree_set_u64(module, "net/eth0/tx_bytes", 2048, "B");
+ * sdk_mdtp_tree_remove(module, "net/eth1");
+ * return sdk_mdtp_tree_emit(module);
+ * @endcode
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_tree_set(IModule    *module,
+                                       const char *path,
+                                       const char *value,
+                                       const char *units);
+
+/**
+ * @brief Sets the value at `path` to an unsigned integer, see `sdk_mdtp_make_value_u64`
+ * @param module Not-null pointer to `IModule`
+ * @param path Not-null path of the value
+ * @param value Value
+ * @param units Not-null zero-terminated units string
+ * @return See `sdk_mdtp_tree_set`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_tree_set_u64(IModule    *module,
+                                           const char *path,
+                                           uint64_t    value,
+                                           const char *units);
+
+/**
+ * @brief Sets the value at `path` to a signed integer, see `sdk_mdtp_make_value_i64`
+ * @param module Not-null pointer to `IModule`
+ * @param path Not-null path of the value
+ * @param value Value
+ * @param units Not-null zero-terminated units string
+ * @return See `sdk_mdtp_tree_set`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_tree_set_i64(IModule    *module,
+                                           const char *path,
+                                           int64_t     value,
+                                           const char *units);
+
+/**
+ * @brief Sets the value at `path` to a floating point number, see `sdk_mdtp_make_value_f64`
+ * @param module Not-null pointer to `IModule`
+ * @param path Not-null path of the value
+ * @param value Value
+ * @param precision Count of fractional digits or `MDTP_F64_SHORTEST`
+ * @param units Not-null zero-terminated units string
+ * @return See `sdk_mdtp_tree_set`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_tree_set_f64(IModule    *module,
+                                           const char *path,
+                                           double      value,
+                                           int         precision,
+                                           const char *units);
+
+/**
+ * @brief Removes the value or the container (with everything inside) at `path`
+ * @param module Not-null pointer to `IModule`
+ * @param path Not-null path of the node
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if `path` is `NULL` or there is no node at
+ * `path`
+ */
+SDK_EXPORT SDKStatus sdk_mdtp_tree_remove(IModule *module, const char *path);
+
+/**
+ * @brief Removes all nodes of the tree
+ * @param module Not-null pointer to `IModule`
+ */
+SDK_EXPORT void sdk_mdtp_tree_clear(IModule *module);
+
+/**
+ * @brief Serializes the tree into the frame of the module.
+ *
+ * Only changed subtrees are serialized, unchanged ones are copied from the previous frame. If the
+ * frame of the module was replaced by something else since the previous emit (for example, by
+ * `sdk_mdtp_make_root`), the whole tree is serialized.
+ *
+ * @param module Not-null pointer to `IModule`
+ * @return Pointer to a valid `ABI_MODULE_MDTP_DATA` frame or `NULL` on error. An empty tree gives
+ * a frame with empty payload. **Do not free it, as this will happen automatically when the module
+ * terminates!**
+ */
+SDK_EXPORT const ABI_MODULE_MDTP_DATA *sdk_mdtp_tree_emit(IModule *module);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -9,6 +9,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 /**
  * @brief Writes a signed 32-bit integer to `memory` starting at offset `offset` in **Big Endian
@@ -88,7 +89,7 @@ static inline void write_ubyte_be(void *memory, size_t offset, uint8_t value) {
  * @return The 8-bit value read from memory.
  */
 static inline uint8_t read_ubyte_be(const void *memory, size_t offset) {
-    return ((uint8_t *)memory)[offset];
+    return ((const uint8_t *)memory)[offset];
 }
 
 
@@ -115,8 +116,198 @@ static inline uint8_t read_ubyte_be(const void *memory, size_t offset) {
  * @return The 32-bit value reconstructed from memory.
  */
 static inline uint32_t read_uint32_be(const void *memory, size_t offset) {
-    return ((uint32_t)(((char *)memory)[offset]) << 24) |
-           ((uint32_t)(((char *)memory)[offset + 1]) << 16) |
-           ((uint32_t)(((char *)memory)[offset + 2]) << 8) |
-           ((uint32_t)(((char *)memory)[offset + 3]));
+    // Bytes must be read as unsigned, `char` would sign-extend bytes >= 0x80
+    return ((uint32_t)(((const uint8_t *)memory)[offset]) << 24) |
+           ((uint32_t)(((const uint8_t *)memory)[offset + 1]) << 16) |
+           ((uint32_t)(((const uint8_t *)memory)[offset + 2]) << 8) |
+           ((uint32_t)(((const uint8_t *)memory)[offset + 3]));
+}
+
+
+
+
+/**
+ * @brief Writes an unsigned 64-bit integer to `memory` starting at offset `offset` in **Big Endian
+ * order**
+ * @param memory Memory
+ * @param offset Offset
+ * @param value Value to write
+ */
+static inline void write_uint64_be(void *memory, size_t offset, uint64_t value) {
+    write_uint32_be(memory, offset, (uint32_t)(value >> 32));
+    write_uint32_be(memory, offset + 4, (uint32_t)value);
+}
+
+
+
+
+/**
+ * @brief Reads an unsigned 64-bit integer from `memory` in **Big Endian** order.
+ * @param memory The memory buffer to read from.
+ * @param offset The offset in bytes from the start of the buffer.
+ * @return The 64-bit value reconstructed from memory.
+ */
+static inline uint64_t read_uint64_be(const void *memory, size_t offset) {
+    return ((uint64_t)read_uint32_be(memory, offset) << 32) | read_uint32_be(memory, offset + 4);
+}
+
+
+
+
+/**
+ * @brief Get count of bytes of `value` encoded as a varint (see `write_varint`)
+ * @param value Value
+ * @return Count of bytes, from 1 to 10
+ */
+static inline size_t varint_size(uint64_t value) {
+    size_t size = 1;
+
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+
+    return size;
+}
+
+
+
+
+/**
+ * @brief Writes an unsigned integer to `memory` as a varint: 7 bits per byte, least significant
+ * first, the high bit of every byte except the last one is set.
+ *
+ * @section example_usage Example usage
+ * After executing this code
+ * @code{.cpp}
+ * write_varint(mem, 0, 300)
+ * @endcode
+ *
+ * Memory `mem` will look like:
+ * ```
+ * [0] : 0xAC
+ * [1] : 0x02
+ * ```
+ *
+ * @param memory Memory with at least `varint_size(value)` bytes after `offset`
+ * @param offset Offset
+ * @param value Value to write
+ * @return Count of bytes written
+ */
+static inline size_t write_varint(void *memory, size_t offset, uint64_t value) {
+    size_t size = 0;
+
+    while (value >= 0x80) {
+        ((uint8_t *)memory)[offset + size++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+
+    ((uint8_t *)memory)[offset + size++] = (uint8_t)value;
+
+    return size;
+}
+
+
+
+
+/**
+ * @brief Reads a varint (see `write_varint`) from `memory`
+ *
+ * @param memory The memory buffer to read from.
+ * @param offset The offset in bytes from the start of the buffer.
+ * @param end Count of bytes of the buffer, the varint must end before it
+ * @param value Pointer where the value is stored
+ * @return Count of bytes read or `0` if the varint is truncated or longer than 64 bits
+ */
+static inline size_t read_varint(const void *memory, size_t offset, size_t end, uint64_t *value) {
+    uint64_t result = 0;
+
+    for (size_t size = 0; size < 10 && offset + size < end; ++size) {
+        uint8_t byte = ((const uint8_t *)memory)[offset + size];
+
+        if (size == 9 && byte > 1) {
+            return 0; // More than 64 bits
+        }
+
+        result |= (uint64_t)(byte & 0x7F) << (7 * size);
+
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return size + 1;
+        }
+    }
+
+    return 0;
+}
+
+
+
+
+/**
+ * @brief Writes `count` 64-bit values to `memory` in **Big Endian** order.
+ * @details The values are swapped in one loop over the whole array, which the compiler turns into
+ * vector byte shuffles. Arrays of `double` are written with their bits, as `write_uint64_be` does.
+ *
+ * @param memory Memory with at least `count * 8` bytes after `offset`
+ * @param offset Offset
+ * @param values Array of `count` 64-bit values (`uint64_t`, `int64_t` or `double`)
+ * @param count Count of values
+ */
+static inline void write_uint64_be_array(void       *memory,
+                                         size_t      offset,
+                                         const void *values,
+                                         size_t      count) {
+    uint8_t       *destination = (uint8_t *)memory + offset;
+    const uint8_t *source = (const uint8_t *)values;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    memcpy(destination, source, count * 8);
+#else
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t value;
+
+        memcpy(&value, source + i * 8, 8);
+#if defined(__GNUC__)
+        value = __builtin_bswap64(value);
+        memcpy(destination + i * 8, &value, 8);
+#else
+        write_uint64_be(destination, i * 8, value);
+#endif
+    }
+#endif
+}
+
+
+
+
+/**
+ * @brief Reads `count` 64-bit values written by `write_uint64_be_array` from `memory`
+ *
+ * @param memory The memory buffer to read from.
+ * @param offset The offset in bytes from the start of the buffer.
+ * @param values Array where `count` 64-bit values (`uint64_t`, `int64_t` or `double`) are stored
+ * @param count Count of values
+ */
+static inline void read_uint64_be_array(const void *memory,
+                                        size_t      offset,
+                                        void       *values,
+                                        size_t      count) {
+    const uint8_t *source = (const uint8_t *)memory + offset;
+    uint8_t       *destination = (uint8_t *)values;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    memcpy(destination, source, count * 8);
+#else
+    for (size_t i = 0; i < count; ++i) {
+#if defined(__GNUC__)
+        uint64_t value;
+
+        memcpy(&value, source + i * 8, 8);
+        value = __builtin_bswap64(value);
+#else
+        uint64_t value = read_uint64_be(source, i * 8);
+#endif
+        memcpy(destination + i * 8, &value, 8);
+    }
+#endif
 }
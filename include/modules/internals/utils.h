@@ -32,6 +32,21 @@ SDK_EXPORT void sdk_utils_log(const IModule* module, LogType log_type, const cha
  */
 SDK_EXPORT uint32_t sdk_utils_get_server_abi_version(const IModule* module);
 
+/**
+ * @brief Check if the server supports an optional feature
+ * @param module Not-null Pointer to `IModule`
+ * @param capability One of `ABI_CAPABILITY_*`
+ * @return `1` if the server reports the capability in its ABI version, otherwise `0`
+ */
+SDK_EXPORT uint8_t sdk_utils_server_has_capability(const IModule* module, uint32_t capability);
+
+/**
+ * @brief Get the newest MDTP version the server accepts
+ * @param module Not-null Pointer to `IModule`
+ * @return `MDTP_VERSION_2` if the server reports `ABI_CAPABILITY_MDTP_V2`, otherwise `MDTP_VERSION`
+ */
+SDK_EXPORT uint8_t sdk_utils_server_mdtp_version(const IModule* module);
+
 #ifdef __cplusplus
 }
 #endif
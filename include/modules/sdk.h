@@ -7,6 +7,23 @@
 
 #pragma once
 
-#include "internals/imodule.h" // For IModule and IModule utils
-#include "internals/mdtp.h"    // For MDTP utils
-#include "internals/utils.h"   // For other SDK utils
+#include "internals/imodule.h"          // For IModule and IModule utils
+#include "internals/mdtp.h"             // For MDTP utils
+#include "internals/mdtp_builder.h"     // For single-pass MDTP frame builder
+#include "internals/mdtp_cadence.h"     // For subtrees refreshed at their own intervals
+#include "internals/mdtp_chunk.h"       // For chunked frames
+#include "internals/mdtp_compression.h" // For compressed frames
+#include "internals/mdtp_crc.h"         // For CRC32C trailers
+#include "internals/mdtp_deadline.h"    // For data collection within a time budget
+#include "internals/mdtp_delta.h"       // For delta frames
+#include "internals/mdtp_dictionary.h"  // For dictionary strings
+#include "internals/mdtp_format.h"      // For allocation-free number formatting
+#include "internals/mdtp_histogram.h"   // For histograms recorded from several threads
+#include "internals/mdtp_index.h"       // For path lookups in existing MDTP frames
+#include "internals/mdtp_reader.h"      // For zero-copy MDTP frame reading
+#include "internals/mdtp_registry.h"    // For metrics updated from several threads
+#include "internals/mdtp_sampler.h"     // For collection on a background thread
+#include "internals/mdtp_sketch.h"      // For quantiles of high-rate event streams
+#include "internals/mdtp_template.h"    // For precompiled MDTP frame templates
+#include "internals/mdtp_tree.h"        // For persistent path-addressed MDTP trees
+#include "internals/utils.h"            // For other SDK utils
@@ -9,4 +9,4 @@
 #define SDK_VERSION_MINOR 0
 #define SDK_VERSION_PATCH 0
 
-#define ABI_VERSION 1
+#define ABI_VERSION 2
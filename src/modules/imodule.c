@@ -6,27 +6,50 @@
  */
 
 #include "../../include/modules/internals/imodule.h"
+#include "../../include/modules/internals/mdtp_chunk.h"
+#include "../../include/modules/internals/utils.h"
+#include "imodule_internal.h"
+#include "mdtp_internal.h"
 #include <malloc.h>
+#include <stdatomic.h>
 #include <string.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-typedef struct IModule {
-    ABI_MODULE_CONTEXT        context;          ///< Context of the module
-    ABI_MODULE_MDTP_DATA      mdtp_data;        ///< Temporary buffer for MDTP data
-    ABI_MODULE_FUNCTIONS      module_functions; ///< Module functions
-    ABI_SERVER_CORE_FUNCTIONS server_functions; ///< Server core functions
-    uint32_t                  poll_ratio;       ///< Poll ratio of the module
-    uint8_t                   is_enabled;       ///< `1` if module is enabled, otherwise `0`
-} IModule;
+#define IMODULE_MIN_FRAME_CAPACITY 256 ///< First allocation of the frame buffer
+#define IMODULE_HASH_PRIME_1 0x9E3779B97F4A7C15ull
+#define IMODULE_HASH_PRIME_2 0xC2B2AE3D27D4EB4Full
+
+
+static _Atomic uint64_t imodule_frame_serial; ///< Serial of the last frame committed by any module
 
 
 ABI_MODULE_FUNCTIONS* module_init(ABI_SERVER_CORE_FUNCTIONS server_functions,
                                  const char *json_configuration); ///< Forward declaration
 
 
+/**
+ * @brief State of hashing bytes that come in several ranges
+ */
+typedef struct ImoduleHash {
+    uint64_t hash;    ///< Hash of the words mixed in so far
+    uint8_t  word[8]; ///< Bytes of the word not mixed in yet
+    size_t   length;  ///< Count of bytes in `word`
+} ImoduleHash;
+
+
+// Forward declaration begin
+static void     imodule_update_info(IModule *module);
+static uint64_t imodule_hash_frame(const IModule *module);
+static void     imodule_hash_begin(ImoduleHash *hash, size_t size);
+static void     imodule_hash_update(ImoduleHash *hash, const uint8_t *bytes, size_t size);
+static uint64_t imodule_hash_end(ImoduleHash *hash);
+static void     imodule_hash_word(ImoduleHash *hash, uint64_t word);
+// Forward declaration end
+
+
 // ================================== UTILS ==================================
 
 // Allocate memory for module and initialize it
@@ -61,6 +84,7 @@ IModule *sdk_imodule_create(const char               *name,
     // Setup other parameters
     module->poll_ratio = poll_ratio;
     module->is_enabled = is_enabled;
+    module->shrink_polls = IMODULE_DEFAULT_SHRINK_POLLS;
 
     return module;
 }
@@ -72,12 +96,24 @@ void sdk_imodule_destroy(IModule *module) {
         return;
     }
 
+    // The sampler and deadline threads use the module until they are stopped
+    mdtp_sampler_destroy(module);
+    mdtp_deadline_destroy(module);
+
     // Destroy context
     free((void *)module->context.module_name);
     free((void *)module->context.module_description);
 
     // Destroy MDTP data
-    free((void *)module->mdtp_data.data);
+    free(module->frame);
+    mdtp_tree_destroy(module->tree);
+    mdtp_delta_destroy(module->delta);
+    mdtp_dictionary_destroy(module->dictionary);
+    mdtp_compression_destroy(module->compression);
+    mdtp_crc_destroy(module->crc);
+    mdtp_chunk_destroy(module->chunks);
+    mdtp_registry_destroy(module->registry);
+    mdtp_cadence_destroy(module->cadence);
 
     // Free memory
     free((void *)module);
@@ -105,10 +141,261 @@ const ABI_MODULE_MDTP_DATA *sdk_imodule_get_mdtp_data(const IModule *module) {
 }
 
 
+// Get hash and generation of MDTP data of the module
+const ABI_MODULE_DATA_INFO *sdk_imodule_get_mdtp_data_info(IModule *module) {
+    // Frames are hashed only when asked, so producers that patch a few bytes stay O(changed)
+    if (module->hash_pending) {
+        module->hash_pending = 0;
+        imodule_describe(&module->data_info, imodule_hash_frame(module));
+    }
+
+    return &module->data_info;
+}
+
+
 // Set MDTP data of the module
 void sdk_imodule_set_mdtp_data(IModule *module, ABI_MODULE_MDTP_DATA data) {
-    free((void *)module->mdtp_data.data);
-    module->mdtp_data = data;
+    free(module->frame);
+
+    module->frame = (uint8_t *)data.data;
+    module->frame_capacity = data.size;
+
+    sdk_imodule_commit_mdtp_data(module, data.size);
+}
+
+
+// Reserve frame buffer of the module
+void *sdk_imodule_reserve_mdtp_data(IModule *module, uint32_t size) {
+    if (module->frame != NULL && module->frame_capacity >= size) {
+        return module->frame;
+    }
+
+    uint8_t *frame = module->frame;
+    size_t   capacity = module->frame_capacity;
+
+    if (mdtp_buffer_reserve(&frame, &capacity, size, IMODULE_MIN_FRAME_CAPACITY) != SDK_OK) {
+        return NULL;
+    }
+
+    // The capacity is kept as `uint32_t`, the extra bytes are never used
+    module->frame = frame;
+    module->frame_capacity = capacity > UINT32_MAX ? UINT32_MAX : (uint32_t)capacity;
+
+    return frame;
+}
+
+
+// Commit frame buffer of the module
+const ABI_MODULE_MDTP_DATA *sdk_imodule_commit_mdtp_data(IModule *module, uint32_t size) {
+    if (size > module->frame_capacity) {
+        return NULL;
+    }
+
+    // Shrink the buffer if all frames of the last `shrink_polls` polls would fit into a half of it
+    if (module->shrink_polls != 0) {
+        if (size > module->high_water) {
+            module->high_water = size;
+        }
+
+        if (++module->shrink_counter >= module->shrink_polls) {
+            uint32_t capacity = module->high_water < IMODULE_MIN_FRAME_CAPACITY
+                                    ? IMODULE_MIN_FRAME_CAPACITY
+                                    : module->high_water;
+
+            module->shrink_target = capacity;
+
+            if (capacity <= module->frame_capacity / 2) {
+                uint8_t *frame = realloc(module->frame, capacity);
+
+                // If realloc failed, the old buffer is still valid, so just keep it
+                if (frame != NULL) {
+                    module->frame = frame;
+                    module->frame_capacity = capacity;
+                }
+            }
+
+            module->shrink_counter = 0;
+            module->high_water = 0;
+        }
+    }
+
+    module->hash_parts = NULL;
+    module->hash_size = size;
+    imodule_update_info(module);
+
+    module->mdtp_data = (ABI_MODULE_MDTP_DATA){.data = module->frame, .size = size};
+
+    return &module->mdtp_data;
+}
+
+
+// Set shrink policy of the frame buffer
+void sdk_imodule_set_mdtp_shrink_polls(IModule *module, uint32_t polls) {
+    module->shrink_polls = polls;
+    module->shrink_counter = 0;
+    module->high_water = 0;
+}
+
+
+// Exchange frame buffer of the module with the caller's one
+const ABI_MODULE_MDTP_DATA *imodule_exchange_frame(IModule  *module,
+                                                   uint8_t **buffer,
+                                                   size_t   *capacity,
+                                                   uint32_t  size) {
+    uint8_t *frame = module->frame;
+    size_t   frame_capacity = module->frame_capacity;
+
+    module->frame = *buffer;
+    module->frame_capacity = *capacity > UINT32_MAX ? UINT32_MAX : (uint32_t)*capacity;
+
+    *buffer = frame;
+    *capacity = frame_capacity;
+
+    module->shrink_target = 0;
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_imodule_commit_mdtp_data(module, size);
+
+    // Both buffers of the swap hold frames of the same producer, so they shrink together
+    if (module->shrink_target != 0 && *buffer != NULL && module->shrink_target <= *capacity / 2) {
+        uint8_t *shrunk = realloc(*buffer, module->shrink_target);
+
+        if (shrunk != NULL) {
+            *buffer = shrunk;
+            *capacity = module->shrink_target;
+        }
+    }
+
+    return data;
+}
+
+
+// Update serial, hash and generation after a chunked frame was stored
+void imodule_commit_chunks(IModule *module, const MdtpChunkPart *parts, size_t count) {
+    module->hash_parts = parts;
+    module->hash_count = count;
+    imodule_update_info(module);
+}
+
+
+// Update serial of the stored frame and mark it as not hashed
+static void imodule_update_info(IModule *module) {
+    // Producers that patch the previous frame in place use the serial to check that the frame
+    // is still their own output
+    module->frame_serial = atomic_fetch_add(&imodule_frame_serial, 1) + 1;
+    module->hash_pending = 1;
+}
+
+
+// Hash the bytes of the stored frame, wherever they are kept
+static uint64_t imodule_hash_frame(const IModule *module) {
+    // A chunked frame is hashed as the frame its parts make up
+    if (module->hash_parts != NULL) {
+        ImoduleHash hash;
+        size_t      size = 0;
+
+        for (size_t i = 0; i < module->hash_count; ++i) {
+            size += module->hash_parts[i].size;
+        }
+
+        imodule_hash_begin(&hash, size);
+
+        for (size_t i = 0; i < module->hash_count; ++i) {
+            imodule_hash_update(&hash,
+                                module->hash_parts[i].data + MDTP_CHUNK_HEADER_SIZE,
+                                module->hash_parts[i].size);
+        }
+
+        return imodule_hash_end(&hash);
+    }
+
+    return imodule_hash_bytes(module->frame, module->hash_size);
+}
+
+
+// Hash bytes of a frame
+uint64_t imodule_hash_bytes(const uint8_t *bytes, size_t size) {
+    ImoduleHash hash;
+
+    imodule_hash_begin(&hash, size);
+    imodule_hash_update(&hash, bytes, size);
+
+    return imodule_hash_end(&hash);
+}
+
+
+// Describe frame with the given hash
+void imodule_describe(ABI_MODULE_DATA_INFO *info, uint64_t hash) {
+    // The generation changes only with the contents, even if the frame was rebuilt. The size is a
+    // part of the hash.
+    if (info->generation == 0 || hash != info->hash) {
+        info->hash = hash;
+        ++info->generation;
+    }
+}
+
+
+// Start hashing `size` bytes
+static void imodule_hash_begin(ImoduleHash *hash, size_t size) {
+    hash->hash = IMODULE_HASH_PRIME_2 ^ (size * IMODULE_HASH_PRIME_1);
+    hash->length = 0;
+}
+
+
+// Hash next bytes 8 at a time
+static void imodule_hash_update(ImoduleHash *hash, const uint8_t *bytes, size_t size) {
+    uint64_t word;
+
+    // Complete the word left by the previous range
+    if (hash->length != 0) {
+        size_t count = size < 8 - hash->length ? size : 8 - hash->length;
+
+        memcpy(hash->word + hash->length, bytes, count);
+        hash->length += count;
+        bytes += count;
+        size -= count;
+
+        if (hash->length < 8) {
+            return;
+        }
+
+        memcpy(&word, hash->word, 8);
+        imodule_hash_word(hash, word);
+        hash->length = 0;
+    }
+
+    for (; size >= 8; bytes += 8, size -= 8) {
+        memcpy(&word, bytes, 8);
+        imodule_hash_word(hash, word);
+    }
+
+    memcpy(hash->word, bytes, size);
+    hash->length = size;
+}
+
+
+// Finish hashing and get the hash
+static uint64_t imodule_hash_end(ImoduleHash *hash) {
+    if (hash->length != 0) {
+        uint64_t word;
+
+        memset(hash->word + hash->length, 0, 8 - hash->length);
+        memcpy(&word, hash->word, 8);
+        imodule_hash_word(hash, word);
+    }
+
+    // Mix the last word into all bits
+    hash->hash ^= hash->hash >> 33;
+    hash->hash *= IMODULE_HASH_PRIME_1;
+    hash->hash ^= hash->hash >> 29;
+
+    return hash->hash;
+}
+
+
+// Mix word into the hash
+static void imodule_hash_word(ImoduleHash *hash, uint64_t word) {
+    hash->hash ^= word * IMODULE_HASH_PRIME_1;
+    hash->hash = ((hash->hash << 31) | (hash->hash >> 33)) * IMODULE_HASH_PRIME_2;
 }
 
 
@@ -154,6 +441,20 @@ const ABI_SERVER_CORE_FUNCTIONS *sdk_imodule_get_server_core_functions(const IMo
 }
 
 
+// Get ABI version of the server, asking the server once
+uint32_t imodule_server_abi_version(IModule *module) {
+    uint32_t version = atomic_load_explicit(&module->server_abi, memory_order_relaxed);
+
+    // Threads that race here get the same version from the server
+    if (version == 0) {
+        version = sdk_utils_get_server_abi_version(module);
+        atomic_store_explicit(&module->server_abi, version, memory_order_relaxed);
+    }
+
+    return version;
+}
+
+
 // ================================== REGISTERERS ==================================
 
 // Register destroy
@@ -183,6 +484,26 @@ void sdk_module_register_get_data(IModule *module, const ABI_MODULE_MDTP_DATA *(
     module->module_functions.module_get_data = callback;
 }
 
+// Get data info
+void sdk_module_register_get_data_info(IModule *module,
+                                       const ABI_MODULE_DATA_INFO *(*callback)(void)) {
+    if (!module || !callback) {
+        return;
+    }
+
+    module->module_functions.module_get_data_info = callback;
+}
+
+// Get data chunk
+void sdk_module_register_get_data_chunk(
+    IModule *module, const ABI_MODULE_MDTP_DATA *(*callback)(uint32_t sequence)) {
+    if (!module || !callback) {
+        return;
+    }
+
+    module->module_functions.module_get_data_chunk = callback;
+}
+
 // Enable module
 void sdk_module_register_enable(IModule *module, void (*callback)(void)) {
     if (!module || !callback) {
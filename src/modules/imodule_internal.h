@@ -0,0 +1,336 @@
+/**
+ * @file modules/imodule_internal.h
+ *
+ * @brief Definition of `IModule` shared between SDK translation units. This header is not
+ * installed, modules work with `IModule` only through `sdk_imodule_*` functions.
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#pragma once
+
+#include "../../include/modules/internals/imodule.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct MdtpTree  MdtpTree;  ///< Forward declaration
+typedef struct MdtpDelta MdtpDelta; ///< Forward declaration
+
+typedef struct MdtpDictionary  MdtpDictionary;  ///< Forward declaration
+typedef struct MdtpCompression MdtpCompression; ///< Forward declaration
+typedef struct MdtpCrc         MdtpCrc;         ///< Forward declaration
+typedef struct MdtpChunks      MdtpChunks;      ///< Forward declaration
+typedef struct MdtpRegistry    MdtpRegistry;    ///< Forward declaration
+typedef struct MdtpSampler     MdtpSampler;     ///< Forward declaration
+typedef struct MdtpDeadline    MdtpDeadline;    ///< Forward declaration
+typedef struct MdtpCadence     MdtpCadence;     ///< Forward declaration
+typedef struct MdtpBuilder     MdtpBuilder;     ///< Forward declaration
+
+/**
+ * @brief Part of a chunked frame: a buffer with room for the part header followed by frame bytes
+ */
+typedef struct MdtpChunkPart {
+    uint8_t *data;     ///< `MDTP_CHUNK_HEADER_SIZE` bytes of the part header, then frame bytes
+    size_t   size;     ///< Count of frame bytes of the part
+    size_t   capacity; ///< Count of frame bytes allocated after the part header
+} MdtpChunkPart;
+
+/**
+ * @brief State of a builder saved by `mdtp_builder_mark`
+ */
+typedef struct MdtpBuilderMark {
+    size_t   size;         ///< Count of bytes written before the mark
+    uint32_t depth;        ///< Count of open containers at the mark
+    uint32_t capabilities; ///< `ABI_CAPABILITY_*` needed by the nodes written before the mark
+} MdtpBuilderMark;
+
+typedef struct IModule {
+    ABI_MODULE_CONTEXT        context;          ///< Context of the module
+    ABI_MODULE_MDTP_DATA      mdtp_data;        ///< MDTP data returned to the server
+    ABI_MODULE_FUNCTIONS      module_functions; ///< Module functions
+    ABI_SERVER_CORE_FUNCTIONS server_functions; ///< Server core functions
+    uint32_t                  poll_ratio;       ///< Poll ratio of the module
+    uint8_t                   is_enabled;       ///< `1` if module is enabled, otherwise `0`
+    _Atomic uint32_t          server_abi;       ///< ABI version of the server, `0` until asked
+
+    uint8_t *frame;          ///< Frame buffer, rewritten in place on every poll
+    uint32_t frame_capacity; ///< Count of bytes allocated for `frame`
+    uint32_t shrink_polls;   ///< Polls under the high-water mark before shrinking (`0` - never)
+    uint32_t shrink_counter; ///< Polls since the last shrink check
+    uint32_t high_water;     ///< Largest frame since the last shrink check
+    uint32_t shrink_target;  ///< Capacity set by the shrink check of the last commit, or `0`
+    uint64_t frame_serial;   ///< Process-wide unique number of the last committed frame
+
+    ABI_MODULE_DATA_INFO data_info;    ///< Hash and generation of the frame hashed last
+    const MdtpChunkPart *hash_parts;   ///< Parts of the stored frame if it was built in chunks
+    size_t               hash_count;   ///< Count of `hash_parts`
+    uint32_t             hash_size;    ///< Count of bytes of the stored frame if it is not chunked
+    uint8_t              hash_pending; ///< `1` if the stored frame was not hashed yet
+
+    MdtpTree  *tree;  ///< Persistent MDTP tree, created on first use
+    MdtpDelta *delta; ///< Delta frames state, `NULL` until delta frames are enabled
+
+    MdtpDictionary  *dictionary;  ///< Dictionary strings state, `NULL` until they are enabled
+    MdtpCompression *compression; ///< Compression state, `NULL` until compression is enabled
+    MdtpCrc         *crc;         ///< CRC32C trailers state, `NULL` until they are enabled
+    MdtpChunks      *chunks;      ///< Chunked frames state, `NULL` until they are enabled
+    MdtpRegistry    *registry;    ///< Metric registry, created on first registration
+    MdtpSampler     *sampler;     ///< Background sampler, `NULL` until it is started
+    MdtpDeadline    *deadline;    ///< Collection time budget, `NULL` until it is set
+    MdtpCadence     *cadence;     ///< Subtree collectors, created on first registration
+} IModule;
+
+
+/**
+ * @brief Get ABI version of the server with its capability bits. The server is asked once, later
+ * calls from any thread return the kept version, so frames finished on every poll do not call
+ * into the server.
+ * @param module Not-null pointer to `IModule`
+ * @return ABI version, see `sdk_utils_get_server_abi_version`
+ */
+uint32_t imodule_server_abi_version(IModule *module);
+
+/**
+ * @brief Installs `*buffer` (with `size` bytes of a complete frame) as the frame buffer of the
+ * module and commits it. The previous frame buffer is returned through `buffer` and `capacity` so
+ * the caller can write the next frame into it without allocating. If the commit checks the size of
+ * the frame buffer, the returned buffer is checked and shrunk the same way.
+ * @param module Not-null pointer to `IModule`
+ * @param buffer Pointer to the buffer allocated via `malloc`
+ * @param capacity Pointer to count of bytes allocated for `*buffer`
+ * @param size Count of frame bytes in `*buffer`
+ * @return Pointer to `ABI_MODULE_MDTP_DATA` of the module
+ */
+const ABI_MODULE_MDTP_DATA *imodule_exchange_frame(IModule  *module,
+                                                   uint8_t **buffer,
+                                                   size_t   *capacity,
+                                                   uint32_t  size);
+
+/**
+ * @brief Destroys the persistent MDTP tree of a module
+ * @param tree Pointer to `MdtpTree`. If `NULL`, no effect.
+ */
+void mdtp_tree_destroy(MdtpTree *tree);
+
+/**
+ * @brief Destroys the delta frames state of a module
+ * @param delta Pointer to `MdtpDelta`. If `NULL`, no effect.
+ */
+void mdtp_delta_destroy(MdtpDelta *delta);
+
+/**
+ * @brief Checks if the module sends delta frames
+ * @param module Not-null pointer to `IModule`
+ * @return `1` if delta frames are enabled, otherwise `0`
+ */
+int mdtp_delta_enabled(const IModule *module);
+
+/**
+ * @brief Destroys the dictionary strings state of a module
+ * @param dictionary Pointer to `MdtpDictionary`. If `NULL`, no effect.
+ */
+void mdtp_dictionary_destroy(MdtpDictionary *dictionary);
+
+/**
+ * @brief Checks if the module sends dictionary strings
+ * @param module Not-null pointer to `IModule`
+ * @return `1` if dictionary strings are enabled, otherwise `0`
+ */
+int mdtp_dictionary_enabled(const IModule *module);
+
+/**
+ * @brief Destroys the compression state of a module
+ * @param compression Pointer to `MdtpCompression`. If `NULL`, no effect.
+ */
+void mdtp_compression_destroy(MdtpCompression *compression);
+
+/**
+ * @brief If the frame to send is a compressed one, makes the frame it was compressed from the
+ * frame to send again, so that delta frames and dictionary strings are made before compression
+ * @param module Not-null pointer to `IModule`
+ */
+void mdtp_compression_restore(IModule *module);
+
+/**
+ * @brief Destroys the CRC32C trailers state of a module
+ * @param crc Pointer to `MdtpCrc`. If `NULL`, no effect.
+ */
+void mdtp_crc_destroy(MdtpCrc *crc);
+
+/**
+ * @brief If the frame to send has a trailer, makes the frame the trailer was appended to the
+ * frame to send again, so that the other encodings are made before the trailer
+ * @param module Not-null pointer to `IModule`
+ */
+void mdtp_crc_restore(IModule *module);
+
+/**
+ * @brief Updates the serial of the module after a chunked frame was stored by
+ * `mdtp_chunk_exchange`. The frame buffer of the module is not changed. The parts are hashed as
+ * the frame they make up when the info of the module is requested.
+ * @param module Not-null pointer to `IModule`
+ * @param parts Parts of the frame, kept unchanged until the next frame is stored
+ * @param count Count of parts
+ */
+void imodule_commit_chunks(IModule *module, const MdtpChunkPart *parts, size_t count);
+
+/**
+ * @brief Hashes the bytes of a frame the way the info of a module does, see
+ * `sdk_imodule_get_mdtp_data_info`
+ * @param bytes Bytes of the frame
+ * @param size Count of bytes
+ * @return Hash of the frame
+ */
+uint64_t imodule_hash_bytes(const uint8_t *bytes, size_t size);
+
+/**
+ * @brief Updates the info of the frames of a producer with the hash of its next frame. The
+ * generation is incremented only if the hash differs from the frame described last.
+ * @param info Not-null pointer to `ABI_MODULE_DATA_INFO` of the frame described last, zeroed if
+ * none
+ * @param hash Hash of the next frame, see `imodule_hash_bytes`
+ */
+void imodule_describe(ABI_MODULE_DATA_INFO *info, uint64_t hash);
+
+/**
+ * @brief Checks if the module takes frames built in chunks
+ * @param module Not-null pointer to `IModule`
+ * @return `1` if chunked frames are enabled, otherwise `0`
+ */
+int mdtp_chunk_enabled(const IModule *module);
+
+/**
+ * @brief Installs the parts of a frame built in chunks as the frame to send and gives the parts of
+ * the previous chunked frame back, so the caller can build the next frame into them without
+ * allocating
+ * @param module Not-null pointer to `IModule` with chunked frames enabled
+ * @param parts Pointer to the array of parts allocated via `malloc`
+ * @param count Count of parts of the frame in `*parts`. The count of the previous parts is
+ * returned through it.
+ * @param capacity Pointer to count of elements allocated for `*parts`
+ * @return Pointer to `ABI_MODULE_MDTP_DATA` of the first part or `NULL` if memory could not be
+ * allocated (then nothing is exchanged)
+ */
+const ABI_MODULE_MDTP_DATA *mdtp_chunk_exchange(IModule        *module,
+                                                MdtpChunkPart **parts,
+                                                size_t         *count,
+                                                size_t         *capacity);
+
+/**
+ * @brief Destroys the chunked frames state of a module
+ * @param chunks Pointer to `MdtpChunks`. If `NULL`, no effect.
+ */
+void mdtp_chunk_destroy(MdtpChunks *chunks);
+
+/**
+ * @brief If the frame to send was split into parts, makes the frame it was split from the frame
+ * to send again, so that the other encodings are made before splitting
+ * @param module Not-null pointer to `IModule`
+ */
+void mdtp_chunk_restore(IModule *module);
+
+/**
+ * @brief Destroys the metric registry of a module
+ * @param registry Pointer to `MdtpRegistry`. If `NULL`, no effect.
+ */
+void mdtp_registry_destroy(MdtpRegistry *registry);
+
+/**
+ * @brief Stops and destroys the background sampler of a module
+ * @param module Not-null pointer to `IModule`. If it has no sampler, no effect.
+ */
+void mdtp_sampler_destroy(IModule *module);
+
+/**
+ * @brief Checks if the background sampler of the module runs
+ * @param module Not-null pointer to `IModule`
+ * @return `1` if the sampler runs, otherwise `0`
+ */
+int mdtp_sampler_running(const IModule *module);
+
+/**
+ * @brief Removes the collection time budget of a module and destroys its state
+ * @param module Not-null pointer to `IModule`. If no budget was ever set, no effect.
+ */
+void mdtp_deadline_destroy(IModule *module);
+
+/**
+ * @brief Checks if the module has a collection time budget
+ * @param module Not-null pointer to `IModule`
+ * @return `1` if the budget is set, otherwise `0`
+ */
+int mdtp_deadline_enabled(const IModule *module);
+
+
+/**
+ * @brief Starts recording the nodes the builder writes next, so their bytes can be copied by
+ * `mdtp_builder_read` once `mdtp_builder_unmark` is called
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param mark Not-null pointer to `MdtpBuilderMark` to save the state of the builder to
+ */
+void mdtp_builder_mark(MdtpBuilder *builder, MdtpBuilderMark *mark);
+
+/**
+ * @brief Stops recording the nodes written since `mdtp_builder_mark`
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param mark Not-null pointer to `MdtpBuilderMark` filled by `mdtp_builder_mark`
+ * @param size Count of bytes written since the mark, they start at offset `mark->size`
+ * @param capabilities `ABI_CAPABILITY_*` the server needs to read the recorded nodes
+ * @return Status of the builder. `SDK_INVALID_ARGUMENT` is remembered if a container opened since
+ * the mark is still open, one opened before it was closed, or a table is open.
+ */
+SDKStatus mdtp_builder_unmark(MdtpBuilder           *builder,
+                              const MdtpBuilderMark *mark,
+                              size_t                *size,
+                              uint32_t              *capabilities);
+
+/**
+ * @brief Copies `size` bytes of the frame being written, starting at `offset`, also when the frame
+ * is written in chunks
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param offset Offset of the first byte in the frame
+ * @param destination Not-null pointer to at least `size` bytes
+ * @param size Count of bytes to copy, all of them written already
+ */
+void mdtp_builder_read(const MdtpBuilder *builder,
+                       size_t             offset,
+                       uint8_t           *destination,
+                       size_t             size);
+
+/**
+ * @brief Appends bytes of complete nodes recorded from a builder writing the same MDTP version
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @param bytes Bytes of the nodes, not-null unless `size` is `0`
+ * @param size Count of bytes
+ * @param capabilities `ABI_CAPABILITY_*` the server needs to read the nodes
+ * @return `SDK_OK` on success, `SDK_INVALID_ARGUMENT` if a table is open, `SDK_ALLOCATION_ERROR` if
+ * the buffer could not grow, or the status of an earlier failed call
+ */
+SDKStatus mdtp_builder_splice(MdtpBuilder   *builder,
+                              const uint8_t *bytes,
+                              size_t         size,
+                              uint32_t       capabilities);
+
+/**
+ * @brief Get MDTP version of the frames written by the builder
+ * @param builder Not-null pointer to `MdtpBuilder`
+ * @return `MDTP_VERSION` or `MDTP_VERSION_2`
+ */
+uint8_t mdtp_builder_version(const MdtpBuilder *builder);
+
+/**
+ * @brief Destroys the subtree collectors of a module and their cached nodes
+ * @param cadence Pointer to `MdtpCadence`. If `NULL`, no effect.
+ */
+void mdtp_cadence_destroy(MdtpCadence *cadence);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -8,6 +8,10 @@
 #include "../../include/modules/internals/mdtp.h"
 #include "../../include/modules/internals/abi.h"
 #include "../../include/modules/internals/imodule.h"
+#include "../../include/modules/internals/mdtp_compression.h"
+#include "../../include/modules/internals/mdtp_chunk.h"
+#include "../../include/modules/internals/mdtp_crc.h"
+#include "../../include/modules/internals/mdtp_reader.h"
 #include "../../include/modules/internals/memutils.h"
 #include <stdarg.h>
 #include <stddef.h>
@@ -16,71 +20,224 @@
 #include <stdlib.h>
 #include <string.h>
 
+// Node sizes of `sdk_mdtp_make_container_v` and `sdk_mdtp_make_root_v` kept on the stack
+#define MDTP_STACK_NODE_SIZES 64
+
 
 // Forward declaration begin
-static uint32_t mdtp_get_nodes_size(const void *first, ...);
-static uint32_t mdtp_get_nodes_size_va(const void *first, va_list args);
+static void    *mdtp_make_container_va(const char *name,
+                                       size_t      name_length,
+                                       void       *first,
+                                       va_list     args);
+static void    *mdtp_allocate_value(const char *value_name,
+                                    size_t      value_name_length,
+                                    const char *value_units,
+                                    size_t      value_units_length,
+                                    size_t      value_length,
+                                    char      **value);
+static void    *mdtp_make_array(const char *value_name,
+                                uint8_t     element_type,
+                                const void *values,
+                                size_t      count,
+                                const char *value_units);
+static uint64_t mdtp_get_node_size(const void *node);
+static uint64_t mdtp_get_nodes_size_va(const void *first, va_list args);
+static uint64_t mdtp_get_nodes_size_v(void *const *nodes, size_t count, size_t *sizes);
+static void     mdtp_move_nodes_v(uint8_t      *destination,
+                                  void        **nodes,
+                                  size_t        count,
+                                  const size_t *sizes);
+static size_t   mdtp_move_node(uint8_t *destination, void *node, size_t node_size);
 // Forward declaration end
 
 
 // Make value node
 void *sdk_mdtp_make_value(const char *value_name, const char *value, const char *value_units) {
-    // From MDTP v1 specification:
+    if (value_name == NULL || value == NULL || value_units == NULL) {
+        return NULL;
+    }
 
-    // [node type]: 1 unsigned byte (1 because node is value)
-    // [node name length]: unsigned int32
-    // [name of node...]: array of char
-    // [units length]: unsigned int32
-    // [units...]: array of char
-    // [value length]: unsigned int32
-    // [value...]: array of char
+    return sdk_mdtp_make_value_n(
+        value_name, strlen(value_name), value, strlen(value), value_units, strlen(value_units));
+}
 
-    if (value_name == NULL || value == NULL || value_units == NULL) {
 
+// Make value node from strings with explicit lengths
+void *sdk_mdtp_make_value_n(const char *value_name,
+                            size_t      value_name_length,
+                            const char *value,
+                            size_t      value_length,
+                            const char *value_units,
+                            size_t      value_units_length) {
+    if (value == NULL || value_length > UINT32_MAX) {
         return NULL;
     }
 
-    size_t buffer_size = 1 + sizeof(uint32_t) + strlen(value_name) + sizeof(uint32_t) +
-                         strlen(value_units) + sizeof(uint32_t) + strlen(value);
-    size_t offset = 0; // Current position
+    char *value_area;
+    void *buffer = mdtp_allocate_value(
+        value_name, value_name_length, value_units, value_units_length, value_length, &value_area);
 
-    void *buffer = calloc(1, buffer_size); // Use calloc to fill memory by zeroes
+    if (buffer == NULL) {
+        return NULL;
+    }
+
+    // Write value
+    memcpy(value_area, value, value_length);
+
+    return buffer;
+}
+
+
+// Make value node holding unsigned integer
+void *sdk_mdtp_make_value_u64(const char *value_name, uint64_t value, const char *value_units) {
+    if (value_name == NULL || value_units == NULL) {
+        return NULL;
+    }
+
+    size_t value_length = sdk_mdtp_format_u64_length(value);
+    char  *value_area;
+    void *buffer = mdtp_allocate_value(value_name,
+                                       strlen(value_name),
+                                       value_units,
+                                       strlen(value_units),
+                                       value_length,
+                                       &value_area);
 
-    // Allocation error
     if (buffer == NULL) {
         return NULL;
     }
 
-    size_t value_name_length = strlen(value_name);
-    size_t value_units_length = strlen(value_units);
-    size_t value_length = strlen(value);
+    // Format directly into the node
+    sdk_mdtp_format_u64(value_area, value);
 
-    // Write node type
-    write_ubyte_be(buffer, offset, 1);
+    return buffer;
+}
+
+
+// Make value node holding signed integer
+void *sdk_mdtp_make_value_i64(const char *value_name, int64_t value, const char *value_units) {
+    if (value_name == NULL || value_units == NULL) {
+        return NULL;
+    }
+
+    size_t value_length = value < 0 ? 1 + sdk_mdtp_format_u64_length(0 - (uint64_t)value)
+                                    : sdk_mdtp_format_u64_length((uint64_t)value);
+    char  *value_area;
+    void *buffer = mdtp_allocate_value(value_name,
+                                       strlen(value_name),
+                                       value_units,
+                                       strlen(value_units),
+                                       value_length,
+                                       &value_area);
+
+    if (buffer == NULL) {
+        return NULL;
+    }
+
+    // Format directly into the node
+    sdk_mdtp_format_i64(value_area, value);
+
+    return buffer;
+}
+
+
+// Make value node holding floating point number
+void *sdk_mdtp_make_value_f64(const char *value_name,
+                              double      value,
+                              int         precision,
+                              const char *value_units) {
+    if (value_name == NULL || value_units == NULL) {
+        return NULL;
+    }
+
+    // Length of the text is not known in advance, so it is formatted on the stack
+    char   text[MDTP_F64_MAX_LENGTH];
+    size_t text_length = sdk_mdtp_format_f64(text, value, precision);
+
+    return sdk_mdtp_make_value_n(
+        value_name, strlen(value_name), text, text_length, value_units, strlen(value_units));
+}
+
+
+// Make array node of floating point numbers
+void *sdk_mdtp_make_array_f64(const char   *value_name,
+                              const double *values,
+                              size_t        count,
+                              const char   *value_units) {
+    return mdtp_make_array(value_name, MDTP_VALUE_F64, values, count, value_units);
+}
+
+
+// Make array node of unsigned integers
+void *sdk_mdtp_make_array_u64(const char     *value_name,
+                              const uint64_t *values,
+                              size_t          count,
+                              const char     *value_units) {
+    return mdtp_make_array(value_name, MDTP_VALUE_U64, values, count, value_units);
+}
+
+
+// Make histogram node
+void *sdk_mdtp_make_histogram(const char     *value_name,
+                              const double   *bounds,
+                              size_t          bound_count,
+                              const uint64_t *counts,
+                              double          sum,
+                              const char     *value_units) {
+    // [node type]: 1 unsigned byte (4 because node is histogram)
+    // [node name length], [name of node...], [units length], [units...]: as in a value
+    // [bound count]: unsigned int32
+    // [bounds...]: 8 bytes each, Big Endian
+    // [counts...]: 8 bytes each, Big Endian, one more than bounds
+    // [sum]: 8 bytes, Big Endian
+
+    if (value_name == NULL || value_units == NULL || counts == NULL ||
+        (bounds == NULL && bound_count != 0) || bound_count > MDTP_HISTOGRAM_MAX_BOUNDS) {
+        return NULL;
+    }
+
+    for (size_t i = 1; i < bound_count; ++i) {
+        if (!(bounds[i - 1] < bounds[i])) {
+            return NULL;
+        }
+    }
+
+    size_t name_length = strlen(value_name);
+    size_t units_length = strlen(value_units);
+
+    if (name_length > UINT32_MAX || units_length > UINT32_MAX) {
+        return NULL;
+    }
+
+    size_t   offset = 0;
+    uint8_t *buffer =
+        malloc(1 + 4 + name_length + 4 + units_length + 4 + bound_count * 16 + 8 + 8);
+
+    if (buffer == NULL) {
+        return NULL;
+    }
+
+    write_ubyte_be(buffer, offset, MDTP_NODE_HISTOGRAM);
     ++offset;
 
-    // Write node name length
-    write_uint32_be(buffer, offset, (uint32_t)value_name_length);
-    offset += 4;
+    write_uint32_be(buffer, offset, (uint32_t)name_length);
+    memcpy(buffer + offset + 4, value_name, name_length);
+    offset += 4 + name_length;
 
-    // Write node name
-    memcpy((char *)buffer + offset, value_name, value_name_length);
-    offset += value_name_length;
+    write_uint32_be(buffer, offset, (uint32_t)units_length);
+    memcpy(buffer + offset + 4, value_units, units_length);
+    offset += 4 + units_length;
 
-    // Write units length
-    write_uint32_be(buffer, offset, (uint32_t)value_units_length);
+    write_uint32_be(buffer, offset, (uint32_t)bound_count);
     offset += 4;
 
-    // Write units
-    memcpy((char *)buffer + offset, value_units, value_units_length);
-    offset += value_units_length;
+    write_uint64_be_array(buffer, offset, bounds, bound_count);
+    offset += bound_count * 8;
 
-    // Write value length
-    write_uint32_be(buffer, offset, (uint32_t)value_length);
-    offset += 4;
+    write_uint64_be_array(buffer, offset, counts, bound_count + 1);
+    offset += (bound_count + 1) * 8;
 
-    // Write value
-    memcpy((char *)buffer + offset, value, value_length);
+    write_uint64_be_array(buffer, offset, &sum, 1);
 
     return buffer;
 }
@@ -88,8 +245,9 @@ void *sdk_mdtp_make_value(const char *value_name, const char *value, const char
 
 // Free value node
 void sdk_mdtp_free_value(void *value_node) {
-    // If not value node
-    if (read_ubyte_be(value_node, 0) != 1) {
+    // If neither value, array nor histogram node
+    if (read_ubyte_be(value_node, 0) != 1 && read_ubyte_be(value_node, 0) != MDTP_NODE_ARRAY &&
+        read_ubyte_be(value_node, 0) != MDTP_NODE_HISTOGRAM) {
         return;
     }
 
@@ -97,9 +255,46 @@ void sdk_mdtp_free_value(void *value_node) {
 }
 
 
-// Make container node]
+// Make container node
 void *sdk_mdtp_make_container(const char *name, void *first, ...) {
-    if (name == NULL || first == NULL) {
+    if (name == NULL) {
+        return NULL;
+    }
+
+    va_list args;
+    va_start(args, first);
+    void *container = mdtp_make_container_va(name, strlen(name), first, args);
+    va_end(args);
+
+    return container;
+}
+
+
+// Make container node from name with explicit length
+void *sdk_mdtp_make_container_n(const char *name, size_t name_length, void *first, ...) {
+    va_list args;
+    va_start(args, first);
+    void *container = mdtp_make_container_va(name, name_length, first, args);
+    va_end(args);
+
+    return container;
+}
+
+
+// Free container node
+void sdk_mdtp_free_container(void *container_node) {
+    // If not container node
+    if (read_ubyte_be(container_node, 0) != 0) {
+        return;
+    }
+
+    free(container_node);
+}
+
+
+// Make root node
+const ABI_MODULE_MDTP_DATA *sdk_mdtp_make_root(IModule *module, void *first, ...) {
+    if (first == NULL) {
         return NULL;
     }
 
@@ -109,14 +304,20 @@ void *sdk_mdtp_make_container(const char *name, void *first, ...) {
     va_copy(args_copy, args);
 
     void    *ptr = first;
-    void    *buffer;
     size_t   offset = 0;
-    size_t   name_length = strlen(name);
-    uint32_t payload_size = mdtp_get_nodes_size_va(first, args_copy);
+    uint64_t payload_size = mdtp_get_nodes_size_va(first, args_copy);
 
-    uint32_t size = 1 /* node type */ + 4 /* name length */ + (uint32_t)name_length /* name */ +
-                    4 /* payload size */ + payload_size /* payload */;
-    buffer = calloc(1, size); // calloc to fill memory by zeroes
+    // Larger frames need `sdk_mdtp_builder_set_chunk_size`
+    if (payload_size > UINT32_MAX - 5) {
+        va_end(args);
+        va_end(args_copy);
+        return NULL;
+    }
+
+    uint32_t size = 1 /* version of MDTP */ + 4 /* payload size */ + (uint32_t)payload_size;
+
+    // Frame is written in place into the buffer held by the module, which is reused across polls
+    void *buffer = sdk_imodule_reserve_mdtp_data(module, size);
 
     if (buffer == NULL) {
         va_end(args);
@@ -125,37 +326,17 @@ void *sdk_mdtp_make_container(const char *name, void *first, ...) {
     }
 
     // Fill buffer
-    // Write node type
-    write_ubyte_be(buffer, offset, 0 /* container */);
+    // Write MDTP version
+    write_ubyte_be(buffer, offset, MDTP_VERSION);
     ++offset;
 
-    // Write name length
-    write_uint32_be(buffer, offset, (uint32_t)name_length);
-    offset += 4;
-
-    // Write name
-    memcpy((char *)buffer + offset, name, name_length);
-    offset += name_length;
-
     // Write payload size
-    write_uint32_be(buffer, offset, payload_size);
+    write_uint32_be(buffer, offset, (uint32_t)payload_size);
     offset += 4;
 
     // Write payload
     while (ptr != NULL) {
-        uint32_t node_size = mdtp_get_nodes_size(ptr, NULL);
-        memcpy((char *)buffer + offset, ptr, node_size);
-
-        // If node type is value
-        if (read_ubyte_be(ptr, 0) == 1) {
-            sdk_mdtp_free_value(ptr);
-        }
-        // If node type is container
-        else if (read_ubyte_be(ptr, 0) == 0) {
-            sdk_mdtp_free_container(ptr);
-        }
-
-        offset += node_size;
+        offset += mdtp_move_node((uint8_t *)buffer + offset, ptr, (size_t)mdtp_get_node_size(ptr));
 
         ptr = va_arg(args, void *);
     }
@@ -163,149 +344,421 @@ void *sdk_mdtp_make_container(const char *name, void *first, ...) {
     va_end(args);
     va_end(args_copy);
 
+    sdk_imodule_commit_mdtp_data(module, size);
+
+    // Compressed, protected and split if enabled, see `sdk_mdtp_compression_enable`,
+    // `sdk_mdtp_crc_enable` and `sdk_mdtp_chunk_enable`
+    sdk_mdtp_compression_emit(module);
+    sdk_mdtp_crc_emit(module);
+
+    return sdk_mdtp_chunk_emit(module);
+}
+
+
+// Make container node from array of nodes
+void *sdk_mdtp_make_container_v(const char *name, void **nodes, size_t count) {
+    if (name == NULL || (nodes == NULL && count != 0)) {
+        return NULL;
+    }
+
+    // Every node header is parsed once, the sizes are reused to move the nodes
+    size_t  stack_sizes[MDTP_STACK_NODE_SIZES];
+    size_t *sizes = count <= MDTP_STACK_NODE_SIZES ? stack_sizes : malloc(count * sizeof(size_t));
+
+    if (sizes == NULL) {
+        return NULL;
+    }
+
+    size_t   name_length = strlen(name);
+    uint64_t payload_size = mdtp_get_nodes_size_v(nodes, count, sizes);
+    uint64_t size = 1 /* node type */ + 4 /* name length */ + name_length /* name */ +
+                    4 /* payload size */ + payload_size /* payload */;
+    uint8_t *buffer = NULL;
+
+    if (name_length <= UINT32_MAX && payload_size <= UINT32_MAX) {
+        buffer = malloc((size_t)size); // Every byte is written below
+    }
+
+    if (buffer == NULL) {
+        if (sizes != stack_sizes) {
+            free(sizes);
+        }
+
+        return NULL;
+    }
+
+    // Write node type, name and payload size
+    write_ubyte_be(buffer, 0, 0 /* container */);
+    write_uint32_be(buffer, 1, (uint32_t)name_length);
+    memcpy(buffer + 5, name, name_length);
+    write_uint32_be(buffer, 5 + name_length, (uint32_t)payload_size);
+
+    // Write payload
+    mdtp_move_nodes_v(buffer + 5 + name_length + 4, nodes, count, sizes);
+
+    if (sizes != stack_sizes) {
+        free(sizes);
+    }
+
     return buffer;
 }
 
 
-// Free container node
-void sdk_mdtp_free_container(void *container_node) {
-    // If not container node
-    if (read_ubyte_be(container_node, 0) != 0) {
-        return;
+// Make root node from array of nodes
+const ABI_MODULE_MDTP_DATA *sdk_mdtp_make_root_v(IModule *module, void **nodes, size_t count) {
+    if (nodes == NULL && count != 0) {
+        return NULL;
     }
 
-    free(container_node);
+    // Every node header is parsed once, the sizes are reused to move the nodes
+    size_t  stack_sizes[MDTP_STACK_NODE_SIZES];
+    size_t *sizes = count <= MDTP_STACK_NODE_SIZES ? stack_sizes : malloc(count * sizeof(size_t));
+
+    if (sizes == NULL) {
+        return NULL;
+    }
+
+    uint64_t payload_size = mdtp_get_nodes_size_v(nodes, count, sizes);
+    uint8_t *buffer = NULL;
+
+    // Larger frames need `sdk_mdtp_builder_set_chunk_size`
+    if (payload_size <= UINT32_MAX - 5) {
+        buffer = sdk_imodule_reserve_mdtp_data(module, 1 + 4 + (uint32_t)payload_size);
+    }
+
+    if (buffer == NULL) {
+        if (sizes != stack_sizes) {
+            free(sizes);
+        }
+
+        return NULL;
+    }
+
+    uint32_t size = 1 /* version of MDTP */ + 4 /* payload size */ + (uint32_t)payload_size;
+
+    // Write header
+    write_ubyte_be(buffer, 0, MDTP_VERSION);
+    write_uint32_be(buffer, 1, (uint32_t)payload_size);
+
+    // Write payload
+    mdtp_move_nodes_v(buffer + 5, nodes, count, sizes);
+
+    if (sizes != stack_sizes) {
+        free(sizes);
+    }
+
+    sdk_imodule_commit_mdtp_data(module, size);
+
+    // Compressed, protected and split if enabled, see `sdk_mdtp_compression_enable`,
+    // `sdk_mdtp_crc_enable` and `sdk_mdtp_chunk_enable`
+    sdk_mdtp_compression_emit(module);
+    sdk_mdtp_crc_emit(module);
+
+    return sdk_mdtp_chunk_emit(module);
 }
 
 
-// Make root node
-const ABI_MODULE_MDTP_DATA *sdk_mdtp_make_root(IModule *module, void *first, ...) {
-    if (first == NULL) {
+// Make container node via va_list
+static void *mdtp_make_container_va(const char *name,
+                                    size_t      name_length,
+                                    void       *first,
+                                    va_list     args) {
+    if (name == NULL || first == NULL || name_length > UINT32_MAX) {
         return NULL;
     }
 
-    va_list args;
     va_list args_copy;
-    va_start(args, first);
     va_copy(args_copy, args);
 
     void    *ptr = first;
+    void    *buffer;
     size_t   offset = 0;
-    uint32_t payload_size = mdtp_get_nodes_size_va(first, args_copy);
+    uint64_t payload_size = mdtp_get_nodes_size_va(first, args_copy);
+    uint64_t size = 1 /* node type */ + 4 /* name length */ + name_length /* name */ +
+                    4 /* payload size */ + payload_size /* payload */;
+
+    if (size > UINT32_MAX) {
+        va_end(args_copy);
+        return NULL;
+    }
 
-    uint32_t size = 1 /* version of MDTP */ + 4 /* payload size */ + payload_size /* payload */;
-    void    *buffer = calloc(1, size); // calloc to fill memory by zeroes
+    buffer = malloc(size); // Every byte is written below
 
     if (buffer == NULL) {
-        va_end(args);
         va_end(args_copy);
         return NULL;
     }
 
-    ABI_MODULE_MDTP_DATA mdtp = (ABI_MODULE_MDTP_DATA){.data = buffer, .size = size};
-
     // Fill buffer
-    // Write MDTP version
-    write_ubyte_be((void *)mdtp.data, offset, MDTP_VERSION);
+    // Write node type
+    write_ubyte_be(buffer, offset, 0 /* container */);
     ++offset;
 
+    // Write name length
+    write_uint32_be(buffer, offset, (uint32_t)name_length);
+    offset += 4;
+
+    // Write name
+    memcpy((char *)buffer + offset, name, name_length);
+    offset += name_length;
+
     // Write payload size
-    write_uint32_be((void *)mdtp.data, offset, payload_size);
+    write_uint32_be(buffer, offset, (uint32_t)payload_size);
     offset += 4;
 
     // Write payload
     while (ptr != NULL) {
-        uint32_t node_size = mdtp_get_nodes_size(ptr, NULL);
-        memcpy((char *)mdtp.data + offset, ptr, node_size);
-
-        // If node type is value
-        if (read_ubyte_be(ptr, 0) == 1) {
-            sdk_mdtp_free_value(ptr);
-        }
-        // If node type is container
-        else if (read_ubyte_be(ptr, 0) == 0) {
-            sdk_mdtp_free_container(ptr);
-        }
-
-        offset += node_size;
+        offset += mdtp_move_node((uint8_t *)buffer + offset, ptr, (size_t)mdtp_get_node_size(ptr));
 
         ptr = va_arg(args, void *);
     }
 
-    va_end(args);
     va_end(args_copy);
 
-    sdk_imodule_set_mdtp_data(module, mdtp);
+    return buffer;
+}
+
+
+// Allocate value node, write everything except the value itself and return where the value goes
+static void *mdtp_allocate_value(const char *value_name,
+                                 size_t      value_name_length,
+                                 const char *value_units,
+                                 size_t      value_units_length,
+                                 size_t      value_length,
+                                 char      **value) {
+    // From MDTP v1 specification:
+
+    // [node type]: 1 unsigned byte (1 because node is value)
+    // [node name length]: unsigned int32
+    // [name of node...]: array of char
+    // [units length]: unsigned int32
+    // [units...]: array of char
+    // [value length]: unsigned int32
+    // [value...]: array of char
+
+    if (value_name == NULL || value_units == NULL || value_name_length > UINT32_MAX ||
+        value_units_length > UINT32_MAX || value_length > UINT32_MAX) {
+        return NULL;
+    }
+
+    size_t buffer_size = 1 + sizeof(uint32_t) + value_name_length + sizeof(uint32_t) +
+                         value_units_length + sizeof(uint32_t) + value_length;
+    size_t offset = 0; // Current position
+
+    uint8_t *buffer = malloc(buffer_size); // Every byte is written here or by the caller
+
+    // Allocation error
+    if (buffer == NULL) {
+        return NULL;
+    }
+
+    // Write node type
+    write_ubyte_be(buffer, offset, 1);
+    ++offset;
+
+    // Write node name length
+    write_uint32_be(buffer, offset, (uint32_t)value_name_length);
+    offset += 4;
+
+    // Write node name
+    memcpy(buffer + offset, value_name, value_name_length);
+    offset += value_name_length;
+
+    // Write units length
+    write_uint32_be(buffer, offset, (uint32_t)value_units_length);
+    offset += 4;
+
+    // Write units
+    memcpy(buffer + offset, value_units, value_units_length);
+    offset += value_units_length;
+
+    // Write value length
+    write_uint32_be(buffer, offset, (uint32_t)value_length);
+    offset += 4;
 
-    return sdk_imodule_get_mdtp_data(module);
+    *value = (char *)buffer + offset;
+
+    return buffer;
 }
 
 
-// Get node size
-static uint32_t mdtp_get_nodes_size(const void *first, ...) {
-    va_list args;
-    va_start(args, first);
-    uint32_t size = mdtp_get_nodes_size_va(first, args);
-    va_end(args);
-    return size;
+// Allocate array node of `count` 8-byte elements of `values`
+static void *mdtp_make_array(const char *value_name,
+                             uint8_t     element_type,
+                             const void *values,
+                             size_t      count,
+                             const char *value_units) {
+    // [node type]: 1 unsigned byte (3 because node is array)
+    // [node name length]: unsigned int32
+    // [name of node...]: array of char
+    // [units length]: unsigned int32
+    // [units...]: array of char
+    // [element type]: 1 unsigned byte
+    // [count]: unsigned int32
+    // [elements...]: 8 bytes each, Big Endian
+
+    if (value_name == NULL || value_units == NULL || (values == NULL && count != 0) ||
+        count > UINT32_MAX / 8) {
+        return NULL;
+    }
+
+    size_t name_length = strlen(value_name);
+    size_t units_length = strlen(value_units);
+
+    if (name_length > UINT32_MAX || units_length > UINT32_MAX) {
+        return NULL;
+    }
+
+    size_t   offset = 0;
+    uint8_t *buffer = malloc(1 + 4 + name_length + 4 + units_length + 1 + 4 + count * 8);
+
+    if (buffer == NULL) {
+        return NULL;
+    }
+
+    write_ubyte_be(buffer, offset, MDTP_NODE_ARRAY);
+    ++offset;
+
+    write_uint32_be(buffer, offset, (uint32_t)name_length);
+    memcpy(buffer + offset + 4, value_name, name_length);
+    offset += 4 + name_length;
+
+    write_uint32_be(buffer, offset, (uint32_t)units_length);
+    memcpy(buffer + offset + 4, value_units, units_length);
+    offset += 4 + units_length;
+
+    write_ubyte_be(buffer, offset, element_type);
+    write_uint32_be(buffer, offset + 1, (uint32_t)count);
+    offset += 5;
+
+    // One byte-swapping pass over the whole array
+    write_uint64_be_array(buffer, offset, values, count);
+
+    return buffer;
 }
 
 
-// Get nodes size via va_list
-static uint32_t mdtp_get_nodes_size_va(const void *first, va_list args) {
-    if (first == NULL) {
-        return 0u;
+// Get size of one node by its header
+static uint64_t mdtp_get_node_size(const void *node) {
+    const uint8_t *b = (const uint8_t *)node;
+
+    // Read node type (first byte)
+    uint8_t type = b[0];
+
+    if (type == 1) {
+        /* VALUE NODE:
+         * [1 type] [4 name_len] [name] [4 units_len] [units] [4 value_len] [value]
+         */
+        uint64_t off = 1;
+
+        off += 4 + (uint64_t)read_uint32_be(b, (size_t)off);
+        off += 4 + (uint64_t)read_uint32_be(b, (size_t)off);
+        off += 4 + (uint64_t)read_uint32_be(b, (size_t)off);
+
+        return off;
+    }
+
+    if (type == 0) {
+        /* CONTAINER NODE:
+         * [1 type] [4 name_len] [name] [4 payload_size] [payload...]
+         */
+        uint64_t off = 1;
+
+        off += 4 + (uint64_t)read_uint32_be(b, (size_t)off);
+        off += 4 + (uint64_t)read_uint32_be(b, (size_t)off);
+
+        return off;
+    }
+
+    if (type == MDTP_NODE_ARRAY) {
+        /* ARRAY NODE:
+         * [1 type] [4 name_len] [name] [4 units_len] [units] [1 element type] [4 count] [elements]
+         */
+        uint64_t off = 1;
+
+        off += 4 + (uint64_t)read_uint32_be(b, (size_t)off);
+        off += 4 + (uint64_t)read_uint32_be(b, (size_t)off);
+        off += 5 + (uint64_t)read_uint32_be(b, (size_t)off + 1) * 8;
+
+        return off;
     }
 
+    if (type == MDTP_NODE_HISTOGRAM) {
+        /* HISTOGRAM NODE:
+         * [1 type] [4 name_len] [name] [4 units_len] [units] [4 bound count] [bounds] [counts]
+         * [8 sum]
+         */
+        uint64_t off = 1;
+
+        off += 4 + (uint64_t)read_uint32_be(b, (size_t)off);
+        off += 4 + (uint64_t)read_uint32_be(b, (size_t)off);
+        off += 4 + (uint64_t)read_uint32_be(b, (size_t)off) * 16 + 8 + 8;
+
+        return off;
+    }
+
+    // Unknown type: ignore (adds 0).
+    return 0;
+}
+
+
+// Get nodes size via va_list
+static uint64_t mdtp_get_nodes_size_va(const void *first, va_list args) {
     uint64_t total = 0; // accumulate in 64-bit to avoid intermediate overflow
 
     for (const void *p = first; p != NULL; p = va_arg(args, void *)) {
-        const uint8_t *b = (const uint8_t *)p;
+        total += mdtp_get_node_size(p);
+    }
 
-        // Read node type (first byte)
-        uint8_t type = b[0];
+    // Callers reject sums exceeding the 32-bit range
+    return total;
+}
 
-        if (type == 1) {
-            /* VALUE NODE:
-             * [1 type] [4 name_len] [name] [4 units_len] [units] [4 value_len] [value]
-             */
-            size_t off = 1;
 
-            uint32_t name_len = read_uint32_be((void *)b, off);
-            off += 4;
-            off += (size_t)name_len;
+// Get nodes size of array of nodes in one pass, storing the size of every node into `sizes`
+static uint64_t mdtp_get_nodes_size_v(void *const *nodes, size_t count, size_t *sizes) {
+    uint64_t total = 0;
 
-            uint32_t units_len = read_uint32_be((void *)b, off);
-            off += 4;
-            off += (size_t)units_len;
+    for (size_t i = 0; i < count; ++i) {
+        if (nodes[i] == NULL) {
+            return UINT64_MAX; // Reported as too large by callers
+        }
 
-            uint32_t value_len = read_uint32_be((void *)b, off);
-            off += 4;
-            off += (size_t)value_len;
+        uint64_t node_size = mdtp_get_node_size(nodes[i]);
+
+        // Sizes of nodes that do not fit are never used, the sum is rejected by callers
+        sizes[i] = (size_t)node_size;
+        total += node_size;
+    }
 
-            total += off;
+    return total;
+}
 
-        } else if (type == 0) {
-            /* CONTAINER NODE:
-             * [1 type] [4 name_len] [name] [4 payload_size] [payload...]
-             */
-            size_t off = 1;
 
-            uint32_t name_len = read_uint32_be((void *)b, off);
-            off += 4;
-            off += (size_t)name_len;
+// Move array of nodes with the sizes from `mdtp_get_nodes_size_v` to `destination`
+static void mdtp_move_nodes_v(uint8_t      *destination,
+                              void        **nodes,
+                              size_t        count,
+                              const size_t *sizes) {
+    for (size_t i = 0; i < count; ++i) {
+        destination += mdtp_move_node(destination, nodes[i], sizes[i]);
+    }
+}
 
-            uint32_t payload_size = read_uint32_be((void *)b, off);
-            off += 4;
-            off += (size_t)payload_size;
 
-            total += off;
+// Copy node of `node_size` bytes to `destination`, free the node and return its size
+static size_t mdtp_move_node(uint8_t *destination, void *node, size_t node_size) {
+    memcpy(destination, node, node_size);
 
-        } else {
-            // Unknown type: ignore (adds 0).
-        }
+    // If node type is value, array or histogram
+    if (read_ubyte_be(node, 0) == 1 || read_ubyte_be(node, 0) == MDTP_NODE_ARRAY ||
+        read_ubyte_be(node, 0) == MDTP_NODE_HISTOGRAM) {
+        sdk_mdtp_free_value(node);
+    }
+    // If node type is container
+    else if (read_ubyte_be(node, 0) == 0) {
+        sdk_mdtp_free_container(node);
     }
 
-    // Clamp to UINT32_MAX if sum exceeded 32-bit range
-    return (total > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)total;
+    return node_size;
 }
@@ -0,0 +1,1610 @@
+/**
+ * @file modules/mdtp_builder.c
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#include "../../include/modules/internals/mdtp_builder.h"
+#include "../../include/modules/internals/abi.h"
+#include "../../include/modules/internals/imodule.h"
+#include "../../include/modules/internals/mdtp.h"
+#include "../../include/modules/internals/mdtp_chunk.h"
+#include "../../include/modules/internals/mdtp_format.h"
+#include "../../include/modules/internals/mdtp_reader.h"
+#include "../../include/modules/internals/memutils.h"
+#include "../../include/modules/internals/utils.h"
+#include "imodule_internal.h"
+#include "mdtp_internal.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MDTP_BUILDER_MIN_CAPACITY 256 ///< First allocation of an empty builder
+#define MDTP_BUILDER_V2_SIZE_FIELD 2  ///< Bytes reserved for the payload size of a v2 container
+#define MDTP_BUILDER_V2_CHUNKED_SIZE_FIELD 5 ///< Same in chunks, where the payload is not moved
+#define MDTP_BUILDER_V2_ROWS_FIELD 5         ///< Bytes reserved for the row count of a v2 table
+
+typedef struct MdtpBuilder {
+    uint8_t  *data;                 ///< Frame buffer (header + payload) or the current chunk
+    size_t    size;                 ///< Count of bytes written (including header)
+    size_t    capacity;             ///< Offset of the end of `data` in the frame
+    size_t    open[MDTP_MAX_DEPTH]; ///< Offsets of payload size fields of open containers
+    uint32_t  depth;                ///< Count of open containers
+    uint8_t   version;              ///< MDTP version of the frames
+    SDKStatus status;               ///< First error occurred while building the frame
+    uint32_t  capabilities;         ///< `ABI_CAPABILITY_*` the server needs to read the frame
+
+    size_t         chunk_size;     ///< Frame bytes of a chunk, `0` - the frame is one buffer
+    size_t         chunk_start;    ///< Offset of the current chunk in the frame
+    MdtpChunkPart *parts;          ///< Chunks of the frame
+    size_t         parts_count;    ///< Count of chunks used by the frame
+    size_t         parts_capacity; ///< Count of elements allocated for `parts`
+
+    uint8_t  table;        ///< `1` while a table is open
+    uint8_t  layout;       ///< Layout of the open table
+    uint32_t columns;      ///< Count of columns of the open table
+    uint32_t column;       ///< Column of the next cell
+    uint32_t rows;         ///< Count of complete rows of the open table
+    size_t   rows_offset;  ///< Offset of the row count field of the open table
+    size_t   cells_offset; ///< Offset of the first cell of the open table
+
+    uint8_t *scratch;          ///< Cells of a column-major table while they are reordered
+    size_t   scratch_capacity; ///< Count of bytes allocated for `scratch`
+    size_t  *cursors;          ///< Offsets in `scratch` of the next cell of every row
+    size_t   cursors_capacity; ///< Count of elements allocated for `cursors`
+} MdtpBuilder;
+
+
+// Forward declaration begin
+static uint8_t  *mdtp_builder_claim(MdtpBuilder *builder, size_t count);
+static int       mdtp_builder_next_chunk(MdtpBuilder *builder, size_t count);
+static uint8_t  *mdtp_builder_at(const MdtpBuilder *builder, size_t offset);
+static void      mdtp_builder_free_chunks(MdtpBuilder *builder);
+static int       mdtp_builder_split_chunks(MdtpBuilder *builder);
+static const ABI_MODULE_MDTP_DATA *mdtp_builder_finish_chunks(MdtpBuilder *builder,
+                                                              IModule     *module);
+static char     *mdtp_builder_claim_value(MdtpBuilder *builder,
+                                          const char  *value_name,
+                                          size_t       value_name_length,
+                                          const char  *value_units,
+                                          size_t       value_units_length,
+                                          uint8_t      value_type,
+                                          size_t       value_length);
+static SDKStatus mdtp_builder_add_array(MdtpBuilder *builder,
+                                        const char  *value_name,
+                                        uint8_t      element_type,
+                                        const void  *values,
+                                        size_t       count,
+                                        const char  *value_units);
+static char     *mdtp_builder_claim_cell(MdtpBuilder *builder,
+                                         uint8_t      value_type,
+                                         size_t       value_length);
+static int       mdtp_builder_transpose(MdtpBuilder *builder);
+static size_t    mdtp_builder_cell_size(const MdtpBuilder *builder, const uint8_t *cell);
+static SDKStatus mdtp_builder_close(MdtpBuilder *builder);
+static SDKStatus mdtp_builder_end_container_v2(MdtpBuilder *builder, size_t size_offset);
+static void      mdtp_builder_put_padded_varint(uint8_t *field, size_t size, uint64_t value);
+static SDKStatus mdtp_builder_fail(MdtpBuilder *builder, SDKStatus status);
+static size_t    mdtp_builder_length_size(const MdtpBuilder *builder, size_t length);
+static void      mdtp_builder_put_length(const MdtpBuilder *builder,
+                                         uint8_t          **cursor,
+                                         size_t             length);
+static void      mdtp_builder_put_string(const MdtpBuilder *builder,
+                                         uint8_t          **cursor,
+                                         const char        *string,
+                                         size_t             length);
+// Forward declaration end
+
+
+// Create builder
+MdtpBuilder *sdk_mdtp_builder_create(void) {
+    MdtpBuilder *builder = malloc(sizeof(MdtpBuilder));
+
+    if (builder == NULL) {
+        return NULL;
+    }
+
+    memset(builder, 0x0, sizeof(MdtpBuilder));
+    builder->version = MDTP_VERSION;
+    sdk_mdtp_builder_reset(builder);
+
+    return builder;
+}
+
+
+// Destroy builder
+void sdk_mdtp_builder_destroy(MdtpBuilder *builder) {
+    if (builder == NULL) {
+        return;
+    }
+
+    if (builder->chunk_size == 0) {
+        free(builder->data);
+    }
+
+    mdtp_builder_free_chunks(builder);
+    free(builder->scratch);
+    free(builder->cursors);
+    free(builder);
+}
+
+
+// Reset builder
+void sdk_mdtp_builder_reset(MdtpBuilder *builder) {
+    builder->size = MDTP_HEADER_SIZE; // Header is written in `sdk_mdtp_builder_finish`
+    builder->depth = 0;
+    builder->status = SDK_OK;
+    builder->capabilities = builder->version == MDTP_VERSION_2 ? ABI_CAPABILITY_MDTP_V2 : 0;
+    builder->table = 0;
+
+    // The first chunk is taken on the first write and starts with the header
+    if (builder->chunk_size != 0) {
+        builder->data = NULL;
+        builder->capacity = 0;
+        builder->chunk_start = 0;
+        builder->parts_count = 0;
+    }
+}
+
+
+// Set MDTP version of the frames
+SDKStatus sdk_mdtp_builder_set_version(MdtpBuilder *builder, uint8_t version) {
+    if (version != MDTP_VERSION && version != MDTP_VERSION_2) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    builder->version = version;
+    sdk_mdtp_builder_reset(builder);
+
+    return SDK_OK;
+}
+
+
+// Set size of the chunks the frames are built in
+SDKStatus sdk_mdtp_builder_set_chunk_size(MdtpBuilder *builder, size_t chunk_size) {
+    if (chunk_size != 0 && chunk_size < MDTP_CHUNK_MIN_SIZE) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    // The buffers of one mode are of no use to the other
+    if (builder->chunk_size == 0) {
+        free(builder->data);
+    }
+
+    if (chunk_size == 0) {
+        mdtp_builder_free_chunks(builder);
+    }
+
+    builder->data = NULL;
+    builder->capacity = 0;
+    builder->chunk_size = chunk_size;
+    sdk_mdtp_builder_reset(builder);
+
+    return SDK_OK;
+}
+
+
+// Begin container
+SDKStatus sdk_mdtp_builder_begin_container(MdtpBuilder *builder, const char *name) {
+    if (name == NULL) {
+        return sdk_mdtp_builder_begin_container_n(builder, NULL, 0);
+    }
+
+    return sdk_mdtp_builder_begin_container_n(builder, name, strlen(name));
+}
+
+
+// Begin container with explicit name length
+SDKStatus sdk_mdtp_builder_begin_container_n(MdtpBuilder *builder,
+                                             const char  *name,
+                                             size_t       name_length) {
+    // From MDTP v1 specification:
+
+    // [node type]: 1 unsigned byte (0 because node is container)
+    // [node name length]: unsigned int32
+    // [name of node...]: array of char
+    // [payload size]: unsigned int32
+    // [payload...]: nested nodes
+
+    // In MDTP v2 lengths and the payload size are varints
+
+    if (builder->status != SDK_OK) {
+        return builder->status;
+    }
+
+    if (name == NULL || name_length > UINT32_MAX || builder->depth == MDTP_MAX_DEPTH ||
+        builder->table) {
+        builder->status = SDK_INVALID_ARGUMENT;
+        return builder->status;
+    }
+
+    // The payload size is unknown yet. In MDTP v2 a guess of its varint size is reserved and
+    // corrected in `sdk_mdtp_builder_end_container`. In chunks the payload cannot be moved, so the
+    // largest size is reserved instead
+    size_t size_field = 4;
+
+    if (builder->version == MDTP_VERSION_2) {
+        size_field = builder->chunk_size != 0 ? MDTP_BUILDER_V2_CHUNKED_SIZE_FIELD
+                                              : MDTP_BUILDER_V2_SIZE_FIELD;
+    }
+
+    uint8_t *cursor = mdtp_builder_claim(
+        builder, 1 + mdtp_builder_length_size(builder, name_length) + name_length + size_field);
+
+    if (cursor == NULL) {
+        return builder->status;
+    }
+
+    *cursor++ = MDTP_NODE_CONTAINER;
+    mdtp_builder_put_string(builder, &cursor, name, name_length);
+
+    // Remember where to write the payload size
+    builder->open[builder->depth++] = builder->size - size_field;
+
+    return SDK_OK;
+}
+
+
+// Add value
+SDKStatus sdk_mdtp_builder_add_value(MdtpBuilder *builder,
+                                     const char  *value_name,
+                                     const char  *value,
+                                     const char  *value_units) {
+    if (value_name == NULL || value == NULL || value_units == NULL) {
+        return sdk_mdtp_builder_add_value_n(builder, NULL, 0, NULL, 0, NULL, 0);
+    }
+
+    return sdk_mdtp_builder_add_value_n(builder,
+                                        value_name,
+                                        strlen(value_name),
+                                        value,
+                                        strlen(value),
+                                        value_units,
+                                        strlen(value_units));
+}
+
+
+// Add value with explicit lengths
+SDKStatus sdk_mdtp_builder_add_value_n(MdtpBuilder *builder,
+                                       const char  *value_name,
+                                       size_t       value_name_length,
+                                       const char  *value,
+                                       size_t       value_length,
+                                       const char  *value_units,
+                                       size_t       value_units_length) {
+    if (builder->status != SDK_OK) {
+        return builder->status;
+    }
+
+    if (value == NULL || value_length > UINT32_MAX) {
+        return mdtp_builder_fail(builder, SDK_INVALID_ARGUMENT);
+    }
+
+    char *value_area = mdtp_builder_claim_value(builder,
+                                                value_name,
+                                                value_name_length,
+                                                value_units,
+                                                value_units_length,
+                                                MDTP_VALUE_TEXT,
+                                                value_length);
+
+    if (value_area == NULL) {
+        return builder->status;
+    }
+
+    memcpy(value_area, value, value_length);
+
+    return SDK_OK;
+}
+
+
+// Add value holding unsigned integer
+SDKStatus sdk_mdtp_builder_add_value_u64(MdtpBuilder *builder,
+                                         const char  *value_name,
+                                         uint64_t     value,
+                                         const char  *value_units) {
+    if (value_name == NULL || value_units == NULL) {
+        return mdtp_builder_fail(builder, SDK_INVALID_ARGUMENT);
+    }
+
+    int   typed = builder->version == MDTP_VERSION_2;
+    char *value_area = mdtp_builder_claim_value(
+        builder,
+        value_name,
+        strlen(value_name),
+        value_units,
+        strlen(value_units),
+        typed ? MDTP_VALUE_U64 : MDTP_VALUE_TEXT,
+        typed ? varint_size(value) : sdk_mdtp_format_u64_length(value));
+
+    if (value_area == NULL) {
+        return builder->status;
+    }
+
+    if (typed) {
+        write_varint(value_area, 0, value);
+        return SDK_OK;
+    }
+
+    // Format directly into the frame
+    sdk_mdtp_format_u64(value_area, value);
+
+    return SDK_OK;
+}
+
+
+// Add value holding signed integer
+SDKStatus sdk_mdtp_builder_add_value_i64(MdtpBuilder *builder,
+                                         const char  *value_name,
+                                         int64_t      value,
+                                         const char  *value_units) {
+    if (value_name == NULL || value_units == NULL) {
+        return mdtp_builder_fail(builder, SDK_INVALID_ARGUMENT);
+    }
+
+    if (builder->version == MDTP_VERSION_2) {
+        // Zigzag: 0, -1, 1, -2, ... become 0, 1, 2, 3, ..., so small magnitudes stay short
+        uint64_t zigzag = value < 0 ? ~((uint64_t)value << 1) : (uint64_t)value << 1;
+        char    *value_area = mdtp_builder_claim_value(builder,
+                                                    value_name,
+                                                    strlen(value_name),
+                                                    value_units,
+                                                    strlen(value_units),
+                                                    MDTP_VALUE_I64,
+                                                    varint_size(zigzag));
+
+        if (value_area == NULL) {
+            return builder->status;
+        }
+
+        write_varint(value_area, 0, zigzag);
+        return SDK_OK;
+    }
+
+    size_t value_length = value < 0 ? 1 + sdk_mdtp_format_u64_length(0 - (uint64_t)value)
+                                    : sdk_mdtp_format_u64_length((uint64_t)value);
+    char  *value_area = mdtp_builder_claim_value(builder,
+                                                value_name,
+                                                strlen(value_name),
+                                                value_units,
+                                                strlen(value_units),
+                                                MDTP_VALUE_TEXT,
+                                                value_length);
+
+    if (value_area == NULL) {
+        return builder->status;
+    }
+
+    // Format directly into the frame
+    sdk_mdtp_format_i64(value_area, value);
+
+    return SDK_OK;
+}
+
+
+// Add value holding floating point number
+SDKStatus sdk_mdtp_builder_add_value_f64(MdtpBuilder *builder,
+                                         const char  *value_name,
+                                         double       value,
+                                         int          precision,
+                                         const char  *value_units) {
+    if (value_name == NULL || value_units == NULL) {
+        return mdtp_builder_fail(builder, SDK_INVALID_ARGUMENT);
+    }
+
+    if (builder->version == MDTP_VERSION_2) {
+        char *value_area = mdtp_builder_claim_value(builder,
+                                                    value_name,
+                                                    strlen(value_name),
+                                                    value_units,
+                                                    strlen(value_units),
+                                                    MDTP_VALUE_F64,
+                                                    sizeof(uint64_t));
+
+        if (value_area == NULL) {
+            return builder->status;
+        }
+
+        uint64_t bits;
+
+        memcpy(&bits, &value, sizeof(uint64_t));
+        write_uint64_be(value_area, 0, bits);
+
+        return SDK_OK;
+    }
+
+    // Length of the text is not known in advance, so it is formatted on the stack
+    char   text[MDTP_F64_MAX_LENGTH];
+    size_t text_length = sdk_mdtp_format_f64(text, value, precision);
+
+    return sdk_mdtp_builder_add_value_n(builder,
+                                        value_name,
+                                        strlen(value_name),
+                                        text,
+                                        text_length,
+                                        value_units,
+                                        strlen(value_units));
+}
+
+
+// Add value holding boolean
+SDKStatus sdk_mdtp_builder_add_value_bool(MdtpBuilder *builder,
+                                          const char  *value_name,
+                                          int          value,
+                                          const char  *value_units) {
+    if (value_name == NULL || value_units == NULL) {
+        return mdtp_builder_fail(builder, SDK_INVALID_ARGUMENT);
+    }
+
+    if (builder->version != MDTP_VERSION_2) {
+        return sdk_mdtp_builder_add_value(
+            builder, value_name, value ? "true" : "false", value_units);
+    }
+
+    char *value_area = mdtp_builder_claim_value(builder,
+                                                value_name,
+                                                strlen(value_name),
+                                                value_units,
+                                                strlen(value_units),
+                                                MDTP_VALUE_BOOL,
+                                                1);
+
+    if (value_area == NULL) {
+        return builder->status;
+    }
+
+    *value_area = value ? 1 : 0;
+
+    return SDK_OK;
+}
+
+
+// Add value holding raw bytes
+SDKStatus sdk_mdtp_builder_add_value_bytes(MdtpBuilder *builder,
+                                           const char  *value_name,
+                                           const void  *value,
+                                           size_t       value_length,
+                                           const char  *value_units) {
+    if (value_name == NULL || value_units == NULL || (value == NULL && value_length != 0)) {
+        return mdtp_builder_fail(builder, SDK_INVALID_ARGUMENT);
+    }
+
+    char *value_area = mdtp_builder_claim_value(
+        builder,
+        value_name,
+        strlen(value_name),
+        value_units,
+        strlen(value_units),
+        builder->version == MDTP_VERSION_2 ? MDTP_VALUE_BYTES : MDTP_VALUE_TEXT,
+        value_length);
+
+    if (value_area == NULL) {
+        return builder->status;
+    }
+
+    if (value_length != 0) {
+        memcpy(value_area, value, value_length);
+    }
+
+    return SDK_OK;
+}
+
+
+// Add array of unsigned integers
+SDKStatus sdk_mdtp_builder_add_array_u64(MdtpBuilder    *builder,
+                                         const char     *value_name,
+                                         const uint64_t *values,
+                                         size_t          count,
+                                         const char     *value_units) {
+    return mdtp_builder_add_array(builder, value_name, MDTP_VALUE_U64, values, count, value_units);
+}
+
+
+// Add array of floating point numbers
+SDKStatus sdk_mdtp_builder_add_array_f64(MdtpBuilder  *builder,
+                                         const char   *value_name,
+                                         const double *values,
+                                         size_t        count,
+                                         const char   *value_units) {
+    return mdtp_builder_add_array(builder, value_name, MDTP_VALUE_F64, values, count, value_units);
+}
+
+
+// Add histogram
+SDKStatus sdk_mdtp_builder_add_histogram(MdtpBuilder    *builder,
+                                         const char     *value_name,
+                                         const double   *bounds,
+                                         size_t          bound_count,
+                                         const uint64_t *counts,
+                                         double          sum,
+                                         const char     *value_units) {
+    // [node type]: 1 unsigned byte (4 because node is histogram)
+    // [node name length], [name of node...], [units length], [units...]: as in a value
+    // [bound count]: unsigned int32
+    // [bounds...]: 8 bytes each
+    // [counts...]: 8 bytes each, one more than bounds
+    // [sum]: 8 bytes
+
+    // In MDTP v2 lengths, the bound count and the counts are varints
+
+    if (builder->status != SDK_OK) {
+        return builder->status;
+    }
+
+    if (value_name == NULL || value_units == NULL || counts == NULL ||
+        (bounds == NULL && bound_count != 0) || bound_count > MDTP_HISTOGRAM_MAX_BOUNDS ||
+        builder->table) {
+        return mdtp_builder_fail(builder, SDK_INVALID_ARGUMENT);
+    }
+
+    for (size_t i = 1; i < bound_count; ++i) {
+        if (!(bounds[i - 1] < bounds[i])) {
+            return mdtp_builder_fail(builder, SDK_INVALID_ARGUMENT);
+        }
+    }
+
+    size_t name_length = strlen(value_name);
+    size_t units_length = strlen(value_units);
+    size_t counts_size = (bound_count + 1) * 8;
+
+    if (builder->version == MDTP_VERSION_2) {
+        counts_size = 0;
+
+        for (size_t i = 0; i <= bound_count; ++i) {
+            counts_size += varint_size(counts[i]);
+        }
+    }
+
+    size_t size = 1 + mdtp_builder_length_size(builder, name_length) + name_length +
+                  mdtp_builder_length_size(builder, units_length) + units_length +
+                  mdtp_builder_length_size(builder, bound_count) + bound_count * 8 + counts_size +
+                  8;
+
+    uint8_t *cursor = mdtp_builder_claim(builder, size);
+
+    if (cursor == NULL) {
+        return builder->status;
+    }
+
+    *cursor++ = MDTP_NODE_HISTOGRAM;
+    mdtp_builder_put_string(builder, &cursor, value_name, name_length);
+    mdtp_builder_put_string(builder, &cursor, value_units, units_length);
+    mdtp_builder_put_length(builder, &cursor, bound_count);
+
+    write_uint64_be_array(cursor, 0, bounds, bound_count);
+    cursor += bound_count * 8;
+
+    if (builder->version == MDTP_VERSION_2) {
+        for (size_t i = 0; i <= bound_count; ++i) {
+            cursor += write_varint(cursor, 0, counts[i]);
+        }
+    } else {
+        write_uint64_be_array(cursor, 0, counts, bound_count + 1);
+        cursor += counts_size;
+    }
+
+    write_uint64_be_array(cursor, 0, &sum, 1);
+
+    builder->capabilities |= ABI_CAPABILITY_HISTOGRAMS;
+
+    return SDK_OK;
+}
+
+
+// End container
+SDKStatus sdk_mdtp_builder_end_container(MdtpBuilder *builder) {
+    if (builder->status != SDK_OK) {
+        return builder->status;
+    }
+
+    if (builder->depth == 0 || builder->table) {
+        builder->status = SDK_INVALID_ARGUMENT;
+        return builder->status;
+    }
+
+    return mdtp_builder_close(builder);
+}
+
+
+// Begin table
+SDKStatus sdk_mdtp_builder_begin_table(MdtpBuilder       *builder,
+                                       const char        *name,
+                                       const char *const *columns,
+                                       const char *const *units,
+                                       uint32_t           count,
+                                       uint8_t            layout) {
+    // [node type]: 1 unsigned byte (2 because node is table)
+    // [node name length], [name of node...], [payload size]: as in a container
+    // [layout]: 1 unsigned byte
+    // [row count]: unsigned int32, back-patched in `sdk_mdtp_builder_end_table`
+    // [column count]: unsigned int32
+    // [columns...]: [name length] [name] [units length] [units] of every column
+    // [cells...]: [value length] [value] of every cell
+
+    // In MDTP v2 lengths and counts are varints, the row count is padded to 5 bytes, and cells are
+    // [value type] [value] as in value nodes
+
+    if (builder->status != SDK_OK) {
+        return builder->status;
+    }
+
+    if (name == NULL || columns == NULL || count == 0 || layout > MDTP_TABLE_COLUMNS ||
+        builder->depth == MDTP_MAX_DEPTH || builder->table) {
+        return mdtp_builder_fail(builder, SDK_INVALID_ARGUMENT);
+    }
+
+    size_t name_length = strlen(name);
+    size_t size_field = 4;
+    size_t rows_field = 4;
+
+    if (builder->version == MDTP_VERSION_2) {
+        size_field = builder->chunk_size != 0 ? MDTP_BUILDER_V2_CHUNKED_SIZE_FIELD
+                                              : MDTP_BUILDER_V2_SIZE_FIELD;
+        rows_field = MDTP_BUILDER_V2_ROWS_FIELD;
+    }
+
+    size_t head = 1 + mdtp_builder_length_size(builder, name_length) + name_length;
+    size_t size = head + size_field + 1 + rows_field + mdtp_builder_length_size(builder, count);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        if (columns[i] == NULL || (units != NULL && units[i] == NULL)) {
+            return mdtp_builder_fail(builder, SDK_INVALID_ARGUMENT);
+        }
+
+        size_t column_length = strlen(columns[i]);
+        size_t units_length = units != NULL ? strlen(units[i]) : 0;
+
+        size += mdtp_builder_length_size(builder, column_length) + column_length +
+                mdtp_builder_length_size(builder, units_length) + units_length;
+    }
+
+    size_t   start = builder->size;
+    uint8_t *cursor = mdtp_builder_claim(builder, size);
+
+    if (cursor == NULL) {
+        return builder->status;
+    }
+
+    *cursor++ = MDTP_NODE_TABLE;
+    mdtp_builder_put_string(builder, &cursor, name, name_length);
+    cursor += size_field;
+
+    // Cells cannot be reordered across chunks
+    layout = builder->chunk_size != 0 ? MDTP_TABLE_ROWS : layout;
+    *cursor++ = layout;
+    cursor += rows_field;
+    mdtp_builder_put_length(builder, &cursor, count);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        const char *column_units = units != NULL ? units[i] : "";
+
+        mdtp_builder_put_string(builder, &cursor, columns[i], strlen(columns[i]));
+        mdtp_builder_put_string(builder, &cursor, column_units, strlen(column_units));
+    }
+
+    builder->open[builder->depth++] = start + head;
+    builder->table = 1;
+    builder->capabilities |= ABI_CAPABILITY_TABLES;
+    builder->layout = layout;
+    builder->columns = count;
+    builder->column = 0;
+    builder->rows = 0;
+    builder->rows_offset = start + head + size_field + 1;
+    builder->cells_offset = builder->size;
+
+    return SDK_OK;
+}
+
+
+// Add row of text cells
+SDKStatus sdk_mdtp_builder_add_row(MdtpBuilder *builder, const char *const *values) {
+    if (builder->status != SDK_OK) {
+        return builder->status;
+    }
+
+    if (values == NULL || !builder->table || builder->column != 0) {
+        return mdtp_builder_fail(builder, SDK_INVALID_ARGUMENT);
+    }
+
+    for (uint32_t i = 0; i < builder->columns && builder->status == SDK_OK; ++i) {
+        sdk_mdtp_builder_add_cell(builder, values[i]);
+    }
+
+    return builder->status;
+}
+
+
+// Add row of unsigned integer cells
+SDKStatus sdk_mdtp_builder_add_row_u64(MdtpBuilder *builder, const uint64_t *values) {
+    if (builder->status != SDK_OK) {
+        return builder->status;
+    }
+
+    if (values == NULL || !builder->table || builder->column != 0) {
+        return mdtp_builder_fail(builder, SDK_INVALID_ARGUMENT);
+    }
+
+    if (builder->rows == UINT32_MAX) {
+        return mdtp_builder_fail(builder, SDK_OTHER_ERROR);
+    }
+
+    int    typed = builder->version == MDTP_VERSION_2;
+    size_t size = 0;
+
+    for (uint32_t i = 0; i < builder->columns; ++i) {
+        size += typed ? 1 + varint_size(values[i]) : 4 + sdk_mdtp_format_u64_length(values[i]);
+    }
+
+    // The whole row is claimed at once and formatted directly into the frame
+    uint8_t *cursor = mdtp_builder_claim(builder, size);
+
+    if (cursor == NULL) {
+        return builder->status;
+    }
+
+    for (uint32_t i = 0; i < builder->columns; ++i) {
+        if (typed) {
+            *cursor++ = MDTP_VALUE_U64;
+            cursor += write_varint(cursor, 0, values[i]);
+            continue;
+        }
+
+        size_t length = sdk_mdtp_format_u64((char *)cursor + 4, values[i]);
+
+        write_uint32_be(cursor, 0, (uint32_t)length);
+        cursor += 4 + length;
+    }
+
+    ++builder->rows;
+
+    return SDK_OK;
+}
+
+
+// Add text cell
+SDKStatus sdk_mdtp_builder_add_cell(MdtpBuilder *builder, const char *value) {
+    if (value == NULL) {
+        return mdtp_builder_fail(builder, SDK_INVALID_ARGUMENT);
+    }
+
+    return sdk_mdtp_builder_add_cell_n(builder, value, strlen(value));
+}
+
+
+// Add text cell with explicit length
+SDKStatus sdk_mdtp_builder_add_cell_n(MdtpBuilder *builder,
+                                      const char  *value,
+                                      size_t       value_length) {
+    if (value == NULL) {
+        return mdtp_builder_fail(builder, SDK_INVALID_ARGUMENT);
+    }
+
+    char *value_area = mdtp_builder_claim_cell(builder, MDTP_VALUE_TEXT, value_length);
+
+    if (value_area == NULL) {
+        return builder->status;
+    }
+
+    memcpy(value_area, value, value_length);
+
+    return SDK_OK;
+}
+
+
+// Add cell holding unsigned integer
+SDKStatus sdk_mdtp_builder_add_cell_u64(MdtpBuilder *builder, uint64_t value) {
+    int   typed = builder->version == MDTP_VERSION_2;
+    char *value_area =
+        mdtp_builder_claim_cell(builder,
+                                typed ? MDTP_VALUE_U64 : MDTP_VALUE_TEXT,
+                                typed ? varint_size(value) : sdk_mdtp_format_u64_length(value));
+
+    if (value_area == NULL) {
+        return builder->status;
+    }
+
+    if (typed) {
+        write_varint(value_area, 0, value);
+        return SDK_OK;
+    }
+
+    sdk_mdtp_format_u64(value_area, value);
+
+    return SDK_OK;
+}
+
+
+// Add cell holding signed integer
+SDKStatus sdk_mdtp_builder_add_cell_i64(MdtpBuilder *builder, int64_t value) {
+    if (builder->version == MDTP_VERSION_2) {
+        uint64_t zigzag = value < 0 ? ~((uint64_t)value << 1) : (uint64_t)value << 1;
+        char    *value_area = mdtp_builder_claim_cell(builder, MDTP_VALUE_I64, varint_size(zigzag));
+
+        if (value_area == NULL) {
+            return builder->status;
+        }
+
+        write_varint(value_area, 0, zigzag);
+        return SDK_OK;
+    }
+
+    size_t value_length = value < 0 ? 1 + sdk_mdtp_format_u64_length(0 - (uint64_t)value)
+                                    : sdk_mdtp_format_u64_length((uint64_t)value);
+    char  *value_area = mdtp_builder_claim_cell(builder, MDTP_VALUE_TEXT, value_length);
+
+    if (value_area == NULL) {
+        return builder->status;
+    }
+
+    sdk_mdtp_format_i64(value_area, value);
+
+    return SDK_OK;
+}
+
+
+// Add cell holding floating point number
+SDKStatus sdk_mdtp_builder_add_cell_f64(MdtpBuilder *builder, double value, int precision) {
+    if (builder->version == MDTP_VERSION_2) {
+        char *value_area = mdtp_builder_claim_cell(builder, MDTP_VALUE_F64, sizeof(uint64_t));
+
+        if (value_area == NULL) {
+            return builder->status;
+        }
+
+        uint64_t bits;
+
+        memcpy(&bits, &value, sizeof(uint64_t));
+        write_uint64_be(value_area, 0, bits);
+
+        return SDK_OK;
+    }
+
+    char   text[MDTP_F64_MAX_LENGTH];
+    size_t text_length = sdk_mdtp_format_f64(text, value, precision);
+
+    return sdk_mdtp_builder_add_cell_n(builder, text, text_length);
+}
+
+
+// End table
+SDKStatus sdk_mdtp_builder_end_table(MdtpBuilder *builder) {
+    if (builder->status != SDK_OK) {
+        return builder->status;
+    }
+
+    if (!builder->table || builder->column != 0) {
+        return mdtp_builder_fail(builder, SDK_INVALID_ARGUMENT);
+    }
+
+    if (builder->layout == MDTP_TABLE_COLUMNS && builder->rows > 1 && builder->columns > 1 &&
+        !mdtp_builder_transpose(builder)) {
+        return builder->status;
+    }
+
+    // Back-patch row count
+    uint8_t *field = mdtp_builder_at(builder, builder->rows_offset);
+
+    if (builder->version == MDTP_VERSION_2) {
+        mdtp_builder_put_padded_varint(field, MDTP_BUILDER_V2_ROWS_FIELD, builder->rows);
+    } else {
+        write_uint32_be(field, 0, builder->rows);
+    }
+
+    builder->table = 0;
+
+    return mdtp_builder_close(builder);
+}
+
+
+// Finish frame
+const ABI_MODULE_MDTP_DATA *sdk_mdtp_builder_finish(MdtpBuilder *builder, IModule *module) {
+    if (builder->status != SDK_OK || builder->depth != 0 || builder->size > UINT32_MAX ||
+        (builder->capabilities != 0 &&
+         (imodule_server_abi_version(module) & builder->capabilities) != builder->capabilities) ||
+        mdtp_builder_claim(builder, 0) == NULL) {
+        sdk_mdtp_builder_reset(builder);
+        return NULL;
+    }
+
+    // Write header
+    write_ubyte_be(mdtp_builder_at(builder, 0), 0, builder->version);
+    write_uint32_be(mdtp_builder_at(builder, 0), 1, (uint32_t)(builder->size - MDTP_HEADER_SIZE));
+
+    if (builder->chunk_size != 0) {
+        return mdtp_builder_finish_chunks(builder, module);
+    }
+
+    uint32_t size = (uint32_t)builder->size;
+
+    sdk_mdtp_builder_reset(builder);
+
+    // The module takes the buffer without copying and gives its previous frame buffer back, so
+    // the builder and the module keep swapping the same two buffers from poll to poll
+    return imodule_exchange_frame(module, &builder->data, &builder->capacity, size);
+}
+
+
+// Start recording the nodes written next
+void mdtp_builder_mark(MdtpBuilder *builder, MdtpBuilderMark *mark) {
+    mark->size = builder->size;
+    mark->depth = builder->depth;
+    mark->capabilities = builder->capabilities;
+
+    // Capabilities are collected anew, so the ones the recorded nodes need are known
+    builder->capabilities = 0;
+}
+
+
+// Stop recording and get the span of the recorded nodes
+SDKStatus mdtp_builder_unmark(MdtpBuilder           *builder,
+                              const MdtpBuilderMark *mark,
+                              size_t                *size,
+                              uint32_t              *capabilities) {
+    *capabilities = builder->capabilities;
+    builder->capabilities |= mark->capabilities;
+
+    // The nodes must be complete to be copied elsewhere
+    if (builder->status == SDK_OK && (builder->depth != mark->depth || builder->table)) {
+        builder->status = SDK_INVALID_ARGUMENT;
+    }
+
+    *size = builder->size - mark->size;
+
+    return builder->status;
+}
+
+
+// Copy bytes of the frame
+void mdtp_builder_read(const MdtpBuilder *builder,
+                       size_t             offset,
+                       uint8_t           *destination,
+                       size_t             size) {
+    if (builder->chunk_size == 0) {
+        memcpy(destination, builder->data + offset, size);
+        return;
+    }
+
+    // The bytes may span several chunks, the current one ends at `size` of the builder
+    for (size_t i = 0, start = 0; i < builder->parts_count && size != 0; ++i) {
+        size_t end = i + 1 == builder->parts_count ? builder->size : start + builder->parts[i].size;
+
+        if (offset < end) {
+            size_t count = end - offset < size ? end - offset : size;
+
+            memcpy(destination,
+                   builder->parts[i].data + MDTP_CHUNK_HEADER_SIZE + (offset - start),
+                   count);
+            destination += count;
+            offset += count;
+            size -= count;
+        }
+
+        start = end;
+    }
+}
+
+
+// Append complete nodes written earlier
+SDKStatus mdtp_builder_splice(MdtpBuilder   *builder,
+                              const uint8_t *bytes,
+                              size_t         size,
+                              uint32_t       capabilities) {
+    if (builder->status != SDK_OK) {
+        return builder->status;
+    }
+
+    if (builder->table) {
+        return mdtp_builder_fail(builder, SDK_INVALID_ARGUMENT);
+    }
+
+    if (size == 0) {
+        return SDK_OK;
+    }
+
+    // In chunks the bytes stay together, like the bytes of one node
+    uint8_t *cursor = mdtp_builder_claim(builder, size);
+
+    if (cursor == NULL) {
+        return builder->status;
+    }
+
+    memcpy(cursor, bytes, size);
+    builder->capabilities |= capabilities;
+
+    return SDK_OK;
+}
+
+
+// Get MDTP version of the frames
+uint8_t mdtp_builder_version(const MdtpBuilder *builder) {
+    return builder->version;
+}
+
+
+// Reserve `count` bytes at the end of the frame and return pointer to them
+static uint8_t *mdtp_builder_claim(MdtpBuilder *builder, size_t count) {
+    if (builder->capacity - builder->size < count || builder->data == NULL) {
+        if (builder->chunk_size != 0) {
+            return mdtp_builder_next_chunk(builder, count)
+                       ? mdtp_builder_claim(builder, count)
+                       : NULL;
+        }
+
+        SDKStatus status = mdtp_buffer_reserve(
+            &builder->data, &builder->capacity, builder->size + count, MDTP_BUILDER_MIN_CAPACITY);
+
+        if (status != SDK_OK) {
+            builder->status = status;
+            return NULL;
+        }
+    }
+
+    uint8_t *cursor = builder->data + (builder->size - builder->chunk_start);
+    builder->size += count;
+
+    return cursor;
+}
+
+
+// Close the current chunk and take the next one with room for `count` bytes
+static int mdtp_builder_next_chunk(MdtpBuilder *builder, size_t count) {
+    // The first chunk starts with the header, which is claimed by `sdk_mdtp_builder_reset`
+    size_t start = builder->parts_count == 0 ? 0 : builder->size;
+    size_t capacity = builder->size - start + count;
+
+    // Bytes of a node are never split while it is written, so a node larger than a chunk gets a
+    // chunk of its own, split by `mdtp_builder_split_chunks` when the frame is finished
+    if (capacity < builder->chunk_size) {
+        capacity = builder->chunk_size;
+    }
+
+    if (builder->parts_count == builder->parts_capacity) {
+        size_t parts_capacity = builder->parts_capacity == 0 ? 8 : builder->parts_capacity * 2;
+        MdtpChunkPart *parts = realloc(builder->parts, parts_capacity * sizeof(MdtpChunkPart));
+
+        if (parts == NULL) {
+            builder->status = SDK_ALLOCATION_ERROR;
+            return 0;
+        }
+
+        memset(parts + builder->parts_capacity,
+               0x0,
+               (parts_capacity - builder->parts_capacity) * sizeof(MdtpChunkPart));
+        builder->parts = parts;
+        builder->parts_capacity = parts_capacity;
+    }
+
+    MdtpChunkPart *part = &builder->parts[builder->parts_count];
+
+    if (part->capacity < capacity) {
+        uint8_t *data = realloc(part->data, MDTP_CHUNK_HEADER_SIZE + capacity);
+
+        if (data == NULL) {
+            builder->status = SDK_ALLOCATION_ERROR;
+            return 0;
+        }
+
+        part->data = data;
+        part->capacity = capacity;
+    }
+
+    if (builder->parts_count != 0) {
+        builder->parts[builder->parts_count - 1].size = builder->size - builder->chunk_start;
+    }
+
+    ++builder->parts_count;
+    part->size = 0;
+    builder->data = part->data + MDTP_CHUNK_HEADER_SIZE;
+    builder->chunk_start = start;
+    builder->capacity = start + capacity; // Reused chunks may be larger, but parts stay bounded
+
+    return 1;
+}
+
+
+// Get pointer to the byte at `offset` of the frame
+static uint8_t *mdtp_builder_at(const MdtpBuilder *builder, size_t offset) {
+    if (builder->chunk_size == 0) {
+        return builder->data + offset;
+    }
+
+    // Fields are patched soon after they are written, so the chunk is searched from the last one
+    size_t part = builder->parts_count - 1;
+    size_t start = builder->chunk_start;
+
+    while (offset < start) {
+        start -= builder->parts[--part].size;
+    }
+
+    return builder->parts[part].data + MDTP_CHUNK_HEADER_SIZE + (offset - start);
+}
+
+
+// Free chunks of the builder
+static void mdtp_builder_free_chunks(MdtpBuilder *builder) {
+    for (size_t i = 0; i < builder->parts_capacity; ++i) {
+        free(builder->parts[i].data);
+    }
+
+    free(builder->parts);
+    builder->parts = NULL;
+    builder->parts_count = 0;
+    builder->parts_capacity = 0;
+}
+
+
+// Split chunks holding more than `chunk_size` bytes, so every part sent stays bounded
+static int mdtp_builder_split_chunks(MdtpBuilder *builder) {
+    size_t chunk_size = builder->chunk_size;
+    size_t count = 0;
+
+    for (size_t i = 0; i < builder->parts_count; ++i) {
+        size_t size = builder->parts[i].size;
+
+        count += size <= chunk_size ? 1 : (size + chunk_size - 1) / chunk_size;
+    }
+
+    if (count == builder->parts_count) {
+        return 1;
+    }
+
+    if (builder->parts_capacity < count) {
+        MdtpChunkPart *parts = realloc(builder->parts, count * sizeof(MdtpChunkPart));
+
+        if (parts == NULL) {
+            return 0;
+        }
+
+        memset(parts + builder->parts_capacity,
+               0x0,
+               (count - builder->parts_capacity) * sizeof(MdtpChunkPart));
+        builder->parts = parts;
+        builder->parts_capacity = count;
+    }
+
+    // Parts are moved from the last one, so every slot after the part being split holds a spare
+    // chunk. Parts are swapped with the spares, so no buffer is lost if an allocation fails.
+    for (size_t from = builder->parts_count, to = count; from-- > 0;) {
+        size_t size = builder->parts[from].size;
+        size_t pieces = size <= chunk_size ? 1 : (size + chunk_size - 1) / chunk_size;
+
+        to -= pieces;
+
+        MdtpChunkPart part = builder->parts[from];
+
+        builder->parts[from] = builder->parts[to];
+        builder->parts[to] = part;
+
+        for (size_t piece = 1; piece < pieces; ++piece) {
+            MdtpChunkPart *spare = &builder->parts[to + piece];
+            size_t         offset = piece * chunk_size;
+            size_t         piece_size = size - offset < chunk_size ? size - offset : chunk_size;
+
+            if (spare->capacity < chunk_size) {
+                uint8_t *data = realloc(spare->data, MDTP_CHUNK_HEADER_SIZE + chunk_size);
+
+                if (data == NULL) {
+                    return 0;
+                }
+
+                spare->data = data;
+                spare->capacity = chunk_size;
+            }
+
+            memcpy(spare->data + MDTP_CHUNK_HEADER_SIZE,
+                   part.data + MDTP_CHUNK_HEADER_SIZE + offset,
+                   piece_size);
+            spare->size = piece_size;
+        }
+
+        builder->parts[to].size = size < chunk_size ? size : chunk_size;
+    }
+
+    builder->parts_count = count;
+
+    return 1;
+}
+
+
+// Hand the frame built in chunks over to the module
+static const ABI_MODULE_MDTP_DATA *mdtp_builder_finish_chunks(MdtpBuilder *builder,
+                                                              IModule     *module) {
+    uint32_t size = (uint32_t)builder->size;
+
+    builder->parts[builder->parts_count - 1].size = builder->size - builder->chunk_start;
+
+    // The module takes the chunks without copying and gives the chunks of its previous chunked
+    // frame back
+    if (builder->parts_count > 1 && mdtp_chunk_enabled(module)) {
+        if (!mdtp_builder_split_chunks(builder)) {
+            sdk_mdtp_builder_reset(builder);
+            return NULL;
+        }
+
+        const ABI_MODULE_MDTP_DATA *data = mdtp_chunk_exchange(
+            module, &builder->parts, &builder->parts_count, &builder->parts_capacity);
+
+        sdk_mdtp_builder_reset(builder);
+
+        return data;
+    }
+
+    // A frame of one chunk, or a module without chunked frames, gets the frame in one piece
+    uint8_t *frame = sdk_imodule_reserve_mdtp_data(module, size);
+
+    if (frame == NULL) {
+        sdk_mdtp_builder_reset(builder);
+        return NULL;
+    }
+
+    for (size_t i = 0, offset = 0; i < builder->parts_count; ++i) {
+        memcpy(frame + offset, builder->parts[i].data + MDTP_CHUNK_HEADER_SIZE,
+               builder->parts[i].size);
+        offset += builder->parts[i].size;
+    }
+
+    sdk_mdtp_builder_reset(builder);
+
+    return sdk_imodule_commit_mdtp_data(module, size);
+}
+
+
+// Append value node without the value itself and return where the value goes
+static char *mdtp_builder_claim_value(MdtpBuilder *builder,
+                                      const char  *value_name,
+                                      size_t       value_name_length,
+                                      const char  *value_units,
+                                      size_t       value_units_length,
+                                      uint8_t      value_type,
+                                      size_t       value_length) {
+    // From MDTP v1 specification:
+
+    // [node type]: 1 unsigned byte (1 because node is value)
+    // [node name length]: unsigned int32
+    // [name of node...]: array of char
+    // [units length]: unsigned int32
+    // [units...]: array of char
+    // [value length]: unsigned int32
+    // [value...]: array of char
+
+    // In MDTP v2 lengths are varints, and [value type] (1 unsigned byte) goes before the value.
+    // Only text and bytes values have a length, the other types have a fixed layout
+
+    if (builder->status != SDK_OK) {
+        return NULL;
+    }
+
+    if (value_name == NULL || value_units == NULL || value_name_length > UINT32_MAX ||
+        value_units_length > UINT32_MAX || value_length > UINT32_MAX || builder->table) {
+        builder->status = SDK_INVALID_ARGUMENT;
+        return NULL;
+    }
+
+    int    typed = builder->version == MDTP_VERSION_2;
+    int    sized = !typed || value_type == MDTP_VALUE_TEXT || value_type == MDTP_VALUE_BYTES;
+    size_t size = 1 + mdtp_builder_length_size(builder, value_name_length) + value_name_length +
+                  mdtp_builder_length_size(builder, value_units_length) + value_units_length +
+                  (typed ? 1 : 0) + (sized ? mdtp_builder_length_size(builder, value_length) : 0) +
+                  value_length;
+
+    uint8_t *cursor = mdtp_builder_claim(builder, size);
+
+    if (cursor == NULL) {
+        return NULL;
+    }
+
+    *cursor++ = MDTP_NODE_VALUE;
+    mdtp_builder_put_string(builder, &cursor, value_name, value_name_length);
+    mdtp_builder_put_string(builder, &cursor, value_units, value_units_length);
+
+    if (typed) {
+        *cursor++ = value_type;
+    }
+
+    if (sized) {
+        mdtp_builder_put_length(builder, &cursor, value_length);
+    }
+
+    return (char *)cursor;
+}
+
+
+// Append array node with `count` 8-byte elements of `values`
+static SDKStatus mdtp_builder_add_array(MdtpBuilder *builder,
+                                        const char  *value_name,
+                                        uint8_t      element_type,
+                                        const void  *values,
+                                        size_t       count,
+                                        const char  *value_units) {
+    // [node type]: 1 unsigned byte (3 because node is array)
+    // [node name length], [name of node...], [units length], [units...]: as in a value
+    // [element type]: 1 unsigned byte
+    // [count]: unsigned int32
+    // [elements...]: 8 bytes each
+
+    // In MDTP v2 lengths and the count are varints
+
+    if (builder->status != SDK_OK) {
+        return builder->status;
+    }
+
+    if (value_name == NULL || value_units == NULL || (values == NULL && count != 0) ||
+        count > UINT32_MAX / 8 || builder->table) {
+        return mdtp_builder_fail(builder, SDK_INVALID_ARGUMENT);
+    }
+
+    size_t name_length = strlen(value_name);
+    size_t units_length = strlen(value_units);
+    size_t size = 1 + mdtp_builder_length_size(builder, name_length) + name_length +
+                  mdtp_builder_length_size(builder, units_length) + units_length + 1 +
+                  mdtp_builder_length_size(builder, count) + count * 8;
+
+    uint8_t *cursor = mdtp_builder_claim(builder, size);
+
+    if (cursor == NULL) {
+        return builder->status;
+    }
+
+    *cursor++ = MDTP_NODE_ARRAY;
+    mdtp_builder_put_string(builder, &cursor, value_name, name_length);
+    mdtp_builder_put_string(builder, &cursor, value_units, units_length);
+    *cursor++ = element_type;
+    mdtp_builder_put_length(builder, &cursor, count);
+
+    // One byte-swapping pass over the whole array
+    write_uint64_be_array(cursor, 0, values, count);
+
+    builder->capabilities |= ABI_CAPABILITY_ARRAYS;
+
+    return SDK_OK;
+}
+
+
+// Append table cell without the value itself and return where the value goes
+static char *mdtp_builder_claim_cell(MdtpBuilder *builder,
+                                     uint8_t      value_type,
+                                     size_t       value_length) {
+    // MDTP v1: [value length] [value]
+    // MDTP v2: [value type] [value], only text and bytes values have a length
+
+    if (builder->status != SDK_OK) {
+        return NULL;
+    }
+
+    if (!builder->table || value_length > UINT32_MAX) {
+        builder->status = SDK_INVALID_ARGUMENT;
+        return NULL;
+    }
+
+    if (builder->rows == UINT32_MAX) {
+        builder->status = SDK_OTHER_ERROR;
+        return NULL;
+    }
+
+    int    typed = builder->version == MDTP_VERSION_2;
+    int    sized = !typed || value_type == MDTP_VALUE_TEXT || value_type == MDTP_VALUE_BYTES;
+    size_t size = (typed ? 1 : 0) + (sized ? mdtp_builder_length_size(builder, value_length) : 0) +
+                  value_length;
+
+    uint8_t *cursor = mdtp_builder_claim(builder, size);
+
+    if (cursor == NULL) {
+        return NULL;
+    }
+
+    if (typed) {
+        *cursor++ = value_type;
+    }
+
+    if (sized) {
+        mdtp_builder_put_length(builder, &cursor, value_length);
+    }
+
+    if (++builder->column == builder->columns) {
+        builder->column = 0;
+        ++builder->rows;
+    }
+
+    return (char *)cursor;
+}
+
+
+// Reorder the cells of the open table column after column, `0` if memory could not be allocated
+static int mdtp_builder_transpose(MdtpBuilder *builder) {
+    size_t   bytes = builder->size - builder->cells_offset;
+    uint8_t *cells = builder->data + builder->cells_offset;
+
+    if (builder->scratch_capacity < bytes) {
+        uint8_t *scratch = realloc(builder->scratch, bytes);
+
+        if (scratch == NULL) {
+            builder->status = SDK_ALLOCATION_ERROR;
+            return 0;
+        }
+
+        builder->scratch = scratch;
+        builder->scratch_capacity = bytes;
+    }
+
+    if (builder->cursors_capacity < builder->rows) {
+        size_t *cursors = realloc(builder->cursors, builder->rows * sizeof(size_t));
+
+        if (cursors == NULL) {
+            builder->status = SDK_ALLOCATION_ERROR;
+            return 0;
+        }
+
+        builder->cursors = cursors;
+        builder->cursors_capacity = builder->rows;
+    }
+
+    memcpy(builder->scratch, cells, bytes);
+
+    // Find where every row starts
+    for (size_t row = 0, offset = 0; row < builder->rows; ++row) {
+        builder->cursors[row] = offset;
+
+        for (uint32_t column = 0; column < builder->columns; ++column) {
+            offset += mdtp_builder_cell_size(builder, builder->scratch + offset);
+        }
+    }
+
+    // Take one cell of every row for every column
+    for (uint32_t column = 0; column < builder->columns; ++column) {
+        for (size_t row = 0; row < builder->rows; ++row) {
+            const uint8_t *cell = builder->scratch + builder->cursors[row];
+            size_t         size = mdtp_builder_cell_size(builder, cell);
+
+            memcpy(cells, cell, size);
+            cells += size;
+            builder->cursors[row] += size;
+        }
+    }
+
+    return 1;
+}
+
+
+// Get count of bytes of a cell written by the builder
+static size_t mdtp_builder_cell_size(const MdtpBuilder *builder, const uint8_t *cell) {
+    uint64_t value = 0;
+
+    if (builder->version != MDTP_VERSION_2) {
+        return 4 + read_uint32_be(cell, 0);
+    }
+
+    switch (cell[0]) {
+    case MDTP_VALUE_U64:
+    case MDTP_VALUE_I64:
+        return 1 + read_varint(cell, 1, SIZE_MAX, &value);
+
+    case MDTP_VALUE_F64:
+        return 1 + sizeof(uint64_t);
+
+    case MDTP_VALUE_BOOL:
+        return 2;
+
+    default: {
+        size_t size = read_varint(cell, 1, SIZE_MAX, &value);
+        return 1 + size + (size_t)value;
+    }
+    }
+}
+
+
+// Close the innermost open container or table and write its payload size
+static SDKStatus mdtp_builder_close(MdtpBuilder *builder) {
+    size_t size_offset = builder->open[--builder->depth];
+
+    if (builder->version == MDTP_VERSION_2) {
+        return mdtp_builder_end_container_v2(builder, size_offset);
+    }
+
+    size_t payload_size = builder->size - size_offset - 4;
+
+    if (payload_size > UINT32_MAX) {
+        builder->status = SDK_OTHER_ERROR;
+        return builder->status;
+    }
+
+    // Back-patch payload size
+    write_uint32_be(mdtp_builder_at(builder, size_offset), 0, (uint32_t)payload_size);
+
+    return SDK_OK;
+}
+
+
+// Write the varint payload size of the MDTP v2 container, moving the payload if the size does
+// not fit the reserved bytes
+static SDKStatus mdtp_builder_end_container_v2(MdtpBuilder *builder, size_t size_offset) {
+    size_t field_size =
+        builder->chunk_size != 0 ? MDTP_BUILDER_V2_CHUNKED_SIZE_FIELD : MDTP_BUILDER_V2_SIZE_FIELD;
+    size_t payload_offset = size_offset + field_size;
+    size_t payload_size = builder->size - payload_offset;
+
+    if (payload_size > UINT32_MAX) {
+        builder->status = SDK_OTHER_ERROR;
+        return builder->status;
+    }
+
+    // In chunks the varint is padded to the reserved size
+    if (builder->chunk_size != 0) {
+        mdtp_builder_put_padded_varint(mdtp_builder_at(builder, size_offset),
+                                       MDTP_BUILDER_V2_CHUNKED_SIZE_FIELD,
+                                       payload_size);
+        return SDK_OK;
+    }
+
+    size_t field = varint_size(payload_size);
+
+    if (field > MDTP_BUILDER_V2_SIZE_FIELD &&
+        mdtp_builder_claim(builder, field - MDTP_BUILDER_V2_SIZE_FIELD) == NULL) {
+        return builder->status;
+    }
+
+    if (field != MDTP_BUILDER_V2_SIZE_FIELD) {
+        memmove(builder->data + size_offset + field,
+                builder->data + payload_offset,
+                payload_size);
+        builder->size = size_offset + field + payload_size;
+    }
+
+    write_varint(builder->data, size_offset, payload_size);
+
+    return SDK_OK;
+}
+
+
+// Write varint of exactly `size` bytes, padded with continuation bytes
+static void mdtp_builder_put_padded_varint(uint8_t *field, size_t size, uint64_t value) {
+    for (size_t i = 0; i < size; ++i) {
+        field[i] = (uint8_t)((value >> (7 * i)) & 0x7F);
+
+        if (i + 1 < size) {
+            field[i] |= 0x80;
+        }
+    }
+}
+
+
+// Remember the first error and return it
+static SDKStatus mdtp_builder_fail(MdtpBuilder *builder, SDKStatus status) {
+    if (builder->status == SDK_OK) {
+        builder->status = status;
+    }
+
+    return builder->status;
+}
+
+
+// Get count of bytes of a length field
+static size_t mdtp_builder_length_size(const MdtpBuilder *builder, size_t length) {
+    return builder->version == MDTP_VERSION_2 ? varint_size(length) : 4;
+}
+
+
+// Write length field and move cursor
+static void mdtp_builder_put_length(const MdtpBuilder *builder,
+                                    uint8_t          **cursor,
+                                    size_t             length) {
+    if (builder->version == MDTP_VERSION_2) {
+        *cursor += write_varint(*cursor, 0, length);
+        return;
+    }
+
+    write_uint32_be(*cursor, 0, (uint32_t)length);
+    *cursor += 4;
+}
+
+
+// Write length-prefixed string and move cursor
+static void mdtp_builder_put_string(const MdtpBuilder *builder,
+                                    uint8_t          **cursor,
+                                    const char        *string,
+                                    size_t             length) {
+    mdtp_builder_put_length(builder, cursor, length);
+    memcpy(*cursor, string, length);
+    *cursor += length;
+}
@@ -0,0 +1,211 @@
+/**
+ * @file modules/mdtp_cadence.c
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#include "../../include/modules/internals/mdtp_cadence.h"
+#include "../../include/modules/internals/mdtp_builder.h"
+#include "imodule_internal.h"
+#include "mdtp_internal.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+/**
+ * @brief Subtree collector with the copy of the nodes it wrote last
+ */
+typedef struct MdtpSubtree {
+    void (*collect)(MdtpBuilder *builder); ///< Collector of the module
+    uint32_t interval_ms;                  ///< Milliseconds the nodes are reused for
+    uint64_t collected_ms;                 ///< Time of the last call on the monotonic clock
+    uint8_t *data;                         ///< Bytes of the nodes written by the last call
+    size_t   size;                         ///< Count of bytes of the nodes
+    size_t   capacity;                     ///< Count of bytes allocated for `data`
+    uint32_t capabilities;                 ///< `ABI_CAPABILITY_*` needed by the nodes
+    uint8_t  version;                      ///< MDTP version of the nodes, `0` if none are kept
+} MdtpSubtree;
+
+typedef struct MdtpCadence {
+    MdtpSubtree *subtrees; ///< Collectors in the order of registration
+    size_t       count;    ///< Count of collectors
+    size_t       capacity; ///< Count of elements allocated for `subtrees`
+} MdtpCadence;
+
+
+// Forward declaration begin
+static MdtpSubtree *mdtp_cadence_find(const IModule *module, void (*collect)(MdtpBuilder *));
+static SDKStatus    mdtp_cadence_collect(MdtpSubtree *subtree,
+                                         MdtpBuilder *builder,
+                                         uint8_t      version);
+static uint64_t     mdtp_cadence_now_ms(void);
+// Forward declaration end
+
+
+// Register subtree collector
+SDKStatus sdk_mdtp_cadence_register(IModule *module,
+                                    void (*collect)(MdtpBuilder *builder),
+                                    uint32_t interval_ms) {
+    if (collect == NULL || mdtp_cadence_find(module, collect) != NULL) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    if (module->cadence == NULL) {
+        module->cadence = calloc(1, sizeof(MdtpCadence));
+
+        if (module->cadence == NULL) {
+            return SDK_ALLOCATION_ERROR;
+        }
+    }
+
+    MdtpCadence *cadence = module->cadence;
+
+    if (cadence->count == cadence->capacity) {
+        size_t       capacity = cadence->capacity == 0 ? 4 : cadence->capacity * 2;
+        MdtpSubtree *subtrees = realloc(cadence->subtrees, capacity * sizeof(MdtpSubtree));
+
+        if (subtrees == NULL) {
+            return SDK_ALLOCATION_ERROR;
+        }
+
+        cadence->subtrees = subtrees;
+        cadence->capacity = capacity;
+    }
+
+    cadence->subtrees[cadence->count++] =
+        (MdtpSubtree){.collect = collect, .interval_ms = interval_ms};
+
+    return SDK_OK;
+}
+
+
+// Collect subtree on the next add
+SDKStatus sdk_mdtp_cadence_refresh(IModule *module, void (*collect)(MdtpBuilder *builder)) {
+    MdtpSubtree *subtree = mdtp_cadence_find(module, collect);
+
+    if (subtree == NULL) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    subtree->version = 0;
+
+    return SDK_OK;
+}
+
+
+// Write every subtree into the frame being built
+SDKStatus sdk_mdtp_cadence_add(IModule *module, MdtpBuilder *builder) {
+    if (module->cadence == NULL) {
+        return SDK_OK;
+    }
+
+    uint8_t  version = mdtp_builder_version(builder);
+    uint64_t now_ms = mdtp_cadence_now_ms();
+
+    for (size_t i = 0; i < module->cadence->count; ++i) {
+        MdtpSubtree *subtree = &module->cadence->subtrees[i];
+        SDKStatus    status;
+
+        // Nodes of another MDTP version cannot be reused
+        if (subtree->version == version && now_ms - subtree->collected_ms < subtree->interval_ms) {
+            status = mdtp_builder_splice(
+                builder, subtree->data, subtree->size, subtree->capabilities);
+        } else {
+            status = mdtp_cadence_collect(subtree, builder, version);
+            subtree->collected_ms = now_ms;
+        }
+
+        if (status != SDK_OK) {
+            return status;
+        }
+    }
+
+    return SDK_OK;
+}
+
+
+// Get count of collectors
+size_t sdk_mdtp_cadence_size(const IModule *module) {
+    return module->cadence == NULL ? 0 : module->cadence->count;
+}
+
+
+// Destroy collectors
+void mdtp_cadence_destroy(MdtpCadence *cadence) {
+    if (cadence == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < cadence->count; ++i) {
+        free(cadence->subtrees[i].data);
+    }
+
+    free(cadence->subtrees);
+    free(cadence);
+}
+
+
+// Find registered collector
+static MdtpSubtree *mdtp_cadence_find(const IModule *module, void (*collect)(MdtpBuilder *)) {
+    if (module->cadence == NULL) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < module->cadence->count; ++i) {
+        if (module->cadence->subtrees[i].collect == collect) {
+            return &module->cadence->subtrees[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+// Call collector and keep a copy of the nodes it wrote
+static SDKStatus mdtp_cadence_collect(MdtpSubtree *subtree,
+                                      MdtpBuilder *builder,
+                                      uint8_t      version) {
+    MdtpBuilderMark mark;
+    size_t          size;
+    uint32_t        capabilities;
+
+    // Until the copy is made, the next add calls the collector again
+    subtree->version = 0;
+
+    mdtp_builder_mark(builder, &mark);
+    subtree->collect(builder);
+
+    SDKStatus status = mdtp_builder_unmark(builder, &mark, &size, &capabilities);
+
+    // Nodes written on every call are never reused
+    if (status != SDK_OK || subtree->interval_ms == 0) {
+        return status;
+    }
+
+    // The nodes are in the frame anyway, only the copy is missing
+    if (subtree->capacity < size &&
+        mdtp_buffer_reserve(&subtree->data, &subtree->capacity, size, 0) != SDK_OK) {
+        return SDK_OK;
+    }
+
+    mdtp_builder_read(builder, mark.size, subtree->data, size);
+    subtree->size = size;
+    subtree->capabilities = capabilities;
+    subtree->version = version;
+
+    return SDK_OK;
+}
+
+
+// Get time on the monotonic clock
+static uint64_t mdtp_cadence_now_ms(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
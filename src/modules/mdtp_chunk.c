@@ -0,0 +1,355 @@
+/**
+ * @file modules/mdtp_chunk.c
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#include "../../include/modules/internals/mdtp_chunk.h"
+#include "../../include/modules/internals/abi.h"
+#include "../../include/modules/internals/imodule.h"
+#include "../../include/modules/internals/mdtp.h"
+#include "../../include/modules/internals/memutils.h"
+#include "../../include/modules/internals/utils.h"
+#include "imodule_internal.h"
+#include "mdtp_internal.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+struct MdtpChunks {
+    uint8_t               enabled;       ///< `1` if frames are split
+    uint32_t              chunk_size;    ///< Largest count of frame bytes of a part
+    MdtpChunkPart        *parts;         ///< Parts of the last chunked frame
+    size_t                count;         ///< Count of parts of the last chunked frame
+    size_t                capacity;      ///< Count of elements allocated for `parts`
+    ABI_MODULE_MDTP_DATA *sent;          ///< Parts as they are sent, one for each of `parts`
+    size_t                sent_capacity; ///< Count of elements allocated for `sent`
+    ABI_MODULE_MDTP_DATA  source;        ///< Frame the parts were split from, `NULL` if built
+};
+
+
+// Forward declaration begin
+static int  mdtp_chunk_reserve(MdtpChunks *chunks, size_t count);
+static void mdtp_chunk_describe(MdtpChunks *chunks);
+// Forward declaration end
+
+
+// Enable chunked frames
+SDKStatus sdk_mdtp_chunk_enable(IModule *module, uint32_t chunk_size) {
+    if (chunk_size < MDTP_CHUNK_MIN_SIZE) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    if (!sdk_utils_server_has_capability(module, ABI_CAPABILITY_CHUNKED_FRAMES)) {
+        return SDK_OTHER_ERROR;
+    }
+
+    if (module->chunks == NULL) {
+        module->chunks = calloc(1, sizeof(MdtpChunks));
+
+        if (module->chunks == NULL) {
+            return SDK_ALLOCATION_ERROR;
+        }
+    }
+
+    module->chunks->enabled = 1;
+    module->chunks->chunk_size = chunk_size;
+
+    return SDK_OK;
+}
+
+
+// Disable chunked frames
+void sdk_mdtp_chunk_disable(IModule *module) {
+    if (module->chunks == NULL) {
+        return;
+    }
+
+    // The server gets the whole frame again. A frame built in chunks has no whole frame, so it
+    // stays until the next one is stored
+    mdtp_chunk_restore(module);
+    module->chunks->enabled = 0;
+}
+
+
+// Make frame to send
+const ABI_MODULE_MDTP_DATA *sdk_mdtp_chunk_emit(IModule *module) {
+    MdtpChunks           *chunks = module->chunks;
+    ABI_MODULE_MDTP_DATA *data = &module->mdtp_data;
+
+    // Nothing to split, or already split
+    if (chunks == NULL || !chunks->enabled || data->data == NULL || data->size < MDTP_HEADER_SIZE ||
+        data->size <= chunks->chunk_size ||
+        (read_ubyte_be(data->data, 0) & MDTP_FLAG_CHUNK) != 0) {
+        return data;
+    }
+
+    size_t count = (data->size + (size_t)chunks->chunk_size - 1) / chunks->chunk_size;
+
+    if (!mdtp_chunk_reserve(chunks, count)) {
+        return data;
+    }
+
+    const uint8_t *frame = data->data;
+
+    for (size_t i = 0; i < count; ++i) {
+        MdtpChunkPart *part = &chunks->parts[i];
+        size_t         offset = i * chunks->chunk_size;
+        size_t         size = data->size - offset;
+
+        if (size > chunks->chunk_size) {
+            size = chunks->chunk_size;
+        }
+
+        if (part->capacity < chunks->chunk_size) {
+            uint8_t *buffer = realloc(part->data, MDTP_CHUNK_HEADER_SIZE + chunks->chunk_size);
+
+            if (buffer == NULL) {
+                return data;
+            }
+
+            part->data = buffer;
+            part->capacity = chunks->chunk_size;
+        }
+
+        memcpy(part->data + MDTP_CHUNK_HEADER_SIZE, frame + offset, size);
+        part->size = size;
+    }
+
+    chunks->count = count;
+    chunks->source = *data;
+    mdtp_chunk_describe(chunks);
+
+    *data = chunks->sent[0];
+
+    return data;
+}
+
+
+// Get part of the chunked frame to send
+const ABI_MODULE_MDTP_DATA *sdk_mdtp_chunk_get(const IModule *module, uint32_t sequence) {
+    const MdtpChunks *chunks = module->chunks;
+
+    if (chunks == NULL || chunks->count == 0 || sequence >= chunks->count ||
+        module->mdtp_data.data != chunks->sent[0].data) {
+        return NULL;
+    }
+
+    return &chunks->sent[sequence];
+}
+
+
+// Read header of a received part
+SDKStatus sdk_mdtp_chunk_parse(const void *part, size_t part_size, MdtpChunk *chunk) {
+    if (part == NULL || part_size == 0 || (read_ubyte_be(part, 0) & MDTP_FLAG_CHUNK) == 0) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    if (part_size < MDTP_CHUNK_HEADER_SIZE ||
+        read_uint32_be(part, 1) != part_size - MDTP_HEADER_SIZE) {
+        return SDK_ARGUMENT_PROCESSING_ERROR;
+    }
+
+    uint32_t sequence = read_uint32_be(part, 5);
+    uint32_t count = read_uint32_be(part, 9);
+
+    if (sequence >= count) {
+        return SDK_ARGUMENT_PROCESSING_ERROR;
+    }
+
+    *chunk = (MdtpChunk){.sequence = sequence,
+                         .count = count,
+                         .bytes = (const uint8_t *)part + MDTP_CHUNK_HEADER_SIZE,
+                         .size = part_size - MDTP_CHUNK_HEADER_SIZE};
+
+    return SDK_OK;
+}
+
+
+// Join received parts
+void *sdk_mdtp_chunk_join(const ABI_MODULE_MDTP_DATA *parts, size_t count, size_t *size) {
+    if (parts == NULL || count == 0 || parts[0].data == NULL || parts[0].size == 0) {
+        return NULL;
+    }
+
+    // A frame sent in one piece
+    if ((read_ubyte_be(parts[0].data, 0) & MDTP_FLAG_CHUNK) == 0) {
+        if (count != 1 || parts[0].size < MDTP_HEADER_SIZE ||
+            read_uint32_be(parts[0].data, 1) != parts[0].size - MDTP_HEADER_SIZE) {
+            return NULL;
+        }
+
+        uint8_t *frame = malloc(parts[0].size);
+
+        if (frame != NULL) {
+            memcpy(frame, parts[0].data, parts[0].size);
+            *size = parts[0].size;
+        }
+
+        return frame;
+    }
+
+    size_t    total = 0;
+    MdtpChunk chunk;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (sdk_mdtp_chunk_parse(parts[i].data, parts[i].size, &chunk) != SDK_OK ||
+            chunk.sequence != i || chunk.count != count) {
+            return NULL;
+        }
+
+        total += chunk.size;
+    }
+
+    if (total < MDTP_HEADER_SIZE) {
+        return NULL;
+    }
+
+    uint8_t *frame = malloc(total);
+    size_t   offset = 0;
+
+    if (frame == NULL) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        sdk_mdtp_chunk_parse(parts[i].data, parts[i].size, &chunk);
+        memcpy(frame + offset, chunk.bytes, chunk.size);
+        offset += chunk.size;
+    }
+
+    // The parts must carry the version of the frame they make up
+    if (read_uint32_be(frame, 1) != total - MDTP_HEADER_SIZE ||
+        (read_ubyte_be(parts[0].data, 0) & MDTP_VERSION_MASK) != (frame[0] & MDTP_VERSION_MASK)) {
+        free(frame);
+        return NULL;
+    }
+
+    *size = total;
+
+    return frame;
+}
+
+
+// Check if chunked frames are enabled
+int mdtp_chunk_enabled(const IModule *module) {
+    return module->chunks != NULL && module->chunks->enabled;
+}
+
+
+// Install parts of a frame built in chunks
+const ABI_MODULE_MDTP_DATA *mdtp_chunk_exchange(IModule        *module,
+                                                MdtpChunkPart **parts,
+                                                size_t         *count,
+                                                size_t         *capacity) {
+    MdtpChunks *chunks = module->chunks;
+
+    // Allocated before anything is exchanged, so a failure leaves both sides as they were
+    if (chunks->sent_capacity < *count) {
+        ABI_MODULE_MDTP_DATA *sent = realloc(chunks->sent, *count * sizeof(ABI_MODULE_MDTP_DATA));
+
+        if (sent == NULL) {
+            return NULL;
+        }
+
+        chunks->sent = sent;
+        chunks->sent_capacity = *count;
+    }
+
+    MdtpChunkPart *previous = chunks->parts;
+    size_t         previous_count = chunks->count;
+    size_t         previous_capacity = chunks->capacity;
+
+    chunks->parts = *parts;
+    chunks->count = *count;
+    chunks->capacity = *capacity;
+    chunks->source = (ABI_MODULE_MDTP_DATA){0};
+
+    *parts = previous;
+    *count = previous_count;
+    *capacity = previous_capacity;
+
+    mdtp_chunk_describe(chunks);
+    imodule_commit_chunks(module, chunks->parts, chunks->count);
+    module->mdtp_data = chunks->sent[0];
+
+    return &module->mdtp_data;
+}
+
+
+// Give the previous step back the frame it made
+void mdtp_chunk_restore(IModule *module) {
+    MdtpChunks *chunks = module->chunks;
+
+    if (chunks != NULL && chunks->source.data != NULL && chunks->count != 0 &&
+        module->mdtp_data.data == chunks->sent[0].data) {
+        module->mdtp_data = chunks->source;
+    }
+}
+
+
+// Destroy chunked frames state of a module
+void mdtp_chunk_destroy(MdtpChunks *chunks) {
+    if (chunks == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < chunks->capacity; ++i) {
+        free(chunks->parts[i].data);
+    }
+
+    free(chunks->parts);
+    free(chunks->sent);
+    free(chunks);
+}
+
+
+// Make room for `count` parts
+static int mdtp_chunk_reserve(MdtpChunks *chunks, size_t count) {
+    if (chunks->capacity < count) {
+        MdtpChunkPart *parts = realloc(chunks->parts, count * sizeof(MdtpChunkPart));
+
+        if (parts == NULL) {
+            return 0;
+        }
+
+        memset(parts + chunks->capacity, 0x0, (count - chunks->capacity) * sizeof(MdtpChunkPart));
+        chunks->parts = parts;
+        chunks->capacity = count;
+    }
+
+    if (chunks->sent_capacity < count) {
+        ABI_MODULE_MDTP_DATA *sent = realloc(chunks->sent, count * sizeof(ABI_MODULE_MDTP_DATA));
+
+        if (sent == NULL) {
+            return 0;
+        }
+
+        chunks->sent = sent;
+        chunks->sent_capacity = count;
+    }
+
+    return 1;
+}
+
+
+// Write part headers and fill `sent`
+static void mdtp_chunk_describe(MdtpChunks *chunks) {
+    uint8_t version = chunks->parts[0].data[MDTP_CHUNK_HEADER_SIZE] & MDTP_VERSION_MASK;
+
+    for (size_t i = 0; i < chunks->count; ++i) {
+        MdtpChunkPart *part = &chunks->parts[i];
+        size_t         size = MDTP_CHUNK_HEADER_SIZE + part->size;
+
+        // [1 version | flag] [4 payload size] [4 sequence] [4 count]
+        write_ubyte_be(part->data, 0, (uint8_t)(version | MDTP_FLAG_CHUNK));
+        write_uint32_be(part->data, 1, (uint32_t)(size - MDTP_HEADER_SIZE));
+        write_uint32_be(part->data, 5, (uint32_t)i);
+        write_uint32_be(part->data, 9, (uint32_t)chunks->count);
+
+        chunks->sent[i] = (ABI_MODULE_MDTP_DATA){.data = part->data, .size = (uint32_t)size};
+    }
+}
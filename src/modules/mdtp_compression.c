@@ -0,0 +1,457 @@
+/**
+ * @file modules/mdtp_compression.c
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#include "../../include/modules/internals/mdtp_compression.h"
+#include "../../include/modules/internals/abi.h"
+#include "../../include/modules/internals/imodule.h"
+#include "../../include/modules/internals/mdtp.h"
+#include "../../include/modules/internals/memutils.h"
+#include "../../include/modules/internals/utils.h"
+#include "imodule_internal.h"
+#include "mdtp_internal.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+// Limits of the LZ4 block format
+#define MDTP_COMPRESSION_MIN_MATCH 4      ///< Shortest match
+#define MDTP_COMPRESSION_LAST_LITERALS 5  ///< The last bytes of a block are always literals
+#define MDTP_COMPRESSION_MATCH_LIMIT 12   ///< The last match starts at least this far from the end
+#define MDTP_COMPRESSION_MAX_OFFSET 65535 ///< Farthest match
+#define MDTP_COMPRESSION_RUN_MASK 15      ///< Length in a token meaning that more bytes follow
+
+#define MDTP_COMPRESSION_HASH_BITS 14           ///< The hash table has `1 << 14` slots
+#define MDTP_COMPRESSION_HASH_PRIME 2654435761u ///< Multiplier of the hash of 4 bytes
+#define MDTP_COMPRESSION_SKIP_TRIGGER 6         ///< The step grows after `1 << 6` misses in a row
+
+struct MdtpCompression {
+    uint8_t              enabled;   ///< `1` if frames are compressed
+    uint32_t             threshold; ///< Smaller frames are sent as they are
+    uint32_t            *table;     ///< Positions of 4-byte sequences by hash, kept across frames
+    uint8_t             *frame;     ///< Last compressed frame
+    size_t               capacity;  ///< Count of bytes allocated for `frame`
+    ABI_MODULE_MDTP_DATA source;    ///< Frame `frame` was compressed from
+};
+
+
+// Forward declaration begin
+static size_t mdtp_compression_compress(uint32_t      *table,
+                                        const uint8_t *source,
+                                        size_t         size,
+                                        uint8_t       *block,
+                                        size_t         limit);
+static int    mdtp_compression_put_sequence(uint8_t       *block,
+                                            size_t        *offset,
+                                            size_t         limit,
+                                            const uint8_t *literals,
+                                            size_t         literals_count,
+                                            size_t         distance,
+                                            size_t         match_length);
+static void   mdtp_compression_put_length(uint8_t *block, size_t *offset, size_t length);
+static int    mdtp_compression_get_length(const uint8_t *block,
+                                          size_t        *offset,
+                                          size_t         end,
+                                          size_t        *length);
+static int    mdtp_compression_decompress_block(const uint8_t *block,
+                                                size_t         block_size,
+                                                uint8_t       *output,
+                                                size_t         size);
+// Forward declaration end
+
+
+// Enable compression
+SDKStatus sdk_mdtp_compression_enable(IModule *module, uint32_t threshold) {
+    if (!sdk_utils_server_has_capability(module, ABI_CAPABILITY_COMPRESSION)) {
+        return SDK_OTHER_ERROR;
+    }
+
+    MdtpCompression *compression = module->compression;
+
+    if (compression == NULL) {
+        compression = calloc(1, sizeof(MdtpCompression));
+
+        if (compression == NULL) {
+            return SDK_ALLOCATION_ERROR;
+        }
+
+        // Stale positions are harmless: every match is compared before it is used
+        compression->table = calloc((size_t)1 << MDTP_COMPRESSION_HASH_BITS, sizeof(uint32_t));
+
+        if (compression->table == NULL) {
+            mdtp_compression_destroy(compression);
+            return SDK_ALLOCATION_ERROR;
+        }
+
+        module->compression = compression;
+    }
+
+    compression->enabled = 1;
+    compression->threshold = threshold;
+
+    return SDK_OK;
+}
+
+
+// Disable compression
+void sdk_mdtp_compression_disable(IModule *module) {
+    if (module->compression == NULL) {
+        return;
+    }
+
+    // The server must not be left with a compressed frame as the last one
+    mdtp_chunk_restore(module);
+    mdtp_crc_restore(module);
+    mdtp_compression_restore(module);
+    module->compression->enabled = 0;
+}
+
+
+// Make frame to send
+const ABI_MODULE_MDTP_DATA *sdk_mdtp_compression_emit(IModule *module) {
+    MdtpCompression      *compression = module->compression;
+    ABI_MODULE_MDTP_DATA *data = &module->mdtp_data;
+
+    if (compression != NULL && compression->enabled) {
+        mdtp_chunk_restore(module);
+        mdtp_crc_restore(module);
+    }
+
+    // Nothing to compress, or already compressed
+    if (compression == NULL || !compression->enabled || data->data == NULL ||
+        data->size < MDTP_HEADER_SIZE || data->size < compression->threshold ||
+        data->data == compression->frame ||
+        (read_ubyte_be(data->data, 0) & (MDTP_FLAG_COMPRESSED | MDTP_FLAG_CHUNK)) != 0) {
+        return data;
+    }
+
+    // [header] [varint size] [block], only a smaller frame is worth sending
+    size_t payload_size = data->size - MDTP_HEADER_SIZE;
+    size_t prefix = varint_size(payload_size);
+
+    if (payload_size <= prefix + 1) {
+        return data;
+    }
+
+    size_t limit = payload_size - prefix - 1;
+
+    if (compression->capacity < MDTP_HEADER_SIZE + prefix + limit) {
+        uint8_t *frame = realloc(compression->frame, MDTP_HEADER_SIZE + prefix + limit);
+
+        if (frame == NULL) {
+            return data;
+        }
+
+        compression->frame = frame;
+        compression->capacity = MDTP_HEADER_SIZE + prefix + limit;
+    }
+
+    const uint8_t *source = data->data;
+    uint8_t       *block = compression->frame + MDTP_HEADER_SIZE + prefix;
+    size_t         block_size = mdtp_compression_compress(
+        compression->table, source + MDTP_HEADER_SIZE, payload_size, block, limit);
+
+    if (block_size == 0) {
+        return data; // Not compressible
+    }
+
+    size_t size = MDTP_HEADER_SIZE + prefix + block_size;
+
+    write_ubyte_be(compression->frame, 0, (uint8_t)(source[0] | MDTP_FLAG_COMPRESSED));
+    write_uint32_be(compression->frame, 1, (uint32_t)(size - MDTP_HEADER_SIZE));
+    write_varint(compression->frame, MDTP_HEADER_SIZE, payload_size);
+
+    compression->source = *data;
+    *data = (ABI_MODULE_MDTP_DATA){.data = compression->frame, .size = (uint32_t)size};
+
+    return data;
+}
+
+
+// Decompress received frame
+void *sdk_mdtp_compression_decompress(const void *frame, size_t frame_size, size_t *size) {
+    if (frame == NULL || frame_size < MDTP_HEADER_SIZE ||
+        read_uint32_be(frame, 1) != frame_size - MDTP_HEADER_SIZE) {
+        return NULL;
+    }
+
+    uint8_t  first = read_ubyte_be(frame, 0);
+    uint8_t *result;
+
+    if ((first & MDTP_FLAG_COMPRESSED) == 0) {
+        result = malloc(frame_size);
+
+        if (result == NULL) {
+            return NULL;
+        }
+
+        memcpy(result, frame, frame_size);
+        *size = frame_size;
+
+        return result;
+    }
+
+    uint64_t payload_size;
+    size_t   read = read_varint(frame, MDTP_HEADER_SIZE, frame_size, &payload_size);
+
+    if (read == 0 || payload_size > UINT32_MAX - MDTP_HEADER_SIZE) {
+        return NULL;
+    }
+
+    result = malloc(MDTP_HEADER_SIZE + (size_t)payload_size);
+
+    if (result == NULL) {
+        return NULL;
+    }
+
+    if (!mdtp_compression_decompress_block((const uint8_t *)frame + MDTP_HEADER_SIZE + read,
+                                           frame_size - MDTP_HEADER_SIZE - read,
+                                           result + MDTP_HEADER_SIZE,
+                                           (size_t)payload_size)) {
+        free(result);
+        return NULL;
+    }
+
+    write_ubyte_be(result, 0, (uint8_t)(first & ~MDTP_FLAG_COMPRESSED));
+    write_uint32_be(result, 1, (uint32_t)payload_size);
+    *size = MDTP_HEADER_SIZE + (size_t)payload_size;
+
+    return result;
+}
+
+
+// Give the previous step back the frame it made
+void mdtp_compression_restore(IModule *module) {
+    MdtpCompression *compression = module->compression;
+
+    if (compression != NULL && compression->frame != NULL &&
+        module->mdtp_data.data == compression->frame) {
+        module->mdtp_data = compression->source;
+    }
+}
+
+
+// Destroy compression state of a module
+void mdtp_compression_destroy(MdtpCompression *compression) {
+    if (compression == NULL) {
+        return;
+    }
+
+    free(compression->table);
+    free(compression->frame);
+    free(compression);
+}
+
+
+// Compress `size` bytes of `source` into an LZ4 block of at most `limit` bytes. Returns count of
+// bytes of the block or `0` if it does not fit.
+static size_t mdtp_compression_compress(uint32_t      *table,
+                                        const uint8_t *source,
+                                        size_t         size,
+                                        uint8_t       *block,
+                                        size_t         limit) {
+    size_t   offset = 0;
+    size_t   anchor = 0;   // Start of the literals not written yet
+    size_t   position = 0; // Position looked for a match
+    uint32_t misses = 0;
+
+    // Greedy parse: take the first match found through the hash table
+    while (size >= MDTP_COMPRESSION_MATCH_LIMIT &&
+           position <= size - MDTP_COMPRESSION_MATCH_LIMIT) {
+        uint32_t sequence;
+        uint32_t candidate_sequence;
+
+        memcpy(&sequence, source + position, sizeof(uint32_t));
+
+        uint32_t hash =
+            (sequence * MDTP_COMPRESSION_HASH_PRIME) >> (32 - MDTP_COMPRESSION_HASH_BITS);
+        size_t candidate = table[hash];
+
+        table[hash] = (uint32_t)position;
+
+        // Positions left from the previous frames are not trusted until compared
+        if (candidate < position) {
+            memcpy(&candidate_sequence, source + candidate, sizeof(uint32_t));
+        }
+
+        if (candidate >= position || position - candidate > MDTP_COMPRESSION_MAX_OFFSET ||
+            candidate_sequence != sequence) {
+            // Move faster through data without matches
+            position += 1 + (misses++ >> MDTP_COMPRESSION_SKIP_TRIGGER);
+            continue;
+        }
+
+        size_t length = MDTP_COMPRESSION_MIN_MATCH;
+
+        while (position + length < size - MDTP_COMPRESSION_LAST_LITERALS &&
+               source[candidate + length] == source[position + length]) {
+            ++length;
+        }
+
+        if (!mdtp_compression_put_sequence(block,
+                                           &offset,
+                                           limit,
+                                           source + anchor,
+                                           position - anchor,
+                                           position - candidate,
+                                           length)) {
+            return 0;
+        }
+
+        position += length;
+        anchor = position;
+        misses = 0;
+    }
+
+    // The last sequence holds only literals
+    if (!mdtp_compression_put_sequence(
+            block, &offset, limit, source + anchor, size - anchor, 0, 0)) {
+        return 0;
+    }
+
+    return offset;
+}
+
+
+// Write sequence of literals and a match (none if `match_length` is `0`), `0` if it does not fit
+static int mdtp_compression_put_sequence(uint8_t       *block,
+                                         size_t        *offset,
+                                         size_t         limit,
+                                         const uint8_t *literals,
+                                         size_t         literals_count,
+                                         size_t         distance,
+                                         size_t         match_length) {
+    // [token] [literals count] [literals] [2 distance, little endian] [match length]
+    size_t match = match_length == 0 ? 0 : match_length - MDTP_COMPRESSION_MIN_MATCH;
+    size_t need = 1 + literals_count / 255 + 1 + literals_count;
+
+    if (match_length != 0) {
+        need += 2 + match / 255 + 1;
+    }
+
+    if (need > limit - *offset) {
+        return 0;
+    }
+
+    size_t literals_token =
+        literals_count < MDTP_COMPRESSION_RUN_MASK ? literals_count : MDTP_COMPRESSION_RUN_MASK;
+    size_t match_token = match < MDTP_COMPRESSION_RUN_MASK ? match : MDTP_COMPRESSION_RUN_MASK;
+
+    block[(*offset)++] = (uint8_t)(literals_token << 4 | match_token);
+    mdtp_compression_put_length(block, offset, literals_count);
+    memcpy(block + *offset, literals, literals_count);
+    *offset += literals_count;
+
+    if (match_length == 0) {
+        return 1;
+    }
+
+    block[(*offset)++] = (uint8_t)(distance & 0xFF);
+    block[(*offset)++] = (uint8_t)(distance >> 8);
+    mdtp_compression_put_length(block, offset, match);
+
+    return 1;
+}
+
+
+// Write the bytes of a length that did not fit its token
+static void mdtp_compression_put_length(uint8_t *block, size_t *offset, size_t length) {
+    if (length < MDTP_COMPRESSION_RUN_MASK) {
+        return;
+    }
+
+    length -= MDTP_COMPRESSION_RUN_MASK;
+
+    for (; length >= 255; length -= 255) {
+        block[(*offset)++] = 255;
+    }
+
+    block[(*offset)++] = (uint8_t)length;
+}
+
+
+// Read the bytes of a length that did not fit its token, `0` if they cross the end
+static int mdtp_compression_get_length(const uint8_t *block,
+                                       size_t        *offset,
+                                       size_t         end,
+                                       size_t        *length) {
+    uint8_t byte;
+
+    do {
+        if (*offset == end || *length > UINT32_MAX) {
+            return 0;
+        }
+
+        byte = block[(*offset)++];
+        *length += byte;
+    } while (byte == 255);
+
+    return 1;
+}
+
+
+// Decompress LZ4 block into exactly `size` bytes, `0` if the block is malformed
+static int mdtp_compression_decompress_block(const uint8_t *block,
+                                             size_t         block_size,
+                                             uint8_t       *output,
+                                             size_t         size) {
+    size_t offset = 0;
+    size_t position = 0;
+
+    while (offset < block_size) {
+        uint8_t token = block[offset++];
+        size_t  literals_count = token >> 4;
+
+        if (literals_count == MDTP_COMPRESSION_RUN_MASK &&
+            !mdtp_compression_get_length(block, &offset, block_size, &literals_count)) {
+            return 0;
+        }
+
+        if (literals_count > block_size - offset || literals_count > size - position) {
+            return 0;
+        }
+
+        memcpy(output + position, block + offset, literals_count);
+        offset += literals_count;
+        position += literals_count;
+
+        if (offset == block_size) {
+            break; // The last sequence
+        }
+
+        if (block_size - offset < 2) {
+            return 0;
+        }
+
+        size_t distance = (size_t)block[offset] | (size_t)block[offset + 1] << 8;
+        size_t match_length = token & MDTP_COMPRESSION_RUN_MASK;
+
+        offset += 2;
+
+        if (distance == 0 || distance > position ||
+            (match_length == MDTP_COMPRESSION_RUN_MASK &&
+             !mdtp_compression_get_length(block, &offset, block_size, &match_length))) {
+            return 0;
+        }
+
+        match_length += MDTP_COMPRESSION_MIN_MATCH;
+
+        if (match_length > size - position) {
+            return 0;
+        }
+
+        // Byte by byte, as the match may overlap the bytes it produces
+        for (size_t i = 0; i < match_length; ++i) {
+            output[position + i] = output[position - distance + i];
+        }
+
+        position += match_length;
+    }
+
+    return position == size;
+}
@@ -0,0 +1,425 @@
+/**
+ * @file modules/mdtp_crc.c
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#include "../../include/modules/internals/mdtp_crc.h"
+#include "../../include/modules/internals/abi.h"
+#include "../../include/modules/internals/imodule.h"
+#include "../../include/modules/internals/mdtp.h"
+#include "../../include/modules/internals/memutils.h"
+#include "../../include/modules/internals/utils.h"
+#include "imodule_internal.h"
+#include "mdtp_internal.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MDTP_CRC_X86 1
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
+#define MDTP_CRC_ARM 1
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#ifndef HWCAP_CRC32
+#define HWCAP_CRC32 (1 << 7) ///< CRC32 instructions bit of `AT_HWCAP`
+#endif
+#ifdef __clang__
+#define MDTP_CRC_TARGET_ARM __attribute__((target("crc")))
+#else
+#define MDTP_CRC_TARGET_ARM __attribute__((target("+crc")))
+#endif
+#endif
+
+#define MDTP_CRC_TRAILER_SIZE 4     ///< [4 crc]
+#define MDTP_CRC_POLYNOMIAL 0x82F63B78u ///< Castagnoli polynomial, reflected
+#define MDTP_CRC_LANE 256           ///< Bytes of each of the 3 streams hardware CRC runs at once
+
+#define MDTP_CRC_STATE_NONE 0  ///< Tables are not built
+#define MDTP_CRC_STATE_BUSY 1  ///< Tables are being built
+#define MDTP_CRC_STATE_READY 2 ///< Tables are built and the implementation is chosen
+
+struct MdtpCrc {
+    uint8_t              enabled;  ///< `1` if trailers are appended
+    uint8_t             *frame;    ///< Last frame with a trailer
+    size_t               capacity; ///< Count of bytes allocated for `frame`
+    ABI_MODULE_MDTP_DATA source;   ///< Frame `frame` was made from
+};
+
+/**
+ * @brief Updates the CRC register (without the initial and final inversion) with bytes
+ */
+typedef uint32_t (*MdtpCrcUpdate)(uint32_t reg, const uint8_t *bytes, size_t size);
+
+
+static uint32_t      mdtp_crc_table[8][256]; ///< Slicing-by-8 tables
+static uint32_t      mdtp_crc_shift[4][256]; ///< Register after `MDTP_CRC_LANE` zero bytes, by byte
+static MdtpCrcUpdate mdtp_crc_update;        ///< Implementation chosen for the processor
+static atomic_int    mdtp_crc_state;         ///< `MDTP_CRC_STATE_*`
+
+
+// Forward declaration begin
+static void     mdtp_crc_init(void);
+static uint32_t mdtp_crc_update_table(uint32_t reg, const uint8_t *bytes, size_t size);
+static uint32_t mdtp_crc_shift_lane(uint32_t reg);
+#ifdef MDTP_CRC_X86
+static uint32_t mdtp_crc_update_sse42(uint32_t reg, const uint8_t *bytes, size_t size);
+#endif
+#ifdef MDTP_CRC_ARM
+static uint32_t mdtp_crc_update_armv8(uint32_t reg, const uint8_t *bytes, size_t size);
+#endif
+// Forward declaration end
+
+
+// Continue CRC32C
+uint32_t sdk_mdtp_crc32c(uint32_t crc, const void *bytes, size_t size) {
+    mdtp_crc_init();
+
+    return ~mdtp_crc_update(~crc, bytes, size);
+}
+
+
+// Enable CRC32C trailers
+SDKStatus sdk_mdtp_crc_enable(IModule *module) {
+    if (!sdk_utils_server_has_capability(module, ABI_CAPABILITY_CRC)) {
+        return SDK_OTHER_ERROR;
+    }
+
+    if (module->crc == NULL) {
+        module->crc = calloc(1, sizeof(MdtpCrc));
+
+        if (module->crc == NULL) {
+            return SDK_ALLOCATION_ERROR;
+        }
+    }
+
+    module->crc->enabled = 1;
+
+    return SDK_OK;
+}
+
+
+// Disable CRC32C trailers
+void sdk_mdtp_crc_disable(IModule *module) {
+    if (module->crc == NULL) {
+        return;
+    }
+
+    // The server gets what it would get without trailers
+    mdtp_chunk_restore(module);
+    mdtp_crc_restore(module);
+    module->crc->enabled = 0;
+}
+
+
+// Make frame to send
+const ABI_MODULE_MDTP_DATA *sdk_mdtp_crc_emit(IModule *module) {
+    MdtpCrc              *crc = module->crc;
+    ABI_MODULE_MDTP_DATA *data = &module->mdtp_data;
+
+    if (crc != NULL && crc->enabled) {
+        mdtp_chunk_restore(module);
+    }
+
+    // Nothing to protect, or already protected. Parts of a frame built in chunks are sent as
+    // they are
+    if (crc == NULL || !crc->enabled || data->data == NULL || data->size < MDTP_HEADER_SIZE ||
+        data->size > UINT32_MAX - MDTP_CRC_TRAILER_SIZE || data->data == crc->frame ||
+        (read_ubyte_be(data->data, 0) & (MDTP_FLAG_CRC | MDTP_FLAG_CHUNK)) != 0) {
+        return data;
+    }
+
+    size_t size = (size_t)data->size + MDTP_CRC_TRAILER_SIZE;
+
+    if (crc->capacity < size) {
+        uint8_t *frame = realloc(crc->frame, size);
+
+        if (frame == NULL) {
+            return data;
+        }
+
+        crc->frame = frame;
+        crc->capacity = size;
+    }
+
+    memcpy(crc->frame, data->data, data->size);
+    write_ubyte_be(crc->frame, 0, (uint8_t)(crc->frame[0] | MDTP_FLAG_CRC));
+    write_uint32_be(crc->frame, 1, (uint32_t)(size - MDTP_HEADER_SIZE));
+    write_uint32_be(crc->frame, data->size, sdk_mdtp_crc32c(0, crc->frame, data->size));
+
+    crc->source = *data;
+    *data = (ABI_MODULE_MDTP_DATA){.data = crc->frame, .size = (uint32_t)size};
+
+    return data;
+}
+
+
+// Check CRC32C trailer
+SDKStatus sdk_mdtp_crc_verify(const void *frame, size_t frame_size) {
+    if (frame == NULL || frame_size == 0 || (read_ubyte_be(frame, 0) & MDTP_FLAG_CRC) == 0) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    size_t size = frame_size - MDTP_CRC_TRAILER_SIZE;
+
+    if (frame_size < MDTP_HEADER_SIZE + MDTP_CRC_TRAILER_SIZE ||
+        read_uint32_be(frame, 1) != frame_size - MDTP_HEADER_SIZE ||
+        read_uint32_be(frame, size) != sdk_mdtp_crc32c(0, frame, size)) {
+        return SDK_ARGUMENT_PROCESSING_ERROR;
+    }
+
+    return SDK_OK;
+}
+
+
+// Check CRC32C trailer and remove it
+void *sdk_mdtp_crc_strip(const void *frame, size_t frame_size, size_t *size) {
+    SDKStatus status = sdk_mdtp_crc_verify(frame, frame_size);
+    size_t    result_size = frame_size;
+
+    if (status == SDK_OK) {
+        result_size -= MDTP_CRC_TRAILER_SIZE;
+    } else if (status != SDK_INVALID_ARGUMENT || frame_size < MDTP_HEADER_SIZE ||
+               read_uint32_be(frame, 1) != frame_size - MDTP_HEADER_SIZE) {
+        return NULL;
+    }
+
+    uint8_t *result = malloc(result_size);
+
+    if (result == NULL) {
+        return NULL;
+    }
+
+    memcpy(result, frame, result_size);
+    write_ubyte_be(result, 0, (uint8_t)(result[0] & ~MDTP_FLAG_CRC));
+    write_uint32_be(result, 1, (uint32_t)(result_size - MDTP_HEADER_SIZE));
+    *size = result_size;
+
+    return result;
+}
+
+
+// Give the previous step back the frame it made
+void mdtp_crc_restore(IModule *module) {
+    MdtpCrc *crc = module->crc;
+
+    if (crc != NULL && crc->frame != NULL && module->mdtp_data.data == crc->frame) {
+        module->mdtp_data = crc->source;
+    }
+}
+
+
+// Destroy CRC32C trailers state of a module
+void mdtp_crc_destroy(MdtpCrc *crc) {
+    if (crc == NULL) {
+        return;
+    }
+
+    free(crc->frame);
+    free(crc);
+}
+
+
+// Build tables and choose the implementation once
+static void mdtp_crc_init(void) {
+    int expected = MDTP_CRC_STATE_NONE;
+
+    if (atomic_load_explicit(&mdtp_crc_state, memory_order_acquire) == MDTP_CRC_STATE_READY) {
+        return;
+    }
+
+    if (!atomic_compare_exchange_strong(&mdtp_crc_state, &expected, MDTP_CRC_STATE_BUSY)) {
+        // Another thread builds the tables, it takes microseconds
+        while (atomic_load_explicit(&mdtp_crc_state, memory_order_acquire) !=
+               MDTP_CRC_STATE_READY) {
+        }
+
+        return;
+    }
+
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t reg = i;
+
+        for (int bit = 0; bit < 8; ++bit) {
+            reg = (reg & 1) != 0 ? (reg >> 1) ^ MDTP_CRC_POLYNOMIAL : reg >> 1;
+        }
+
+        mdtp_crc_table[0][i] = reg;
+    }
+
+    for (int k = 1; k < 8; ++k) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t previous = mdtp_crc_table[k - 1][i];
+
+            mdtp_crc_table[k][i] = (previous >> 8) ^ mdtp_crc_table[0][previous & 0xFF];
+        }
+    }
+
+    // Zero bytes change the register linearly, so the shift of every register is the XOR of the
+    // shifts of its bits
+    uint32_t bits[32];
+
+    for (int bit = 0; bit < 32; ++bit) {
+        uint32_t reg = 1u << bit;
+
+        for (int i = 0; i < MDTP_CRC_LANE; ++i) {
+            reg = mdtp_crc_table[0][reg & 0xFF] ^ (reg >> 8);
+        }
+
+        bits[bit] = reg;
+    }
+
+    for (int k = 0; k < 4; ++k) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t shift = 0;
+
+            for (int bit = 0; bit < 8; ++bit) {
+                if ((i & (1u << bit)) != 0) {
+                    shift ^= bits[k * 8 + bit];
+                }
+            }
+
+            mdtp_crc_shift[k][i] = shift;
+        }
+    }
+
+    mdtp_crc_update = mdtp_crc_update_table;
+
+#ifdef MDTP_CRC_X86
+    if (__builtin_cpu_supports("sse4.2")) {
+        mdtp_crc_update = mdtp_crc_update_sse42;
+    }
+#endif
+
+#ifdef MDTP_CRC_ARM
+    if ((getauxval(AT_HWCAP) & HWCAP_CRC32) != 0) {
+        mdtp_crc_update = mdtp_crc_update_armv8;
+    }
+#endif
+
+    atomic_store_explicit(&mdtp_crc_state, MDTP_CRC_STATE_READY, memory_order_release);
+}
+
+
+// Update register with slicing-by-8 tables
+static uint32_t mdtp_crc_update_table(uint32_t reg, const uint8_t *bytes, size_t size) {
+    for (; size >= 8; bytes += 8, size -= 8) {
+        uint32_t low = reg ^ ((uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 |
+                              (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24);
+        uint32_t high = (uint32_t)bytes[4] | (uint32_t)bytes[5] << 8 | (uint32_t)bytes[6] << 16 |
+                        (uint32_t)bytes[7] << 24;
+
+        reg = mdtp_crc_table[7][low & 0xFF] ^ mdtp_crc_table[6][(low >> 8) & 0xFF] ^
+              mdtp_crc_table[5][(low >> 16) & 0xFF] ^ mdtp_crc_table[4][low >> 24] ^
+              mdtp_crc_table[3][high & 0xFF] ^ mdtp_crc_table[2][(high >> 8) & 0xFF] ^
+              mdtp_crc_table[1][(high >> 16) & 0xFF] ^ mdtp_crc_table[0][high >> 24];
+    }
+
+    for (; size > 0; ++bytes, --size) {
+        reg = mdtp_crc_table[0][(reg ^ *bytes) & 0xFF] ^ (reg >> 8);
+    }
+
+    return reg;
+}
+
+
+// Get register after `MDTP_CRC_LANE` zero bytes
+static uint32_t mdtp_crc_shift_lane(uint32_t reg) {
+    return mdtp_crc_shift[0][reg & 0xFF] ^ mdtp_crc_shift[1][(reg >> 8) & 0xFF] ^
+           mdtp_crc_shift[2][(reg >> 16) & 0xFF] ^ mdtp_crc_shift[3][reg >> 24];
+}
+
+
+#ifdef MDTP_CRC_X86
+// Update register with SSE4.2 instructions
+__attribute__((target("sse4.2"))) static uint32_t mdtp_crc_update_sse42(uint32_t       reg,
+                                                                        const uint8_t *bytes,
+                                                                        size_t         size) {
+    // An instruction takes 3 cycles, but a new one can start every cycle, so 3 independent
+    // streams run at once and are joined by shifting the registers of the first two
+    for (; size >= 3 * MDTP_CRC_LANE; bytes += 3 * MDTP_CRC_LANE, size -= 3 * MDTP_CRC_LANE) {
+        uint64_t first = reg;
+        uint64_t second = 0;
+        uint64_t third = 0;
+
+        for (size_t i = 0; i < MDTP_CRC_LANE; i += 8) {
+            uint64_t words[3];
+
+            memcpy(&words[0], bytes + i, 8);
+            memcpy(&words[1], bytes + MDTP_CRC_LANE + i, 8);
+            memcpy(&words[2], bytes + 2 * MDTP_CRC_LANE + i, 8);
+
+            first = _mm_crc32_u64(first, words[0]);
+            second = _mm_crc32_u64(second, words[1]);
+            third = _mm_crc32_u64(third, words[2]);
+        }
+
+        reg = mdtp_crc_shift_lane(mdtp_crc_shift_lane((uint32_t)first) ^ (uint32_t)second) ^
+              (uint32_t)third;
+    }
+
+    uint64_t wide = reg;
+
+    for (; size >= 8; bytes += 8, size -= 8) {
+        uint64_t word;
+
+        memcpy(&word, bytes, 8);
+        wide = _mm_crc32_u64(wide, word);
+    }
+
+    reg = (uint32_t)wide;
+
+    for (; size > 0; ++bytes, --size) {
+        reg = _mm_crc32_u8(reg, *bytes);
+    }
+
+    return reg;
+}
+#endif
+
+
+#ifdef MDTP_CRC_ARM
+// Update register with ARMv8 CRC32 instructions
+MDTP_CRC_TARGET_ARM static uint32_t mdtp_crc_update_armv8(uint32_t       reg,
+                                                          const uint8_t *bytes,
+                                                          size_t         size) {
+    // See `mdtp_crc_update_sse42`
+    for (; size >= 3 * MDTP_CRC_LANE; bytes += 3 * MDTP_CRC_LANE, size -= 3 * MDTP_CRC_LANE) {
+        uint32_t first = reg;
+        uint32_t second = 0;
+        uint32_t third = 0;
+
+        for (size_t i = 0; i < MDTP_CRC_LANE; i += 8) {
+            uint64_t words[3];
+
+            memcpy(&words[0], bytes + i, 8);
+            memcpy(&words[1], bytes + MDTP_CRC_LANE + i, 8);
+            memcpy(&words[2], bytes + 2 * MDTP_CRC_LANE + i, 8);
+
+            first = __crc32cd(first, words[0]);
+            second = __crc32cd(second, words[1]);
+            third = __crc32cd(third, words[2]);
+        }
+
+        reg = mdtp_crc_shift_lane(mdtp_crc_shift_lane(first) ^ second) ^ third;
+    }
+
+    for (; size >= 8; bytes += 8, size -= 8) {
+        uint64_t word;
+
+        memcpy(&word, bytes, 8);
+        reg = __crc32cd(reg, word);
+    }
+
+    for (; size > 0; ++bytes, --size) {
+        reg = __crc32cb(reg, *bytes);
+    }
+
+    return reg;
+}
+#endif
@@ -0,0 +1,431 @@
+/**
+ * @file modules/mdtp_deadline.c
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#include "../../include/modules/internals/mdtp_deadline.h"
+#include "../../include/modules/internals/utils.h"
+#include "imodule_internal.h"
+#include "mdtp_internal.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+/*
+ * The worker writes `back`, then swaps it with `ready` under the mutex. The server swaps `ready`
+ * with `front` under the mutex and reads `front`. So the frame being read is never written, and
+ * the mutex is never held during a collection.
+ *
+ * A worker whose collection hangs past the budget when the budget is removed is abandoned. The
+ * module gets a new state with the frames, and the worker frees the old one once the collect
+ * routine returns. The module keeps the thread and joins it when it is destroyed, as the routine
+ * may use the module. A module has at most one abandoned worker.
+ */
+
+struct MdtpDeadline {
+    MdtpFrameCopy front;    ///< Frame returned to the server, owned by the server thread
+    uint8_t       stale;    ///< `1` if `front` is stale, owned by the server thread
+    uint8_t       incident; ///< `1` from a late collection to one in time, owned by the server
+    MdtpFrameCopy ready;    ///< Latest collected frame, guarded by `mutex`
+    MdtpFrameCopy back;     ///< Frame being collected, owned by the worker thread
+
+    ABI_MODULE_DATA_INFO info; ///< Info of the frame collected last, owned by the worker thread
+
+    const ABI_MODULE_MDTP_DATA *(*collect)(void); ///< Collect routine of the module
+    uint32_t        budget_ms;                   ///< Milliseconds to wait for a collection
+    pthread_t       thread;                      ///< Worker thread
+    pthread_t       hung;                        ///< Abandoned worker thread, if `hung_pending`
+    pthread_mutex_t mutex;                       ///< Guards the fields below and `ready`
+    pthread_cond_t  requested;                   ///< Signaled when a collection is requested
+    pthread_cond_t  finished;                    ///< Signaled when a collection or worker finished
+    uint8_t         request;                     ///< `1` if the worker must collect
+    uint8_t         busy;                        ///< `1` from the request to the end of collection
+    uint8_t         collecting;                  ///< `1` while the collect routine runs
+    uint8_t         collected;                   ///< `1` if `ready` holds a frame not yet taken
+    uint8_t         succeeded;                   ///< `1` if the last collection made a frame
+    uint8_t         stopping;                    ///< `1` if the worker must exit
+    uint8_t         exited;                      ///< `1` once the worker left its loop
+    uint8_t         abandoned;                   ///< `1` if the worker must free the state
+    uint8_t         running;                     ///< `1` while the worker thread exists
+    uint8_t         hung_pending;                ///< `1` if `hung` is not joined yet
+};
+
+
+// Forward declaration begin
+static MdtpDeadline *mdtp_deadline_get(IModule *module);
+static SDKStatus     mdtp_deadline_abandon(IModule *module);
+static void          mdtp_deadline_free(MdtpDeadline *deadline);
+static void          mdtp_deadline_stop(IModule *module, int abandon);
+static void         *mdtp_deadline_run(void *argument);
+static void          mdtp_deadline_until(struct timespec *until, uint32_t milliseconds);
+static void          mdtp_deadline_warn(const IModule *module, uint32_t budget_ms);
+// Forward declaration end
+
+
+// Set time budget
+SDKStatus sdk_mdtp_deadline_enable(IModule *module,
+                                   const ABI_MODULE_MDTP_DATA *(*collect)(void),
+                                   uint32_t budget_ms) {
+    if (collect == NULL || budget_ms == 0 || mdtp_deadline_enabled(module) ||
+        mdtp_sampler_running(module) || mdtp_delta_enabled(module) ||
+        mdtp_dictionary_enabled(module) || mdtp_chunk_enabled(module)) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    MdtpDeadline *deadline = mdtp_deadline_get(module);
+
+    if (deadline == NULL) {
+        return SDK_ALLOCATION_ERROR;
+    }
+
+    deadline->collect = collect;
+    deadline->budget_ms = budget_ms;
+    deadline->stopping = 0;
+    deadline->exited = 0;
+
+    // Set before the thread starts, which reads the neighboring fields
+    deadline->running = 1;
+
+    if (pthread_create(&deadline->thread, NULL, mdtp_deadline_run, deadline) != 0) {
+        deadline->running = 0;
+        return SDK_OTHER_ERROR;
+    }
+
+    return SDK_OK;
+}
+
+
+// Remove time budget
+void sdk_mdtp_deadline_disable(IModule *module) {
+    mdtp_deadline_stop(module, 1);
+}
+
+
+// Collect frame within the time budget
+const ABI_MODULE_MDTP_DATA *sdk_mdtp_deadline_get_data(IModule *module) {
+    MdtpDeadline *deadline = module->deadline;
+
+    if (deadline == NULL) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&deadline->mutex);
+
+    if (deadline->running) {
+        // A late collection is still running, it is waited for instead of starting another one
+        if (!deadline->busy) {
+            deadline->busy = 1;
+            deadline->request = 1;
+            pthread_cond_signal(&deadline->requested);
+        }
+
+        struct timespec until;
+        int             waited = 0;
+
+        mdtp_deadline_until(&until, deadline->budget_ms);
+
+        while (deadline->busy && waited != ETIMEDOUT) {
+            waited = pthread_cond_timedwait(&deadline->finished, &deadline->mutex, &until);
+        }
+    }
+
+    int late = deadline->running && deadline->busy;
+
+    // A frame collected in time or finished late after the previous poll
+    if (deadline->collected) {
+        MdtpFrameCopy frame = deadline->front;
+
+        deadline->front = deadline->ready;
+        deadline->ready = frame;
+        deadline->collected = 0;
+    }
+
+    deadline->stale = (uint8_t)(late || !deadline->succeeded);
+
+    pthread_mutex_unlock(&deadline->mutex);
+
+    if (late && !deadline->incident) {
+        deadline->incident = 1;
+        mdtp_deadline_warn(module, deadline->budget_ms);
+    } else if (!late) {
+        deadline->incident = 0;
+    }
+
+    return deadline->front.mdtp_data.data == NULL ? NULL : &deadline->front.mdtp_data;
+}
+
+
+// Get hash and generation of the last returned frame
+const ABI_MODULE_DATA_INFO *sdk_mdtp_deadline_get_data_info(const IModule *module) {
+    if (module->deadline == NULL || module->deadline->front.mdtp_data.data == NULL) {
+        return NULL;
+    }
+
+    return &module->deadline->front.info;
+}
+
+
+// Check if the last returned frame is stale
+uint8_t sdk_mdtp_deadline_is_stale(const IModule *module) {
+    return module->deadline != NULL && module->deadline->stale;
+}
+
+
+// Check if a time budget is set
+int mdtp_deadline_enabled(const IModule *module) {
+    return module->deadline != NULL && module->deadline->running;
+}
+
+
+// Destroy deadline state
+void mdtp_deadline_destroy(IModule *module) {
+    if (module->deadline == NULL) {
+        return;
+    }
+
+    // The collect routine may use the module, so its worker is never abandoned here
+    mdtp_deadline_stop(module, 0);
+
+    if (module->deadline->hung_pending) {
+        pthread_join(module->deadline->hung, NULL);
+    }
+
+    mdtp_deadline_free(module->deadline);
+
+    module->deadline = NULL;
+}
+
+
+// Get deadline state of module, create it on first use
+static MdtpDeadline *mdtp_deadline_get(IModule *module) {
+    if (module->deadline != NULL) {
+        return module->deadline;
+    }
+
+    MdtpDeadline      *deadline = calloc(1, sizeof(MdtpDeadline));
+    pthread_condattr_t attributes;
+
+    if (deadline == NULL) {
+        return NULL;
+    }
+
+    // Budgets are measured on the monotonic clock, so changes of the wall clock do not shift them
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+
+    int failed = pthread_mutex_init(&deadline->mutex, NULL) != 0;
+
+    if (!failed && pthread_cond_init(&deadline->requested, NULL) != 0) {
+        pthread_mutex_destroy(&deadline->mutex);
+        failed = 1;
+    }
+
+    if (!failed && pthread_cond_init(&deadline->finished, &attributes) != 0) {
+        pthread_cond_destroy(&deadline->requested);
+        pthread_mutex_destroy(&deadline->mutex);
+        failed = 1;
+    }
+
+    pthread_condattr_destroy(&attributes);
+
+    if (failed) {
+        free(deadline);
+        return NULL;
+    }
+
+    deadline->succeeded = 1;
+
+    module->deadline = deadline;
+
+    return deadline;
+}
+
+
+// Leave the state to the hung worker and give the frames to a new one, the mutex is held
+static SDKStatus mdtp_deadline_abandon(IModule *module) {
+    MdtpDeadline *worker = module->deadline;
+
+    // A second abandoned worker is waited for instead
+    if (worker->hung_pending) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    module->deadline = NULL;
+
+    MdtpDeadline *deadline = mdtp_deadline_get(module);
+
+    if (deadline == NULL) {
+        module->deadline = worker;
+        return SDK_ALLOCATION_ERROR;
+    }
+
+    deadline->front = worker->front;
+    deadline->stale = worker->stale;
+    deadline->incident = worker->incident;
+    deadline->ready = worker->ready;
+    deadline->collected = worker->collected;
+    deadline->succeeded = worker->succeeded;
+    deadline->info = worker->info;
+    deadline->hung = worker->thread;
+    deadline->hung_pending = 1;
+
+    worker->front = (MdtpFrameCopy){0};
+    worker->ready = (MdtpFrameCopy){0};
+    worker->abandoned = 1;
+
+    return SDK_OK;
+}
+
+
+// Free deadline state, the worker must not run
+static void mdtp_deadline_free(MdtpDeadline *deadline) {
+    free(deadline->front.data);
+    free(deadline->ready.data);
+    free(deadline->back.data);
+
+    pthread_cond_destroy(&deadline->requested);
+    pthread_cond_destroy(&deadline->finished);
+    pthread_mutex_destroy(&deadline->mutex);
+    free(deadline);
+}
+
+
+// Stop worker, abandon it if `abandon` is set and the collection hangs past the budget
+static void mdtp_deadline_stop(IModule *module, int abandon) {
+    MdtpDeadline *deadline = module->deadline;
+
+    if (deadline == NULL || !deadline->running) {
+        return;
+    }
+
+    struct timespec until;
+    int             waited = 0;
+
+    mdtp_deadline_until(&until, deadline->budget_ms);
+
+    pthread_mutex_lock(&deadline->mutex);
+    deadline->stopping = 1;
+    pthread_cond_signal(&deadline->requested);
+
+    // A hung collection is waited for at most the budget
+    while (abandon && !deadline->exited && waited != ETIMEDOUT) {
+        waited = pthread_cond_timedwait(&deadline->finished, &deadline->mutex, &until);
+    }
+
+    if (abandon && !deadline->exited && deadline->collecting &&
+        mdtp_deadline_abandon(module) == SDK_OK) {
+        // The worker may free the state as soon as the mutex is unlocked
+        pthread_mutex_unlock(&deadline->mutex);
+        return;
+    }
+
+    // Either the collection is waited for, or its frame is being copied, which does not hang
+    while (!deadline->exited) {
+        pthread_cond_wait(&deadline->finished, &deadline->mutex);
+    }
+
+    pthread_mutex_unlock(&deadline->mutex);
+
+    pthread_join(deadline->thread, NULL);
+
+    deadline->running = 0;
+}
+
+
+// Collect frames on request until the budget is removed
+static void *mdtp_deadline_run(void *argument) {
+    MdtpDeadline *deadline = argument;
+
+    pthread_mutex_lock(&deadline->mutex);
+
+    while (1) {
+        while (!deadline->request && !deadline->stopping) {
+            pthread_cond_wait(&deadline->requested, &deadline->mutex);
+        }
+
+        if (deadline->stopping) {
+            break;
+        }
+
+        deadline->request = 0;
+        deadline->collecting = 1;
+
+        pthread_mutex_unlock(&deadline->mutex);
+
+        const ABI_MODULE_MDTP_DATA *data = deadline->collect();
+
+        pthread_mutex_lock(&deadline->mutex);
+
+        deadline->collecting = 0;
+
+        // The module may be gone, the frame is dropped
+        if (deadline->abandoned) {
+            pthread_mutex_unlock(&deadline->mutex);
+            mdtp_deadline_free(deadline);
+            return NULL;
+        }
+
+        // The state is not abandoned once the collection finished, so the module outlives the copy
+        pthread_mutex_unlock(&deadline->mutex);
+
+        int succeeded =
+            data != NULL && mdtp_frame_copy(&deadline->back, data, &deadline->info) == SDK_OK;
+
+        pthread_mutex_lock(&deadline->mutex);
+
+        if (succeeded) {
+            MdtpFrameCopy frame = deadline->ready;
+
+            deadline->ready = deadline->back;
+            deadline->back = frame;
+            deadline->collected = 1;
+        }
+
+        deadline->succeeded = (uint8_t)succeeded;
+        deadline->busy = 0;
+        pthread_cond_signal(&deadline->finished);
+    }
+
+    deadline->exited = 1;
+    pthread_cond_signal(&deadline->finished);
+
+    pthread_mutex_unlock(&deadline->mutex);
+
+    return NULL;
+}
+
+
+// Get time on the monotonic clock the given milliseconds from now
+static void mdtp_deadline_until(struct timespec *until, uint32_t milliseconds) {
+    clock_gettime(CLOCK_MONOTONIC, until);
+    until->tv_sec += (time_t)(milliseconds / 1000);
+    until->tv_nsec += (long)(milliseconds % 1000) * 1000000;
+
+    if (until->tv_nsec >= 1000000000) {
+        until->tv_sec += 1;
+        until->tv_nsec -= 1000000000;
+    }
+}
+
+
+// Log the start of an incident
+static void mdtp_deadline_warn(const IModule *module, uint32_t budget_ms) {
+    char message[128];
+
+    // Servers without a logger do not get the warning
+    if (sdk_imodule_get_server_core_functions(module)->abi_log == NULL) {
+        return;
+    }
+
+    snprintf(message,
+             sizeof(message),
+             "Data collection exceeded its budget of %u ms, the last good frame is sent",
+             budget_ms);
+
+    sdk_utils_log(module, LOG_WARNING, message);
+}
@@ -0,0 +1,551 @@
+/**
+ * @file modules/mdtp_delta.c
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#include "../../include/modules/internals/mdtp_delta.h"
+#include "../../include/modules/internals/abi.h"
+#include "../../include/modules/internals/imodule.h"
+#include "../../include/modules/internals/mdtp.h"
+#include "../../include/modules/internals/mdtp_builder.h"
+#include "../../include/modules/internals/mdtp_reader.h"
+#include "../../include/modules/internals/memutils.h"
+#include "../../include/modules/internals/utils.h"
+#include "imodule_internal.h"
+#include "mdtp_internal.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MDTP_DELTA_LOOKAHEAD 8      ///< How far inserted and removed nodes are looked for
+
+struct MdtpDelta {
+    uint32_t        keyframe_interval; ///< Count of frames between keyframes, `0` - disabled
+    uint32_t        frames;            ///< Count of deltas sent since the last keyframe
+    uint8_t         keyframe;          ///< `1` if the next frame must be a keyframe
+    uint64_t        serial;            ///< Serial of the frame of the module at the last emit
+    MdtpBuffer      previous;          ///< Copy of the last full frame sent
+    MdtpBuffer      delta;             ///< Last delta frame
+};
+
+
+// Forward declaration begin
+static void      mdtp_delta_write_count(MdtpBuffer *buffer, uint8_t type, uint32_t count);
+static int       mdtp_delta_same_node(const MdtpReader *old_node, const MdtpReader *new_node);
+static uint32_t  mdtp_delta_find(const MdtpReader *node, MdtpReader readers);
+static void      mdtp_delta_encode(MdtpBuffer *buffer,
+                                   MdtpReader *old_level,
+                                   MdtpReader *new_level,
+                                   uint32_t    depth);
+static int       mdtp_delta_apply(MdtpBuffer    *buffer,
+                                  MdtpReader    *old_level,
+                                  const uint8_t *operations,
+                                  size_t         offset,
+                                  size_t         end,
+                                  uint32_t       depth);
+static int       mdtp_delta_copy_node(MdtpBuffer *buffer, const MdtpReader *node);
+// Forward declaration end
+
+
+// Enable delta frames
+SDKStatus sdk_mdtp_delta_enable(IModule *module, uint32_t keyframe_interval) {
+    if (keyframe_interval == 0) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    if (!sdk_utils_server_has_capability(module, ABI_CAPABILITY_DELTA_FRAMES)) {
+        return SDK_OTHER_ERROR;
+    }
+
+    if (module->delta == NULL) {
+        module->delta = calloc(1, sizeof(MdtpDelta));
+
+        if (module->delta == NULL) {
+            return SDK_ALLOCATION_ERROR;
+        }
+    }
+
+    module->delta->keyframe_interval = keyframe_interval;
+    module->delta->keyframe = 1;
+
+    return SDK_OK;
+}
+
+
+// Disable delta frames
+void sdk_mdtp_delta_disable(IModule *module) {
+    MdtpDelta *delta = module->delta;
+
+    if (delta == NULL) {
+        return;
+    }
+
+    // The server must not be left with a delta as the last frame
+    if (module->mdtp_data.data == delta->delta.data) {
+        module->mdtp_data = (ABI_MODULE_MDTP_DATA){.data = delta->previous.data,
+                                                   .size = (uint32_t)delta->previous.size};
+    }
+
+    delta->keyframe_interval = 0;
+}
+
+
+// Request keyframe
+void sdk_mdtp_delta_request_keyframe(IModule *module) {
+    if (module->delta != NULL) {
+        module->delta->keyframe = 1;
+    }
+}
+
+
+// Make frame to send
+const ABI_MODULE_MDTP_DATA *sdk_mdtp_delta_emit(IModule *module) {
+    MdtpDelta *delta = module->delta;
+
+    if (delta == NULL || delta->keyframe_interval == 0) {
+        return &module->mdtp_data;
+    }
+
+    mdtp_chunk_restore(module);
+    mdtp_crc_restore(module);
+    mdtp_compression_restore(module);
+
+    // A frame built in chunks is not in the frame buffer
+    if (module->mdtp_data.data != NULL &&
+        (read_ubyte_be(module->mdtp_data.data, 0) & MDTP_FLAG_CHUNK) != 0) {
+        return &module->mdtp_data;
+    }
+
+    // Full frame to send: a new one stored in the module or the previous one again
+    const uint8_t *frame = delta->previous.data;
+    size_t         size = delta->previous.size;
+
+    if (module->frame_serial != delta->serial) {
+        frame = module->frame;
+        size = module->mdtp_data.size;
+    }
+
+    if (frame == NULL) {
+        return &module->mdtp_data; // Nothing was stored yet
+    }
+
+    // Deltas are made between MDTP v1 frames only
+    int keyframe = delta->keyframe || delta->previous.size == 0 ||
+                   delta->frames + 1 >= delta->keyframe_interval ||
+                   read_ubyte_be(frame, 0) != MDTP_VERSION ||
+                   read_ubyte_be(delta->previous.data, 0) != MDTP_VERSION;
+
+    if (!keyframe) {
+        MdtpBuffer *buffer = &delta->delta;
+        MdtpReader  old_level;
+        MdtpReader  new_level;
+
+        buffer->size = 0;
+        buffer->status =
+            sdk_mdtp_reader_init(&old_level, delta->previous.data, delta->previous.size);
+
+        if (buffer->status == SDK_OK) {
+            buffer->status = sdk_mdtp_reader_init(&new_level, frame, size);
+        }
+
+        if (mdtp_buffer_claim(buffer, MDTP_HEADER_SIZE) != NULL) {
+            mdtp_delta_encode(buffer, &old_level, &new_level, 0);
+        }
+
+        // A delta that is not smaller than the frame is useless
+        if (buffer->status == SDK_OK && buffer->size < size) {
+            write_ubyte_be(buffer->data, 0, MDTP_VERSION | MDTP_FLAG_DELTA);
+            write_uint32_be(buffer->data, 1, (uint32_t)(buffer->size - MDTP_HEADER_SIZE));
+
+            module->mdtp_data =
+                (ABI_MODULE_MDTP_DATA){.data = buffer->data, .size = (uint32_t)buffer->size};
+            ++delta->frames;
+        } else {
+            keyframe = 1;
+        }
+    }
+
+    if (keyframe) {
+        module->mdtp_data = (ABI_MODULE_MDTP_DATA){.data = frame, .size = (uint32_t)size};
+        delta->frames = 0;
+        delta->keyframe = 0;
+    }
+
+    // Remember the frame the server has now
+    if (frame != delta->previous.data) {
+        delta->previous.size = 0;
+        delta->previous.status = SDK_OK;
+        mdtp_buffer_write(&delta->previous, frame, size);
+
+        if (delta->previous.status != SDK_OK) {
+            delta->previous.size = 0; // The next frame is a keyframe
+        }
+    }
+
+    delta->serial = module->frame_serial;
+
+    return &module->mdtp_data;
+}
+
+
+// Apply received frame to the previous full frame
+void *sdk_mdtp_delta_apply(const void *base,
+                           size_t      base_size,
+                           const void *frame,
+                           size_t      frame_size,
+                           size_t     *size) {
+    if (frame == NULL || frame_size < MDTP_HEADER_SIZE) {
+        return NULL;
+    }
+
+    MdtpBuffer buffer = {0};
+    uint8_t    first = read_ubyte_be(frame, 0);
+
+    if ((first & MDTP_FLAG_DELTA) == 0) {
+        // Keyframe
+        if (sdk_mdtp_validate(frame, frame_size) != SDK_OK) {
+            return NULL;
+        }
+
+        mdtp_buffer_write(&buffer, frame, frame_size);
+    } else {
+        MdtpReader old_level;
+
+        if (first != (MDTP_VERSION | MDTP_FLAG_DELTA) ||
+            read_uint32_be(frame, 1) != frame_size - MDTP_HEADER_SIZE || base == NULL ||
+            sdk_mdtp_validate(base, base_size) != SDK_OK ||
+            read_ubyte_be(base, 0) != MDTP_VERSION ||
+            sdk_mdtp_reader_init(&old_level, base, base_size) != SDK_OK) {
+            return NULL;
+        }
+
+        mdtp_buffer_claim(&buffer, MDTP_HEADER_SIZE);
+
+        if (!mdtp_delta_apply(&buffer, &old_level, frame, MDTP_HEADER_SIZE, frame_size, 0) ||
+            buffer.size - MDTP_HEADER_SIZE > UINT32_MAX) {
+            buffer.status = SDK_ARGUMENT_PROCESSING_ERROR;
+        }
+
+        if (buffer.status == SDK_OK) {
+            write_ubyte_be(buffer.data, 0, MDTP_VERSION);
+            write_uint32_be(buffer.data, 1, (uint32_t)(buffer.size - MDTP_HEADER_SIZE));
+        }
+    }
+
+    // Inserted nodes are not checked while applying
+    if (buffer.status != SDK_OK || sdk_mdtp_validate(buffer.data, buffer.size) != SDK_OK) {
+        free(buffer.data);
+        return NULL;
+    }
+
+    *size = buffer.size;
+
+    return buffer.data;
+}
+
+
+// Check if delta frames are enabled
+int mdtp_delta_enabled(const IModule *module) {
+    return module->delta != NULL && module->delta->keyframe_interval != 0;
+}
+
+
+// Destroy delta state
+void mdtp_delta_destroy(MdtpDelta *delta) {
+    if (delta == NULL) {
+        return;
+    }
+
+    free(delta->previous.data);
+    free(delta->delta.data);
+    free(delta);
+}
+
+
+// Append KEEP or REMOVE operation
+static void mdtp_delta_write_count(MdtpBuffer *buffer, uint8_t type, uint32_t count) {
+    uint8_t *cursor = mdtp_buffer_claim(buffer, 5);
+
+    if (cursor != NULL) {
+        *cursor = type;
+        write_uint32_be(cursor, 1, count);
+    }
+}
+
+
+// Check that two nodes have the same type and name
+static int mdtp_delta_same_node(const MdtpReader *old_node, const MdtpReader *new_node) {
+    size_t      old_length;
+    size_t      new_length;
+    const char *old_name = sdk_mdtp_reader_name(old_node, &old_length);
+    const char *new_name = sdk_mdtp_reader_name(new_node, &new_length);
+
+    return sdk_mdtp_reader_type(old_node) == sdk_mdtp_reader_type(new_node) &&
+           old_length == new_length && memcmp(old_name, new_name, old_length) == 0;
+}
+
+
+// Count of nodes in `readers` (the first one is the current node) before a node like `node`,
+// `0` if it is not within `MDTP_DELTA_LOOKAHEAD` nodes
+static uint32_t mdtp_delta_find(const MdtpReader *node, MdtpReader readers) {
+    for (uint32_t distance = 1; distance < MDTP_DELTA_LOOKAHEAD; ++distance) {
+        if (!sdk_mdtp_reader_next(&readers)) {
+            return 0;
+        }
+
+        if (mdtp_delta_same_node(node, &readers)) {
+            return distance;
+        }
+    }
+
+    return 0;
+}
+
+
+// Write operations turning children of `old_level` into children of `new_level`
+static void mdtp_delta_encode(MdtpBuffer *buffer,
+                              MdtpReader *old_level,
+                              MdtpReader *new_level,
+                              uint32_t    depth) {
+    int      has_old = sdk_mdtp_reader_next(old_level);
+    int      has_new = sdk_mdtp_reader_next(new_level);
+    uint32_t keep = 0;
+
+    while (has_old && has_new && buffer->status == SDK_OK) {
+        size_t      old_size;
+        size_t      new_size;
+        const void *old_node = sdk_mdtp_reader_node(old_level, &old_size);
+        const void *new_node = sdk_mdtp_reader_node(new_level, &new_size);
+
+        if (mdtp_delta_same_node(old_level, new_level) && old_size == new_size &&
+            memcmp(old_node, new_node, old_size) == 0) {
+            ++keep;
+            has_old = sdk_mdtp_reader_next(old_level);
+            has_new = sdk_mdtp_reader_next(new_level);
+            continue;
+        }
+
+        if (keep != 0) {
+            mdtp_delta_write_count(buffer, MDTP_DELTA_KEEP, keep);
+            keep = 0;
+        }
+
+        if (mdtp_delta_same_node(old_level, new_level)) {
+            if (sdk_mdtp_reader_type(new_level) == MDTP_NODE_CONTAINER &&
+                depth + 1 < MDTP_MAX_DEPTH) {
+                // Changed container: operations on its children
+                MdtpReader old_child;
+                MdtpReader new_child;
+
+                mdtp_delta_write_count(buffer, MDTP_DELTA_MERGE, 0);
+
+                size_t size_offset = buffer->size - 4;
+
+                sdk_mdtp_reader_enter_container(old_level, &old_child);
+                sdk_mdtp_reader_enter_container(new_level, &new_child);
+                mdtp_delta_encode(buffer, &old_child, &new_child, depth + 1);
+
+                if (buffer->status == SDK_OK) {
+                    size_t size = buffer->size - size_offset - 4;
+
+                    if (size > UINT32_MAX) {
+                        buffer->status = SDK_OTHER_ERROR;
+                    } else {
+                        write_uint32_be(buffer->data, size_offset, (uint32_t)size);
+                    }
+                }
+            } else {
+                // Changed value
+                mdtp_buffer_write(buffer, &(uint8_t){MDTP_DELTA_REPLACE}, 1);
+                mdtp_buffer_write(buffer, new_node, new_size);
+            }
+
+            has_old = sdk_mdtp_reader_next(old_level);
+            has_new = sdk_mdtp_reader_next(new_level);
+            continue;
+        }
+
+        uint32_t inserted = mdtp_delta_find(old_level, *new_level);
+        uint32_t removed = inserted != 0 ? 0 : mdtp_delta_find(new_level, *old_level);
+
+        if (inserted != 0) {
+            // New nodes before the old one
+            for (uint32_t i = 0; i < inserted && has_new; ++i) {
+                new_node = sdk_mdtp_reader_node(new_level, &new_size);
+                mdtp_buffer_write(buffer, new_node, new_size);
+                has_new = sdk_mdtp_reader_next(new_level);
+            }
+        } else if (removed != 0) {
+            // Old nodes before the new one are gone
+            mdtp_delta_write_count(buffer, MDTP_DELTA_REMOVE, removed);
+
+            for (uint32_t i = 0; i < removed && has_old; ++i) {
+                has_old = sdk_mdtp_reader_next(old_level);
+            }
+        } else {
+            mdtp_buffer_write(buffer, &(uint8_t){MDTP_DELTA_REPLACE}, 1);
+            mdtp_buffer_write(buffer, new_node, new_size);
+            has_old = sdk_mdtp_reader_next(old_level);
+            has_new = sdk_mdtp_reader_next(new_level);
+        }
+    }
+
+    // Nodes added at the end go after the kept ones
+    if (has_new && keep != 0) {
+        mdtp_delta_write_count(buffer, MDTP_DELTA_KEEP, keep);
+        keep = 0;
+    }
+
+    for (; has_new && buffer->status == SDK_OK; has_new = sdk_mdtp_reader_next(new_level)) {
+        size_t      new_size;
+        const void *new_node = sdk_mdtp_reader_node(new_level, &new_size);
+
+        mdtp_buffer_write(buffer, new_node, new_size);
+    }
+
+    // Nodes removed from the end. Kept nodes at the end need no operation.
+    uint32_t removed = 0;
+
+    for (; has_old; has_old = sdk_mdtp_reader_next(old_level)) {
+        ++removed;
+    }
+
+    if (removed != 0) {
+        if (keep != 0) {
+            mdtp_delta_write_count(buffer, MDTP_DELTA_KEEP, keep);
+        }
+
+        mdtp_delta_write_count(buffer, MDTP_DELTA_REMOVE, removed);
+    }
+
+    if (sdk_mdtp_reader_status(old_level) != SDK_OK ||
+        sdk_mdtp_reader_status(new_level) != SDK_OK) {
+        buffer->status = SDK_ARGUMENT_PROCESSING_ERROR;
+    }
+}
+
+
+// Apply operations in [offset, end) to children of `old_level`, `0` if they are malformed
+static int mdtp_delta_apply(MdtpBuffer    *buffer,
+                            MdtpReader    *old_level,
+                            const uint8_t *operations,
+                            size_t         offset,
+                            size_t         end,
+                            uint32_t       depth) {
+    int has_old = sdk_mdtp_reader_next(old_level);
+
+    while (offset < end && buffer->status == SDK_OK) {
+        uint8_t type = operations[offset];
+
+        if (type == MDTP_DELTA_KEEP || type == MDTP_DELTA_REMOVE || type == MDTP_DELTA_MERGE) {
+            if (end - offset < 5) {
+                return 0;
+            }
+
+            uint32_t count = read_uint32_be(operations, offset + 1);
+
+            offset += 5;
+
+            if (type == MDTP_DELTA_MERGE) {
+                MdtpReader old_child;
+
+                if (count > end - offset || !has_old || depth + 1 >= MDTP_MAX_DEPTH ||
+                    sdk_mdtp_reader_enter_container(old_level, &old_child) != SDK_OK) {
+                    return 0;
+                }
+
+                // Header of the container: [1 type] [4 name length] [name] [4 payload size]
+                size_t      name_length;
+                const void *node = sdk_mdtp_reader_node(old_level, &(size_t){0});
+
+                sdk_mdtp_reader_name(old_level, &name_length);
+                mdtp_buffer_write(buffer, node, 5 + name_length + 4);
+
+                size_t size_offset = buffer->size - 4;
+
+                if (!mdtp_delta_apply(
+                        buffer, &old_child, operations, offset, offset + count, depth + 1)) {
+                    return 0;
+                }
+
+                if (buffer->status == SDK_OK) {
+                    size_t size = buffer->size - size_offset - 4;
+
+                    if (size > UINT32_MAX) {
+                        return 0;
+                    }
+
+                    write_uint32_be(buffer->data, size_offset, (uint32_t)size);
+                }
+
+                offset += count;
+                has_old = sdk_mdtp_reader_next(old_level);
+                continue;
+            }
+
+            for (uint32_t i = 0; i < count; ++i) {
+                if (!has_old) {
+                    return 0;
+                }
+
+                if (type == MDTP_DELTA_KEEP && !mdtp_delta_copy_node(buffer, old_level)) {
+                    return 0;
+                }
+
+                has_old = sdk_mdtp_reader_next(old_level);
+            }
+
+            continue;
+        }
+
+        // Inserted or replacing node
+        int replace = type == MDTP_DELTA_REPLACE;
+
+        if (replace) {
+            if (!has_old) {
+                return 0;
+            }
+
+            ++offset;
+        }
+
+        MdtpReader node = {
+            .data = operations,
+            .offset = offset,
+            .end = end,
+        };
+
+        if (!sdk_mdtp_reader_next(&node) || !mdtp_delta_copy_node(buffer, &node)) {
+            return 0;
+        }
+
+        offset = node.node_end;
+
+        if (replace) {
+            has_old = sdk_mdtp_reader_next(old_level);
+        }
+    }
+
+    // The rest is kept
+    for (; has_old; has_old = sdk_mdtp_reader_next(old_level)) {
+        if (!mdtp_delta_copy_node(buffer, old_level)) {
+            return 0;
+        }
+    }
+
+    return sdk_mdtp_reader_status(old_level) == SDK_OK;
+}
+
+
+// Append bytes of the current node of reader
+static int mdtp_delta_copy_node(MdtpBuffer *buffer, const MdtpReader *node) {
+    size_t      size;
+    const void *bytes = sdk_mdtp_reader_node(node, &size);
+
+    mdtp_buffer_write(buffer, bytes, size);
+
+    return buffer->status == SDK_OK;
+}
@@ -0,0 +1,620 @@
+/**
+ * @file modules/mdtp_dictionary.c
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#include "../../include/modules/internals/mdtp_dictionary.h"
+#include "../../include/modules/internals/abi.h"
+#include "../../include/modules/internals/imodule.h"
+#include "../../include/modules/internals/mdtp.h"
+#include "../../include/modules/internals/mdtp_builder.h"
+#include "../../include/modules/internals/mdtp_reader.h"
+#include "../../include/modules/internals/memutils.h"
+#include "../../include/modules/internals/utils.h"
+#include "imodule_internal.h"
+#include "mdtp_internal.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MDTP_DICTIONARY_SLOTS (MDTP_DICTIONARY_MAX_ENTRIES * 2) ///< Power of 2
+
+#define MDTP_DICTIONARY_REFERENCE 1 ///< Low bits of a string tag: entry id
+#define MDTP_DICTIONARY_DEFINE 0    ///< Low bits of a string tag: new entry
+#define MDTP_DICTIONARY_LITERAL 2   ///< Low bits of a string tag: string outside the dictionary
+
+typedef struct MdtpDictionaryEntry {
+    uint64_t hash;   ///< FNV-1a hash of the string
+    size_t   offset; ///< Offset of the string in `strings`
+    size_t   length; ///< Count of bytes of the string
+} MdtpDictionaryEntry;
+
+struct MdtpDictionary {
+    uint8_t              enabled; ///< `1` if frames are encoded
+    uint8_t              reset;   ///< `1` if the next frame must start a new dictionary
+    MdtpDictionaryEntry *entries; ///< Entries in the order of ids
+    size_t               count;   ///< Count of entries
+    uint32_t            *slots;   ///< Hash table of entries, `id + 1` or `0` if the slot is free
+    MdtpBuffer           strings; ///< Bytes of all entries
+    MdtpBuffer           frame;   ///< Last encoded frame
+    ABI_MODULE_MDTP_DATA source;  ///< Frame `frame` was encoded from
+};
+
+struct MdtpDictionaryDecoder {
+    MdtpDictionaryEntry *entries; ///< Entries in the order of ids
+    size_t               count;   ///< Count of entries
+    MdtpBuffer           strings; ///< Bytes of all entries
+};
+
+
+// Forward declaration begin
+static void      mdtp_dictionary_write_varint(MdtpBuffer *buffer, uint64_t value);
+static void      mdtp_dictionary_clear(MdtpDictionary *dictionary);
+static void      mdtp_dictionary_write_string(MdtpDictionary *dictionary,
+                                              const char     *string,
+                                              size_t          length);
+static void      mdtp_dictionary_encode(MdtpDictionary *dictionary,
+                                        MdtpReader     *level,
+                                        uint32_t        depth);
+static int       mdtp_dictionary_decode_string(MdtpDictionaryDecoder *decoder,
+                                               MdtpBuffer            *buffer,
+                                               const uint8_t         *frame,
+                                               size_t                *offset,
+                                               size_t                 end);
+static int       mdtp_dictionary_decode_nodes(MdtpDictionaryDecoder *decoder,
+                                              MdtpBuffer            *buffer,
+                                              const uint8_t         *frame,
+                                              size_t                 offset,
+                                              size_t                 end,
+                                              uint32_t               depth);
+// Forward declaration end
+
+
+// Enable dictionary strings
+SDKStatus sdk_mdtp_dictionary_enable(IModule *module) {
+    if (!sdk_utils_server_has_capability(module, ABI_CAPABILITY_DICTIONARY)) {
+        return SDK_OTHER_ERROR;
+    }
+
+    MdtpDictionary *dictionary = module->dictionary;
+
+    if (dictionary == NULL) {
+        dictionary = calloc(1, sizeof(MdtpDictionary));
+
+        if (dictionary == NULL) {
+            return SDK_ALLOCATION_ERROR;
+        }
+
+        dictionary->entries = malloc(MDTP_DICTIONARY_MAX_ENTRIES * sizeof(MdtpDictionaryEntry));
+        dictionary->slots = calloc(MDTP_DICTIONARY_SLOTS, sizeof(uint32_t));
+
+        if (dictionary->entries == NULL || dictionary->slots == NULL) {
+            mdtp_dictionary_destroy(dictionary);
+            return SDK_ALLOCATION_ERROR;
+        }
+
+        module->dictionary = dictionary;
+    }
+
+    dictionary->enabled = 1;
+    dictionary->reset = 1;
+
+    return SDK_OK;
+}
+
+
+// Disable dictionary strings
+void sdk_mdtp_dictionary_disable(IModule *module) {
+    MdtpDictionary *dictionary = module->dictionary;
+
+    if (dictionary == NULL) {
+        return;
+    }
+
+    // The server must not be left with an encoded frame as the last one
+    if (module->mdtp_data.data == dictionary->frame.data) {
+        module->mdtp_data = dictionary->source;
+    }
+
+    dictionary->enabled = 0;
+}
+
+
+// Start a new dictionary
+void sdk_mdtp_dictionary_reset(IModule *module) {
+    if (module->dictionary != NULL) {
+        module->dictionary->reset = 1;
+    }
+}
+
+
+// Make frame to send
+const ABI_MODULE_MDTP_DATA *sdk_mdtp_dictionary_emit(IModule *module) {
+    MdtpDictionary       *dictionary = module->dictionary;
+    ABI_MODULE_MDTP_DATA *data = &module->mdtp_data;
+
+    if (dictionary != NULL && dictionary->enabled) {
+        mdtp_chunk_restore(module);
+        mdtp_crc_restore(module);
+        mdtp_compression_restore(module);
+    }
+
+    // Nothing to encode, or already encoded. Only plain MDTP v1 frames are encoded
+    if (dictionary == NULL || !dictionary->enabled || data->data == NULL ||
+        data->size < MDTP_HEADER_SIZE || data->data == dictionary->frame.data ||
+        read_ubyte_be(data->data, 0) != MDTP_VERSION) {
+        return data;
+    }
+
+    if (dictionary->reset) {
+        mdtp_dictionary_clear(dictionary);
+    }
+
+    MdtpBuffer *frame = &dictionary->frame;
+    MdtpReader  level;
+
+    frame->size = 0;
+    frame->status = sdk_mdtp_reader_init(&level, data->data, data->size);
+
+    mdtp_buffer_claim(frame, MDTP_HEADER_SIZE);
+    mdtp_dictionary_write_varint(frame, dictionary->count);
+    mdtp_dictionary_encode(dictionary, &level, 0);
+
+    if (frame->status != SDK_OK || frame->size - MDTP_HEADER_SIZE > UINT32_MAX) {
+        // Entries added while encoding would not reach the server
+        dictionary->reset = 1;
+        return data;
+    }
+
+    write_ubyte_be(frame->data, 0, MDTP_VERSION | MDTP_FLAG_DICTIONARY);
+    write_uint32_be(frame->data, 1, (uint32_t)(frame->size - MDTP_HEADER_SIZE));
+
+    dictionary->source = *data;
+    *data = (ABI_MODULE_MDTP_DATA){.data = frame->data, .size = (uint32_t)frame->size};
+
+    return data;
+}
+
+
+// Create decoder
+MdtpDictionaryDecoder *sdk_mdtp_dictionary_decoder_create(void) {
+    MdtpDictionaryDecoder *decoder = calloc(1, sizeof(MdtpDictionaryDecoder));
+
+    if (decoder == NULL) {
+        return NULL;
+    }
+
+    decoder->entries = malloc(MDTP_DICTIONARY_MAX_ENTRIES * sizeof(MdtpDictionaryEntry));
+
+    if (decoder->entries == NULL) {
+        free(decoder);
+        return NULL;
+    }
+
+    return decoder;
+}
+
+
+// Destroy decoder
+void sdk_mdtp_dictionary_decoder_destroy(MdtpDictionaryDecoder *decoder) {
+    if (decoder == NULL) {
+        return;
+    }
+
+    free(decoder->entries);
+    free(decoder->strings.data);
+    free(decoder);
+}
+
+
+// Decode received frame
+void *sdk_mdtp_dictionary_decode(MdtpDictionaryDecoder *decoder,
+                                 const void            *frame,
+                                 size_t                 frame_size,
+                                 size_t                *size) {
+    MdtpBuffer buffer = {0};
+    uint8_t    first = frame != NULL && frame_size != 0 ? read_ubyte_be(frame, 0) : 0;
+
+    if ((first & MDTP_FLAG_DICTIONARY) == 0) {
+        // Plain frame
+        if (sdk_mdtp_validate(frame, frame_size) != SDK_OK) {
+            return NULL;
+        }
+
+        mdtp_buffer_write(&buffer, frame, frame_size);
+    } else {
+        uint64_t known = 0;
+        size_t   offset = MDTP_HEADER_SIZE;
+        size_t   read = 0;
+
+        if (first == (MDTP_VERSION | MDTP_FLAG_DICTIONARY) && frame_size >= MDTP_HEADER_SIZE &&
+            read_uint32_be(frame, 1) == frame_size - MDTP_HEADER_SIZE) {
+            read = read_varint(frame, offset, frame_size, &known);
+        }
+
+        // Entries defined after the known ones are dropped
+        if (read != 0 && known <= decoder->count) {
+            if (known < decoder->count) {
+                decoder->strings.size = decoder->entries[known].offset;
+                decoder->count = (size_t)known;
+            }
+
+            mdtp_buffer_claim(&buffer, MDTP_HEADER_SIZE);
+
+            if (!mdtp_dictionary_decode_nodes(
+                    decoder, &buffer, frame, offset + read, frame_size, 0) ||
+                buffer.size - MDTP_HEADER_SIZE > UINT32_MAX) {
+                buffer.status = SDK_ARGUMENT_PROCESSING_ERROR;
+            }
+
+            if (buffer.status == SDK_OK) {
+                write_ubyte_be(buffer.data, 0, MDTP_VERSION);
+                write_uint32_be(buffer.data, 1, (uint32_t)(buffer.size - MDTP_HEADER_SIZE));
+            }
+        } else {
+            buffer.status = SDK_ARGUMENT_PROCESSING_ERROR;
+        }
+    }
+
+    if (buffer.status != SDK_OK || sdk_mdtp_validate(buffer.data, buffer.size) != SDK_OK) {
+        decoder->count = 0;
+        decoder->strings.size = 0;
+        decoder->strings.status = SDK_OK;
+        free(buffer.data);
+        return NULL;
+    }
+
+    *size = buffer.size;
+
+    return buffer.data;
+}
+
+
+// Check if dictionary strings are enabled
+int mdtp_dictionary_enabled(const IModule *module) {
+    return module->dictionary != NULL && module->dictionary->enabled;
+}
+
+
+// Destroy dictionary of a module
+void mdtp_dictionary_destroy(MdtpDictionary *dictionary) {
+    if (dictionary == NULL) {
+        return;
+    }
+
+    free(dictionary->entries);
+    free(dictionary->slots);
+    free(dictionary->strings.data);
+    free(dictionary->frame.data);
+    free(dictionary);
+}
+
+
+// Append varint to buffer
+static void mdtp_dictionary_write_varint(MdtpBuffer *buffer, uint64_t value) {
+    uint8_t *cursor = mdtp_buffer_claim(buffer, varint_size(value));
+
+    if (cursor != NULL) {
+        write_varint(cursor, 0, value);
+    }
+}
+
+
+// Drop all entries
+static void mdtp_dictionary_clear(MdtpDictionary *dictionary) {
+    memset(dictionary->slots, 0, MDTP_DICTIONARY_SLOTS * sizeof(uint32_t));
+    dictionary->count = 0;
+    dictionary->strings.size = 0;
+    dictionary->strings.status = SDK_OK;
+    dictionary->reset = 0;
+}
+
+
+// Append string as a reference, a definition or a literal
+static void mdtp_dictionary_write_string(MdtpDictionary *dictionary,
+                                         const char     *string,
+                                         size_t          length) {
+    MdtpBuffer *frame = &dictionary->frame;
+
+    if (length <= MDTP_DICTIONARY_MAX_STRING) {
+        uint64_t hash = mdtp_fnv_hash(MDTP_FNV_OFFSET, string, length);
+        size_t   slot = hash & (MDTP_DICTIONARY_SLOTS - 1);
+
+        // There is always a free slot, as there are twice as many slots as entries
+        for (; dictionary->slots[slot] != 0; slot = (slot + 1) & (MDTP_DICTIONARY_SLOTS - 1)) {
+            size_t                     id = dictionary->slots[slot] - 1;
+            const MdtpDictionaryEntry *entry = &dictionary->entries[id];
+
+            if (entry->hash == hash && entry->length == length &&
+                memcmp(dictionary->strings.data + entry->offset, string, length) == 0) {
+                mdtp_dictionary_write_varint(frame, (id << 1) | MDTP_DICTIONARY_REFERENCE);
+                return;
+            }
+        }
+
+        if (dictionary->count < MDTP_DICTIONARY_MAX_ENTRIES) {
+            size_t offset = dictionary->strings.size;
+
+            mdtp_buffer_write(&dictionary->strings, string, length);
+
+            if (dictionary->strings.status != SDK_OK) {
+                frame->status = dictionary->strings.status;
+                return;
+            }
+
+            dictionary->entries[dictionary->count] = (MdtpDictionaryEntry){
+                .hash = hash,
+                .offset = offset,
+                .length = length,
+            };
+            dictionary->slots[slot] = (uint32_t)++dictionary->count;
+
+            mdtp_dictionary_write_varint(frame, (length << 2) | MDTP_DICTIONARY_DEFINE);
+            mdtp_buffer_write(frame, string, length);
+            return;
+        }
+    }
+
+    mdtp_dictionary_write_varint(frame, (length << 2) | MDTP_DICTIONARY_LITERAL);
+    mdtp_buffer_write(frame, string, length);
+}
+
+
+// Encode nodes of `level`
+static void mdtp_dictionary_encode(MdtpDictionary *dictionary,
+                                   MdtpReader     *level,
+                                   uint32_t        depth) {
+    MdtpBuffer *frame = &dictionary->frame;
+
+    while (frame->status == SDK_OK && sdk_mdtp_reader_next(level)) {
+        size_t      length;
+        const char *name = sdk_mdtp_reader_name(level, &length);
+        uint8_t     type = sdk_mdtp_reader_type(level);
+
+        mdtp_buffer_write(frame, &type, 1);
+        mdtp_dictionary_write_string(dictionary, name, length);
+
+        if (type == MDTP_NODE_VALUE) {
+            const char *units = sdk_mdtp_reader_units(level, &length);
+            mdtp_dictionary_write_string(dictionary, units, length);
+
+            const char *value = sdk_mdtp_reader_value(level, &length);
+            uint8_t    *cursor = mdtp_buffer_claim(frame, 4);
+
+            if (cursor != NULL) {
+                write_uint32_be(cursor, 0, (uint32_t)length);
+                mdtp_buffer_write(frame, value, length);
+            }
+
+            continue;
+        }
+
+        if (type == MDTP_NODE_TABLE) {
+            // [4 payload size] [payload] as they are
+            mdtp_buffer_write(frame, level->data + level->value - 4, 4 + level->value_length);
+            continue;
+        }
+
+        if (type == MDTP_NODE_ARRAY) {
+            const char *units = sdk_mdtp_reader_units(level, &length);
+            mdtp_dictionary_write_string(dictionary, units, length);
+
+            // [1 element type] [4 count] [elements] as they are
+            mdtp_buffer_write(frame, level->data + level->value - 5, 5 + level->value_length);
+            continue;
+        }
+
+        if (type == MDTP_NODE_HISTOGRAM) {
+            const char *units = sdk_mdtp_reader_units(level, &length);
+            mdtp_dictionary_write_string(dictionary, units, length);
+
+            // [4 bound count] [bounds] [counts] [8 sum] as they are
+            mdtp_buffer_write(frame,
+                                  level->data + level->value - 4,
+                                  level->node_end - level->value + 4);
+            continue;
+        }
+
+        // Container: its payload size is known after its children are written
+        MdtpReader child;
+
+        if (depth + 1 >= MDTP_MAX_DEPTH ||
+            sdk_mdtp_reader_enter_container(level, &child) != SDK_OK) {
+            frame->status = SDK_ARGUMENT_PROCESSING_ERROR;
+            return;
+        }
+
+        if (mdtp_buffer_claim(frame, 4) == NULL) {
+            return;
+        }
+
+        size_t size_offset = frame->size - 4;
+
+        mdtp_dictionary_encode(dictionary, &child, depth + 1);
+
+        if (frame->status == SDK_OK) {
+            size_t size = frame->size - size_offset - 4;
+
+            if (size > UINT32_MAX) {
+                frame->status = SDK_OTHER_ERROR;
+                return;
+            }
+
+            write_uint32_be(frame->data, size_offset, (uint32_t)size);
+        }
+    }
+
+    if (sdk_mdtp_reader_status(level) != SDK_OK && frame->status == SDK_OK) {
+        frame->status = SDK_ARGUMENT_PROCESSING_ERROR;
+    }
+}
+
+
+// Decode string at `*offset` and append it as [4 length] [string], `0` if it is malformed
+static int mdtp_dictionary_decode_string(MdtpDictionaryDecoder *decoder,
+                                         MdtpBuffer            *buffer,
+                                         const uint8_t         *frame,
+                                         size_t                *offset,
+                                         size_t                 end) {
+    uint64_t tag;
+    size_t   read = read_varint(frame, *offset, end, &tag);
+
+    if (read == 0) {
+        return 0;
+    }
+
+    *offset += read;
+
+    const void *string;
+    size_t      length;
+
+    if ((tag & 1) == MDTP_DICTIONARY_REFERENCE) {
+        if ((tag >> 1) >= decoder->count) {
+            return 0;
+        }
+
+        const MdtpDictionaryEntry *entry = &decoder->entries[tag >> 1];
+
+        string = decoder->strings.data + entry->offset;
+        length = entry->length;
+    } else {
+        if ((tag >> 2) > end - *offset) {
+            return 0;
+        }
+
+        string = frame + *offset;
+        length = (size_t)(tag >> 2);
+        *offset += length;
+
+        if ((tag & 3) == MDTP_DICTIONARY_DEFINE) {
+            if (length > MDTP_DICTIONARY_MAX_STRING ||
+                decoder->count == MDTP_DICTIONARY_MAX_ENTRIES) {
+                return 0;
+            }
+
+            decoder->entries[decoder->count++] = (MdtpDictionaryEntry){
+                .offset = decoder->strings.size,
+                .length = length,
+            };
+            mdtp_buffer_write(&decoder->strings, string, length);
+
+            if (decoder->strings.status != SDK_OK) {
+                return 0;
+            }
+        }
+    }
+
+    uint8_t *cursor = mdtp_buffer_claim(buffer, 4);
+
+    if (cursor != NULL) {
+        write_uint32_be(cursor, 0, (uint32_t)length);
+        mdtp_buffer_write(buffer, string, length);
+    }
+
+    return buffer->status == SDK_OK;
+}
+
+
+// Decode nodes in [offset, end) and append them, `0` if they are malformed
+static int mdtp_dictionary_decode_nodes(MdtpDictionaryDecoder *decoder,
+                                        MdtpBuffer            *buffer,
+                                        const uint8_t         *frame,
+                                        size_t                 offset,
+                                        size_t                 end,
+                                        uint32_t               depth) {
+    while (offset < end) {
+        uint8_t type = frame[offset++];
+
+        if (type != MDTP_NODE_CONTAINER && type != MDTP_NODE_VALUE && type != MDTP_NODE_TABLE &&
+            type != MDTP_NODE_ARRAY && type != MDTP_NODE_HISTOGRAM) {
+            return 0;
+        }
+
+        mdtp_buffer_write(buffer, &type, 1);
+
+        if (!mdtp_dictionary_decode_string(decoder, buffer, frame, &offset, end)) {
+            return 0;
+        }
+
+        if (type == MDTP_NODE_VALUE) {
+            if (!mdtp_dictionary_decode_string(decoder, buffer, frame, &offset, end) ||
+                end - offset < 4 || read_uint32_be(frame, offset) > end - offset - 4) {
+                return 0;
+            }
+
+            size_t length = 4 + read_uint32_be(frame, offset);
+
+            mdtp_buffer_write(buffer, frame + offset, length);
+            offset += length;
+            continue;
+        }
+
+        if (type == MDTP_NODE_ARRAY) {
+            if (!mdtp_dictionary_decode_string(decoder, buffer, frame, &offset, end) ||
+                end - offset < 5 || read_uint32_be(frame, offset + 1) > (end - offset - 5) / 8) {
+                return 0;
+            }
+
+            size_t length = 5 + (size_t)read_uint32_be(frame, offset + 1) * 8;
+
+            mdtp_buffer_write(buffer, frame + offset, length);
+            offset += length;
+            continue;
+        }
+
+        if (type == MDTP_NODE_HISTOGRAM) {
+            if (!mdtp_dictionary_decode_string(decoder, buffer, frame, &offset, end) ||
+                end - offset < 4 || read_uint32_be(frame, offset) > MDTP_HISTOGRAM_MAX_BOUNDS ||
+                4 + (size_t)read_uint32_be(frame, offset) * 16 + 16 > end - offset) {
+                return 0;
+            }
+
+            size_t length = 4 + (size_t)read_uint32_be(frame, offset) * 16 + 16;
+
+            mdtp_buffer_write(buffer, frame + offset, length);
+            offset += length;
+            continue;
+        }
+
+        if (type == MDTP_NODE_TABLE) {
+            if (end - offset < 4 || read_uint32_be(frame, offset) > end - offset - 4) {
+                return 0;
+            }
+
+            size_t length = 4 + read_uint32_be(frame, offset);
+
+            mdtp_buffer_write(buffer, frame + offset, length);
+            offset += length;
+            continue;
+        }
+
+        if (end - offset < 4 || read_uint32_be(frame, offset) > end - offset - 4 ||
+            depth + 1 >= MDTP_MAX_DEPTH || mdtp_buffer_claim(buffer, 4) == NULL) {
+            return 0;
+        }
+
+        size_t payload = read_uint32_be(frame, offset);
+        size_t size_offset = buffer->size - 4;
+
+        offset += 4;
+
+        if (!mdtp_dictionary_decode_nodes(
+                decoder, buffer, frame, offset, offset + payload, depth + 1)) {
+            return 0;
+        }
+
+        size_t size = buffer->size - size_offset - 4;
+
+        if (size > UINT32_MAX) {
+            return 0;
+        }
+
+        write_uint32_be(buffer->data, size_offset, (uint32_t)size);
+        offset += payload;
+    }
+
+    return buffer->status == SDK_OK;
+}
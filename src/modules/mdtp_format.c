@@ -0,0 +1,539 @@
+/**
+ * @file modules/mdtp_format.c
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#include "../../include/modules/internals/mdtp_format.h"
+#include "mdtp_format_tables.h"
+#include <limits.h>
+#include <locale.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MDTP_F64_FIXED_EXPONENT_LIMIT 17 ///< Shortest text uses `e` notation from this exponent
+#define MDTP_F64_MANTISSA_BITS 52        ///< Explicit mantissa bits of IEEE 754 double
+#define MDTP_F64_EXPONENT_BIAS 1023      ///< Exponent bias of IEEE 754 double
+
+// floor(log10(2^e)), valid for e in [0, 1650]
+#define MDTP_LOG10_POW2(e) ((uint32_t)(((e) * 78913) >> 18))
+// floor(log10(5^e)), valid for e in [0, 2620]
+#define MDTP_LOG10_POW5(e) ((uint32_t)(((e) * 732923) >> 20))
+// Bit length of 5^e, valid for e in [0, 3528]
+#define MDTP_POW5_BITS(e) ((int32_t)((((e) * 1217359) >> 19) + 1))
+
+
+/**
+ * @brief Two-digit decimal strings from "00" to "99"
+ */
+static const char MDTP_DIGIT_PAIRS[200] = {
+    '0', '0', '0', '1', '0', '2', '0', '3', '0', '4', '0', '5', '0', '6', '0', '7', '0', '8', '0',
+    '9', '1', '0', '1', '1', '1', '2', '1', '3', '1', '4', '1', '5', '1', '6', '1', '7', '1', '8',
+    '1', '9', '2', '0', '2', '1', '2', '2', '2', '3', '2', '4', '2', '5', '2', '6', '2', '7', '2',
+    '8', '2', '9', '3', '0', '3', '1', '3', '2', '3', '3', '3', '4', '3', '5', '3', '6', '3', '7',
+    '3', '8', '3', '9', '4', '0', '4', '1', '4', '2', '4', '3', '4', '4', '4', '5', '4', '6', '4',
+    '7', '4', '8', '4', '9', '5', '0', '5', '1', '5', '2', '5', '3', '5', '4', '5', '5', '5', '6',
+    '5', '7', '5', '8', '5', '9', '6', '0', '6', '1', '6', '2', '6', '3', '6', '4', '6', '5', '6',
+    '6', '6', '7', '6', '8', '6', '9', '7', '0', '7', '1', '7', '2', '7', '3', '7', '4', '7', '5',
+    '7', '6', '7', '7', '7', '8', '7', '9', '8', '0', '8', '1', '8', '2', '8', '3', '8', '4', '8',
+    '5', '8', '6', '8', '7', '8', '8', '8', '9', '9', '0', '9', '1', '9', '2', '9', '3', '9', '4',
+    '9', '5', '9', '6', '9', '7', '9', '8', '9', '9'};
+
+/**
+ * @brief Powers of 10 that are exact both as `double` and as `uint64_t`
+ */
+static const double MDTP_POW10_F64[MDTP_F64_MAX_PRECISION + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17};
+
+static const uint64_t MDTP_POW10_U64[MDTP_F64_MAX_PRECISION + 1] = {1ull,
+                                                                    10ull,
+                                                                    100ull,
+                                                                    1000ull,
+                                                                    10000ull,
+                                                                    100000ull,
+                                                                    1000000ull,
+                                                                    10000000ull,
+                                                                    100000000ull,
+                                                                    1000000000ull,
+                                                                    10000000000ull,
+                                                                    100000000000ull,
+                                                                    1000000000000ull,
+                                                                    10000000000000ull,
+                                                                    100000000000000ull,
+                                                                    1000000000000000ull,
+                                                                    10000000000000000ull,
+                                                                    100000000000000000ull};
+
+
+// Forward declaration begin
+static void     mdtp_write_digits(char *end, uint64_t value);
+static size_t   mdtp_format_fixed(char *buffer, double value, int precision);
+static size_t   mdtp_format_shortest(char *buffer, double value);
+static uint64_t mdtp_mul_shift_64(uint64_t m, const uint64_t *multiplier, int32_t shift);
+#if !defined(__SIZEOF_INT128__)
+static uint64_t mdtp_umul128(uint64_t a, uint64_t b, uint64_t *high);
+#endif
+static uint32_t mdtp_pow5_factor(uint64_t value);
+static uint64_t mdtp_ryu_d2d(uint64_t ieee_mantissa, uint32_t ieee_exponent, int32_t *exponent);
+static size_t   mdtp_format_decimal(char       *buffer,
+                                    int         negative,
+                                    const char *digits,
+                                    size_t      count,
+                                    int         exponent);
+// Forward declaration end
+
+
+// Count decimal digits
+size_t sdk_mdtp_format_u64_length(uint64_t value) {
+    size_t length = 1;
+
+    for (;;) {
+        if (value < 10) {
+            return length;
+        }
+        if (value < 100) {
+            return length + 1;
+        }
+        if (value < 1000) {
+            return length + 2;
+        }
+        if (value < 10000) {
+            return length + 3;
+        }
+
+        value /= 10000;
+        length += 4;
+    }
+}
+
+
+// Format unsigned integer
+size_t sdk_mdtp_format_u64(char *buffer, uint64_t value) {
+    size_t length = sdk_mdtp_format_u64_length(value);
+
+    mdtp_write_digits(buffer + length, value);
+
+    return length;
+}
+
+
+// Format signed integer
+size_t sdk_mdtp_format_i64(char *buffer, int64_t value) {
+    if (value >= 0) {
+        return sdk_mdtp_format_u64(buffer, (uint64_t)value);
+    }
+
+    // Negate in unsigned arithmetic, so INT64_MIN does not overflow
+    buffer[0] = '-';
+
+    return 1 + sdk_mdtp_format_u64(buffer + 1, 0 - (uint64_t)value);
+}
+
+
+// Format floating point number
+size_t sdk_mdtp_format_f64(char *buffer, double value, int precision) {
+    if (precision < 0) {
+        return mdtp_format_shortest(buffer, value);
+    }
+
+    if (precision > MDTP_F64_MAX_PRECISION) {
+        precision = MDTP_F64_MAX_PRECISION;
+    }
+
+    return mdtp_format_fixed(buffer, value, precision);
+}
+
+
+// Write digits of `value` right to left, ending right before `end`
+static void mdtp_write_digits(char *end, uint64_t value) {
+    while (value >= 100) {
+        size_t pair = (size_t)(value % 100) * 2;
+        value /= 100;
+        end -= 2;
+        memcpy(end, MDTP_DIGIT_PAIRS + pair, 2);
+    }
+
+    if (value >= 10) {
+        memcpy(end - 2, MDTP_DIGIT_PAIRS + value * 2, 2);
+    } else {
+        end[-1] = (char)('0' + value);
+    }
+}
+
+
+// Format with fixed count of fractional digits, same as "%.*f"
+static size_t mdtp_format_fixed(char *buffer, double value, int precision) {
+    double scaled = fabs(value) * MDTP_POW10_F64[precision];
+
+    // Fast path: the scaled value is an exact integer plus an exact fraction, so it can be rounded
+    // in integers. The product itself is off by at most half an ulp, so only fractions that are
+    // clearly away from the .5 tie are rounded here. Ties, huge numbers, NaN and inf go to printf.
+    if (scaled < 0x1p53) {
+        double integral = (double)(uint64_t)scaled;
+        double fraction = scaled - integral;
+
+        if (fabs(fraction - 0.5) > scaled * 0x1p-51) {
+            uint64_t rounded = (uint64_t)integral + (fraction > 0.5);
+            uint64_t integer_part = rounded / MDTP_POW10_U64[precision];
+            uint64_t fractional_part = rounded % MDTP_POW10_U64[precision];
+            size_t   length = 0;
+
+            if (signbit(value)) {
+                buffer[length++] = '-';
+            }
+
+            length += sdk_mdtp_format_u64(buffer + length, integer_part);
+
+            if (precision > 0) {
+                buffer[length++] = '.';
+
+                // Fractional part is zero-padded to `precision` digits
+                memset(buffer + length, '0', (size_t)precision);
+                mdtp_write_digits(buffer + length + precision, fractional_part);
+                length += (size_t)precision;
+            }
+
+            return length;
+        }
+    }
+
+    // The decimal point of the current locale may take several bytes
+    char text[MDTP_F64_MAX_LENGTH + MB_LEN_MAX + 1];
+    int  length = snprintf(text, sizeof(text), "%.*f", precision, value);
+
+    if (length < 0 || (size_t)length >= sizeof(text)) {
+        return 0;
+    }
+
+    // printf writes the decimal point of the current locale, MDTP always uses '.'
+    const char *point = localeconv()->decimal_point;
+    size_t      point_length = strlen(point);
+    char       *found = point_length != 0 && strcmp(point, ".") != 0 ? strstr(text, point) : NULL;
+
+    if (found != NULL) {
+        *found = '.';
+        memmove(found + 1,
+                found + point_length,
+                (size_t)length - (size_t)(found - text) - point_length);
+        length -= (int)point_length - 1;
+    }
+
+    memcpy(buffer, text, (size_t)length);
+
+    return (size_t)length;
+}
+
+
+// Format shortest text that reads back as the same value
+static size_t mdtp_format_shortest(char *buffer, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    int      negative = (int)(bits >> 63);
+    uint32_t ieee_exponent = (uint32_t)(bits >> MDTP_F64_MANTISSA_BITS) & 0x7FFu;
+    uint64_t ieee_mantissa = bits & ((1ull << MDTP_F64_MANTISSA_BITS) - 1);
+
+    if (ieee_exponent == 0x7FFu) {
+        const char *text = ieee_mantissa != 0 ? (negative ? "-nan" : "nan")
+                                              : (negative ? "-inf" : "inf");
+        size_t      length = strlen(text);
+
+        memcpy(buffer, text, length);
+
+        return length;
+    }
+
+    if (ieee_exponent == 0 && ieee_mantissa == 0) {
+        return mdtp_format_decimal(buffer, negative, "0", 1, 0);
+    }
+
+    int32_t  exponent;
+    uint64_t output = mdtp_ryu_d2d(ieee_mantissa, ieee_exponent, &exponent);
+
+    char   digits[MDTP_U64_MAX_LENGTH];
+    size_t count = sdk_mdtp_format_u64(digits, output);
+
+    // `exponent` is the power of 10 of the last digit, the layout wants the one of the first digit
+    exponent += (int32_t)count - 1;
+
+    // Remove trailing zeros
+    while (count > 1 && digits[count - 1] == '0') {
+        --count;
+    }
+
+    return mdtp_format_decimal(buffer, negative, digits, count, exponent);
+}
+
+
+// Multiply 64-bit `m` by 128-bit `multiplier` and shift the 192-bit product right by `shift`
+static uint64_t mdtp_mul_shift_64(uint64_t m, const uint64_t *multiplier, int32_t shift) {
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 uint128;
+
+    uint128 low = (uint128)m * multiplier[0];
+    uint128 high = (uint128)m * multiplier[1];
+
+    return (uint64_t)(((low >> 64) + high) >> (shift - 64));
+#else
+    uint64_t high1;
+    uint64_t low1 = mdtp_umul128(m, multiplier[1], &high1);
+    uint64_t high0;
+    mdtp_umul128(m, multiplier[0], &high0);
+
+    uint64_t sum = high0 + low1;
+
+    if (sum < high0) {
+        ++high1; // Carry
+    }
+
+    uint32_t distance = (uint32_t)(shift - 64); // Always in (0, 64)
+
+    return (high1 << (64 - distance)) | (sum >> distance);
+#endif
+}
+
+
+#if !defined(__SIZEOF_INT128__)
+// Full 64 x 64 -> 128 bit multiplication without compiler support
+static uint64_t mdtp_umul128(uint64_t a, uint64_t b, uint64_t *high) {
+    uint64_t a_low = (uint32_t)a;
+    uint64_t a_high = a >> 32;
+    uint64_t b_low = (uint32_t)b;
+    uint64_t b_high = b >> 32;
+
+    uint64_t low_low = a_low * b_low;
+    uint64_t low_high = a_low * b_high;
+    uint64_t high_low = a_high * b_low;
+    uint64_t high_high = a_high * b_high;
+
+    uint64_t middle1 = high_low + (low_low >> 32);
+    uint64_t middle2 = low_high + (uint32_t)middle1;
+
+    *high = high_high + (middle1 >> 32) + (middle2 >> 32);
+
+    return (middle2 << 32) | (uint32_t)low_low;
+}
+#endif
+
+
+// Count how many times `value` is divisible by 5
+static uint32_t mdtp_pow5_factor(uint64_t value) {
+    uint32_t count = 0;
+
+    while (value % 5 == 0) {
+        value /= 5;
+        ++count;
+    }
+
+    return count;
+}
+
+
+// Shortest decimal `output` * 10^`exponent` that rounds to the double with the given bits (Ryu)
+static uint64_t mdtp_ryu_d2d(uint64_t ieee_mantissa, uint32_t ieee_exponent, int32_t *exponent) {
+    int32_t  e2;
+    uint64_t m2;
+
+    if (ieee_exponent == 0) {
+        // Subnormal
+        e2 = 1 - MDTP_F64_EXPONENT_BIAS - MDTP_F64_MANTISSA_BITS - 2;
+        m2 = ieee_mantissa;
+    } else {
+        e2 = (int32_t)ieee_exponent - MDTP_F64_EXPONENT_BIAS - MDTP_F64_MANTISSA_BITS - 2;
+        m2 = (1ull << MDTP_F64_MANTISSA_BITS) | ieee_mantissa;
+    }
+
+    // Interval bounds belong to the interval if the mantissa is even (round-half-even on read)
+    int accept_bounds = (m2 & 1) == 0;
+
+    // The value and its rounding interval are [mv - 1 - mm_shift, mv + 2] * 2^e2 / 4. The lower
+    // half-interval is shorter at powers of 2, where the exponent changes
+    uint64_t mv = 4 * m2;
+    uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+
+    // Convert the interval to decimal: vr, vp and vm are its middle, upper and lower bounds
+    // multiplied by 10^-e10
+    uint64_t vr, vp, vm;
+    int32_t  e10;
+    int      vm_is_trailing_zeros = 0;
+    int      vr_is_trailing_zeros = 0;
+
+    if (e2 >= 0) {
+        uint32_t q = MDTP_LOG10_POW2(e2) - (e2 > 3);
+        int32_t  k = MDTP_POW5_INV_BITCOUNT + MDTP_POW5_BITS((int32_t)q) - 1;
+        int32_t  i = -e2 + (int32_t)q + k;
+
+        e10 = (int32_t)q;
+        vr = mdtp_mul_shift_64(4 * m2, MDTP_POW5_INV_SPLIT[q], i);
+        vp = mdtp_mul_shift_64(4 * m2 + 2, MDTP_POW5_INV_SPLIT[q], i);
+        vm = mdtp_mul_shift_64(4 * m2 - 1 - mm_shift, MDTP_POW5_INV_SPLIT[q], i);
+
+        // Only small q can make the bounds exact multiples of 10^q
+        if (q <= 21) {
+            if (mv % 5 == 0) {
+                vr_is_trailing_zeros = mdtp_pow5_factor(mv) >= q;
+            } else if (accept_bounds) {
+                vm_is_trailing_zeros = mdtp_pow5_factor(mv - 1 - mm_shift) >= q;
+            } else {
+                vp -= mdtp_pow5_factor(mv + 2) >= q;
+            }
+        }
+    } else {
+        uint32_t q = MDTP_LOG10_POW5(-e2) - (-e2 > 1);
+        int32_t  i = -e2 - (int32_t)q;
+        int32_t  k = MDTP_POW5_BITS(i) - MDTP_POW5_BITCOUNT;
+        int32_t  j = (int32_t)q - k;
+
+        e10 = (int32_t)q + e2;
+        vr = mdtp_mul_shift_64(4 * m2, MDTP_POW5_SPLIT[i], j);
+        vp = mdtp_mul_shift_64(4 * m2 + 2, MDTP_POW5_SPLIT[i], j);
+        vm = mdtp_mul_shift_64(4 * m2 - 1 - mm_shift, MDTP_POW5_SPLIT[i], j);
+
+        if (q <= 1) {
+            // mv has at least q trailing zero bits, so {vr, vp, vm} are trailing zeros
+            vr_is_trailing_zeros = 1;
+
+            if (accept_bounds) {
+                vm_is_trailing_zeros = mm_shift == 1;
+            } else {
+                --vp;
+            }
+        } else if (q < 63) {
+            vr_is_trailing_zeros = (mv & ((1ull << q) - 1)) == 0;
+        }
+    }
+
+    // Remove digits while the interval still contains a shorter number
+    int32_t  removed = 0;
+    uint32_t last_removed_digit = 0;
+    uint64_t output;
+
+    if (vm_is_trailing_zeros || vr_is_trailing_zeros) {
+        // Rare exact case: track exactness of the removed digits
+        while (vp / 10 > vm / 10) {
+            vm_is_trailing_zeros &= vm % 10 == 0;
+            vr_is_trailing_zeros &= last_removed_digit == 0;
+            last_removed_digit = (uint32_t)(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+
+        if (vm_is_trailing_zeros) {
+            while (vm % 10 == 0) {
+                vr_is_trailing_zeros &= last_removed_digit == 0;
+                last_removed_digit = (uint32_t)(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                ++removed;
+            }
+        }
+
+        if (vr_is_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0) {
+            last_removed_digit = 4; // Exactly halfway: round to even
+        }
+
+        output = vr + ((vr == vm && (!accept_bounds || !vm_is_trailing_zeros)) ||
+                       last_removed_digit >= 5);
+    } else {
+        // Common case
+        int round_up = 0;
+
+        if (vp / 100 > vm / 100) {
+            round_up = vr % 100 >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+
+        while (vp / 10 > vm / 10) {
+            round_up = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+
+        output = vr + (vr == vm || round_up);
+    }
+
+    *exponent = e10 + removed;
+
+    return output;
+}
+
+
+// Lay out significant digits `d.ddd` * 10^`exponent` in fixed or exponential notation
+static size_t mdtp_format_decimal(char       *buffer,
+                                  int         negative,
+                                  const char *digits,
+                                  size_t      count,
+                                  int         exponent) {
+    size_t length = 0;
+
+    if (negative) {
+        buffer[length++] = '-';
+    }
+
+    if (exponent < -5 || exponent >= MDTP_F64_FIXED_EXPONENT_LIMIT) {
+        // d.ddde±XX
+        buffer[length++] = digits[0];
+
+        if (count > 1) {
+            buffer[length++] = '.';
+            memcpy(buffer + length, digits + 1, count - 1);
+            length += count - 1;
+        }
+
+        buffer[length++] = 'e';
+        buffer[length++] = exponent < 0 ? '-' : '+';
+
+        uint64_t magnitude = (uint64_t)(exponent < 0 ? -exponent : exponent);
+
+        if (magnitude < 10) {
+            buffer[length++] = '0';
+        }
+
+        length += sdk_mdtp_format_u64(buffer + length, magnitude);
+
+        return length;
+    }
+
+    if (exponent < 0) {
+        // 0.000ddd
+        size_t zeros = (size_t)(-exponent - 1);
+
+        memcpy(buffer + length, "0.", 2);
+        length += 2;
+        memset(buffer + length, '0', zeros);
+        length += zeros;
+        memcpy(buffer + length, digits, count);
+
+        return length + count;
+    }
+
+    size_t integer_digits = (size_t)exponent + 1;
+
+    if (count <= integer_digits) {
+        // ddd000
+        memcpy(buffer + length, digits, count);
+        length += count;
+        memset(buffer + length, '0', integer_digits - count);
+
+        return length + integer_digits - count;
+    }
+
+    // ddd.ddd
+    memcpy(buffer + length, digits, integer_digits);
+    length += integer_digits;
+    buffer[length++] = '.';
+    memcpy(buffer + length, digits + integer_digits, count - integer_digits);
+
+    return length + count - integer_digits;
+}
@@ -0,0 +1,340 @@
+/**
+ * @file modules/mdtp_histogram.c
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#include "../../include/modules/internals/mdtp_histogram.h"
+#include "../../include/modules/internals/mdtp.h"
+#include "../../include/modules/internals/mdtp_builder.h"
+#include "../../include/modules/internals/mdtp_reader.h"
+#include <math.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct MdtpHistogram {
+    double           *bounds;   ///< Increasing upper bounds of all buckets but the last
+    size_t            count;    ///< Count of elements of `bounds`
+    _Atomic uint64_t *counts;   ///< Observations of every bucket, `count + 1` elements
+    _Atomic uint64_t  sum;      ///< Bits of the sum of the observations
+    uint64_t         *snapshot; ///< Counts copied by the last snapshot, `count + 1` elements
+    uint8_t           interval; ///< `1` if snapshots of nodes take the observations out
+};
+
+
+// Forward declaration begin
+static MdtpHistogram *mdtp_histogram_allocate(size_t count);
+static void           mdtp_histogram_add_sum(MdtpHistogram *histogram, double value);
+static double         mdtp_histogram_collect(MdtpHistogram *histogram);
+static void           mdtp_histogram_restore(MdtpHistogram *histogram, double sum);
+static MdtpHistogram *mdtp_histogram_check(MdtpHistogram *histogram);
+static int            mdtp_histogram_valid(const double *bounds, size_t count);
+static size_t         mdtp_histogram_bucket(const MdtpHistogram *histogram, double value);
+// Forward declaration end
+
+
+// Create histogram
+MdtpHistogram *sdk_mdtp_histogram_create(const double *bounds, size_t count) {
+    if (bounds == NULL || !mdtp_histogram_valid(bounds, count)) {
+        return NULL;
+    }
+
+    MdtpHistogram *histogram = mdtp_histogram_allocate(count);
+
+    if (histogram != NULL) {
+        memcpy(histogram->bounds, bounds, count * sizeof(double));
+    }
+
+    return histogram;
+}
+
+
+// Create histogram with linear bounds
+MdtpHistogram *sdk_mdtp_histogram_create_linear(double start, double width, size_t count) {
+    if (!(width > 0)) {
+        return NULL;
+    }
+
+    MdtpHistogram *histogram = mdtp_histogram_allocate(count);
+
+    if (histogram == NULL) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        histogram->bounds[i] = start + (double)i * width;
+    }
+
+    return mdtp_histogram_check(histogram);
+}
+
+
+// Create histogram with exponential bounds
+MdtpHistogram *sdk_mdtp_histogram_create_exponential(double start, double factor, size_t count) {
+    if (!(start > 0) || !(factor > 1)) {
+        return NULL;
+    }
+
+    MdtpHistogram *histogram = mdtp_histogram_allocate(count);
+
+    if (histogram == NULL) {
+        return NULL;
+    }
+
+    histogram->bounds[0] = start;
+
+    for (size_t i = 1; i < count; ++i) {
+        histogram->bounds[i] = histogram->bounds[i - 1] * factor;
+    }
+
+    return mdtp_histogram_check(histogram);
+}
+
+
+// Destroy histogram
+void sdk_mdtp_histogram_destroy(MdtpHistogram *histogram) {
+    if (histogram == NULL) {
+        return;
+    }
+
+    free(histogram->bounds);
+    free(histogram->counts);
+    free(histogram->snapshot);
+    free(histogram);
+}
+
+
+// Record observation
+void sdk_mdtp_histogram_observe(MdtpHistogram *histogram, double value) {
+    if (isnan(value)) {
+        return;
+    }
+
+    atomic_fetch_add_explicit(
+        &histogram->counts[mdtp_histogram_bucket(histogram, value)], 1, memory_order_relaxed);
+    mdtp_histogram_add_sum(histogram, value);
+}
+
+
+// Reset histogram
+void sdk_mdtp_histogram_reset(MdtpHistogram *histogram) {
+    for (size_t i = 0; i <= histogram->count; ++i) {
+        atomic_exchange_explicit(&histogram->counts[i], 0, memory_order_relaxed);
+    }
+
+    // Bits of 0.0
+    atomic_exchange_explicit(&histogram->sum, 0, memory_order_relaxed);
+}
+
+
+// Send only the observations of the poll
+void sdk_mdtp_histogram_set_cumulative(MdtpHistogram *histogram, uint8_t cumulative) {
+    histogram->interval = !cumulative;
+}
+
+
+// Get bucket bounds
+const double *sdk_mdtp_histogram_bounds(const MdtpHistogram *histogram, size_t *count) {
+    *count = histogram->count;
+
+    return histogram->bounds;
+}
+
+
+// Copy counts and sum
+uint64_t sdk_mdtp_histogram_snapshot(const MdtpHistogram *histogram,
+                                     uint64_t            *counts,
+                                     double              *sum) {
+    uint64_t total = 0;
+
+    for (size_t i = 0; i <= histogram->count; ++i) {
+        uint64_t count = atomic_load_explicit(&histogram->counts[i], memory_order_relaxed);
+
+        if (counts != NULL) {
+            counts[i] = count;
+        }
+
+        total += count;
+    }
+
+    if (sum != NULL) {
+        uint64_t bits = atomic_load_explicit(&histogram->sum, memory_order_relaxed);
+
+        memcpy(sum, &bits, sizeof(double));
+    }
+
+    return total;
+}
+
+
+// Snapshot histogram into a node
+void *sdk_mdtp_histogram_make(MdtpHistogram *histogram,
+                              const char    *value_name,
+                              const char    *value_units) {
+    double sum = mdtp_histogram_collect(histogram);
+    void  *node = sdk_mdtp_make_histogram(
+        value_name, histogram->bounds, histogram->count, histogram->snapshot, sum, value_units);
+
+    if (node == NULL) {
+        mdtp_histogram_restore(histogram, sum);
+    }
+
+    return node;
+}
+
+
+// Snapshot histogram into the frame being built
+SDKStatus sdk_mdtp_histogram_add(MdtpHistogram *histogram,
+                                 MdtpBuilder   *builder,
+                                 const char    *value_name,
+                                 const char    *value_units) {
+    double    sum = mdtp_histogram_collect(histogram);
+    SDKStatus status = sdk_mdtp_builder_add_histogram(builder,
+                                                      value_name,
+                                                      histogram->bounds,
+                                                      histogram->count,
+                                                      histogram->snapshot,
+                                                      sum,
+                                                      value_units);
+
+    if (status != SDK_OK) {
+        mdtp_histogram_restore(histogram, sum);
+    }
+
+    return status;
+}
+
+
+// Allocate histogram with `count` bounds and zero counts
+static MdtpHistogram *mdtp_histogram_allocate(size_t count) {
+    if (count == 0 || count > MDTP_HISTOGRAM_MAX_BOUNDS) {
+        return NULL;
+    }
+
+    MdtpHistogram *histogram = calloc(1, sizeof(MdtpHistogram));
+
+    if (histogram == NULL) {
+        return NULL;
+    }
+
+    histogram->count = count;
+    histogram->bounds = malloc(count * sizeof(double));
+    histogram->counts = calloc(count + 1, sizeof(_Atomic uint64_t));
+    histogram->snapshot = malloc((count + 1) * sizeof(uint64_t));
+
+    if (histogram->bounds == NULL || histogram->counts == NULL || histogram->snapshot == NULL) {
+        sdk_mdtp_histogram_destroy(histogram);
+        return NULL;
+    }
+
+    return histogram;
+}
+
+
+// Add value to the sum
+static void mdtp_histogram_add_sum(MdtpHistogram *histogram, double value) {
+    // There is no atomic addition of doubles, the bits of the sum are replaced instead
+    uint64_t expected = atomic_load_explicit(&histogram->sum, memory_order_relaxed);
+    uint64_t desired;
+
+    do {
+        double sum;
+
+        memcpy(&sum, &expected, sizeof(double));
+        sum += value;
+        memcpy(&desired, &sum, sizeof(double));
+    } while (!atomic_compare_exchange_weak_explicit(
+        &histogram->sum, &expected, desired, memory_order_relaxed, memory_order_relaxed));
+}
+
+
+// Copy the counts into `snapshot`, take them out in interval mode, and return the sum
+static double mdtp_histogram_collect(MdtpHistogram *histogram) {
+    double sum;
+
+    if (!histogram->interval) {
+        sdk_mdtp_histogram_snapshot(histogram, histogram->snapshot, &sum);
+        return sum;
+    }
+
+    // An exchange takes every observation recorded up to it, the next ones stay for later
+    for (size_t i = 0; i <= histogram->count; ++i) {
+        histogram->snapshot[i] =
+            atomic_exchange_explicit(&histogram->counts[i], 0, memory_order_relaxed);
+    }
+
+    // Bits of 0.0
+    uint64_t bits = atomic_exchange_explicit(&histogram->sum, 0, memory_order_relaxed);
+
+    memcpy(&sum, &bits, sizeof(double));
+
+    return sum;
+}
+
+
+// Put the observations taken by a failed snapshot back
+static void mdtp_histogram_restore(MdtpHistogram *histogram, double sum) {
+    if (!histogram->interval) {
+        return;
+    }
+
+    for (size_t i = 0; i <= histogram->count; ++i) {
+        if (histogram->snapshot[i] != 0) {
+            atomic_fetch_add_explicit(
+                &histogram->counts[i], histogram->snapshot[i], memory_order_relaxed);
+        }
+    }
+
+    mdtp_histogram_add_sum(histogram, sum);
+}
+
+
+// Destroy histogram if its generated bounds went out of range or stopped increasing
+static MdtpHistogram *mdtp_histogram_check(MdtpHistogram *histogram) {
+    if (!mdtp_histogram_valid(histogram->bounds, histogram->count)) {
+        sdk_mdtp_histogram_destroy(histogram);
+        return NULL;
+    }
+
+    return histogram;
+}
+
+
+// Check that bounds are finite and increasing
+static int mdtp_histogram_valid(const double *bounds, size_t count) {
+    if (count == 0 || count > MDTP_HISTOGRAM_MAX_BOUNDS) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (!isfinite(bounds[i]) || (i != 0 && !(bounds[i - 1] < bounds[i]))) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+
+// Find the first bucket whose bound is not below `value`
+static size_t mdtp_histogram_bucket(const MdtpHistogram *histogram, double value) {
+    size_t low = 0;
+    size_t high = histogram->count;
+
+    // Binary search, `high` is the bucket without an upper bound
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+
+        if (value <= histogram->bounds[middle]) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+
+    return low;
+}
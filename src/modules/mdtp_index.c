@@ -0,0 +1,305 @@
+/**
+ * @file modules/mdtp_index.c
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#include "../../include/modules/internals/mdtp_index.h"
+#include "../../include/modules/internals/mdtp_builder.h"
+#include "../../include/modules/internals/mdtp_reader.h"
+#include "../../include/modules/internals/memutils.h"
+#include "mdtp_internal.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MDTP_INDEX_NONE UINT32_MAX ///< No entry
+
+typedef struct MdtpIndexEntry {
+    uint64_t hash;   ///< FNV-1a hash of the full path of the node
+    size_t   offset; ///< Offset of the node in the frame
+    size_t   end;    ///< End of the payload of the enclosing container (or of the frame)
+    uint32_t parent; ///< Entry of the enclosing container or `MDTP_INDEX_NONE`
+    uint32_t next;   ///< Next entry in the same bucket or `MDTP_INDEX_NONE`
+} MdtpIndexEntry;
+
+struct MdtpIndex {
+    const uint8_t  *frame;            ///< Indexed frame
+    size_t          size;             ///< Count of bytes of `frame`
+    MdtpIndexEntry *entries;          ///< Nodes in the order of appearance
+    size_t          entries_count;    ///< Count of entries
+    size_t          entries_capacity; ///< Count of entries allocated
+    uint32_t       *buckets;          ///< First entry of every bucket
+    size_t          buckets_count;    ///< Count of buckets, power of 2
+    uint8_t         version;          ///< MDTP version of the indexed frame
+};
+
+
+// Forward declaration begin
+static SDKStatus mdtp_index_append(MdtpIndex        *index,
+                                   const MdtpReader *reader,
+                                   uint64_t          hash,
+                                   uint32_t          parent);
+static SDKStatus mdtp_index_fill_buckets(MdtpIndex *index);
+static int       mdtp_index_matches(const MdtpIndex *index,
+                                    uint32_t         entry,
+                                    const char      *path,
+                                    size_t           path_length);
+// Forward declaration end
+
+
+// Create index
+MdtpIndex *sdk_mdtp_index_create(void) {
+    return calloc(1, sizeof(MdtpIndex));
+}
+
+
+// Destroy index
+void sdk_mdtp_index_destroy(MdtpIndex *index) {
+    if (index == NULL) {
+        return;
+    }
+
+    free(index->entries);
+    free(index->buckets);
+    free(index);
+}
+
+
+// Index all nodes of frame
+SDKStatus sdk_mdtp_index_build(MdtpIndex *index, const void *frame, size_t size) {
+    // Readers and entries of the containers around the current node
+    MdtpReader readers[MDTP_MAX_DEPTH + 1];
+    uint32_t   parents[MDTP_MAX_DEPTH + 1];
+    size_t     depth = 0;
+
+    index->frame = NULL;
+    index->size = 0;
+    index->entries_count = 0;
+
+    SDKStatus status = sdk_mdtp_reader_init(&readers[0], frame, size);
+
+    parents[0] = MDTP_INDEX_NONE;
+
+    while (status == SDK_OK) {
+        MdtpReader *reader = &readers[depth];
+
+        if (!sdk_mdtp_reader_next(reader)) {
+            status = sdk_mdtp_reader_status(reader);
+
+            if (depth == 0) {
+                break;
+            }
+
+            --depth;
+            continue;
+        }
+
+        // Path hash of the node continues the hash of its container
+        size_t      name_length;
+        const char *name = sdk_mdtp_reader_name(reader, &name_length);
+        uint64_t    hash = MDTP_FNV_OFFSET;
+
+        if (parents[depth] != MDTP_INDEX_NONE) {
+            hash = mdtp_fnv_hash(index->entries[parents[depth]].hash, "/", 1);
+        }
+
+        hash = mdtp_fnv_hash(hash, name, name_length);
+        status = mdtp_index_append(index, reader, hash, parents[depth]);
+
+        if (status == SDK_OK && sdk_mdtp_reader_type(reader) == MDTP_NODE_CONTAINER) {
+            if (depth == MDTP_MAX_DEPTH) {
+                status = SDK_ARGUMENT_PROCESSING_ERROR;
+                break;
+            }
+
+            sdk_mdtp_reader_enter_container(reader, &readers[depth + 1]);
+            parents[++depth] = (uint32_t)(index->entries_count - 1);
+        }
+    }
+
+    if (status == SDK_OK) {
+        status = mdtp_index_fill_buckets(index);
+    }
+
+    if (status != SDK_OK) {
+        index->entries_count = 0;
+        return status;
+    }
+
+    index->frame = frame;
+    index->size = size;
+    index->version = readers[0].version;
+
+    return SDK_OK;
+}
+
+
+// Point index to frame with the same layout
+SDKStatus sdk_mdtp_index_rebind(MdtpIndex *index, const void *frame, size_t size) {
+    if (frame == NULL) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    index->frame = frame;
+    index->size = size;
+
+    return SDK_OK;
+}
+
+
+// Get count of indexed nodes
+size_t sdk_mdtp_index_size(const MdtpIndex *index) {
+    return index->entries_count;
+}
+
+
+// Find node by path
+SDKStatus sdk_mdtp_index_lookup(const MdtpIndex *index, const char *path, MdtpReader *node) {
+    if (path == NULL || index->entries_count == 0) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    size_t   path_length = strlen(path);
+    uint64_t hash = mdtp_fnv_hash(MDTP_FNV_OFFSET, path, path_length);
+    uint32_t entry = index->buckets[hash & (index->buckets_count - 1)];
+
+    for (; entry != MDTP_INDEX_NONE; entry = index->entries[entry].next) {
+        // The end is checked too, as the frame may have been rebound
+        if (index->entries[entry].hash != hash || index->entries[entry].end > index->size ||
+            !mdtp_index_matches(index, entry, path, path_length)) {
+            continue;
+        }
+
+        // Parse the node as if the reader of its container reached it
+        *node = (MdtpReader){
+            .data = index->frame,
+            .offset = index->entries[entry].offset,
+            .end = index->entries[entry].end,
+            .version = index->version,
+            .status = SDK_OK,
+        };
+
+        if (sdk_mdtp_reader_next(node)) {
+            return SDK_OK;
+        }
+    }
+
+    return SDK_INVALID_ARGUMENT;
+}
+
+
+// Append entry for the current node of reader
+static SDKStatus mdtp_index_append(MdtpIndex        *index,
+                                   const MdtpReader *reader,
+                                   uint64_t          hash,
+                                   uint32_t          parent) {
+    if (index->entries_count == index->entries_capacity) {
+        size_t capacity = index->entries_capacity == 0 ? 64 : index->entries_capacity * 2;
+
+        if (capacity >= MDTP_INDEX_NONE) {
+            return SDK_ALLOCATION_ERROR;
+        }
+
+        MdtpIndexEntry *entries = realloc(index->entries, capacity * sizeof(MdtpIndexEntry));
+
+        if (entries == NULL) {
+            return SDK_ALLOCATION_ERROR;
+        }
+
+        index->entries = entries;
+        index->entries_capacity = capacity;
+    }
+
+    index->entries[index->entries_count++] = (MdtpIndexEntry){
+        .hash = hash,
+        .offset = reader->node,
+        .end = reader->end,
+        .parent = parent,
+        .next = MDTP_INDEX_NONE,
+    };
+
+    return SDK_OK;
+}
+
+
+// Distribute entries into buckets
+static SDKStatus mdtp_index_fill_buckets(MdtpIndex *index) {
+    // At most one entry per bucket on average
+    size_t buckets_count = 16;
+
+    while (buckets_count < index->entries_count) {
+        buckets_count *= 2;
+    }
+
+    if (buckets_count > index->buckets_count) {
+        uint32_t *buckets = realloc(index->buckets, buckets_count * sizeof(uint32_t));
+
+        if (buckets == NULL) {
+            return SDK_ALLOCATION_ERROR;
+        }
+
+        index->buckets = buckets;
+        index->buckets_count = buckets_count;
+    }
+
+    memset(index->buckets, 0xFF, index->buckets_count * sizeof(uint32_t));
+
+    // In reverse, so that the first of nodes with the same path is at the head of the chain
+    for (size_t i = index->entries_count; i-- > 0;) {
+        size_t bucket = index->entries[i].hash & (index->buckets_count - 1);
+
+        index->entries[i].next = index->buckets[bucket];
+        index->buckets[bucket] = (uint32_t)i;
+    }
+
+    return SDK_OK;
+}
+
+
+// Compare names of the entry and its containers with `path`
+static int mdtp_index_matches(const MdtpIndex *index,
+                              uint32_t         entry,
+                              const char      *path,
+                              size_t           path_length) {
+    size_t end = path_length;
+
+    // Compare names from the last one, checking bounds as the frame may have been rebound
+    while (entry != MDTP_INDEX_NONE) {
+        MdtpReader reader = {
+            .data = index->frame,
+            .offset = index->entries[entry].offset,
+            .end = index->size,
+            .version = index->version,
+            .status = SDK_OK,
+        };
+
+        size_t      name_length;
+        const char *name;
+
+        if (reader.offset > reader.end || !sdk_mdtp_reader_next(&reader)) {
+            return 0;
+        }
+
+        name = sdk_mdtp_reader_name(&reader, &name_length);
+
+        if (name_length > end || memcmp(path + end - name_length, name, name_length) != 0) {
+            return 0;
+        }
+
+        end -= name_length;
+        entry = index->entries[entry].parent;
+
+        if (entry != MDTP_INDEX_NONE) {
+            if (end == 0 || path[end - 1] != '/') {
+                return 0;
+            }
+
+            --end;
+        }
+    }
+
+    return end == 0;
+}
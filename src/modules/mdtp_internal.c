@@ -0,0 +1,129 @@
+/**
+ * @file modules/mdtp_internal.c
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#include "mdtp_internal.h"
+#include "imodule_internal.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MDTP_FNV_PRIME 0x100000001B3ull ///< Multiplier of FNV-1a
+
+
+static atomic_size_t        mdtp_thread_count;   ///< Count of threads that got a number
+static _Thread_local size_t mdtp_thread_current; ///< Number of the thread or `0`
+
+
+// Grow buffer to hold `size` bytes
+SDKStatus mdtp_buffer_reserve(uint8_t **data, size_t *capacity, size_t size, size_t min_capacity) {
+    if (*data != NULL && *capacity >= size) {
+        return SDK_OK;
+    }
+
+    size_t grown = *capacity < min_capacity ? min_capacity : *capacity;
+
+    if (grown == 0) {
+        grown = size;
+    }
+
+    // Grow geometrically
+    while (grown < size) {
+        if (grown > SIZE_MAX / 2) {
+            return SDK_ALLOCATION_ERROR;
+        }
+
+        grown *= 2;
+    }
+
+    uint8_t *bytes = realloc(*data, grown);
+
+    if (bytes == NULL) {
+        return SDK_ALLOCATION_ERROR;
+    }
+
+    *data = bytes;
+    *capacity = grown;
+
+    return SDK_OK;
+}
+
+
+// Reserve `count` bytes at the end of buffer and return pointer to them
+uint8_t *mdtp_buffer_claim(MdtpBuffer *buffer, size_t count) {
+    if (buffer->status != SDK_OK) {
+        return NULL;
+    }
+
+    if (count > SIZE_MAX - buffer->size) {
+        buffer->status = SDK_ALLOCATION_ERROR;
+        return NULL;
+    }
+
+    buffer->status = mdtp_buffer_reserve(
+        &buffer->data, &buffer->capacity, buffer->size + count, MDTP_BUFFER_MIN_CAPACITY);
+
+    if (buffer->status != SDK_OK) {
+        return NULL;
+    }
+
+    uint8_t *cursor = buffer->data + buffer->size;
+    buffer->size += count;
+
+    return cursor;
+}
+
+
+// Append bytes to buffer
+void mdtp_buffer_write(MdtpBuffer *buffer, const void *bytes, size_t count) {
+    uint8_t *cursor = mdtp_buffer_claim(buffer, count);
+
+    if (cursor != NULL && count != 0) {
+        memcpy(cursor, bytes, count);
+    }
+}
+
+
+// Continue FNV-1a hash with bytes
+uint64_t mdtp_fnv_hash(uint64_t hash, const void *bytes, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= ((const uint8_t *)bytes)[i];
+        hash *= MDTP_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+
+// Copy collected frame
+SDKStatus mdtp_frame_copy(MdtpFrameCopy              *copy,
+                          const ABI_MODULE_MDTP_DATA *data,
+                          ABI_MODULE_DATA_INFO       *info) {
+    if (copy->capacity < data->size &&
+        mdtp_buffer_reserve(&copy->data, &copy->capacity, data->size, 0) != SDK_OK) {
+        return SDK_ALLOCATION_ERROR;
+    }
+
+    memcpy(copy->data, data->data, data->size);
+
+    copy->mdtp_data = (ABI_MODULE_MDTP_DATA){.data = copy->data, .size = data->size};
+    imodule_describe(info, imodule_hash_bytes(copy->data, data->size));
+
+    copy->info = *info;
+
+    return SDK_OK;
+}
+
+
+// Get number of the calling thread
+size_t mdtp_thread_number(void) {
+    if (mdtp_thread_current == 0) {
+        mdtp_thread_current =
+            atomic_fetch_add_explicit(&mdtp_thread_count, 1, memory_order_relaxed) + 1;
+    }
+
+    return mdtp_thread_current;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file modules/mdtp_internal.h
+ *
+ * @brief Helpers shared between the SDK translation units that write, index and collect MDTP
+ * frames. This header is not installed.
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#pragma once
+
+#include "../../include/general/sdk_status.h"
+#include "../../include/modules/internals/abi.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MDTP_HEADER_SIZE 5                    ///< [1 version] [4 payload size]
+#define MDTP_BUFFER_MIN_CAPACITY 256          ///< First allocation of `MdtpBuffer`
+#define MDTP_FNV_OFFSET 0xCBF29CE484222325ull ///< FNV-1a hash of no bytes
+#define MDTP_CACHE_LINE 64                    ///< Bytes of a cache line
+
+/**
+ * @brief Bytes appended one after another, growing geometrically
+ */
+typedef struct MdtpBuffer {
+    uint8_t  *data;     ///< Bytes
+    size_t    size;     ///< Count of bytes written
+    size_t    capacity; ///< Count of bytes allocated
+    SDKStatus status;   ///< First error while writing
+} MdtpBuffer;
+
+/**
+ * @brief Copy of a frame collected on another thread, returned to the server
+ */
+typedef struct MdtpFrameCopy {
+    uint8_t             *data;      ///< Bytes of the frame
+    size_t               capacity;  ///< Count of bytes allocated for `data`
+    ABI_MODULE_MDTP_DATA mdtp_data; ///< Frame returned to the server, `data` is `NULL` if none
+    ABI_MODULE_DATA_INFO info;      ///< Hash and generation of the frame
+} MdtpFrameCopy;
+
+/**
+ * @brief Grows a buffer so that it holds at least `size` bytes. The capacity starts at
+ * `min_capacity` (or at `size` if it is `0`) and doubles until the bytes fit.
+ * @param data Pointer to the buffer allocated via `malloc`, or to `NULL`
+ * @param capacity Pointer to count of bytes allocated for `*data`
+ * @param size Count of bytes the buffer must hold
+ * @param min_capacity First allocation
+ * @return `SDK_OK` on success, `SDK_ALLOCATION_ERROR` if memory could not be allocated. The buffer
+ * is unchanged on failure.
+ */
+SDKStatus mdtp_buffer_reserve(uint8_t **data, size_t *capacity, size_t size, size_t min_capacity);
+
+/**
+ * @brief Reserves `count` bytes at the end of the buffer
+ * @param buffer Not-null pointer to `MdtpBuffer`
+ * @param count Count of bytes
+ * @return Pointer to the reserved bytes, or `NULL` if the buffer could not grow or an earlier write
+ * failed. The error is kept in `status`.
+ */
+uint8_t *mdtp_buffer_claim(MdtpBuffer *buffer, size_t count);
+
+/**
+ * @brief Appends bytes to the buffer. Errors are kept in `status`.
+ * @param buffer Not-null pointer to `MdtpBuffer`
+ * @param bytes Bytes to append, may be `NULL` if `count` is `0`
+ * @param count Count of bytes
+ */
+void mdtp_buffer_write(MdtpBuffer *buffer, const void *bytes, size_t count);
+
+/**
+ * @brief Continues an FNV-1a hash with bytes
+ * @param hash Hash of the bytes before, `MDTP_FNV_OFFSET` to start a new one
+ * @param bytes Bytes to hash
+ * @param length Count of bytes
+ * @return Hash
+ */
+uint64_t mdtp_fnv_hash(uint64_t hash, const void *bytes, size_t length);
+
+/**
+ * @brief Copies the frame a collect routine returned and describes it. The copy is hashed on its
+ * own, so the info of the module is not touched from the thread of the collection.
+ * @param copy Not-null pointer to `MdtpFrameCopy`, its buffer is reused
+ * @param data Not-null frame returned by the collect routine
+ * @param info Not-null pointer to the info of the frame copied last by the caller, zeroed if none.
+ * It is updated and copied into `copy`.
+ * @return `SDK_OK` on success, `SDK_ALLOCATION_ERROR` if memory could not be allocated. The copy
+ * and the info are unchanged on failure.
+ */
+SDKStatus mdtp_frame_copy(MdtpFrameCopy              *copy,
+                          const ABI_MODULE_MDTP_DATA *data,
+                          ABI_MODULE_DATA_INFO       *info);
+
+/**
+ * @brief Get number of the calling thread. Numbers start from `1` and are given to threads on
+ * their first call, so sharded counters may pick the shard of a thread with a mask.
+ * @return Number of the calling thread
+ */
+size_t mdtp_thread_number(void);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,1108 @@
+/**
+ * @file modules/mdtp_reader.c
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#include "../../include/modules/internals/mdtp_reader.h"
+#include "../../include/modules/internals/mdtp.h"
+#include "../../include/modules/internals/mdtp_builder.h"
+#include "../../include/modules/internals/memutils.h"
+#include "mdtp_internal.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MDTP_READER_MAX_NUMBER 64   ///< Longest text parsed as a floating point number
+
+
+// Forward declaration begin
+static SDKStatus mdtp_reader_check_header(const void *frame, size_t size);
+static int       mdtp_reader_parse(MdtpReader *reader);
+static int       mdtp_reader_parse_v2(MdtpReader *reader);
+static int       mdtp_reader_parse_value_v2(MdtpReader *reader, size_t offset);
+static int       mdtp_reader_parse_array(MdtpReader *reader, size_t offset);
+static int       mdtp_reader_parse_histogram(MdtpReader *reader, size_t offset);
+static int       mdtp_reader_parse_table(MdtpReader *reader);
+static int       mdtp_reader_parse_column(MdtpReader *reader, size_t *offset);
+static int       mdtp_reader_parse_cell(MdtpReader *reader);
+static int       mdtp_reader_read_count(const MdtpReader *reader,
+                                        size_t           *offset,
+                                        uint32_t         *count);
+static int       mdtp_reader_read_length(const MdtpReader *reader,
+                                         size_t            offset,
+                                         uint32_t         *length);
+static int       mdtp_reader_read_varint(const MdtpReader *reader,
+                                         size_t           *offset,
+                                         uint32_t         *length);
+static int       mdtp_reader_text_u64(const char *text, size_t length, uint64_t *value);
+// Forward declaration end
+
+
+// Validate the whole frame
+SDKStatus sdk_mdtp_validate(const void *frame, size_t size) {
+    SDKStatus status = mdtp_reader_check_header(frame, size);
+
+    if (status != SDK_OK) {
+        return status;
+    }
+
+    // Ends of payloads of the root and the containers around the current node
+    size_t     ends[MDTP_MAX_DEPTH + 1];
+    size_t     depth = 0;
+    MdtpReader reader = {
+        .data = frame,
+        .offset = MDTP_HEADER_SIZE,
+        .end = size,
+        .version = read_ubyte_be(frame, 0),
+    };
+
+    ends[0] = size;
+
+    for (;;) {
+        // Leave containers whose payload is over
+        while (reader.offset == ends[depth] && depth != 0) {
+            --depth;
+        }
+
+        reader.end = ends[depth];
+
+        if (reader.offset == reader.end) {
+            return SDK_OK; // End of the root
+        }
+
+        if (!mdtp_reader_parse(&reader)) {
+            return SDK_ARGUMENT_PROCESSING_ERROR;
+        }
+
+        if (reader.type == MDTP_NODE_CONTAINER) {
+            if (depth == MDTP_MAX_DEPTH) {
+                return SDK_ARGUMENT_PROCESSING_ERROR;
+            }
+
+            ends[++depth] = reader.node_end;
+            reader.offset = reader.value; // Continue with the payload
+        } else if (reader.type == MDTP_NODE_TABLE) {
+            MdtpReader cells;
+
+            if (sdk_mdtp_reader_enter_table(&reader, &cells) != SDK_OK) {
+                return SDK_ARGUMENT_PROCESSING_ERROR;
+            }
+
+            while (sdk_mdtp_reader_next(&cells)) {
+            }
+
+            if (cells.status != SDK_OK) {
+                return SDK_ARGUMENT_PROCESSING_ERROR;
+            }
+
+            reader.offset = reader.node_end;
+        } else {
+            reader.offset = reader.node_end;
+        }
+    }
+}
+
+
+// Initialize reader over the root
+SDKStatus sdk_mdtp_reader_init(MdtpReader *reader, const void *frame, size_t size) {
+    SDKStatus status = mdtp_reader_check_header(frame, size);
+
+    if (status != SDK_OK) {
+        return status;
+    }
+
+    *reader = (MdtpReader){
+        .data = frame,
+        .offset = MDTP_HEADER_SIZE,
+        .end = size,
+        .version = read_ubyte_be(frame, 0),
+        .status = SDK_OK,
+    };
+
+    return SDK_OK;
+}
+
+
+// Move to the next node
+int sdk_mdtp_reader_next(MdtpReader *reader) {
+    if (reader->status != SDK_OK) {
+        return 0;
+    }
+
+    if (reader->offset == reader->end) {
+        // A table must hold all of its cells
+        if (reader->table && reader->cell != (uint64_t)reader->rows * reader->columns) {
+            reader->status = SDK_ARGUMENT_PROCESSING_ERROR;
+        }
+
+        return 0;
+    }
+
+    if (!mdtp_reader_parse(reader)) {
+        reader->status = SDK_ARGUMENT_PROCESSING_ERROR;
+        return 0;
+    }
+
+    reader->offset = reader->node_end;
+
+    return 1;
+}
+
+
+// Get status
+SDKStatus sdk_mdtp_reader_status(const MdtpReader *reader) {
+    return reader->status;
+}
+
+
+// Create reader over the current container
+SDKStatus sdk_mdtp_reader_enter_container(const MdtpReader *reader, MdtpReader *child) {
+    if (reader->node_end == 0 || reader->type != MDTP_NODE_CONTAINER) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    *child = (MdtpReader){
+        .data = reader->data,
+        .offset = reader->value,
+        .end = reader->node_end,
+        .version = reader->version,
+        .status = SDK_OK,
+    };
+
+    return SDK_OK;
+}
+
+
+// Create reader over the cells of the current table
+SDKStatus sdk_mdtp_reader_enter_table(const MdtpReader *reader, MdtpReader *cells) {
+    if (reader->node_end == 0 || reader->type != MDTP_NODE_TABLE) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    MdtpReader table = {
+        .data = reader->data,
+        .offset = reader->value,
+        .end = reader->node_end,
+        .version = reader->version,
+        .status = SDK_OK,
+        .table = 1,
+    };
+
+    if (!mdtp_reader_parse_table(&table)) {
+        return SDK_ARGUMENT_PROCESSING_ERROR;
+    }
+
+    *cells = table;
+
+    return SDK_OK;
+}
+
+
+// Get count of rows of the table
+uint32_t sdk_mdtp_reader_table_rows(const MdtpReader *cells) {
+    return cells->rows;
+}
+
+
+// Get count of columns of the table
+uint32_t sdk_mdtp_reader_table_columns(const MdtpReader *cells) {
+    return cells->columns;
+}
+
+
+// Get layout of the table
+uint8_t sdk_mdtp_reader_table_layout(const MdtpReader *cells) {
+    return cells->layout;
+}
+
+
+// Get name and units of a column of the table
+SDKStatus sdk_mdtp_reader_table_column(const MdtpReader *cells,
+                                       uint32_t          column,
+                                       const char      **name,
+                                       size_t           *name_length,
+                                       const char      **units,
+                                       size_t           *units_length) {
+    if (!cells->table || column >= cells->columns) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    // The columns were checked by `sdk_mdtp_reader_enter_table`
+    MdtpReader definition = *cells;
+    size_t     offset = cells->first_column;
+
+    for (uint32_t i = 0; i <= column; ++i) {
+        mdtp_reader_parse_column(&definition, &offset);
+    }
+
+    *name = (const char *)cells->data + definition.name;
+    *name_length = definition.name_length;
+    *units = (const char *)cells->data + definition.units;
+    *units_length = definition.units_length;
+
+    return SDK_OK;
+}
+
+
+// Get row of the current cell
+uint32_t sdk_mdtp_reader_cell_row(const MdtpReader *cells) {
+    if (cells->cell == 0) {
+        return 0;
+    }
+
+    uint64_t cell = cells->cell - 1;
+
+    return (uint32_t)(cells->layout == MDTP_TABLE_ROWS ? cell / cells->columns
+                                                       : cell % cells->rows);
+}
+
+
+// Get column of the current cell
+uint32_t sdk_mdtp_reader_cell_column(const MdtpReader *cells) {
+    if (cells->cell == 0) {
+        return 0;
+    }
+
+    uint64_t cell = cells->cell - 1;
+
+    return (uint32_t)(cells->layout == MDTP_TABLE_ROWS ? cell % cells->columns
+                                                       : cell / cells->rows);
+}
+
+
+// Get MDTP version of the frame
+uint8_t sdk_mdtp_reader_version(const MdtpReader *reader) {
+    return reader->version == MDTP_VERSION_2 ? MDTP_VERSION_2 : MDTP_VERSION;
+}
+
+
+// Get type of the current node
+uint8_t sdk_mdtp_reader_type(const MdtpReader *reader) {
+    return reader->type;
+}
+
+
+// Get type of the value of the current node
+uint8_t sdk_mdtp_reader_value_type(const MdtpReader *reader) {
+    return reader->value_type;
+}
+
+
+// Get name of the current node
+const char *sdk_mdtp_reader_name(const MdtpReader *reader, size_t *length) {
+    *length = reader->name_length;
+
+    return (const char *)reader->data + reader->name;
+}
+
+
+// Get units of the current node
+const char *sdk_mdtp_reader_units(const MdtpReader *reader, size_t *length) {
+    if (reader->type != MDTP_NODE_VALUE && reader->type != MDTP_NODE_ARRAY &&
+        reader->type != MDTP_NODE_HISTOGRAM) {
+        *length = 0;
+        return NULL;
+    }
+
+    *length = reader->units_length;
+
+    return (const char *)reader->data + reader->units;
+}
+
+
+// Get value of the current node
+const char *sdk_mdtp_reader_value(const MdtpReader *reader, size_t *length) {
+    if (reader->type != MDTP_NODE_VALUE) {
+        *length = 0;
+        return NULL;
+    }
+
+    *length = reader->value_length;
+
+    return (const char *)reader->data + reader->value;
+}
+
+
+// Get value of the current node as unsigned integer
+SDKStatus sdk_mdtp_reader_value_u64(const MdtpReader *reader, uint64_t *value) {
+    size_t      length;
+    const char *bytes = sdk_mdtp_reader_value(reader, &length);
+    uint64_t    result = 0;
+
+    if (bytes == NULL) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    switch (reader->value_type) {
+    case MDTP_VALUE_U64:
+        read_varint(bytes, 0, length, value);
+        return SDK_OK;
+
+    case MDTP_VALUE_I64:
+        read_varint(bytes, 0, length, &result);
+
+        if ((result & 1) != 0) {
+            return SDK_INVALID_ARGUMENT; // Negative
+        }
+
+        *value = result >> 1;
+        return SDK_OK;
+
+    case MDTP_VALUE_TEXT:
+        if (!mdtp_reader_text_u64(bytes, length, &result)) {
+            return SDK_INVALID_ARGUMENT;
+        }
+
+        *value = result;
+        return SDK_OK;
+
+    default:
+        return SDK_INVALID_ARGUMENT;
+    }
+}
+
+
+// Get value of the current node as signed integer
+SDKStatus sdk_mdtp_reader_value_i64(const MdtpReader *reader, int64_t *value) {
+    size_t      length;
+    const char *bytes = sdk_mdtp_reader_value(reader, &length);
+    uint64_t    result = 0;
+
+    if (bytes == NULL) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    switch (reader->value_type) {
+    case MDTP_VALUE_U64:
+        read_varint(bytes, 0, length, &result);
+
+        if (result > INT64_MAX) {
+            return SDK_INVALID_ARGUMENT;
+        }
+
+        *value = (int64_t)result;
+        return SDK_OK;
+
+    case MDTP_VALUE_I64:
+        // Zigzag: 0, -1, 1, -2, ...
+        read_varint(bytes, 0, length, &result);
+        *value = (result & 1) != 0 ? -(int64_t)(result >> 1) - 1 : (int64_t)(result >> 1);
+        return SDK_OK;
+
+    case MDTP_VALUE_TEXT:
+        if (length != 0 && bytes[0] == '-') {
+            if (!mdtp_reader_text_u64(bytes + 1, length - 1, &result) ||
+                result > (uint64_t)INT64_MAX + 1) {
+                return SDK_INVALID_ARGUMENT;
+            }
+
+            *value = result == (uint64_t)INT64_MAX + 1 ? INT64_MIN : -(int64_t)result;
+            return SDK_OK;
+        }
+
+        if (!mdtp_reader_text_u64(bytes, length, &result) || result > INT64_MAX) {
+            return SDK_INVALID_ARGUMENT;
+        }
+
+        *value = (int64_t)result;
+        return SDK_OK;
+
+    default:
+        return SDK_INVALID_ARGUMENT;
+    }
+}
+
+
+// Get value of the current node as floating point number
+SDKStatus sdk_mdtp_reader_value_f64(const MdtpReader *reader, double *value) {
+    size_t      length;
+    const char *bytes = sdk_mdtp_reader_value(reader, &length);
+    uint64_t    bits = 0;
+    int64_t     integer;
+
+    if (bytes == NULL) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    switch (reader->value_type) {
+    case MDTP_VALUE_F64:
+        bits = read_uint64_be(bytes, 0);
+        memcpy(value, &bits, sizeof(double));
+        return SDK_OK;
+
+    case MDTP_VALUE_U64:
+        read_varint(bytes, 0, length, &bits);
+        *value = (double)bits;
+        return SDK_OK;
+
+    case MDTP_VALUE_I64:
+        sdk_mdtp_reader_value_i64(reader, &integer);
+        *value = (double)integer;
+        return SDK_OK;
+
+    case MDTP_VALUE_TEXT: {
+        // `strtod` needs a zero-terminated string
+        char  text[MDTP_READER_MAX_NUMBER + 1];
+        char *end;
+
+        if (length == 0 || length > MDTP_READER_MAX_NUMBER) {
+            return SDK_INVALID_ARGUMENT;
+        }
+
+        memcpy(text, bytes, length);
+        text[length] = '\0';
+
+        double result = strtod(text, &end);
+
+        if (end != text + length) {
+            return SDK_INVALID_ARGUMENT;
+        }
+
+        *value = result;
+        return SDK_OK;
+    }
+
+    default:
+        return SDK_INVALID_ARGUMENT;
+    }
+}
+
+
+// Get value of the current node as boolean
+SDKStatus sdk_mdtp_reader_value_bool(const MdtpReader *reader, uint8_t *value) {
+    size_t      length;
+    const char *bytes = sdk_mdtp_reader_value(reader, &length);
+
+    if (bytes == NULL) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    if (reader->value_type == MDTP_VALUE_BOOL) {
+        *value = (uint8_t)bytes[0];
+        return SDK_OK;
+    }
+
+    if (reader->value_type == MDTP_VALUE_TEXT) {
+        if ((length == 4 && memcmp(bytes, "true", 4) == 0) || (length == 1 && bytes[0] == '1')) {
+            *value = 1;
+            return SDK_OK;
+        }
+
+        if ((length == 5 && memcmp(bytes, "false", 5) == 0) || (length == 1 && bytes[0] == '0')) {
+            *value = 0;
+            return SDK_OK;
+        }
+    }
+
+    return SDK_INVALID_ARGUMENT;
+}
+
+
+// Get count of elements of the current array
+size_t sdk_mdtp_reader_array_length(const MdtpReader *reader) {
+    return reader->type == MDTP_NODE_ARRAY ? reader->value_length / 8 : 0;
+}
+
+
+// Copy elements of the current array of unsigned integers
+SDKStatus sdk_mdtp_reader_array_u64(const MdtpReader *reader, uint64_t *values) {
+    if (reader->type != MDTP_NODE_ARRAY || reader->value_type != MDTP_VALUE_U64) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    read_uint64_be_array(reader->data, reader->value, values, reader->value_length / 8);
+
+    return SDK_OK;
+}
+
+
+// Copy elements of the current array as floating point numbers
+SDKStatus sdk_mdtp_reader_array_f64(const MdtpReader *reader, double *values) {
+    if (reader->type != MDTP_NODE_ARRAY) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    size_t count = reader->value_length / 8;
+
+    // Both element types are 8 bytes, integers are converted in place
+    read_uint64_be_array(reader->data, reader->value, values, count);
+
+    if (reader->value_type == MDTP_VALUE_U64) {
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t value;
+
+            memcpy(&value, &values[i], sizeof(uint64_t));
+            values[i] = (double)value;
+        }
+    }
+
+    return SDK_OK;
+}
+
+
+// Get count of buckets of the current histogram
+size_t sdk_mdtp_reader_histogram_buckets(const MdtpReader *reader) {
+    return reader->type == MDTP_NODE_HISTOGRAM ? reader->value_length / 8 + 1 : 0;
+}
+
+
+// Copy the current histogram
+SDKStatus sdk_mdtp_reader_histogram(const MdtpReader *reader,
+                                    double           *bounds,
+                                    uint64_t         *counts,
+                                    double           *sum,
+                                    uint64_t         *count) {
+    if (reader->type != MDTP_NODE_HISTOGRAM) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    size_t   buckets = reader->value_length / 8 + 1;
+    size_t   offset = reader->value + reader->value_length;
+    uint64_t total = 0;
+
+    if (bounds != NULL) {
+        read_uint64_be_array(reader->data, reader->value, bounds, buckets - 1);
+        bounds[buckets - 1] = INFINITY;
+    }
+
+    // The node is checked by `sdk_mdtp_reader_next`, so every count is there
+    for (size_t i = 0; i < buckets; ++i) {
+        uint64_t value = 0;
+
+        if (reader->version == MDTP_VERSION_2) {
+            offset += read_varint(reader->data, offset, reader->node_end, &value);
+        } else {
+            value = read_uint64_be(reader->data, offset);
+            offset += 8;
+        }
+
+        if (counts != NULL) {
+            counts[i] = value;
+        }
+
+        total += value;
+    }
+
+    if (sum != NULL) {
+        uint64_t bits = read_uint64_be(reader->data, offset);
+
+        memcpy(sum, &bits, sizeof(double));
+    }
+
+    if (count != NULL) {
+        *count = total;
+    }
+
+    return SDK_OK;
+}
+
+
+// Get bytes of the current node
+const void *sdk_mdtp_reader_node(const MdtpReader *reader, size_t *size) {
+    *size = reader->node_end - reader->node;
+
+    return reader->data + reader->node;
+}
+
+
+// Check version and payload size of the frame
+static SDKStatus mdtp_reader_check_header(const void *frame, size_t size) {
+    if (frame == NULL) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    if (size < MDTP_HEADER_SIZE ||
+        (read_ubyte_be(frame, 0) != MDTP_VERSION && read_ubyte_be(frame, 0) != MDTP_VERSION_2) ||
+        read_uint32_be(frame, 1) != size - MDTP_HEADER_SIZE) {
+        return SDK_ARGUMENT_PROCESSING_ERROR;
+    }
+
+    return SDK_OK;
+}
+
+
+// Parse the node at `reader->offset` into the current node fields, `0` if it is malformed
+static int mdtp_reader_parse(MdtpReader *reader) {
+    if (reader->table) {
+        return mdtp_reader_parse_cell(reader);
+    }
+
+    if (reader->version == MDTP_VERSION_2) {
+        return mdtp_reader_parse_v2(reader);
+    }
+
+    size_t   offset = reader->offset;
+    uint32_t length;
+
+    // [1 type] [4 name length] [name]
+    if (reader->end - offset < 1 || !mdtp_reader_read_length(reader, offset + 1, &length)) {
+        return 0;
+    }
+
+    uint8_t type = reader->data[offset];
+    size_t  name = offset + 5;
+
+    if (type != MDTP_NODE_CONTAINER && type != MDTP_NODE_VALUE && type != MDTP_NODE_TABLE &&
+        type != MDTP_NODE_ARRAY && type != MDTP_NODE_HISTOGRAM) {
+        return 0; // Unknown node type
+    }
+
+    reader->node = offset;
+    reader->type = type;
+    reader->value_type = MDTP_VALUE_TEXT;
+    reader->name = name;
+    reader->name_length = length;
+
+    // Container and table: [4 payload size] [payload]
+    // Value: [4 units length] [units] [4 value length] [value]
+    // Array: [4 units length] [units] [1 element type] [4 count] [elements]
+    // Histogram: [4 units length] [units] [4 bound count] [bounds] [counts] [8 sum]
+    if (type == MDTP_NODE_VALUE || type == MDTP_NODE_ARRAY || type == MDTP_NODE_HISTOGRAM) {
+        if (!mdtp_reader_read_length(reader, name + reader->name_length, &length)) {
+            return 0;
+        }
+
+        reader->units = name + reader->name_length + 4;
+        reader->units_length = length;
+
+        if (type == MDTP_NODE_ARRAY) {
+            return mdtp_reader_parse_array(reader, reader->units + reader->units_length);
+        }
+
+        if (type == MDTP_NODE_HISTOGRAM) {
+            return mdtp_reader_parse_histogram(reader, reader->units + reader->units_length);
+        }
+    } else {
+        reader->units = 0;
+        reader->units_length = 0;
+    }
+
+    size_t value_field = type == MDTP_NODE_VALUE ? reader->units + reader->units_length
+                                                 : name + reader->name_length;
+
+    if (!mdtp_reader_read_length(reader, value_field, &length)) {
+        return 0;
+    }
+
+    reader->value = value_field + 4;
+    reader->value_length = length;
+    reader->node_end = reader->value + length;
+
+    return 1;
+}
+
+
+// Read the length field at `offset`, `0` if the field or the bytes it counts cross the end
+static int mdtp_reader_read_length(const MdtpReader *reader, size_t offset, uint32_t *length) {
+    if (offset > reader->end || reader->end - offset < 4) {
+        return 0;
+    }
+
+    *length = read_uint32_be(reader->data, offset);
+
+    return *length <= reader->end - offset - 4;
+}
+
+
+// Parse the MDTP v2 node at `reader->offset`, `0` if it is malformed
+static int mdtp_reader_parse_v2(MdtpReader *reader) {
+    size_t   offset = reader->offset;
+    uint32_t length;
+
+    // [1 type] [varint name length] [name]
+    if (reader->end - offset < 1) {
+        return 0;
+    }
+
+    uint8_t type = reader->data[offset++];
+
+    if ((type != MDTP_NODE_CONTAINER && type != MDTP_NODE_VALUE && type != MDTP_NODE_TABLE &&
+         type != MDTP_NODE_ARRAY && type != MDTP_NODE_HISTOGRAM) ||
+        !mdtp_reader_read_varint(reader, &offset, &length)) {
+        return 0;
+    }
+
+    reader->node = reader->offset;
+    reader->type = type;
+    reader->value_type = MDTP_VALUE_TEXT;
+    reader->name = offset;
+    reader->name_length = length;
+    reader->units = 0;
+    reader->units_length = 0;
+
+    offset += length;
+
+    // Container and table: [varint payload size] [payload]
+    if (type == MDTP_NODE_CONTAINER || type == MDTP_NODE_TABLE) {
+        if (!mdtp_reader_read_varint(reader, &offset, &length)) {
+            return 0;
+        }
+
+        reader->value = offset;
+        reader->value_length = length;
+        reader->node_end = offset + length;
+
+        return 1;
+    }
+
+    // Value: [varint units length] [units] [1 value type] [value]
+    // Array: [varint units length] [units] [1 element type] [varint count] [elements]
+    // Histogram: [varint units length] [units] [varint bound count] [bounds] [counts] [8 sum]
+    if (!mdtp_reader_read_varint(reader, &offset, &length)) {
+        return 0;
+    }
+
+    reader->units = offset;
+    reader->units_length = length;
+
+    if (type == MDTP_NODE_ARRAY) {
+        return mdtp_reader_parse_array(reader, offset + length);
+    }
+
+    if (type == MDTP_NODE_HISTOGRAM) {
+        return mdtp_reader_parse_histogram(reader, offset + length);
+    }
+
+    return mdtp_reader_parse_value_v2(reader, offset + length);
+}
+
+
+// Parse the MDTP v2 `[1 value type] [value]` at `offset` and end the node with it, `0` if it is
+// malformed
+static int mdtp_reader_parse_value_v2(MdtpReader *reader, size_t offset) {
+    uint32_t length;
+
+    if (offset >= reader->end) {
+        return 0;
+    }
+
+    uint8_t  value_type = reader->data[offset++];
+    uint64_t number;
+    size_t   size;
+
+    switch (value_type) {
+    case MDTP_VALUE_TEXT:
+    case MDTP_VALUE_BYTES:
+        if (!mdtp_reader_read_varint(reader, &offset, &length)) {
+            return 0;
+        }
+
+        break;
+
+    case MDTP_VALUE_U64:
+    case MDTP_VALUE_I64:
+        size = read_varint(reader->data, offset, reader->end, &number);
+
+        if (size == 0) {
+            return 0;
+        }
+
+        length = (uint32_t)size;
+        break;
+
+    case MDTP_VALUE_F64:
+        if (reader->end - offset < 8) {
+            return 0;
+        }
+
+        length = 8;
+        break;
+
+    case MDTP_VALUE_BOOL:
+        if (reader->end == offset || reader->data[offset] > 1) {
+            return 0;
+        }
+
+        length = 1;
+        break;
+
+    default:
+        return 0; // Unknown value type
+    }
+
+    reader->value_type = value_type;
+    reader->value = offset;
+    reader->value_length = length;
+    reader->node_end = offset + length;
+
+    return 1;
+}
+
+
+// Parse `[1 element type] [count] [elements]` of the array node at `offset`, `0` if it is
+// malformed
+static int mdtp_reader_parse_array(MdtpReader *reader, size_t offset) {
+    uint32_t count;
+
+    if (offset >= reader->end) {
+        return 0;
+    }
+
+    uint8_t element_type = reader->data[offset++];
+
+    if ((element_type != MDTP_VALUE_U64 && element_type != MDTP_VALUE_F64) ||
+        !mdtp_reader_read_count(reader, &offset, &count) ||
+        (uint64_t)count * 8 > reader->end - offset) {
+        return 0;
+    }
+
+    reader->value_type = element_type;
+    reader->value = offset;
+    reader->value_length = count * 8;
+    reader->node_end = offset + (size_t)count * 8;
+
+    return 1;
+}
+
+
+// Parse `[bound count] [bounds] [counts] [8 sum]` of the histogram node at `offset`, `0` if it is
+// malformed
+static int mdtp_reader_parse_histogram(MdtpReader *reader, size_t offset) {
+    uint32_t count;
+
+    if (offset > reader->end || !mdtp_reader_read_count(reader, &offset, &count) ||
+        count > MDTP_HISTOGRAM_MAX_BOUNDS || (size_t)count * 8 > reader->end - offset) {
+        return 0;
+    }
+
+    reader->value = offset;
+    reader->value_length = count * 8;
+    offset += (size_t)count * 8;
+
+    // One count more than bounds, for the bucket above the last bound
+    if (reader->version == MDTP_VERSION_2) {
+        for (uint32_t i = 0; i <= count; ++i) {
+            uint64_t value;
+            size_t   size = read_varint(reader->data, offset, reader->end, &value);
+
+            if (size == 0) {
+                return 0;
+            }
+
+            offset += size;
+        }
+    } else {
+        if (((size_t)count + 1) * 8 > reader->end - offset) {
+            return 0;
+        }
+
+        offset += ((size_t)count + 1) * 8;
+    }
+
+    if (reader->end - offset < 8) {
+        return 0;
+    }
+
+    reader->node_end = offset + 8;
+
+    return 1;
+}
+
+
+// Parse the table header at `reader->offset` and move to the first cell, `0` if it is malformed
+static int mdtp_reader_parse_table(MdtpReader *reader) {
+    // [1 layout] [row count] [column count] [columns]
+    size_t offset = reader->offset;
+
+    if (offset == reader->end || reader->data[offset] > MDTP_TABLE_COLUMNS) {
+        return 0;
+    }
+
+    reader->layout = reader->data[offset++];
+
+    if (!mdtp_reader_read_count(reader, &offset, &reader->rows) ||
+        !mdtp_reader_read_count(reader, &offset, &reader->columns)) {
+        return 0;
+    }
+
+    reader->first_column = offset;
+
+    for (uint32_t i = 0; i < reader->columns; ++i) {
+        if (!mdtp_reader_parse_column(reader, &offset)) {
+            return 0;
+        }
+    }
+
+    // Every cell takes at least one byte, so absurd counts are caught here
+    if ((uint64_t)reader->rows * reader->columns > reader->end - offset) {
+        return 0;
+    }
+
+    reader->offset = offset;
+    reader->next_column = reader->first_column;
+
+    return 1;
+}
+
+
+// Parse the column definition at `*offset` into the name and units fields and move past it, `0`
+// if it is malformed
+static int mdtp_reader_parse_column(MdtpReader *reader, size_t *offset) {
+    uint32_t length;
+
+    // [length] [name] [length] [units]
+    if (reader->version == MDTP_VERSION_2) {
+        if (!mdtp_reader_read_varint(reader, offset, &length)) {
+            return 0;
+        }
+
+        reader->name = *offset;
+        reader->name_length = length;
+        *offset += length;
+
+        if (!mdtp_reader_read_varint(reader, offset, &length)) {
+            return 0;
+        }
+
+        reader->units = *offset;
+        reader->units_length = length;
+        *offset += length;
+
+        return 1;
+    }
+
+    if (!mdtp_reader_read_length(reader, *offset, &length)) {
+        return 0;
+    }
+
+    reader->name = *offset + 4;
+    reader->name_length = length;
+    *offset = reader->name + length;
+
+    if (!mdtp_reader_read_length(reader, *offset, &length)) {
+        return 0;
+    }
+
+    reader->units = *offset + 4;
+    reader->units_length = length;
+    *offset = reader->units + length;
+
+    return 1;
+}
+
+
+// Parse the table cell at `reader->offset`, `0` if it is malformed or the table has no more cells
+static int mdtp_reader_parse_cell(MdtpReader *reader) {
+    uint64_t cell = reader->cell;
+
+    if (cell == (uint64_t)reader->rows * reader->columns) {
+        return 0; // Bytes after the last cell
+    }
+
+    // A row-major table moves to the next column with every cell, a column-major one once a
+    // column is over. The definitions were checked by `sdk_mdtp_reader_enter_table`
+    int next = reader->layout == MDTP_TABLE_ROWS || cell % reader->rows == 0;
+
+    if (next) {
+        if (reader->layout == MDTP_TABLE_ROWS && cell % reader->columns == 0) {
+            reader->next_column = reader->first_column;
+        }
+
+        mdtp_reader_parse_column(reader, &reader->next_column);
+    }
+
+    reader->node = reader->offset;
+    reader->type = MDTP_NODE_VALUE;
+
+    if (reader->version == MDTP_VERSION_2) {
+        if (!mdtp_reader_parse_value_v2(reader, reader->offset)) {
+            return 0;
+        }
+    } else {
+        // [4 value length] [value]
+        uint32_t length;
+
+        if (!mdtp_reader_read_length(reader, reader->offset, &length)) {
+            return 0;
+        }
+
+        reader->value_type = MDTP_VALUE_TEXT;
+        reader->value = reader->offset + 4;
+        reader->value_length = length;
+        reader->node_end = reader->value + length;
+    }
+
+    reader->cell = cell + 1;
+
+    return 1;
+}
+
+
+// Read the row or column count at `*offset` and move past it, `0` if it crosses the end
+static int mdtp_reader_read_count(const MdtpReader *reader, size_t *offset, uint32_t *count) {
+    if (reader->version != MDTP_VERSION_2) {
+        if (reader->end - *offset < 4) {
+            return 0;
+        }
+
+        *count = read_uint32_be(reader->data, *offset);
+        *offset += 4;
+
+        return 1;
+    }
+
+    uint64_t value;
+    size_t   size = read_varint(reader->data, *offset, reader->end, &value);
+
+    if (size == 0 || value > UINT32_MAX) {
+        return 0;
+    }
+
+    *count = (uint32_t)value;
+    *offset += size;
+
+    return 1;
+}
+
+
+// Read the varint length at `*offset` and move past it, `0` if the field or the bytes it counts
+// cross the end
+static int mdtp_reader_read_varint(const MdtpReader *reader, size_t *offset, uint32_t *length) {
+    uint64_t value;
+    size_t   size = 0;
+
+    if (*offset <= reader->end) {
+        size = read_varint(reader->data, *offset, reader->end, &value);
+    }
+
+    if (size == 0 || value > reader->end - *offset - size) {
+        return 0;
+    }
+
+    *offset += size;
+    *length = (uint32_t)value;
+
+    return 1;
+}
+
+
+// Parse text of decimal digits, `0` if it is not one or does not fit
+static int mdtp_reader_text_u64(const char *text, size_t length, uint64_t *value) {
+    uint64_t result = 0;
+
+    if (length == 0) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < length; ++i) {
+        if (text[i] < '0' || text[i] > '9') {
+            return 0;
+        }
+
+        uint64_t digit = (uint64_t)(text[i] - '0');
+
+        if (result > (UINT64_MAX - digit) / 10) {
+            return 0;
+        }
+
+        result = result * 10 + digit;
+    }
+
+    *value = result;
+
+    return 1;
+}
@@ -0,0 +1,286 @@
+/**
+ * @file modules/mdtp_registry.c
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#include "../../include/modules/internals/mdtp_registry.h"
+#include "../../include/modules/internals/mdtp_builder.h"
+#include "imodule_internal.h"
+#include "mdtp_internal.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+/**
+ * @brief Shard of a counter, alone on its cache line
+ */
+typedef struct MdtpMetricShard {
+    _Alignas(MDTP_CACHE_LINE) _Atomic uint64_t value; ///< Part of the counter
+} MdtpMetricShard;
+
+struct MdtpMetric {
+    MdtpMetric     *next;      ///< Next metric in the order of registration
+    char           *name;      ///< Name of the value node
+    char           *units;     ///< Units of the value node
+    int             precision; ///< Fractional digits of a gauge
+    uint8_t         kind;      ///< `MDTP_METRIC_*`
+    size_t          mask;      ///< Count of shards minus one, the count is a power of two
+    MdtpMetricShard shards[];  ///< Shards, a gauge keeps the bits in the first
+};
+
+typedef struct MdtpRegistry {
+    MdtpMetric *first;  ///< First registered metric
+    MdtpMetric *last;   ///< Last registered metric
+    size_t      count;  ///< Count of metrics
+    size_t      shards; ///< Count of shards of every counter
+} MdtpRegistry;
+
+
+// Forward declaration begin
+static MdtpMetric *mdtp_registry_register(IModule    *module,
+                                          uint8_t     kind,
+                                          const char *name,
+                                          int         precision,
+                                          const char *units);
+static void        mdtp_registry_free_metric(MdtpMetric *metric);
+static uint64_t    mdtp_registry_sum(const MdtpMetric *metric);
+// Forward declaration end
+
+
+// Register counter
+MdtpMetric *sdk_mdtp_registry_counter(IModule *module, const char *name, const char *units) {
+    return mdtp_registry_register(module, MDTP_METRIC_COUNTER, name, 0, units);
+}
+
+
+// Register up/down counter
+MdtpMetric *sdk_mdtp_registry_updown(IModule *module, const char *name, const char *units) {
+    return mdtp_registry_register(module, MDTP_METRIC_UPDOWN, name, 0, units);
+}
+
+
+// Register gauge
+MdtpMetric *sdk_mdtp_registry_gauge(IModule    *module,
+                                    const char *name,
+                                    int         precision,
+                                    const char *units) {
+    return mdtp_registry_register(module, MDTP_METRIC_GAUGE, name, precision, units);
+}
+
+
+// Get count of metrics
+size_t sdk_mdtp_registry_size(const IModule *module) {
+    return module->registry == NULL ? 0 : module->registry->count;
+}
+
+
+// Write every metric into the frame being built
+SDKStatus sdk_mdtp_registry_add(const IModule *module, MdtpBuilder *builder) {
+    if (module->registry == NULL) {
+        return SDK_OK;
+    }
+
+    for (MdtpMetric *metric = module->registry->first; metric != NULL; metric = metric->next) {
+        SDKStatus status;
+
+        switch (metric->kind) {
+        case MDTP_METRIC_COUNTER:
+            status = sdk_mdtp_builder_add_value_u64(
+                builder, metric->name, sdk_mdtp_metric_u64(metric), metric->units);
+            break;
+        case MDTP_METRIC_UPDOWN:
+            status = sdk_mdtp_builder_add_value_i64(
+                builder, metric->name, sdk_mdtp_metric_i64(metric), metric->units);
+            break;
+        default:
+            status = sdk_mdtp_builder_add_value_f64(builder,
+                                                    metric->name,
+                                                    sdk_mdtp_metric_f64(metric),
+                                                    metric->precision,
+                                                    metric->units);
+            break;
+        }
+
+        if (status != SDK_OK) {
+            return status;
+        }
+    }
+
+    return SDK_OK;
+}
+
+
+// Add to counter
+void sdk_mdtp_metric_add(MdtpMetric *metric, uint64_t value) {
+    MdtpMetricShard *shard = &metric->shards[mdtp_thread_number() & metric->mask];
+
+    atomic_fetch_add_explicit(&shard->value, value, memory_order_relaxed);
+}
+
+
+// Add to up/down counter
+void sdk_mdtp_metric_add_i64(MdtpMetric *metric, int64_t value) {
+    // Unsigned addition wraps, so the sum of the shards is the signed sum of the additions
+    sdk_mdtp_metric_add(metric, (uint64_t)value);
+}
+
+
+// Set gauge
+void sdk_mdtp_metric_set(MdtpMetric *metric, double value) {
+    uint64_t bits;
+
+    memcpy(&bits, &value, sizeof(double));
+    atomic_store_explicit(&metric->shards[0].value, bits, memory_order_relaxed);
+}
+
+
+// Get counter
+uint64_t sdk_mdtp_metric_u64(const MdtpMetric *metric) {
+    return mdtp_registry_sum(metric);
+}
+
+
+// Get up/down counter
+int64_t sdk_mdtp_metric_i64(const MdtpMetric *metric) {
+    return (int64_t)mdtp_registry_sum(metric);
+}
+
+
+// Get gauge
+double sdk_mdtp_metric_f64(const MdtpMetric *metric) {
+    uint64_t bits = atomic_load_explicit(&metric->shards[0].value, memory_order_relaxed);
+    double   value;
+
+    memcpy(&value, &bits, sizeof(double));
+
+    return value;
+}
+
+
+// Get kind of metric
+uint8_t sdk_mdtp_metric_kind(const MdtpMetric *metric) {
+    return metric->kind;
+}
+
+
+// Destroy registry
+void mdtp_registry_destroy(MdtpRegistry *registry) {
+    if (registry == NULL) {
+        return;
+    }
+
+    MdtpMetric *metric = registry->first;
+
+    while (metric != NULL) {
+        MdtpMetric *next = metric->next;
+        mdtp_registry_free_metric(metric);
+        metric = next;
+    }
+
+    free(registry);
+}
+
+
+// Register metric, create the registry on first use
+static MdtpMetric *mdtp_registry_register(IModule    *module,
+                                          uint8_t     kind,
+                                          const char *name,
+                                          int         precision,
+                                          const char *units) {
+    if (name == NULL || units == NULL) {
+        return NULL;
+    }
+
+    MdtpRegistry *registry = module->registry;
+
+    if (registry == NULL) {
+        registry = calloc(1, sizeof(MdtpRegistry));
+
+        if (registry == NULL) {
+            return NULL;
+        }
+
+        // Threads on different processors get different shards as long as their numbers are
+        // consecutive
+        long processors = sysconf(_SC_NPROCESSORS_CONF);
+
+        // An unknown count gives one shard
+        if (processors < 1) {
+            processors = 1;
+        }
+
+        registry->shards = 1;
+
+        while (registry->shards < (size_t)processors &&
+               registry->shards < MDTP_REGISTRY_MAX_SHARDS) {
+            registry->shards *= 2;
+        }
+
+        module->registry = registry;
+    }
+
+    for (MdtpMetric *metric = registry->first; metric != NULL; metric = metric->next) {
+        if (strcmp(metric->name, name) == 0) {
+            return metric->kind == kind ? metric : NULL;
+        }
+    }
+
+    // Shards are whole cache lines, so the size is a multiple of the alignment, as
+    // `aligned_alloc` needs
+    size_t      size = sizeof(MdtpMetric) + registry->shards * sizeof(MdtpMetricShard);
+    MdtpMetric *metric = aligned_alloc(_Alignof(MdtpMetric), size);
+
+    if (metric == NULL) {
+        return NULL;
+    }
+
+    memset(metric, 0x0, size);
+
+    metric->name = strdup(name);
+    metric->units = strdup(units);
+    metric->precision = precision;
+    metric->kind = kind;
+    metric->mask = registry->shards - 1;
+
+    if (metric->name == NULL || metric->units == NULL) {
+        mdtp_registry_free_metric(metric);
+        return NULL;
+    }
+
+    if (registry->last == NULL) {
+        registry->first = metric;
+    } else {
+        registry->last->next = metric;
+    }
+
+    registry->last = metric;
+    ++registry->count;
+
+    return metric;
+}
+
+
+// Free metric
+static void mdtp_registry_free_metric(MdtpMetric *metric) {
+    free(metric->name);
+    free(metric->units);
+    free(metric);
+}
+
+
+// Sum shards of a counter
+static uint64_t mdtp_registry_sum(const MdtpMetric *metric) {
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i <= metric->mask; ++i) {
+        sum += atomic_load_explicit(&metric->shards[i].value, memory_order_relaxed);
+    }
+
+    return sum;
+}
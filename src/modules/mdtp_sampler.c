@@ -0,0 +1,298 @@
+/**
+ * @file modules/mdtp_sampler.c
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#include "../../include/modules/internals/mdtp_sampler.h"
+#include "imodule_internal.h"
+#include "mdtp_internal.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define MDTP_SAMPLER_SLOTS 3       ///< Buffers of the triple buffer
+#define MDTP_SAMPLER_SLOT_MASK 0x3 ///< Bits of `ready` holding the index of a buffer
+#define MDTP_SAMPLER_FRESH 0x4     ///< Bit of `ready` set if the server has not taken the buffer
+
+
+struct MdtpSampler {
+    MdtpFrameCopy        slots[MDTP_SAMPLER_SLOTS]; ///< Buffers of published frames
+    ABI_MODULE_DATA_INFO info;                      ///< Info of the frame collected last
+
+    _Atomic uint32_t ready; ///< Index of the latest complete buffer, with `MDTP_SAMPLER_FRESH`
+    uint32_t         back;  ///< Index of the buffer the sampler thread writes, owned by it
+    uint32_t         front; ///< Index of the buffer the server reads, owned by the server thread
+    uint8_t          any;   ///< `1` once the server has taken a frame
+
+    _Atomic uint64_t published; ///< Count of published frames
+
+    const ABI_MODULE_MDTP_DATA *(*collect)(void); ///< Collect routine of the module
+    uint32_t        interval_ms;                 ///< Milliseconds between collections
+    pthread_t       thread;                      ///< Sampler thread
+    pthread_mutex_t mutex;                       ///< Guards `stopping`
+    pthread_cond_t  wake;                        ///< Signaled when the sampler must stop
+    uint8_t         stopping;                    ///< `1` if the sampler thread must exit
+    uint8_t         running;                     ///< `1` while the sampler thread exists
+};
+
+
+// Forward declaration begin
+static MdtpSampler *mdtp_sampler_get(IModule *module);
+static void        *mdtp_sampler_run(void *argument);
+static void         mdtp_sampler_collect(IModule *module);
+static int          mdtp_sampler_take(MdtpSampler *sampler);
+// Forward declaration end
+
+
+// Start sampler
+SDKStatus sdk_mdtp_sampler_start(IModule *module,
+                                 const ABI_MODULE_MDTP_DATA *(*collect)(void),
+                                 uint32_t interval_ms) {
+    if (collect == NULL || interval_ms == 0 || mdtp_sampler_running(module) ||
+        mdtp_deadline_enabled(module) || mdtp_delta_enabled(module) ||
+        mdtp_dictionary_enabled(module) || mdtp_chunk_enabled(module)) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    MdtpSampler *sampler = mdtp_sampler_get(module);
+
+    if (sampler == NULL) {
+        return SDK_ALLOCATION_ERROR;
+    }
+
+    sampler->collect = collect;
+    sampler->interval_ms = interval_ms;
+    sampler->stopping = 0;
+
+    mdtp_sampler_collect(module);
+
+    // Set before the thread starts, which reads the neighboring fields
+    sampler->running = 1;
+
+    if (pthread_create(&sampler->thread, NULL, mdtp_sampler_run, module) != 0) {
+        sampler->running = 0;
+        return SDK_OTHER_ERROR;
+    }
+
+    return SDK_OK;
+}
+
+
+// Stop sampler
+void sdk_mdtp_sampler_stop(IModule *module) {
+    MdtpSampler *sampler = module->sampler;
+
+    if (sampler == NULL || !sampler->running) {
+        return;
+    }
+
+    pthread_mutex_lock(&sampler->mutex);
+    sampler->stopping = 1;
+    pthread_cond_signal(&sampler->wake);
+    pthread_mutex_unlock(&sampler->mutex);
+
+    pthread_join(sampler->thread, NULL);
+
+    sampler->running = 0;
+}
+
+
+// Get latest frame
+const ABI_MODULE_MDTP_DATA *sdk_mdtp_sampler_get_data(IModule *module) {
+    MdtpSampler *sampler = module->sampler;
+
+    if (sampler == NULL || !mdtp_sampler_take(sampler)) {
+        return NULL;
+    }
+
+    return &sampler->slots[sampler->front].mdtp_data;
+}
+
+
+// Get hash and generation of the returned frame
+const ABI_MODULE_DATA_INFO *sdk_mdtp_sampler_get_data_info(const IModule *module) {
+    const MdtpSampler *sampler = module->sampler;
+
+    if (sampler == NULL || !sampler->any) {
+        return NULL;
+    }
+
+    return &sampler->slots[sampler->front].info;
+}
+
+
+// Get count of published frames
+uint64_t sdk_mdtp_sampler_published(const IModule *module) {
+    if (module->sampler == NULL) {
+        return 0;
+    }
+
+    return atomic_load_explicit(&module->sampler->published, memory_order_relaxed);
+}
+
+
+// Check if sampler runs
+int mdtp_sampler_running(const IModule *module) {
+    return module->sampler != NULL && module->sampler->running;
+}
+
+
+// Destroy sampler
+void mdtp_sampler_destroy(IModule *module) {
+    MdtpSampler *sampler = module->sampler;
+
+    if (sampler == NULL) {
+        return;
+    }
+
+    sdk_mdtp_sampler_stop(module);
+
+    for (size_t i = 0; i < MDTP_SAMPLER_SLOTS; ++i) {
+        free(sampler->slots[i].data);
+    }
+
+    pthread_cond_destroy(&sampler->wake);
+    pthread_mutex_destroy(&sampler->mutex);
+    free(sampler);
+
+    module->sampler = NULL;
+}
+
+
+// Get sampler of module, create it on first use
+static MdtpSampler *mdtp_sampler_get(IModule *module) {
+    if (module->sampler != NULL) {
+        return module->sampler;
+    }
+
+    MdtpSampler       *sampler = calloc(1, sizeof(MdtpSampler));
+    pthread_condattr_t attributes;
+
+    if (sampler == NULL) {
+        return NULL;
+    }
+
+    // Deadlines are on the monotonic clock, so changes of the wall clock do not stall sampling
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+
+    if (pthread_mutex_init(&sampler->mutex, NULL) != 0) {
+        pthread_condattr_destroy(&attributes);
+        free(sampler);
+        return NULL;
+    }
+
+    if (pthread_cond_init(&sampler->wake, &attributes) != 0) {
+        pthread_condattr_destroy(&attributes);
+        pthread_mutex_destroy(&sampler->mutex);
+        free(sampler);
+        return NULL;
+    }
+
+    pthread_condattr_destroy(&attributes);
+
+    // Buffer `0` is written first, `1` waits as the latest one, `2` is read
+    sampler->back = 0;
+    atomic_init(&sampler->ready, 1);
+    sampler->front = 2;
+
+    module->sampler = sampler;
+
+    return sampler;
+}
+
+
+// Collect frames until the sampler is stopped
+static void *mdtp_sampler_run(void *argument) {
+    IModule        *module = argument;
+    MdtpSampler    *sampler = module->sampler;
+    struct timespec deadline;
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+    pthread_mutex_lock(&sampler->mutex);
+
+    while (!sampler->stopping) {
+        // The first frame was collected by `sdk_mdtp_sampler_start`
+        deadline.tv_sec += (time_t)(sampler->interval_ms / 1000);
+        deadline.tv_nsec += (long)(sampler->interval_ms % 1000) * 1000000;
+
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000;
+        }
+
+        int waited = 0;
+
+        while (!sampler->stopping && waited != ETIMEDOUT) {
+            waited = pthread_cond_timedwait(&sampler->wake, &sampler->mutex, &deadline);
+        }
+
+        if (sampler->stopping) {
+            break;
+        }
+
+        pthread_mutex_unlock(&sampler->mutex);
+
+        mdtp_sampler_collect(module);
+
+        // A collection longer than the interval moves the schedule instead of queueing up
+        struct timespec now;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        if (now.tv_sec > deadline.tv_sec ||
+            (now.tv_sec == deadline.tv_sec && now.tv_nsec > deadline.tv_nsec)) {
+            deadline = now;
+        }
+
+        pthread_mutex_lock(&sampler->mutex);
+    }
+
+    pthread_mutex_unlock(&sampler->mutex);
+
+    return NULL;
+}
+
+
+// Run collect routine and publish its frame
+static void mdtp_sampler_collect(IModule *module) {
+    MdtpSampler                *sampler = module->sampler;
+    const ABI_MODULE_MDTP_DATA *data = sampler->collect();
+
+    if (data == NULL) {
+        return;
+    }
+
+    // The previous frame stays published
+    if (mdtp_frame_copy(&sampler->slots[sampler->back], data, &sampler->info) != SDK_OK) {
+        return;
+    }
+
+    // The release makes the bytes visible to the server before the index
+    uint32_t previous = atomic_exchange_explicit(
+        &sampler->ready, sampler->back | MDTP_SAMPLER_FRESH, memory_order_acq_rel);
+
+    sampler->back = previous & MDTP_SAMPLER_SLOT_MASK;
+
+    atomic_fetch_add_explicit(&sampler->published, 1, memory_order_relaxed);
+}
+
+
+// Take the latest complete buffer if there is a new one, return `1` if the server has any
+static int mdtp_sampler_take(MdtpSampler *sampler) {
+    if (atomic_load_explicit(&sampler->ready, memory_order_relaxed) & MDTP_SAMPLER_FRESH) {
+        // The acquire pairs with the release of the publication
+        uint32_t previous =
+            atomic_exchange_explicit(&sampler->ready, sampler->front, memory_order_acq_rel);
+
+        sampler->front = previous & MDTP_SAMPLER_SLOT_MASK;
+        sampler->any = 1;
+    }
+
+    return sampler->any;
+}
@@ -0,0 +1,373 @@
+/**
+ * @file modules/mdtp_sketch.c
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#include "../../include/modules/internals/mdtp_sketch.h"
+#include "../../include/modules/internals/mdtp.h"
+#include "../../include/modules/internals/mdtp_builder.h"
+#include "imodule_internal.h"
+#include "mdtp_internal.h"
+#include <math.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MDTP_SKETCH_MANTISSA_BITS 52 ///< Bits of the mantissa of a double
+#define MDTP_SKETCH_QUANTILES 4      ///< Quantiles written by `sdk_mdtp_sketch_add`
+
+/*
+ * The bits of a positive double, read as an integer, grow with the value: the exponent is above
+ * the mantissa. Shifted right to keep `precision` bits of the mantissa, they are the key of a
+ * logarithmic bucket. Bucket `0` counts values below `min`, the last bucket values from `max`.
+ */
+
+struct MdtpSketch {
+    double             min;       ///< Smallest value with its own bucket
+    double             max;       ///< Largest value with its own bucket
+    uint64_t           min_key;   ///< Key of `min`
+    uint32_t           precision; ///< Count of bits of the mantissa in a key
+    size_t             buckets;   ///< Count of buckets of a shard
+    size_t             mask;      ///< Count of shards minus one, the count is a power of two
+    _Atomic uint64_t **shards;    ///< Counts of every bucket, one array for each shard
+    uint64_t          *merged;    ///< Counts of all shards summed by the last read
+};
+
+static const double mdtp_sketch_quantiles[MDTP_SKETCH_QUANTILES] = {0.5, 0.9, 0.99, 0.999};
+static const char  *mdtp_sketch_names[MDTP_SKETCH_QUANTILES] = {"p50", "p90", "p99", "p999"};
+
+
+// Forward declaration begin
+static uint64_t mdtp_sketch_key(const MdtpSketch *sketch, double value);
+static double   mdtp_sketch_value(const MdtpSketch *sketch, size_t bucket);
+static uint64_t mdtp_sketch_collect(MdtpSketch *sketch, int drain);
+static void     mdtp_sketch_estimate(const MdtpSketch *sketch,
+                                     uint64_t          total,
+                                     const double     *quantiles,
+                                     double           *values,
+                                     size_t            count);
+static void     mdtp_sketch_restore(MdtpSketch *sketch);
+// Forward declaration end
+
+
+// Create sketch
+MdtpSketch *sdk_mdtp_sketch_create(double min, double max, int precision, size_t shards) {
+    if (!(min > 0) || !(max > min) || !isfinite(max) || precision < 1 ||
+        precision > MDTP_SKETCH_MAX_PRECISION || shards == 0 || shards > SIZE_MAX / 2) {
+        return NULL;
+    }
+
+    MdtpSketch *sketch = calloc(1, sizeof(MdtpSketch));
+
+    if (sketch == NULL) {
+        return NULL;
+    }
+
+    sketch->min = min;
+    sketch->max = max;
+    sketch->precision = (uint32_t)precision;
+    sketch->min_key = mdtp_sketch_key(sketch, min);
+
+    uint64_t buckets = mdtp_sketch_key(sketch, max) - sketch->min_key + 2;
+    size_t   count = 1;
+
+    // A power of two, so a thread finds its shard with a mask
+    while (count < shards) {
+        count *= 2;
+    }
+
+    if (buckets > MDTP_SKETCH_MAX_BUCKETS) {
+        free(sketch);
+        return NULL;
+    }
+
+    sketch->buckets = (size_t)buckets;
+    sketch->mask = count - 1;
+    sketch->shards = calloc(count, sizeof(_Atomic uint64_t *));
+    sketch->merged = malloc(sketch->buckets * sizeof(uint64_t));
+
+    if (sketch->shards == NULL || sketch->merged == NULL) {
+        sdk_mdtp_sketch_destroy(sketch);
+        return NULL;
+    }
+
+    // Shards start and end on cache line boundaries, so threads recording into different shards
+    // never share a line
+    size_t size = (sketch->buckets * sizeof(_Atomic uint64_t) + MDTP_CACHE_LINE - 1) /
+                  MDTP_CACHE_LINE * MDTP_CACHE_LINE;
+
+    for (size_t i = 0; i < count; ++i) {
+        sketch->shards[i] = aligned_alloc(MDTP_CACHE_LINE, size);
+
+        if (sketch->shards[i] == NULL) {
+            sdk_mdtp_sketch_destroy(sketch);
+            return NULL;
+        }
+
+        memset(sketch->shards[i], 0x0, size);
+    }
+
+    return sketch;
+}
+
+
+// Destroy sketch
+void sdk_mdtp_sketch_destroy(MdtpSketch *sketch) {
+    if (sketch == NULL) {
+        return;
+    }
+
+    if (sketch->shards != NULL) {
+        for (size_t i = 0; i <= sketch->mask; ++i) {
+            free(sketch->shards[i]);
+        }
+    }
+
+    free(sketch->shards);
+    free(sketch->merged);
+    free(sketch);
+}
+
+
+// Record value
+void sdk_mdtp_sketch_record(MdtpSketch *sketch, double value) {
+    size_t bucket;
+
+    if (value >= sketch->max) {
+        bucket = sketch->buckets - 1;
+    } else if (value >= sketch->min) {
+        bucket = (size_t)(mdtp_sketch_key(sketch, value) - sketch->min_key) + 1;
+    } else if (isnan(value)) {
+        return;
+    } else {
+        bucket = 0;
+    }
+
+    _Atomic uint64_t *shard = sketch->shards[mdtp_thread_number() & sketch->mask];
+
+    atomic_fetch_add_explicit(&shard[bucket], 1, memory_order_relaxed);
+}
+
+
+// Merge sketches
+SDKStatus sdk_mdtp_sketch_merge(MdtpSketch *destination, const MdtpSketch *source) {
+    if (destination->min_key != source->min_key || destination->precision != source->precision ||
+        destination->buckets != source->buckets) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    for (size_t shard = 0; shard <= source->mask; ++shard) {
+        for (size_t i = 0; i < source->buckets; ++i) {
+            uint64_t count = atomic_load_explicit(&source->shards[shard][i], memory_order_relaxed);
+
+            if (count != 0) {
+                atomic_fetch_add_explicit(
+                    &destination->shards[0][i], count, memory_order_relaxed);
+            }
+        }
+    }
+
+    return SDK_OK;
+}
+
+
+// Reset sketch
+void sdk_mdtp_sketch_reset(MdtpSketch *sketch) {
+    for (size_t shard = 0; shard <= sketch->mask; ++shard) {
+        for (size_t i = 0; i < sketch->buckets; ++i) {
+            atomic_store_explicit(&sketch->shards[shard][i], 0, memory_order_relaxed);
+        }
+    }
+}
+
+
+// Estimate quantiles
+uint64_t sdk_mdtp_sketch_quantiles(MdtpSketch   *sketch,
+                                   const double *quantiles,
+                                   double       *values,
+                                   size_t        count) {
+    uint64_t total = mdtp_sketch_collect(sketch, 0);
+
+    mdtp_sketch_estimate(sketch, total, quantiles, values, count);
+
+    return total;
+}
+
+
+// Write quantiles of the interval into the frame being built
+SDKStatus sdk_mdtp_sketch_add(MdtpSketch  *sketch,
+                              MdtpBuilder *builder,
+                              const char  *name,
+                              int          precision,
+                              const char  *units) {
+    double   values[MDTP_SKETCH_QUANTILES];
+    uint64_t total = mdtp_sketch_collect(sketch, 1);
+
+    mdtp_sketch_estimate(sketch, total, mdtp_sketch_quantiles, values, MDTP_SKETCH_QUANTILES);
+
+    SDKStatus status = sdk_mdtp_builder_begin_container(builder, name);
+
+    if (status == SDK_OK) {
+        status = sdk_mdtp_builder_add_value_u64(builder, "count", total, "");
+    }
+
+    for (size_t i = 0; i < MDTP_SKETCH_QUANTILES && status == SDK_OK; ++i) {
+        status = sdk_mdtp_builder_add_value_f64(
+            builder, mdtp_sketch_names[i], values[i], precision, units);
+    }
+
+    if (status == SDK_OK) {
+        status = sdk_mdtp_builder_end_container(builder);
+    }
+
+    if (status != SDK_OK) {
+        mdtp_sketch_restore(sketch);
+    }
+
+    return status;
+}
+
+
+// Make container node with quantiles of the interval
+void *sdk_mdtp_sketch_make(MdtpSketch *sketch, const char *name, int precision, const char *units) {
+    double   values[MDTP_SKETCH_QUANTILES];
+    void    *nodes[MDTP_SKETCH_QUANTILES + 1];
+    uint64_t total = mdtp_sketch_collect(sketch, 1);
+    void    *container = NULL;
+
+    mdtp_sketch_estimate(sketch, total, mdtp_sketch_quantiles, values, MDTP_SKETCH_QUANTILES);
+
+    nodes[0] = sdk_mdtp_make_value_u64("count", total, "");
+
+    for (size_t i = 0; i < MDTP_SKETCH_QUANTILES; ++i) {
+        nodes[i + 1] = sdk_mdtp_make_value_f64(mdtp_sketch_names[i], values[i], precision, units);
+    }
+
+    if (name != NULL) {
+        container = sdk_mdtp_make_container_v(name, nodes, MDTP_SKETCH_QUANTILES + 1);
+    }
+
+    // On failure the nodes are still ours
+    if (container == NULL) {
+        for (size_t i = 0; i < MDTP_SKETCH_QUANTILES + 1; ++i) {
+            if (nodes[i] != NULL) {
+                sdk_mdtp_free_value(nodes[i]);
+            }
+        }
+
+        mdtp_sketch_restore(sketch);
+    }
+
+    return container;
+}
+
+
+// Get key of a positive value
+static uint64_t mdtp_sketch_key(const MdtpSketch *sketch, double value) {
+    uint64_t bits;
+
+    memcpy(&bits, &value, sizeof(double));
+
+    return bits >> (MDTP_SKETCH_MANTISSA_BITS - sketch->precision);
+}
+
+
+// Get the value that stands for the values of a bucket
+static double mdtp_sketch_value(const MdtpSketch *sketch, size_t bucket) {
+    if (bucket == 0) {
+        return sketch->min;
+    }
+
+    if (bucket == sketch->buckets - 1) {
+        return sketch->max;
+    }
+
+    // The middle of the bucket is off by at most half of its width
+    uint64_t key = sketch->min_key + bucket - 1;
+    uint64_t low_bits = key << (MDTP_SKETCH_MANTISSA_BITS - sketch->precision);
+    uint64_t high_bits = (key + 1) << (MDTP_SKETCH_MANTISSA_BITS - sketch->precision);
+    double   low;
+    double   high;
+
+    memcpy(&low, &low_bits, sizeof(double));
+    memcpy(&high, &high_bits, sizeof(double));
+
+    double value = low + (high - low) / 2;
+
+    return value < sketch->min ? sketch->min : value > sketch->max ? sketch->max : value;
+}
+
+
+// Sum the shards into `merged`, with `drain` also set them to `0`, and return the total count
+static uint64_t mdtp_sketch_collect(MdtpSketch *sketch, int drain) {
+    uint64_t total = 0;
+
+    memset(sketch->merged, 0x0, sketch->buckets * sizeof(uint64_t));
+
+    for (size_t shard = 0; shard <= sketch->mask; ++shard) {
+        _Atomic uint64_t *counts = sketch->shards[shard];
+
+        for (size_t i = 0; i < sketch->buckets; ++i) {
+            uint64_t count = atomic_load_explicit(&counts[i], memory_order_relaxed);
+
+            // An exchange takes every value recorded up to it, the next ones stay for later
+            if (drain && count != 0) {
+                count = atomic_exchange_explicit(&counts[i], 0, memory_order_relaxed);
+            }
+
+            sketch->merged[i] += count;
+            total += count;
+        }
+    }
+
+    return total;
+}
+
+
+// Estimate quantiles from `merged`
+static void mdtp_sketch_estimate(const MdtpSketch *sketch,
+                                 uint64_t          total,
+                                 const double     *quantiles,
+                                 double           *values,
+                                 size_t            count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (total == 0) {
+            values[i] = 0;
+            continue;
+        }
+
+        // Rank of the quantile among the values in order, from `0`
+        uint64_t rank = 0;
+
+        if (quantiles[i] >= 1) {
+            rank = total - 1;
+        } else if (quantiles[i] > 0) {
+            rank = (uint64_t)(quantiles[i] * (double)(total - 1));
+        }
+
+        uint64_t seen = 0;
+        size_t   bucket = 0;
+
+        while (bucket + 1 < sketch->buckets && seen + sketch->merged[bucket] <= rank) {
+            seen += sketch->merged[bucket];
+            ++bucket;
+        }
+
+        values[i] = mdtp_sketch_value(sketch, bucket);
+    }
+}
+
+
+// Give the counts of the last drain back to the sketch
+static void mdtp_sketch_restore(MdtpSketch *sketch) {
+    for (size_t i = 0; i < sketch->buckets; ++i) {
+        if (sketch->merged[i] != 0) {
+            atomic_fetch_add_explicit(
+                &sketch->shards[0][i], sketch->merged[i], memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,614 @@
+/**
+ * @file modules/mdtp_template.c
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#include "../../include/modules/internals/mdtp_template.h"
+#include "../../include/modules/internals/abi.h"
+#include "../../include/modules/internals/imodule.h"
+#include "../../include/modules/internals/mdtp.h"
+#include "../../include/modules/internals/mdtp_builder.h"
+#include "../../include/modules/internals/mdtp_format.h"
+#include "../../include/modules/internals/memutils.h"
+#include "imodule_internal.h"
+#include "mdtp_internal.h"
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+struct MdtpTemplateSlot {
+    MdtpTemplate *owner;            ///< Template of the slot
+    size_t        offset;           ///< Offset of the value length field in the frame
+    uint32_t      length;           ///< Length of the value in the frame
+    uint8_t       dirty;            ///< `1` if the value changed since the last emit
+    uint8_t       resized;          ///< `1` if `pending` holds a value of a new length
+    char         *pending;          ///< Value of a new length, written to the frame on emit
+    uint32_t      pending_length;   ///< Count of bytes of `pending`
+    size_t        pending_capacity; ///< Count of bytes allocated for `pending`
+};
+
+typedef struct MdtpTemplateContainer {
+    size_t   size_offset;  ///< Offset of the payload size field in the frame
+    uint32_t payload_size; ///< Payload size of the container
+    size_t   first_slot;   ///< Index of the first slot inside the container
+    size_t   end_slot;     ///< Index after the last slot inside the container
+} MdtpTemplateContainer;
+
+struct MdtpTemplate {
+    uint8_t *data;           ///< Current frame (header + payload)
+    size_t   size;           ///< Count of bytes of the frame
+    size_t   capacity;       ///< Count of bytes allocated for `data`
+    uint8_t *spare;          ///< Buffer the frame is rewritten into when values change length
+    size_t   spare_capacity; ///< Count of bytes allocated for `spare`
+
+    MdtpTemplateSlot      *slots;            ///< Value nodes in the order of appearance
+    size_t                 slots_count;      ///< Count of slots
+    MdtpTemplateContainer *containers;       ///< Root and container nodes
+    size_t                 containers_count; ///< Count of containers
+    size_t                *dirty;            ///< Indices of dirty slots
+    size_t                 dirty_count;      ///< Count of dirty slots
+    size_t                 resized_count;    ///< Count of slots with `resized` set
+    int64_t               *shift;            ///< Scratch: length change of slots before slot `i`
+
+    const IModule *module; ///< Module the last frame was emitted to
+    uint64_t       serial; ///< Serial of the last emitted frame in `module`
+    uint64_t       layout; ///< Incremented whenever offsets of nodes in the frame change
+};
+
+
+// Forward declaration begin
+static MdtpTemplate *mdtp_template_create(uint8_t *data, size_t size, size_t capacity);
+static int           mdtp_template_walk(MdtpTemplate *mdtp_template,
+                                        size_t        offset,
+                                        size_t        end,
+                                        uint32_t      depth,
+                                        int           fill);
+static SDKStatus     mdtp_template_rebuild(MdtpTemplate *mdtp_template);
+// Forward declaration end
+
+
+// Compile template from nodes
+MdtpTemplate *sdk_mdtp_template_compile(void *first, ...) {
+    if (first == NULL) {
+        return NULL;
+    }
+
+    va_list args;
+    size_t  count = 1;
+
+    // Count nodes
+    va_start(args, first);
+    while (va_arg(args, void *) != NULL) {
+        ++count;
+    }
+    va_end(args);
+
+    void **nodes = malloc(count * sizeof(void *));
+
+    // Collect nodes into an array
+    va_start(args, first);
+    for (size_t i = 0; i < count; ++i) {
+        void *node = i == 0 ? first : va_arg(args, void *);
+
+        if (nodes != NULL) {
+            nodes[i] = node;
+        } else {
+            free(node); // Nodes are owned by us, even on failure
+        }
+    }
+    va_end(args);
+
+    if (nodes == NULL) {
+        return NULL;
+    }
+
+    MdtpTemplate *mdtp_template = sdk_mdtp_template_compile_v(nodes, count);
+
+    free(nodes);
+
+    return mdtp_template;
+}
+
+
+// Compile template from array of nodes
+MdtpTemplate *sdk_mdtp_template_compile_v(void **nodes, size_t count) {
+    // A container with an empty name is [1 type] [4 name length = 0] [4 payload size] [payload],
+    // so its payload is the payload of the frame
+    uint8_t *container = sdk_mdtp_make_container_v("", nodes, count);
+
+    if (container == NULL) {
+        // Nodes are owned by us, even on failure
+        for (size_t i = 0; nodes != NULL && i < count; ++i) {
+            free(nodes[i]);
+        }
+
+        return NULL;
+    }
+
+    uint32_t payload_size = read_uint32_be(container, 5);
+
+    // Turn the container into a frame in place
+    memmove(container + MDTP_HEADER_SIZE, container + 9, payload_size);
+    write_ubyte_be(container, 0, MDTP_VERSION);
+    write_uint32_be(container, 1, payload_size);
+
+    return mdtp_template_create(
+        container, (size_t)MDTP_HEADER_SIZE + payload_size, (size_t)9 + payload_size);
+}
+
+
+// Destroy template
+void sdk_mdtp_template_destroy(MdtpTemplate *mdtp_template) {
+    if (mdtp_template == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < mdtp_template->slots_count; ++i) {
+        free(mdtp_template->slots[i].pending);
+    }
+
+    free(mdtp_template->data);
+    free(mdtp_template->spare);
+    free(mdtp_template->slots);
+    free(mdtp_template->containers);
+    free(mdtp_template->dirty);
+    free(mdtp_template->shift);
+    free(mdtp_template);
+}
+
+
+// Get count of slots
+size_t sdk_mdtp_template_slot_count(const MdtpTemplate *mdtp_template) {
+    return mdtp_template->slots_count;
+}
+
+
+// Get layout generation
+uint64_t sdk_mdtp_template_layout(const MdtpTemplate *mdtp_template) {
+    return mdtp_template->layout;
+}
+
+
+// Get slot by index
+MdtpTemplateSlot *sdk_mdtp_template_slot_at(MdtpTemplate *mdtp_template, size_t index) {
+    if (index >= mdtp_template->slots_count) {
+        return NULL;
+    }
+
+    return &mdtp_template->slots[index];
+}
+
+
+// Get slot by path
+MdtpTemplateSlot *sdk_mdtp_template_slot(MdtpTemplate *mdtp_template, const char *path) {
+    if (path == NULL) {
+        return NULL;
+    }
+
+    const uint8_t *data = mdtp_template->data;
+    size_t         offset = MDTP_HEADER_SIZE;
+    size_t         end = mdtp_template->size;
+
+    for (;;) {
+        const char *separator = strchr(path, '/');
+        size_t      name_length = separator != NULL ? (size_t)(separator - path) : strlen(path);
+        int         found = 0;
+
+        // Find node with the name among nodes in [offset, end)
+        while (offset < end) {
+            uint8_t  type = data[offset];
+            uint32_t node_name_length = read_uint32_be(data, offset + 1);
+            size_t   body = offset + 5 + node_name_length;
+            int      matches = node_name_length == name_length &&
+                          memcmp(data + offset + 5, path, name_length) == 0;
+
+            if (type == 0) {
+                size_t payload_end = body + 4 + read_uint32_be(data, body);
+
+                if (matches && separator != NULL) {
+                    // Descend into the container
+                    offset = body + 4;
+                    end = payload_end;
+                    found = 1;
+                    break;
+                }
+
+                offset = payload_end;
+            } else {
+                uint32_t units_length = read_uint32_be(data, body);
+                size_t   value_offset = body + 4 + units_length;
+
+                if (matches && separator == NULL) {
+                    // Find the slot of the value node, slots are sorted by offset
+                    size_t low = 0;
+                    size_t high = mdtp_template->slots_count;
+
+                    while (low < high) {
+                        size_t middle = low + (high - low) / 2;
+
+                        if (mdtp_template->slots[middle].offset < value_offset) {
+                            low = middle + 1;
+                        } else {
+                            high = middle;
+                        }
+                    }
+
+                    return &mdtp_template->slots[low];
+                }
+
+                offset = value_offset + 4 + read_uint32_be(data, value_offset);
+            }
+        }
+
+        if (!found) {
+            return NULL;
+        }
+
+        path = separator + 1;
+    }
+}
+
+
+// Set value of slot
+SDKStatus sdk_mdtp_template_set(MdtpTemplateSlot *slot, const char *value) {
+    if (value == NULL) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    return sdk_mdtp_template_set_n(slot, value, strlen(value));
+}
+
+
+// Set value of slot with explicit length
+SDKStatus sdk_mdtp_template_set_n(MdtpTemplateSlot *slot, const char *value, size_t value_length) {
+    if (value == NULL || value_length > UINT32_MAX) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    MdtpTemplate *mdtp_template = slot->owner;
+
+    if (value_length == slot->length) {
+        // Same length: the value is written into the frame right away
+        uint8_t *current = mdtp_template->data + slot->offset + 4;
+
+        if (slot->resized) {
+            slot->resized = 0;
+            --mdtp_template->resized_count;
+        }
+
+        if (memcmp(current, value, value_length) == 0) {
+            return SDK_OK;
+        }
+
+        memcpy(current, value, value_length);
+    } else {
+        // New length: the frame is rewritten on emit, keep the value until then
+        if (slot->pending_capacity < value_length) {
+            char *pending = realloc(slot->pending, value_length);
+
+            if (pending == NULL) {
+                return SDK_ALLOCATION_ERROR;
+            }
+
+            slot->pending = pending;
+            slot->pending_capacity = value_length;
+        }
+
+        memcpy(slot->pending, value, value_length);
+        slot->pending_length = (uint32_t)value_length;
+
+        if (!slot->resized) {
+            slot->resized = 1;
+            ++mdtp_template->resized_count;
+        }
+    }
+
+    if (!slot->dirty) {
+        slot->dirty = 1;
+        mdtp_template->dirty[mdtp_template->dirty_count++] = (size_t)(slot - mdtp_template->slots);
+    }
+
+    return SDK_OK;
+}
+
+
+// Set value of slot to unsigned integer
+SDKStatus sdk_mdtp_template_set_u64(MdtpTemplateSlot *slot, uint64_t value) {
+    char   text[MDTP_U64_MAX_LENGTH];
+    size_t length = sdk_mdtp_format_u64(text, value);
+
+    return sdk_mdtp_template_set_n(slot, text, length);
+}
+
+
+// Set value of slot to signed integer
+SDKStatus sdk_mdtp_template_set_i64(MdtpTemplateSlot *slot, int64_t value) {
+    char   text[MDTP_I64_MAX_LENGTH];
+    size_t length = sdk_mdtp_format_i64(text, value);
+
+    return sdk_mdtp_template_set_n(slot, text, length);
+}
+
+
+// Set value of slot to floating point number
+SDKStatus sdk_mdtp_template_set_f64(MdtpTemplateSlot *slot, double value, int precision) {
+    char   text[MDTP_F64_MAX_LENGTH];
+    size_t length = sdk_mdtp_format_f64(text, value, precision);
+
+    return sdk_mdtp_template_set_n(slot, text, length);
+}
+
+
+// Emit frame
+const ABI_MODULE_MDTP_DATA *sdk_mdtp_template_emit(MdtpTemplate *mdtp_template, IModule *module) {
+    if (mdtp_template->resized_count != 0) {
+        if (mdtp_template_rebuild(mdtp_template) != SDK_OK) {
+            return NULL;
+        }
+
+        mdtp_template->module = NULL; // Layout changed, the previous frame cannot be patched
+    }
+
+    uint32_t size = (uint32_t)mdtp_template->size;
+
+    if (mdtp_template->module == module && module->frame_serial == mdtp_template->serial) {
+        // The module still holds our previous frame, only changed values are rewritten
+        for (size_t i = 0; i < mdtp_template->dirty_count; ++i) {
+            const MdtpTemplateSlot *slot = &mdtp_template->slots[mdtp_template->dirty[i]];
+
+            memcpy(module->frame + slot->offset + 4,
+                   mdtp_template->data + slot->offset + 4,
+                   slot->length);
+        }
+    } else {
+        uint8_t *frame = sdk_imodule_reserve_mdtp_data(module, size);
+
+        if (frame == NULL) {
+            return NULL;
+        }
+
+        memcpy(frame, mdtp_template->data, size);
+    }
+
+    for (size_t i = 0; i < mdtp_template->dirty_count; ++i) {
+        mdtp_template->slots[mdtp_template->dirty[i]].dirty = 0;
+    }
+
+    mdtp_template->dirty_count = 0;
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_imodule_commit_mdtp_data(module, size);
+
+    mdtp_template->module = module;
+    mdtp_template->serial = module->frame_serial;
+
+    return data;
+}
+
+
+// Create template owning the frame `data`
+static MdtpTemplate *mdtp_template_create(uint8_t *data, size_t size, size_t capacity) {
+    MdtpTemplate *mdtp_template = malloc(sizeof(MdtpTemplate));
+
+    if (mdtp_template == NULL) {
+        free(data);
+        return NULL;
+    }
+
+    memset(mdtp_template, 0x0, sizeof(MdtpTemplate));
+    mdtp_template->data = data;
+    mdtp_template->size = size;
+    mdtp_template->capacity = capacity;
+
+    // First pass counts slots and containers, second pass fills them
+    if (!mdtp_template_walk(mdtp_template, MDTP_HEADER_SIZE, size, 0, 0)) {
+        sdk_mdtp_template_destroy(mdtp_template);
+        return NULL;
+    }
+
+    size_t slots_count = mdtp_template->slots_count;
+    size_t containers_count = mdtp_template->containers_count + 1; // With root
+
+    mdtp_template->slots = calloc(slots_count + 1, sizeof(MdtpTemplateSlot));
+    mdtp_template->containers = calloc(containers_count, sizeof(MdtpTemplateContainer));
+    mdtp_template->dirty = calloc(slots_count + 1, sizeof(size_t));
+    mdtp_template->shift = calloc(slots_count + 1, sizeof(int64_t));
+
+    if (mdtp_template->slots == NULL || mdtp_template->containers == NULL ||
+        mdtp_template->dirty == NULL || mdtp_template->shift == NULL) {
+        sdk_mdtp_template_destroy(mdtp_template);
+        return NULL;
+    }
+
+    // Root is the container with the payload size in the header
+    mdtp_template->containers[0] = (MdtpTemplateContainer){
+        .size_offset = 1,
+        .payload_size = (uint32_t)(size - MDTP_HEADER_SIZE),
+        .first_slot = 0,
+        .end_slot = slots_count,
+    };
+    mdtp_template->slots_count = 0;
+    mdtp_template->containers_count = 1;
+
+    mdtp_template_walk(mdtp_template, MDTP_HEADER_SIZE, size, 0, 1);
+
+    return mdtp_template;
+}
+
+
+// Walk nodes in [offset, end): count (`fill` is 0) or record (`fill` is 1) slots and containers
+static int mdtp_template_walk(MdtpTemplate *mdtp_template,
+                              size_t        offset,
+                              size_t        end,
+                              uint32_t      depth,
+                              int           fill) {
+    const uint8_t *data = mdtp_template->data;
+
+    while (offset < end) {
+        if (end - offset < 5) {
+            return 0;
+        }
+
+        uint8_t  type = data[offset];
+        uint64_t body = (uint64_t)offset + 5 + read_uint32_be(data, offset + 1);
+
+        if (body + 4 > end) {
+            return 0;
+        }
+
+        if (type == 0) {
+            uint32_t payload_size = read_uint32_be(data, (size_t)body);
+            uint64_t payload_end = body + 4 + payload_size;
+
+            if (payload_end > end || depth == MDTP_MAX_DEPTH) {
+                return 0;
+            }
+
+            size_t container = mdtp_template->containers_count++;
+
+            if (fill) {
+                mdtp_template->containers[container] = (MdtpTemplateContainer){
+                    .size_offset = (size_t)body,
+                    .payload_size = payload_size,
+                    .first_slot = mdtp_template->slots_count,
+                };
+            }
+
+            if (!mdtp_template_walk(
+                    mdtp_template, (size_t)body + 4, (size_t)payload_end, depth + 1, fill)) {
+                return 0;
+            }
+
+            if (fill) {
+                mdtp_template->containers[container].end_slot = mdtp_template->slots_count;
+            }
+
+            offset = (size_t)payload_end;
+        } else if (type == 1) {
+            uint64_t value_offset = body + 4 + read_uint32_be(data, (size_t)body);
+
+            if (value_offset + 4 > end) {
+                return 0;
+            }
+
+            uint32_t length = read_uint32_be(data, (size_t)value_offset);
+
+            if (value_offset + 4 + length > end) {
+                return 0;
+            }
+
+            size_t slot = mdtp_template->slots_count++;
+
+            if (fill) {
+                mdtp_template->slots[slot] = (MdtpTemplateSlot){
+                    .owner = mdtp_template,
+                    .offset = (size_t)value_offset,
+                    .length = length,
+                };
+            }
+
+            offset = (size_t)(value_offset + 4 + length);
+        } else {
+            return 0; // Unknown node type
+        }
+    }
+
+    return 1;
+}
+
+
+// Write values of new lengths into the frame and fix payload sizes around them
+static SDKStatus mdtp_template_rebuild(MdtpTemplate *mdtp_template) {
+    MdtpTemplateSlot *slots = mdtp_template->slots;
+    int64_t          *shift = mdtp_template->shift;
+
+    // shift[i] - how much slots before slot `i` grow (or shrink) the frame
+    shift[0] = 0;
+
+    for (size_t i = 0; i < mdtp_template->slots_count; ++i) {
+        shift[i + 1] = shift[i];
+
+        if (slots[i].resized) {
+            shift[i + 1] += (int64_t)slots[i].pending_length - (int64_t)slots[i].length;
+        }
+    }
+
+    int64_t size = (int64_t)mdtp_template->size + shift[mdtp_template->slots_count];
+
+    if (size > (int64_t)UINT32_MAX) {
+        return SDK_OTHER_ERROR;
+    }
+
+    if (mdtp_template->spare_capacity < (size_t)size) {
+        size_t   capacity = (size_t)size + (size_t)size / 2;
+        uint8_t *spare = realloc(mdtp_template->spare, capacity);
+
+        if (spare == NULL) {
+            return SDK_ALLOCATION_ERROR;
+        }
+
+        mdtp_template->spare = spare;
+        mdtp_template->spare_capacity = capacity;
+    }
+
+    // Copy unchanged spans between resized values
+    const uint8_t *source = mdtp_template->data;
+    uint8_t       *destination = mdtp_template->spare;
+    size_t         position = 0;
+
+    for (size_t i = 0; i < mdtp_template->slots_count; ++i) {
+        MdtpTemplateSlot *slot = &slots[i];
+
+        if (!slot->resized) {
+            slot->offset = (size_t)((int64_t)slot->offset + shift[i]);
+            continue;
+        }
+
+        size_t span = slot->offset - position;
+
+        memcpy(destination, source + position, span);
+        destination += span;
+        write_uint32_be(destination, 0, slot->pending_length);
+        memcpy(destination + 4, slot->pending, slot->pending_length);
+        destination += 4 + slot->pending_length;
+        position = slot->offset + 4 + slot->length;
+
+        slot->offset = (size_t)((int64_t)slot->offset + shift[i]);
+        slot->length = slot->pending_length;
+        slot->resized = 0;
+    }
+
+    memcpy(destination, source + position, mdtp_template->size - position);
+
+    // Size fields precede the slots of their container, so they move by the shift of the first one
+    for (size_t i = 0; i < mdtp_template->containers_count; ++i) {
+        MdtpTemplateContainer *container = &mdtp_template->containers[i];
+
+        container->size_offset = (size_t)((int64_t)container->size_offset +
+                                          (i == 0 ? 0 : shift[container->first_slot]));
+        container->payload_size = (uint32_t)((int64_t)container->payload_size +
+                                             shift[container->end_slot] -
+                                             shift[container->first_slot]);
+
+        write_uint32_be(mdtp_template->spare, container->size_offset, container->payload_size);
+    }
+
+    // Swap buffers
+    uint8_t *data = mdtp_template->data;
+    size_t   capacity = mdtp_template->capacity;
+
+    mdtp_template->data = mdtp_template->spare;
+    mdtp_template->capacity = mdtp_template->spare_capacity;
+    mdtp_template->spare = data;
+    mdtp_template->spare_capacity = capacity;
+    mdtp_template->size = (size_t)size;
+    mdtp_template->resized_count = 0;
+    ++mdtp_template->layout;
+
+    return SDK_OK;
+}
+
@@ -0,0 +1,728 @@
+/**
+ * @file modules/mdtp_tree.c
+ *
+ * @license GPLv3, see LICENSE for details
+ * @copyright Copyright (©) 2025, Maksim Shchavelev <maksimshchavelev@gmail.com>
+ */
+
+#include "../../include/modules/internals/mdtp_tree.h"
+#include "../../include/modules/internals/abi.h"
+#include "../../include/modules/internals/imodule.h"
+#include "../../include/modules/internals/mdtp.h"
+#include "../../include/modules/internals/mdtp_builder.h"
+#include "../../include/modules/internals/mdtp_format.h"
+#include "../../include/modules/internals/memutils.h"
+#include "imodule_internal.h"
+#include "mdtp_internal.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MDTP_TREE_MIN_BUCKETS 64    ///< Initial count of buckets of the path index
+#define MDTP_TREE_MIN_CAPACITY 256  ///< First allocation of the frame buffer
+
+typedef struct MdtpTreeNode MdtpTreeNode;
+
+struct MdtpTreeNode {
+    char         *path;         ///< Full path of the node, zero-terminated
+    size_t        path_length;  ///< Count of bytes of `path`
+    size_t        name_offset;  ///< Offset of the name of the node in `path`
+    uint64_t      hash;         ///< Hash of `path`
+    MdtpTreeNode *bucket_next;  ///< Next node in the same bucket of the path index
+    MdtpTreeNode *parent;       ///< Parent container
+    MdtpTreeNode *first_child;  ///< First child (containers only)
+    MdtpTreeNode *last_child;   ///< Last child (containers only)
+    MdtpTreeNode *previous;     ///< Previous sibling
+    MdtpTreeNode *next;         ///< Next sibling
+    uint8_t       type;         ///< `0` - container, `1` - value
+    uint8_t       dirty;        ///< `1` if the node or its subtree changed since the last emit
+    uint8_t       cached;       ///< `1` if bytes of the node are in the previous frame
+    uint32_t      depth;        ///< Count of containers above the node (except the root)
+    char         *value;        ///< Value (values only)
+    uint32_t      value_length; ///< Count of bytes of `value`
+    size_t        value_capacity; ///< Count of bytes allocated for `value`
+    char         *units;          ///< Units (values only)
+    uint32_t      units_length;   ///< Count of bytes of `units`
+    size_t        units_capacity; ///< Count of bytes allocated for `units`
+    size_t        offset;         ///< Offset in the previous frame relative to the parent
+    size_t        size;           ///< Count of bytes of the node in the previous frame
+};
+
+struct MdtpTree {
+    MdtpTreeNode   root;          ///< Root, its children are the payload of the frame
+    MdtpTreeNode **buckets;       ///< Path index
+    size_t         buckets_count; ///< Count of buckets, power of 2
+    size_t         nodes_count;   ///< Count of nodes in the index
+    uint8_t       *buffer;        ///< Buffer the next frame is written into
+    size_t         capacity;      ///< Count of bytes allocated for `buffer`
+    size_t         size;          ///< Count of bytes written into `buffer`
+    SDKStatus      status;        ///< First error of the current emit
+    uint64_t       serial;        ///< Serial of the frame of the last emit in the module
+};
+
+
+// Forward declaration begin
+static MdtpTree     *mdtp_tree_get(IModule *module);
+static SDKStatus     mdtp_tree_set_n(IModule    *module,
+                                     const char *path,
+                                     const char *value,
+                                     size_t      value_length,
+                                     const char *units,
+                                     size_t      units_length);
+static int          mdtp_tree_is_valid_path(const char *path, size_t path_length);
+static size_t       mdtp_tree_parent_length(const char *path, size_t path_length);
+static MdtpTreeNode *mdtp_tree_find(const MdtpTree *tree, const char *path, size_t path_length);
+static SDKStatus     mdtp_tree_index(MdtpTree *tree, MdtpTreeNode *node);
+static void          mdtp_tree_unindex(MdtpTree *tree, MdtpTreeNode *node);
+static MdtpTreeNode *mdtp_tree_add_node(MdtpTree     *tree,
+                                        MdtpTreeNode *parent,
+                                        const char   *path,
+                                        size_t        path_length,
+                                        uint8_t       type,
+                                        SDKStatus    *status);
+static MdtpTreeNode *mdtp_tree_get_container(MdtpTree   *tree,
+                                             const char *path,
+                                             size_t      path_length,
+                                             SDKStatus  *status);
+static void          mdtp_tree_free_node(MdtpTree *tree, MdtpTreeNode *node);
+static void          mdtp_tree_mark_dirty(MdtpTreeNode *node);
+static SDKStatus     mdtp_tree_reserve_string(char **string, size_t *capacity, size_t length);
+static void          mdtp_tree_write_string(char       *string,
+                                            uint32_t   *length,
+                                            const char *source,
+                                            size_t      source_length);
+static uint8_t      *mdtp_tree_claim(MdtpTree *tree, size_t count);
+static void          mdtp_tree_serialize(MdtpTree       *tree,
+                                         MdtpTreeNode   *parent,
+                                         const uint8_t  *previous,
+                                         size_t          previous_start,
+                                         size_t          start);
+// Forward declaration end
+
+
+// Set value
+SDKStatus sdk_mdtp_tree_set(IModule    *module,
+                            const char *path,
+                            const char *value,
+                            const char *units) {
+    if (value == NULL || units == NULL) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    return mdtp_tree_set_n(module, path, value, strlen(value), units, strlen(units));
+}
+
+
+// Set value to unsigned integer
+SDKStatus sdk_mdtp_tree_set_u64(IModule    *module,
+                                const char *path,
+                                uint64_t    value,
+                                const char *units) {
+    if (units == NULL) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    char   text[MDTP_U64_MAX_LENGTH];
+    size_t length = sdk_mdtp_format_u64(text, value);
+
+    return mdtp_tree_set_n(module, path, text, length, units, strlen(units));
+}
+
+
+// Set value to signed integer
+SDKStatus sdk_mdtp_tree_set_i64(IModule    *module,
+                                const char *path,
+                                int64_t     value,
+                                const char *units) {
+    if (units == NULL) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    char   text[MDTP_I64_MAX_LENGTH];
+    size_t length = sdk_mdtp_format_i64(text, value);
+
+    return mdtp_tree_set_n(module, path, text, length, units, strlen(units));
+}
+
+
+// Set value to floating point number
+SDKStatus sdk_mdtp_tree_set_f64(IModule    *module,
+                                const char *path,
+                                double      value,
+                                int         precision,
+                                const char *units) {
+    if (units == NULL) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    char   text[MDTP_F64_MAX_LENGTH];
+    size_t length = sdk_mdtp_format_f64(text, value, precision);
+
+    return mdtp_tree_set_n(module, path, text, length, units, strlen(units));
+}
+
+
+// Remove node
+SDKStatus sdk_mdtp_tree_remove(IModule *module, const char *path) {
+    if (path == NULL || module->tree == NULL) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    MdtpTree     *tree = module->tree;
+    MdtpTreeNode *node = mdtp_tree_find(tree, path, strlen(path));
+
+    if (node == NULL) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    // Unlink from the parent
+    MdtpTreeNode *parent = node->parent;
+
+    if (node->previous != NULL) {
+        node->previous->next = node->next;
+    } else {
+        parent->first_child = node->next;
+    }
+
+    if (node->next != NULL) {
+        node->next->previous = node->previous;
+    } else {
+        parent->last_child = node->previous;
+    }
+
+    mdtp_tree_mark_dirty(parent);
+    mdtp_tree_free_node(tree, node);
+
+    return SDK_OK;
+}
+
+
+// Remove all nodes
+void sdk_mdtp_tree_clear(IModule *module) {
+    MdtpTree *tree = module->tree;
+
+    if (tree == NULL) {
+        return;
+    }
+
+    MdtpTreeNode *child = tree->root.first_child;
+
+    while (child != NULL) {
+        MdtpTreeNode *next = child->next;
+        mdtp_tree_free_node(tree, child);
+        child = next;
+    }
+
+    tree->root.first_child = NULL;
+    tree->root.last_child = NULL;
+    mdtp_tree_mark_dirty(&tree->root);
+}
+
+
+// Serialize tree into frame of module
+const ABI_MODULE_MDTP_DATA *sdk_mdtp_tree_emit(IModule *module) {
+    MdtpTree *tree = mdtp_tree_get(module);
+
+    if (tree == NULL) {
+        return NULL;
+    }
+
+    // The previous frame can be reused only if the module still holds it
+    const uint8_t *previous =
+        tree->serial != 0 && module->frame_serial == tree->serial ? module->frame : NULL;
+
+    if (previous != NULL && !tree->root.dirty) {
+        // Nothing changed since the previous emit
+        const ABI_MODULE_MDTP_DATA *data =
+            sdk_imodule_commit_mdtp_data(module, (uint32_t)tree->size);
+
+        tree->serial = module->frame_serial;
+
+        return data;
+    }
+
+    tree->size = 0;
+    tree->status = SDK_OK;
+
+    if (mdtp_tree_claim(tree, MDTP_HEADER_SIZE) != NULL) {
+        mdtp_tree_serialize(tree, &tree->root, previous, 0, 0);
+    }
+
+    if (tree->status != SDK_OK || tree->size > UINT32_MAX) {
+        tree->serial = 0; // Offsets of nodes are broken, serialize everything next time
+        return NULL;
+    }
+
+    // Write header
+    write_ubyte_be(tree->buffer, 0, MDTP_VERSION);
+    write_uint32_be(tree->buffer, 1, (uint32_t)(tree->size - MDTP_HEADER_SIZE));
+
+    // The module takes the new frame, the previous frame buffer is used for the next emit
+    const ABI_MODULE_MDTP_DATA *data =
+        imodule_exchange_frame(module, &tree->buffer, &tree->capacity, (uint32_t)tree->size);
+
+    tree->serial = module->frame_serial;
+
+    return data;
+}
+
+
+// Destroy tree
+void mdtp_tree_destroy(MdtpTree *tree) {
+    if (tree == NULL) {
+        return;
+    }
+
+    MdtpTreeNode *child = tree->root.first_child;
+
+    while (child != NULL) {
+        MdtpTreeNode *next = child->next;
+        mdtp_tree_free_node(tree, child);
+        child = next;
+    }
+
+    free(tree->buckets);
+    free(tree->buffer);
+    free(tree);
+}
+
+
+// Get tree of module, create it on first use
+static MdtpTree *mdtp_tree_get(IModule *module) {
+    if (module->tree != NULL) {
+        return module->tree;
+    }
+
+    MdtpTree *tree = calloc(1, sizeof(MdtpTree));
+
+    if (tree == NULL) {
+        return NULL;
+    }
+
+    tree->buckets = calloc(MDTP_TREE_MIN_BUCKETS, sizeof(MdtpTreeNode *));
+
+    if (tree->buckets == NULL) {
+        free(tree);
+        return NULL;
+    }
+
+    tree->buckets_count = MDTP_TREE_MIN_BUCKETS;
+    tree->root.dirty = 1; // First emit writes a frame even for an empty tree
+
+    module->tree = tree;
+
+    return tree;
+}
+
+
+// Set value with explicit lengths
+static SDKStatus mdtp_tree_set_n(IModule    *module,
+                                 const char *path,
+                                 const char *value,
+                                 size_t      value_length,
+                                 const char *units,
+                                 size_t      units_length) {
+    if (path == NULL || value_length > UINT32_MAX || units_length > UINT32_MAX) {
+        return SDK_INVALID_ARGUMENT;
+    }
+
+    MdtpTree *tree = mdtp_tree_get(module);
+
+    if (tree == NULL) {
+        return SDK_ALLOCATION_ERROR;
+    }
+
+    size_t        path_length = strlen(path);
+    MdtpTreeNode *node = mdtp_tree_find(tree, path, path_length);
+    SDKStatus     status = SDK_OK;
+
+    if (node == NULL) {
+        if (!mdtp_tree_is_valid_path(path, path_length)) {
+            return SDK_INVALID_ARGUMENT;
+        }
+
+        // Find or create the parent container, then the value itself
+        size_t        parent_length = mdtp_tree_parent_length(path, path_length);
+        MdtpTreeNode *parent = mdtp_tree_get_container(tree, path, parent_length, &status);
+
+        if (parent == NULL) {
+            return status;
+        }
+
+        node = mdtp_tree_add_node(tree, parent, path, path_length, 1, &status);
+
+        if (node == NULL) {
+            return status;
+        }
+    } else if (node->type != 1) {
+        return SDK_INVALID_ARGUMENT; // Container
+    } else if (node->value_length == value_length && node->units_length == units_length &&
+               memcmp(node->value, value, value_length) == 0 &&
+               memcmp(node->units, units, units_length) == 0) {
+        return SDK_OK; // Not changed
+    }
+
+    // Both buffers are grown before either is written, a failure keeps the old value and units
+    status = mdtp_tree_reserve_string(&node->value, &node->value_capacity, value_length);
+
+    if (status == SDK_OK) {
+        status = mdtp_tree_reserve_string(&node->units, &node->units_capacity, units_length);
+    }
+
+    if (status != SDK_OK) {
+        return status;
+    }
+
+    mdtp_tree_write_string(node->value, &node->value_length, value, value_length);
+    mdtp_tree_write_string(node->units, &node->units_length, units, units_length);
+    mdtp_tree_mark_dirty(node);
+
+    return SDK_OK;
+}
+
+
+// Check that no name of the path is empty
+static int mdtp_tree_is_valid_path(const char *path, size_t path_length) {
+    if (path_length == 0 || path[0] == '/' || path[path_length - 1] == '/') {
+        return 0;
+    }
+
+    for (size_t i = 1; i < path_length; ++i) {
+        if (path[i] == '/' && path[i - 1] == '/') {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+
+// Get length of the path of the parent (`0` for children of the root)
+static size_t mdtp_tree_parent_length(const char *path, size_t path_length) {
+    while (path_length != 0 && path[path_length - 1] != '/') {
+        --path_length;
+    }
+
+    return path_length != 0 ? path_length - 1 : 0;
+}
+
+
+// Find node by path in the index
+static MdtpTreeNode *mdtp_tree_find(const MdtpTree *tree, const char *path, size_t path_length) {
+    uint64_t      hash = mdtp_fnv_hash(MDTP_FNV_OFFSET, path, path_length);
+    MdtpTreeNode *node = tree->buckets[hash & (tree->buckets_count - 1)];
+
+    for (; node != NULL; node = node->bucket_next) {
+        if (node->hash == hash && node->path_length == path_length &&
+            memcmp(node->path, path, path_length) == 0) {
+            return node;
+        }
+    }
+
+    return NULL;
+}
+
+
+// Add node to the index, grow the index if needed
+static SDKStatus mdtp_tree_index(MdtpTree *tree, MdtpTreeNode *node) {
+    if (tree->nodes_count >= tree->buckets_count) {
+        size_t         buckets_count = tree->buckets_count * 2;
+        MdtpTreeNode **buckets = calloc(buckets_count, sizeof(MdtpTreeNode *));
+
+        if (buckets == NULL) {
+            return SDK_ALLOCATION_ERROR;
+        }
+
+        // Rehash
+        for (size_t i = 0; i < tree->buckets_count; ++i) {
+            MdtpTreeNode *current = tree->buckets[i];
+
+            while (current != NULL) {
+                MdtpTreeNode *next = current->bucket_next;
+                size_t        bucket = current->hash & (buckets_count - 1);
+
+                current->bucket_next = buckets[bucket];
+                buckets[bucket] = current;
+                current = next;
+            }
+        }
+
+        free(tree->buckets);
+        tree->buckets = buckets;
+        tree->buckets_count = buckets_count;
+    }
+
+    size_t bucket = node->hash & (tree->buckets_count - 1);
+
+    node->bucket_next = tree->buckets[bucket];
+    tree->buckets[bucket] = node;
+    ++tree->nodes_count;
+
+    return SDK_OK;
+}
+
+
+// Remove node from the index
+static void mdtp_tree_unindex(MdtpTree *tree, MdtpTreeNode *node) {
+    MdtpTreeNode **link = &tree->buckets[node->hash & (tree->buckets_count - 1)];
+
+    while (*link != node) {
+        link = &(*link)->bucket_next;
+    }
+
+    *link = node->bucket_next;
+    --tree->nodes_count;
+}
+
+
+// Create node as the last child of `parent`
+static MdtpTreeNode *mdtp_tree_add_node(MdtpTree     *tree,
+                                        MdtpTreeNode *parent,
+                                        const char   *path,
+                                        size_t        path_length,
+                                        uint8_t       type,
+                                        SDKStatus    *status) {
+    size_t   name_offset = parent == &tree->root ? 0 : parent->path_length + 1;
+    uint32_t depth = parent == &tree->root ? 0 : parent->depth + 1;
+
+    // Names longer than MDTP allows and too deep nodes are rejected
+    if (path_length - name_offset > UINT32_MAX ||
+        depth >= MDTP_MAX_DEPTH) {
+        *status = SDK_INVALID_ARGUMENT;
+        return NULL;
+    }
+
+    MdtpTreeNode *node = calloc(1, sizeof(MdtpTreeNode));
+    char         *node_path = malloc(path_length + 1);
+
+    if (node == NULL || node_path == NULL) {
+        free(node);
+        free(node_path);
+        *status = SDK_ALLOCATION_ERROR;
+        return NULL;
+    }
+
+    memcpy(node_path, path, path_length);
+    node_path[path_length] = '\0';
+
+    node->path = node_path;
+    node->path_length = path_length;
+    node->name_offset = name_offset;
+    node->hash = mdtp_fnv_hash(MDTP_FNV_OFFSET, path, path_length);
+    node->parent = parent;
+    node->type = type;
+    node->depth = depth;
+
+    if (mdtp_tree_index(tree, node) != SDK_OK) {
+        free(node_path);
+        free(node);
+        *status = SDK_ALLOCATION_ERROR;
+        return NULL;
+    }
+
+    // Append to the children of the parent
+    node->previous = parent->last_child;
+
+    if (parent->last_child != NULL) {
+        parent->last_child->next = node;
+    } else {
+        parent->first_child = node;
+    }
+
+    parent->last_child = node;
+    mdtp_tree_mark_dirty(node);
+
+    return node;
+}
+
+
+// Find or create container at `path`, creating missing containers above it
+static MdtpTreeNode *mdtp_tree_get_container(MdtpTree   *tree,
+                                             const char *path,
+                                             size_t      path_length,
+                                             SDKStatus  *status) {
+    if (path_length == 0) {
+        return &tree->root;
+    }
+
+    MdtpTreeNode *node = mdtp_tree_find(tree, path, path_length);
+
+    if (node != NULL) {
+        if (node->type != 0) {
+            *status = SDK_INVALID_ARGUMENT; // Value on the path
+            return NULL;
+        }
+
+        return node;
+    }
+
+    size_t        parent_length = mdtp_tree_parent_length(path, path_length);
+    MdtpTreeNode *parent = mdtp_tree_get_container(tree, path, parent_length, status);
+
+    if (parent == NULL) {
+        return NULL;
+    }
+
+    return mdtp_tree_add_node(tree, parent, path, path_length, 0, status);
+}
+
+
+// Free node with its subtree and remove them from the index
+static void mdtp_tree_free_node(MdtpTree *tree, MdtpTreeNode *node) {
+    MdtpTreeNode *child = node->first_child;
+
+    while (child != NULL) {
+        MdtpTreeNode *next = child->next;
+        mdtp_tree_free_node(tree, child);
+        child = next;
+    }
+
+    mdtp_tree_unindex(tree, node);
+
+    free(node->path);
+    free(node->value);
+    free(node->units);
+    free(node);
+}
+
+
+// Mark node and its ancestors dirty
+static void mdtp_tree_mark_dirty(MdtpTreeNode *node) {
+    // Ancestors of a dirty node are always dirty
+    while (node != NULL && !node->dirty) {
+        node->dirty = 1;
+        node = node->parent;
+    }
+}
+
+
+// Grow buffer owned by node to hold `length` bytes, keeping its contents
+static SDKStatus mdtp_tree_reserve_string(char **string, size_t *capacity, size_t length) {
+    if (*capacity < length) {
+        char *buffer = realloc(*string, length);
+
+        if (buffer == NULL) {
+            return SDK_ALLOCATION_ERROR;
+        }
+
+        *string = buffer;
+        *capacity = length;
+    }
+
+    return SDK_OK;
+}
+
+
+// Copy string into buffer reserved by `mdtp_tree_reserve_string`
+static void mdtp_tree_write_string(char       *string,
+                                   uint32_t   *length,
+                                   const char *source,
+                                   size_t      source_length) {
+    if (source_length != 0) {
+        memcpy(string, source, source_length);
+    }
+
+    *length = (uint32_t)source_length;
+}
+
+
+// Reserve `count` bytes at the end of the frame and return pointer to them
+static uint8_t *mdtp_tree_claim(MdtpTree *tree, size_t count) {
+    SDKStatus status = mdtp_buffer_reserve(
+        &tree->buffer, &tree->capacity, tree->size + count, MDTP_TREE_MIN_CAPACITY);
+
+    if (status != SDK_OK) {
+        tree->status = status;
+        return NULL;
+    }
+
+    uint8_t *cursor = tree->buffer + tree->size;
+    tree->size += count;
+
+    return cursor;
+}
+
+
+// Write children of `parent`. Clean children are copied from `previous`, where the parent started
+// at `previous_start`. In the new frame the parent starts at `start`.
+static void mdtp_tree_serialize(MdtpTree       *tree,
+                                MdtpTreeNode   *parent,
+                                const uint8_t  *previous,
+                                size_t          previous_start,
+                                size_t          start) {
+    for (MdtpTreeNode *child = parent->first_child; child != NULL && tree->status == SDK_OK;
+         child = child->next) {
+        size_t      child_start = tree->size;
+        const char *name = child->path + child->name_offset;
+        size_t      name_length = child->path_length - child->name_offset;
+
+        if (previous != NULL && child->cached && !child->dirty) {
+            // Unchanged subtree, splice its bytes
+            uint8_t *cursor = mdtp_tree_claim(tree, child->size);
+
+            if (cursor == NULL) {
+                return;
+            }
+
+            memcpy(cursor, previous + previous_start + child->offset, child->size);
+        } else if (child->type == 1) {
+            // [1 type] [4 name length] [name] [4 units length] [units] [4 value length] [value]
+            uint8_t *cursor = mdtp_tree_claim(
+                tree, 1 + 4 + name_length + 4 + child->units_length + 4 + child->value_length);
+
+            if (cursor == NULL) {
+                return;
+            }
+
+            *cursor = 1;
+            write_uint32_be(cursor, 1, (uint32_t)name_length);
+            memcpy(cursor + 5, name, name_length);
+            cursor += 5 + name_length;
+            write_uint32_be(cursor, 0, child->units_length);
+            memcpy(cursor + 4, child->units, child->units_length);
+            cursor += 4 + child->units_length;
+            write_uint32_be(cursor, 0, child->value_length);
+            memcpy(cursor + 4, child->value, child->value_length);
+        } else {
+            // [1 type] [4 name length] [name] [4 payload size] [payload]
+            uint8_t *cursor = mdtp_tree_claim(tree, 1 + 4 + name_length + 4);
+
+            if (cursor == NULL) {
+                return;
+            }
+
+            *cursor = 0;
+            write_uint32_be(cursor, 1, (uint32_t)name_length);
+            memcpy(cursor + 5, name, name_length);
+
+            size_t size_offset = tree->size - 4;
+
+            // Children of a new container have nothing to splice
+            mdtp_tree_serialize(tree,
+                                child,
+                                child->cached ? previous : NULL,
+                                previous_start + child->offset,
+                                child_start);
+
+            if (tree->size - size_offset - 4 > UINT32_MAX) {
+                tree->status = SDK_OTHER_ERROR;
+            }
+
+            if (tree->status != SDK_OK) {
+                return;
+            }
+
+            write_uint32_be(tree->buffer, size_offset, (uint32_t)(tree->size - size_offset - 4));
+        }
+
+        child->offset = child_start - start;
+        child->size = tree->size - child_start;
+        child->cached = 1;
+        child->dirty = 0;
+    }
+
+    if (tree->status == SDK_OK) {
+        parent->dirty = 0;
+    }
+}
@@ -6,7 +6,9 @@
  */
 
 #include "../../include/modules/internals/utils.h"
+#include "../../include/modules/internals/abi.h"
 #include "../../include/modules/internals/imodule.h"
+#include "../../include/modules/internals/mdtp.h"
 
 // Log
 void sdk_utils_log(const IModule *module, LogType log_type, const char *message) {
@@ -19,3 +21,14 @@ uint32_t sdk_utils_get_server_abi_version(const IModule *module) {
     return sdk_imodule_get_server_core_functions(module)->abi_get_abi_version(
         sdk_imodule_get_context(module));
 }
+
+// Check server capability
+uint8_t sdk_utils_server_has_capability(const IModule *module, uint32_t capability) {
+    return (sdk_utils_get_server_abi_version(module) & ~ABI_VERSION_MASK & capability) != 0;
+}
+
+// Get MDTP version of the server
+uint8_t sdk_utils_server_mdtp_version(const IModule *module) {
+    return sdk_utils_server_has_capability(module, ABI_CAPABILITY_MDTP_V2) ? MDTP_VERSION_2
+                                                                           : MDTP_VERSION;
+}
@@ -149,6 +149,116 @@ void test_make_root_node(void) {
 
 
 
+// Slices of a buffer must produce the same node as zero-terminated strings
+void test_make_value_node_from_slices(void) {
+    const char *line = "MemTotal:       16314788 kB";
+
+    void *expected = sdk_mdtp_make_value("MemTotal", "16314788", "kB");
+    void *node = sdk_mdtp_make_value_n(line, 8, line + 16, 8, line + 25, 2);
+
+    TEST_ASSERT_NOT_NULL(node);
+    TEST_ASSERT_EQUAL_MEMORY(expected, node, 1 + 4 + 8 + 4 + 2 + 4 + 8);
+
+    void *container = sdk_mdtp_make_container_n("memory/extra", 6, node, NULL);
+    void *expected_container = sdk_mdtp_make_container("memory", expected, NULL);
+
+    TEST_ASSERT_NOT_NULL(container);
+    TEST_ASSERT_EQUAL_MEMORY(expected_container, container, 1 + 4 + 6 + 4 + 30);
+
+    sdk_mdtp_free_container(container);
+    sdk_mdtp_free_container(expected_container);
+}
+
+
+
+// Array-based construction must produce the same frame as varargs
+void test_make_root_from_array(void) {
+    IModule *module = sdk_imodule_create("test", "test", (ABI_SERVER_CORE_FUNCTIONS){0}, 0, 0);
+    IModule *reference_module =
+        sdk_imodule_create("reference", "reference", (ABI_SERVER_CORE_FUNCTIONS){0}, 0, 0);
+
+    const ABI_MODULE_MDTP_DATA *reference = sdk_mdtp_make_root(
+        reference_module,
+        sdk_mdtp_make_container("cpu",
+                                sdk_mdtp_make_value("core0", "10", "%"),
+                                sdk_mdtp_make_value("core1", "20", "%"),
+                                sdk_mdtp_make_value("core2", "30", "%"),
+                                NULL),
+        sdk_mdtp_make_container("empty", sdk_mdtp_make_container_v("nothing", NULL, 0), NULL),
+        NULL);
+
+    void *cores[3] = {sdk_mdtp_make_value("core0", "10", "%"),
+                      sdk_mdtp_make_value("core1", "20", "%"),
+                      sdk_mdtp_make_value("core2", "30", "%")};
+    void *nothing[1] = {sdk_mdtp_make_container_v("nothing", NULL, 0)};
+    void *nodes[2] = {sdk_mdtp_make_container_v("cpu", cores, 3),
+                      sdk_mdtp_make_container_v("empty", nothing, 1)};
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_make_root_v(module, nodes, 2);
+
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL(reference->size, data->size);
+    TEST_ASSERT_EQUAL_MEMORY(reference->data, data->data, data->size);
+
+    // NULL element is an error, nodes stay owned by the caller
+    void *broken[2] = {sdk_mdtp_make_value("a", "1", ""), NULL};
+    TEST_ASSERT_NULL(sdk_mdtp_make_container_v("broken", broken, 2));
+    TEST_ASSERT_NULL(sdk_mdtp_make_root_v(module, broken, 2));
+    sdk_mdtp_free_value(broken[0]);
+
+    // Empty frame
+    data = sdk_mdtp_make_root_v(module, NULL, 0);
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL(5, data->size);
+
+    sdk_imodule_destroy(module);
+    sdk_imodule_destroy(reference_module);
+}
+
+
+
+// The frame buffer of the module must be rewritten in place once it is large enough
+void test_make_root_reuses_frame_buffer(void) {
+    IModule *module = sdk_imodule_create("test", "test", (ABI_SERVER_CORE_FUNCTIONS){0}, 0, 0);
+
+    const ABI_MODULE_MDTP_DATA *first =
+        sdk_mdtp_make_root(module, sdk_mdtp_make_value("use", "1234", "gb"), NULL);
+    const void *first_data = first->data;
+
+    const ABI_MODULE_MDTP_DATA *second =
+        sdk_mdtp_make_root(module, sdk_mdtp_make_value("use", "12", "gb"), NULL);
+
+    TEST_ASSERT_EQUAL_PTR(first_data, second->data);
+    TEST_ASSERT_EQUAL(25, second->size);
+    TEST_ASSERT_EQUAL(((char *)second->data)[23], '1');
+    TEST_ASSERT_EQUAL(((char *)second->data)[24], '2');
+
+    sdk_imodule_destroy(module);
+}
+
+
+
+// After `polls` small frames the buffer must shrink to the high-water mark
+void test_frame_buffer_shrinks(void) {
+    IModule *module = sdk_imodule_create("test", "test", (ABI_SERVER_CORE_FUNCTIONS){0}, 0, 0);
+
+    sdk_imodule_set_mdtp_shrink_polls(module, 2);
+
+    // Grow the buffer
+    TEST_ASSERT_NOT_NULL(sdk_imodule_reserve_mdtp_data(module, 100000));
+    TEST_ASSERT_NOT_NULL(sdk_imodule_commit_mdtp_data(module, 100000));
+    TEST_ASSERT_NOT_NULL(sdk_imodule_commit_mdtp_data(module, 10));
+
+    // Buffer is shrunk, so it has to grow again
+    TEST_ASSERT_NOT_NULL(sdk_imodule_commit_mdtp_data(module, 1000));
+    TEST_ASSERT_NOT_NULL(sdk_imodule_commit_mdtp_data(module, 10));
+    TEST_ASSERT_NULL(sdk_imodule_commit_mdtp_data(module, 100000));
+
+    sdk_imodule_destroy(module);
+}
+
+
+
 
 int main(void) {
     UNITY_BEGIN();
@@ -157,6 +267,10 @@ int main(void) {
     RUN_TEST(test_make_empty_value_node);
     RUN_TEST(test_make_container_node);
     RUN_TEST(test_make_root_node);
+    RUN_TEST(test_make_value_node_from_slices);
+    RUN_TEST(test_make_root_from_array);
+    RUN_TEST(test_make_root_reuses_frame_buffer);
+    RUN_TEST(test_frame_buffer_shrinks);
 
     return UNITY_END();
 }
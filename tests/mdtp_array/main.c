@@ -0,0 +1,247 @@
+#include <modules/sdk.h>
+#include <modules/internals/memutils.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "../mdtp_fixture.h"
+
+#define CORES 64
+
+
+static double   usage[CORES];
+static uint64_t ticks[CORES];
+
+
+// Check the two arrays of a frame made by `make_frame`
+static void check_frame(const void *frame, size_t size) {
+    MdtpReader reader;
+    MdtpReader child;
+    size_t     length;
+    double     f64[CORES];
+    uint64_t   u64[CORES];
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_validate(frame, size));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_init(&reader, frame, size));
+
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&reader));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_enter_container(&reader, &child));
+
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&child));
+    TEST_ASSERT_EQUAL(MDTP_NODE_ARRAY, sdk_mdtp_reader_type(&child));
+    TEST_ASSERT_EQUAL(MDTP_VALUE_F64, sdk_mdtp_reader_value_type(&child));
+    TEST_ASSERT_EQUAL_STRING_LEN("usage", sdk_mdtp_reader_name(&child, &length), 5);
+    TEST_ASSERT_EQUAL_STRING_LEN("%", sdk_mdtp_reader_units(&child, &length), 1);
+    TEST_ASSERT_EQUAL(CORES, sdk_mdtp_reader_array_length(&child));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_array_f64(&child, f64));
+    TEST_ASSERT_EQUAL_MEMORY(usage, f64, sizeof(usage));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_reader_array_u64(&child, u64));
+
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&child));
+    TEST_ASSERT_EQUAL(MDTP_VALUE_U64, sdk_mdtp_reader_value_type(&child));
+    TEST_ASSERT_EQUAL_STRING_LEN("ticks", sdk_mdtp_reader_name(&child, &length), 5);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_array_u64(&child, u64));
+    TEST_ASSERT_EQUAL_MEMORY(ticks, u64, sizeof(ticks));
+
+    // Unsigned integers are converted
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_array_f64(&child, f64));
+    TEST_ASSERT_EQUAL_DOUBLE((double)ticks[CORES - 1], f64[CORES - 1]);
+
+    TEST_ASSERT_FALSE(sdk_mdtp_reader_next(&child));
+    TEST_ASSERT_FALSE(sdk_mdtp_reader_next(&reader));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_status(&reader));
+}
+
+
+// Build the two arrays with the builder
+static const ABI_MODULE_MDTP_DATA *make_frame(void) {
+    sdk_mdtp_builder_begin_container(builder, "cpu");
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_add_array_f64(builder, "usage", usage, CORES, "%"));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_add_array_u64(builder, "ticks", ticks, CORES, ""));
+    sdk_mdtp_builder_end_container(builder);
+
+    return sdk_mdtp_builder_finish(builder, module);
+}
+
+
+void test_array_make(void) {
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_make_root(
+        module,
+        sdk_mdtp_make_container("cpu",
+                                sdk_mdtp_make_array_f64("usage", usage, CORES, "%"),
+                                sdk_mdtp_make_array_u64("ticks", ticks, CORES, ""),
+                                NULL),
+        NULL);
+
+    TEST_ASSERT_NOT_NULL(data);
+    check_frame(data->data, data->size);
+
+    // Same bytes as the builder makes
+    void  *made = malloc(data->size);
+    size_t size = data->size;
+
+    memcpy(made, data->data, size);
+    data = make_frame();
+    TEST_ASSERT_EQUAL(size, data->size);
+    TEST_ASSERT_EQUAL_MEMORY(made, data->data, size);
+    free(made);
+
+    // Elements are 8-byte Big Endian. [5 header] [1 type] [4 + 3 name] [4 payload size] [1 type]
+    // [4 + 5 name] [4 + 1 units] [1 element type] [4 count]
+    const uint8_t *frame = data->data;
+    size_t         offset = 5 + 1 + 4 + 3 + 4 + 1 + 4 + 5 + 4 + 1 + 1 + 4;
+    uint64_t       bits;
+
+    memcpy(&bits, &usage[0], sizeof(bits));
+    TEST_ASSERT_EQUAL_UINT64(bits, read_uint64_be(frame, offset));
+
+    void *value = sdk_mdtp_make_array_u64("empty", NULL, 0, "");
+
+    TEST_ASSERT_NOT_NULL(value);
+    sdk_mdtp_free_value(value);
+    TEST_ASSERT_NULL(sdk_mdtp_make_array_u64("ticks", NULL, 1, ""));
+    TEST_ASSERT_NULL(sdk_mdtp_make_array_f64(NULL, usage, CORES, ""));
+}
+
+
+void test_array_versions(void) {
+    static const uint8_t versions[] = {MDTP_VERSION, MDTP_VERSION_2};
+
+    for (size_t i = 0; i < sizeof(versions); ++i) {
+        sdk_mdtp_builder_set_version(builder, versions[i]);
+
+        const ABI_MODULE_MDTP_DATA *data = make_frame();
+
+        TEST_ASSERT_NOT_NULL(data);
+        TEST_ASSERT_EQUAL(versions[i], ((const uint8_t *)data->data)[0] & MDTP_VERSION_MASK);
+        check_frame(data->data, data->size);
+    }
+
+    sdk_mdtp_builder_set_version(builder, MDTP_VERSION);
+}
+
+
+void test_array_smaller(void) {
+    char name[16];
+    char text[32];
+
+    // One value node for each core
+    for (size_t i = 0; i < CORES; ++i) {
+        sprintf(name, "core%zu", i);
+        sprintf(text, "%.17g", usage[i]);
+        sdk_mdtp_builder_add_value(builder, name, text, "%");
+    }
+
+    size_t values = sdk_mdtp_builder_finish(builder, module)->size;
+
+    sdk_mdtp_builder_add_array_f64(builder, "usage", usage, CORES, "%");
+
+    TEST_ASSERT_LESS_THAN(values / 2, sdk_mdtp_builder_finish(builder, module)->size);
+}
+
+
+void test_array_misuse(void) {
+    IModule *old = old_module();
+    static const char *const  columns[] = {"pid"};
+
+    // Arrays are not sent to a server without them, even if it knows tables
+    sdk_mdtp_builder_begin_table(builder, "processes", columns, NULL, 1, MDTP_TABLE_ROWS);
+    sdk_mdtp_builder_add_cell_u64(builder, 1);
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT,
+                      sdk_mdtp_builder_add_array_u64(builder, "ticks", ticks, CORES, ""));
+    sdk_mdtp_builder_end_table(builder);
+    sdk_mdtp_builder_add_array_u64(builder, "ticks", ticks, CORES, "");
+    TEST_ASSERT_NULL(sdk_mdtp_builder_finish(builder, old));
+
+    // Tables alone are fine
+    sdk_mdtp_builder_begin_table(builder, "processes", columns, NULL, 1, MDTP_TABLE_ROWS);
+    sdk_mdtp_builder_add_cell_u64(builder, 1);
+    sdk_mdtp_builder_end_table(builder);
+    TEST_ASSERT_NOT_NULL(sdk_mdtp_builder_finish(builder, old));
+
+    // The capabilities of the server are asked once
+    TEST_ASSERT_EQUAL(1, old_server_calls);
+
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT,
+                      sdk_mdtp_builder_add_array_u64(builder, "ticks", NULL, 1, ""));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT,
+                      sdk_mdtp_builder_add_array_f64(builder, NULL, usage, CORES, ""));
+    sdk_mdtp_builder_reset(builder);
+
+    sdk_imodule_destroy(old);
+}
+
+
+void test_array_malformed(void) {
+    uint8_t frame[256];
+    size_t  size;
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_make_root(
+        module, sdk_mdtp_make_array_u64("ticks", ticks, 4, ""), NULL);
+
+    size = data->size;
+    memcpy(frame, data->data, size);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_validate(frame, size));
+
+    // [5 header] [1 type] [4 + 5 name] [4 + 0 units] [1 element type] [4 count]
+    size_t element_type = 5 + 1 + 4 + 5 + 4;
+
+    frame[element_type] = MDTP_VALUE_TEXT;
+    TEST_ASSERT_EQUAL(SDK_ARGUMENT_PROCESSING_ERROR, sdk_mdtp_validate(frame, size));
+    frame[element_type] = MDTP_VALUE_U64;
+
+    write_uint32_be(frame, element_type + 1, 5);
+    TEST_ASSERT_EQUAL(SDK_ARGUMENT_PROCESSING_ERROR, sdk_mdtp_validate(frame, size));
+    write_uint32_be(frame, element_type + 1, UINT32_MAX);
+    TEST_ASSERT_EQUAL(SDK_ARGUMENT_PROCESSING_ERROR, sdk_mdtp_validate(frame, size));
+}
+
+
+void test_array_dictionary(void) {
+    MdtpDictionaryDecoder *decoder = sdk_mdtp_dictionary_decoder_create();
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_dictionary_enable(module));
+
+    for (int poll = 0; poll < 3; ++poll) {
+        make_frame();
+
+        const ABI_MODULE_MDTP_DATA *sent = sdk_mdtp_dictionary_emit(module);
+        size_t                      size;
+
+        TEST_ASSERT_TRUE((((const uint8_t *)sent->data)[0] & MDTP_FLAG_DICTIONARY) != 0);
+
+        void *frame = sdk_mdtp_dictionary_decode(decoder, sent->data, sent->size, &size);
+
+        TEST_ASSERT_NOT_NULL(frame);
+        check_frame(frame, size);
+        free(frame);
+    }
+
+    sdk_mdtp_dictionary_disable(module);
+    sdk_mdtp_dictionary_decoder_destroy(decoder);
+}
+
+
+int main(void) {
+    fixture_create(ABI_CAPABILITY_ARRAYS | ABI_CAPABILITY_TABLES | ABI_CAPABILITY_MDTP_V2 |
+                   ABI_CAPABILITY_DICTIONARY,
+                   ABI_CAPABILITY_TABLES | ABI_CAPABILITY_MDTP_V2);
+
+    for (size_t i = 0; i < CORES; ++i) {
+        usage[i] = (double)i * 1.5 + 0.125;
+        ticks[i] = UINT64_C(0x0102030405060708) * (i + 1);
+    }
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_array_make);
+    RUN_TEST(test_array_versions);
+    RUN_TEST(test_array_smaller);
+    RUN_TEST(test_array_misuse);
+    RUN_TEST(test_array_malformed);
+    RUN_TEST(test_array_dictionary);
+
+    fixture_destroy();
+
+    return UNITY_END();
+}
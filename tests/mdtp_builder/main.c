@@ -0,0 +1,224 @@
+#include <modules/internals/memutils.h>
+#include <modules/sdk.h>
+#include <string.h>
+#include <unity.h>
+
+void tearDown(void) {}
+
+void setUp(void) {}
+
+
+// Stub
+ABI_MODULE_FUNCTIONS module_init(ABI_SERVER_CORE_FUNCTIONS server_functions,
+                                 const char               *json_configuration) {
+    return (ABI_MODULE_FUNCTIONS){0};
+}
+
+
+static IModule     *module;
+static MdtpBuilder *builder;
+
+
+// Builder must produce exactly the same bytes as nested `sdk_mdtp_make_*` calls
+void test_builder_matches_make_root(void) {
+    IModule *reference_module =
+        sdk_imodule_create("reference", "reference", (ABI_SERVER_CORE_FUNCTIONS){0}, 0, 0);
+
+    const ABI_MODULE_MDTP_DATA *reference = sdk_mdtp_make_root(
+        reference_module,
+        sdk_mdtp_make_container("cpu",
+                                sdk_mdtp_make_value("usage", "12", "%"),
+                                sdk_mdtp_make_container("core0",
+                                                        sdk_mdtp_make_value("freq", "2400", "MHz"),
+                                                        NULL),
+                                NULL),
+        sdk_mdtp_make_value("uptime", "100", "s"),
+        NULL);
+
+    sdk_mdtp_builder_begin_container(builder, "cpu");
+    sdk_mdtp_builder_add_value(builder, "usage", "12", "%");
+    sdk_mdtp_builder_begin_container(builder, "core0");
+    sdk_mdtp_builder_add_value(builder, "freq", "2400", "MHz");
+    sdk_mdtp_builder_end_container(builder);
+    sdk_mdtp_builder_end_container(builder);
+    sdk_mdtp_builder_add_value(builder, "uptime", "100", "s");
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_builder_finish(builder, module);
+
+    TEST_ASSERT_NOT_NULL(reference);
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL(reference->size, data->size);
+    TEST_ASSERT_EQUAL_MEMORY(reference->data, data->data, data->size);
+
+    sdk_imodule_destroy(reference_module);
+}
+
+
+void test_builder_root_layout(void) {
+    sdk_mdtp_builder_begin_container(builder, "ram");
+    sdk_mdtp_builder_add_value(builder, "use", "12", "gb");
+    sdk_mdtp_builder_end_container(builder);
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_builder_finish(builder, module);
+
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL(37, data->size);
+    TEST_ASSERT_EQUAL(MDTP_VERSION, read_ubyte_be(data->data, 0));
+    TEST_ASSERT_EQUAL(32, read_uint32_be(data->data, 1));  // Root payload size
+    TEST_ASSERT_EQUAL(20, read_uint32_be(data->data, 13)); // Container payload size
+}
+
+
+void test_builder_empty_frame(void) {
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_builder_finish(builder, module);
+
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL(5, data->size);
+    TEST_ASSERT_EQUAL(0, read_uint32_be(data->data, 1));
+}
+
+
+void test_builder_unbalanced_containers(void) {
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_builder_end_container(builder));
+    TEST_ASSERT_NULL(sdk_mdtp_builder_finish(builder, module));
+
+    sdk_mdtp_builder_begin_container(builder, "open");
+    TEST_ASSERT_NULL(sdk_mdtp_builder_finish(builder, module));
+}
+
+
+void test_builder_error_is_sticky(void) {
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_builder_add_value(builder, NULL, "1", "u"));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_builder_add_value(builder, "a", "1", "u"));
+    TEST_ASSERT_NULL(sdk_mdtp_builder_finish(builder, module));
+
+    // Builder is reset after finish
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_add_value(builder, "a", "1", "u"));
+    TEST_ASSERT_NOT_NULL(sdk_mdtp_builder_finish(builder, module));
+}
+
+
+void test_builder_max_depth(void) {
+    for (int i = 0; i < MDTP_MAX_DEPTH; ++i) {
+        TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_begin_container(builder, "c"));
+    }
+
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_builder_begin_container(builder, "c"));
+    sdk_mdtp_builder_reset(builder);
+}
+
+
+// Frames larger than the initial buffer must survive growth
+void test_builder_large_frame(void) {
+    sdk_mdtp_builder_begin_container(builder, "processes");
+
+    for (int i = 0; i < 700; ++i) {
+        sdk_mdtp_builder_add_value(builder, "pid", "123456", "");
+    }
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_end_container(builder));
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_builder_finish(builder, module);
+
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL(5 + 1 + 4 + 9 + 4 + 700 * (1 + 4 + 3 + 4 + 0 + 4 + 6), data->size);
+    TEST_ASSERT_EQUAL(700 * (1 + 4 + 3 + 4 + 0 + 4 + 6), read_uint32_be(data->data, 19));
+}
+
+
+
+// Slices of a buffer must produce the same bytes as zero-terminated strings
+void test_builder_slices(void) {
+    const char *line = "eth0: 1234 5678";
+
+    sdk_mdtp_builder_begin_container(builder, "eth0");
+    sdk_mdtp_builder_add_value(builder, "rx", "1234", "bytes");
+    sdk_mdtp_builder_end_container(builder);
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_builder_finish(builder, module);
+    uint8_t                     expected[64];
+    uint32_t                    expected_size = data->size;
+
+    memcpy(expected, data->data, expected_size);
+
+    sdk_mdtp_builder_begin_container_n(builder, line, 4);
+    sdk_mdtp_builder_add_value_n(builder, "rx_bytes", 2, line + 6, 4, "bytes", 5);
+    sdk_mdtp_builder_end_container(builder);
+
+    data = sdk_mdtp_builder_finish(builder, module);
+
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL(expected_size, data->size);
+    TEST_ASSERT_EQUAL_MEMORY(expected, data->data, expected_size);
+}
+
+
+
+// Once warmed up, the builder and the module keep swapping the same two buffers
+void test_builder_reuses_buffers(void) {
+    const void *frames[4];
+
+    for (int i = 0; i < 4; ++i) {
+        sdk_mdtp_builder_add_value(builder, "usage", "12", "%");
+        frames[i] = sdk_mdtp_builder_finish(builder, module)->data;
+    }
+
+    TEST_ASSERT_EQUAL_PTR(frames[0], frames[2]);
+    TEST_ASSERT_EQUAL_PTR(frames[1], frames[3]);
+    TEST_ASSERT_TRUE(frames[0] != frames[1]);
+}
+
+
+
+// After an oversized frame both swapped buffers shrink back
+void test_builder_buffers_shrink(void) {
+    IModule *other = sdk_imodule_create("other", "other", (ABI_SERVER_CORE_FUNCTIONS){0}, 0, 0);
+
+    sdk_imodule_set_mdtp_shrink_polls(other, 4);
+
+    for (int i = 0; i < 5000; ++i) {
+        sdk_mdtp_builder_add_value(builder, "pid", "123456", "");
+    }
+
+    TEST_ASSERT_NOT_NULL(sdk_mdtp_builder_finish(builder, other));
+
+    for (int i = 0; i < 8; ++i) {
+        sdk_mdtp_builder_add_value(builder, "usage", "12", "%");
+        TEST_ASSERT_NOT_NULL(sdk_mdtp_builder_finish(builder, other));
+    }
+
+    // Neither the buffer of the module nor the one of the builder holds a large frame anymore
+    for (int i = 0; i < 2; ++i) {
+        TEST_ASSERT_NULL(sdk_imodule_commit_mdtp_data(other, 50000));
+        sdk_mdtp_builder_add_value(builder, "usage", "12", "%");
+        TEST_ASSERT_NOT_NULL(sdk_mdtp_builder_finish(builder, other));
+    }
+
+    sdk_imodule_destroy(other);
+}
+
+
+
+
+int main(void) {
+    module = sdk_imodule_create("test", "test", (ABI_SERVER_CORE_FUNCTIONS){0}, 0, 0);
+    builder = sdk_mdtp_builder_create();
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_builder_matches_make_root);
+    RUN_TEST(test_builder_root_layout);
+    RUN_TEST(test_builder_empty_frame);
+    RUN_TEST(test_builder_unbalanced_containers);
+    RUN_TEST(test_builder_error_is_sticky);
+    RUN_TEST(test_builder_max_depth);
+    RUN_TEST(test_builder_large_frame);
+    RUN_TEST(test_builder_slices);
+    RUN_TEST(test_builder_reuses_buffers);
+    RUN_TEST(test_builder_buffers_shrink);
+
+    sdk_mdtp_builder_destroy(builder);
+    sdk_imodule_destroy(module);
+
+    return UNITY_END();
+}
@@ -0,0 +1,234 @@
+#include <modules/sdk.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unity.h>
+
+void tearDown(void) {}
+
+void setUp(void) {}
+
+
+// Stub
+ABI_MODULE_FUNCTIONS module_init(ABI_SERVER_CORE_FUNCTIONS server_functions,
+                                 const char               *json_configuration) {
+    return (ABI_MODULE_FUNCTIONS){0};
+}
+
+
+static uint32_t get_abi_version(const ABI_MODULE_CONTEXT *context) {
+    return 2 | ABI_CAPABILITY_ARRAYS | ABI_CAPABILITY_MDTP_V2;
+}
+
+
+static uint32_t get_abi_version_plain(const ABI_MODULE_CONTEXT *context) {
+    return 2 | ABI_CAPABILITY_MDTP_V2;
+}
+
+
+static IModule     *module;
+static MdtpBuilder *builder;
+static uint64_t     cheap_calls;
+static uint64_t     expensive_calls;
+static uint64_t     broken_calls;
+
+
+static void sleep_ms(long milliseconds) {
+    struct timespec time = {.tv_sec = milliseconds / 1000,
+                            .tv_nsec = milliseconds % 1000 * 1000000};
+    nanosleep(&time, NULL);
+}
+
+
+// Collected on every poll
+static void collect_cheap(MdtpBuilder *builder) {
+    sdk_mdtp_builder_add_value_u64(builder, "cpu", ++cheap_calls, "");
+}
+
+
+// Collected once a minute
+static void collect_expensive(MdtpBuilder *builder) {
+    uint64_t sizes[] = {1, 2, 3};
+
+    ++expensive_calls;
+
+    sdk_mdtp_builder_begin_container(builder, "packages");
+    sdk_mdtp_builder_add_value_u64(builder, "calls", expensive_calls, "");
+    sdk_mdtp_builder_add_array_u64(builder, "sizes", sizes, 3, "bytes");
+    sdk_mdtp_builder_end_container(builder);
+}
+
+
+// Leaves its container open
+static void collect_broken(MdtpBuilder *builder) {
+    ++broken_calls;
+    sdk_mdtp_builder_begin_container(builder, "broken");
+}
+
+
+// Build a frame of the subtrees and read the values of both
+static void poll(MdtpBuilder *builder, uint64_t *cheap, uint64_t *expensive) {
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_begin_container(builder, "system"));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_cadence_add(module, builder));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_end_container(builder));
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_builder_finish(builder, module);
+    MdtpReader                  reader;
+    MdtpReader                  system;
+    MdtpReader                  packages;
+    size_t                      length;
+
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_validate(data->data, data->size));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_init(&reader, data->data, data->size));
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&reader));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_enter_container(&reader, &system));
+
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&system));
+    TEST_ASSERT_EQUAL_STRING_LEN("cpu", sdk_mdtp_reader_name(&system, &length), 3);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_u64(&system, cheap));
+
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&system));
+    TEST_ASSERT_EQUAL_STRING_LEN("packages", sdk_mdtp_reader_name(&system, &length), 8);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_enter_container(&system, &packages));
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&packages));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_u64(&packages, expensive));
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&packages));
+    TEST_ASSERT_EQUAL(3, sdk_mdtp_reader_array_length(&packages));
+    TEST_ASSERT_FALSE(sdk_mdtp_reader_next(&packages));
+
+    TEST_ASSERT_FALSE(sdk_mdtp_reader_next(&system));
+}
+
+
+void test_cadence_register(void) {
+    TEST_ASSERT_EQUAL(0, sdk_mdtp_cadence_size(module));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_cadence_add(module, builder));
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_cadence_register(module, collect_cheap, 0));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_cadence_register(module, collect_expensive, 60000));
+
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_cadence_register(module, NULL, 0));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_cadence_register(module, collect_cheap, 10));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_cadence_refresh(module, collect_broken));
+    TEST_ASSERT_EQUAL(2, sdk_mdtp_cadence_size(module));
+}
+
+
+void test_cadence_splice(void) {
+    uint64_t cheap;
+    uint64_t expensive;
+
+    // The expensive subtree is collected once and spliced in afterwards
+    for (uint64_t i = 1; i <= 5; ++i) {
+        poll(builder, &cheap, &expensive);
+        TEST_ASSERT_EQUAL_UINT64(i, cheap);
+        TEST_ASSERT_EQUAL_UINT64(1, expensive);
+    }
+
+    TEST_ASSERT_EQUAL_UINT64(5, cheap_calls);
+    TEST_ASSERT_EQUAL_UINT64(1, expensive_calls);
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_cadence_refresh(module, collect_expensive));
+    poll(builder, &cheap, &expensive);
+    TEST_ASSERT_EQUAL_UINT64(2, expensive);
+    poll(builder, &cheap, &expensive);
+    TEST_ASSERT_EQUAL_UINT64(2, expensive_calls);
+}
+
+
+void test_cadence_versions(void) {
+    uint64_t cheap;
+    uint64_t expensive;
+
+    // Nodes of MDTP v1 are not spliced into MDTP v2 frames
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_set_version(builder, MDTP_VERSION_2));
+    poll(builder, &cheap, &expensive);
+    TEST_ASSERT_EQUAL_UINT64(3, expensive);
+    poll(builder, &cheap, &expensive);
+    TEST_ASSERT_EQUAL_UINT64(3, expensive_calls);
+
+    // Nodes recorded in chunks are spliced into one buffer and back
+    MdtpBuilder *chunked = sdk_mdtp_builder_create();
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_set_version(chunked, MDTP_VERSION_2));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_set_chunk_size(chunked, MDTP_CHUNK_MIN_SIZE));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_cadence_refresh(module, collect_expensive));
+
+    for (int i = 0; i < 3; ++i) {
+        poll(chunked, &cheap, &expensive);
+        TEST_ASSERT_EQUAL_UINT64(4, expensive);
+        poll(builder, &cheap, &expensive);
+        TEST_ASSERT_EQUAL_UINT64(4, expensive);
+    }
+
+    sdk_mdtp_builder_destroy(chunked);
+}
+
+
+void test_cadence_interval(void) {
+    ABI_SERVER_CORE_FUNCTIONS server = {.abi_get_abi_version = get_abi_version};
+    IModule                  *other = sdk_imodule_create("other", "other", server, 0, 1);
+    uint64_t                  calls = expensive_calls;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_cadence_register(other, collect_expensive, 50));
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_cadence_add(other, builder));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_cadence_add(other, builder));
+    TEST_ASSERT_EQUAL_UINT64(calls + 1, expensive_calls);
+
+    // Called again once the interval passed
+    sleep_ms(60);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_cadence_add(other, builder));
+    TEST_ASSERT_EQUAL_UINT64(calls + 2, expensive_calls);
+    TEST_ASSERT_NOT_NULL(sdk_mdtp_builder_finish(builder, other));
+
+    sdk_imodule_destroy(other);
+}
+
+
+void test_cadence_errors(void) {
+    ABI_SERVER_CORE_FUNCTIONS server = {.abi_get_abi_version = get_abi_version_plain};
+    IModule                  *plain = sdk_imodule_create("plain", "plain", server, 0, 1);
+
+    // Spliced nodes keep the capabilities they need
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_cadence_register(plain, collect_expensive, 60000));
+
+    for (int i = 0; i < 2; ++i) {
+        TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_cadence_add(plain, builder));
+        TEST_ASSERT_NULL(sdk_mdtp_builder_finish(builder, plain));
+    }
+
+    // Nodes left open fail the frame, and the collector is called again next time
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_cadence_register(plain, collect_broken, 60000));
+
+    for (uint64_t i = 1; i <= 2; ++i) {
+        TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_cadence_add(plain, builder));
+        TEST_ASSERT_NULL(sdk_mdtp_builder_finish(builder, plain));
+        TEST_ASSERT_EQUAL_UINT64(i, broken_calls);
+    }
+
+    sdk_imodule_destroy(plain);
+}
+
+
+int main(void) {
+    ABI_SERVER_CORE_FUNCTIONS server = {.abi_get_abi_version = get_abi_version};
+
+    module = sdk_imodule_create("test", "test", server, 0, 1);
+    builder = sdk_mdtp_builder_create();
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_cadence_register);
+    RUN_TEST(test_cadence_splice);
+    RUN_TEST(test_cadence_versions);
+    RUN_TEST(test_cadence_interval);
+    RUN_TEST(test_cadence_errors);
+
+    sdk_mdtp_builder_destroy(builder);
+    sdk_imodule_destroy(module);
+
+    return UNITY_END();
+}
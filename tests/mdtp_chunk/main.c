@@ -0,0 +1,337 @@
+#include <modules/sdk.h>
+#include <modules/internals/memutils.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "../mdtp_fixture.h"
+
+#define MAX_PARTS 1024
+#define CHUNK_SIZE 256
+
+static MdtpBuilder *chunked;
+
+
+// Fetch all parts of the frame to send as the server does, check them and join them
+static void *receive(IModule *from, const ABI_MODULE_MDTP_DATA *first, size_t *size) {
+    static ABI_MODULE_MDTP_DATA parts[MAX_PARTS];
+    MdtpChunk                   chunk;
+    size_t                      count = 1;
+
+    parts[0] = *first;
+
+    if (sdk_mdtp_chunk_parse(first->data, first->size, &chunk) == SDK_OK) {
+        TEST_ASSERT_EQUAL(0, chunk.sequence);
+        TEST_ASSERT_LESS_OR_EQUAL(MAX_PARTS, chunk.count);
+
+        for (count = 1; count < chunk.count; ++count) {
+            const ABI_MODULE_MDTP_DATA *part = sdk_mdtp_chunk_get(from, (uint32_t)count);
+
+            TEST_ASSERT_NOT_NULL(part);
+            parts[count] = *part;
+        }
+
+        TEST_ASSERT_NULL(sdk_mdtp_chunk_get(from, (uint32_t)count));
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        TEST_ASSERT_LESS_OR_EQUAL(MDTP_CHUNK_HEADER_SIZE + CHUNK_SIZE, parts[i].size);
+    }
+
+    void *frame = sdk_mdtp_chunk_join(parts, count, size);
+
+    TEST_ASSERT_NOT_NULL(frame);
+
+    return frame;
+}
+
+
+void test_chunk_capability(void) {
+    IModule *old = old_module();
+
+    TEST_ASSERT_EQUAL(SDK_OTHER_ERROR, sdk_mdtp_chunk_enable(old, CHUNK_SIZE));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_chunk_enable(module, 16));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_builder_set_chunk_size(chunked, 16));
+
+    // A frame built in chunks for a module without chunked frames is stored in one piece
+    write_processes(chunked, 50, 0);
+    write_processes(builder, 50, 0);
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_builder_finish(chunked, old);
+
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_FALSE(has_flag(data, MDTP_FLAG_CHUNK));
+    TEST_ASSERT_EQUAL_PTR(data, sdk_mdtp_chunk_emit(old));
+    TEST_ASSERT_NULL(sdk_mdtp_chunk_get(old, 0));
+
+    const ABI_MODULE_MDTP_DATA *plain = sdk_mdtp_builder_finish(builder, module);
+
+    TEST_ASSERT_EQUAL(plain->size, data->size);
+    TEST_ASSERT_EQUAL_MEMORY(plain->data, data->data, data->size);
+
+    sdk_imodule_destroy(old);
+}
+
+
+void test_chunk_split(void) {
+    size_t size;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_chunk_enable(module, CHUNK_SIZE));
+
+    make_process_frame(100, 0);
+
+    const ABI_MODULE_MDTP_DATA *sent = sdk_mdtp_chunk_emit(module);
+    const void                 *buffer = sent->data;
+
+    TEST_ASSERT_TRUE(has_flag(sent, MDTP_FLAG_CHUNK));
+
+    void *frame = receive(module, sent, &size);
+
+    TEST_ASSERT_EQUAL(expected_size, size);
+    TEST_ASSERT_EQUAL_MEMORY(expected, frame, size);
+    free(frame);
+
+    // Emitting again returns the same part, and the parts are reused for the next frame
+    TEST_ASSERT_EQUAL_PTR(sent, sdk_mdtp_chunk_emit(module));
+    make_process_frame(100, 7);
+    sent = sdk_mdtp_chunk_emit(module);
+
+    TEST_ASSERT_EQUAL_PTR(buffer, sent->data);
+    frame = receive(module, sent, &size);
+    TEST_ASSERT_EQUAL(expected_size, size);
+    TEST_ASSERT_EQUAL_MEMORY(expected, frame, size);
+    free(frame);
+
+    // Frames that fit one part are sent as they are
+    make_process_frame(2, 0);
+    sent = sdk_mdtp_chunk_emit(module);
+
+    TEST_ASSERT_FALSE(has_flag(sent, MDTP_FLAG_CHUNK));
+    TEST_ASSERT_NULL(sdk_mdtp_chunk_get(module, 0));
+
+    // Disabling chunked frames leaves the server with the whole frame
+    make_process_frame(100, 0);
+    sdk_mdtp_chunk_emit(module);
+    sdk_mdtp_chunk_disable(module);
+    sent = sdk_imodule_get_mdtp_data(module);
+
+    TEST_ASSERT_FALSE(has_flag(sent, MDTP_FLAG_CHUNK));
+    TEST_ASSERT_EQUAL(expected_size, sent->size);
+    TEST_ASSERT_EQUAL_MEMORY(expected, sent->data, expected_size);
+}
+
+
+void test_chunk_builder(void) {
+    size_t size;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_chunk_enable(module, CHUNK_SIZE));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_crc_enable(module));
+
+    for (uint64_t poll = 0; poll < 3; ++poll) {
+        make_process_frame(300, poll);
+        write_processes(chunked, 300, poll);
+
+        ABI_MODULE_DATA_INFO        info = *sdk_imodule_get_mdtp_data_info(module);
+        const ABI_MODULE_MDTP_DATA *sent = sdk_mdtp_builder_finish(chunked, module);
+
+        TEST_ASSERT_NOT_NULL(sent);
+        TEST_ASSERT_TRUE(has_flag(sent, MDTP_FLAG_CHUNK));
+
+        // The parts are hashed as the frame they make up, the same as the whole frame
+        TEST_ASSERT_EQUAL_UINT64(info.hash, sdk_imodule_get_mdtp_data_info(module)->hash);
+        TEST_ASSERT_EQUAL_UINT64(info.generation,
+                                 sdk_imodule_get_mdtp_data_info(module)->generation);
+
+        // The other encodings leave the parts as they are
+        TEST_ASSERT_EQUAL_PTR(sent, sdk_mdtp_crc_emit(module));
+        TEST_ASSERT_TRUE(has_flag(sent, MDTP_FLAG_CHUNK));
+
+        void *frame = receive(module, sent, &size);
+
+        TEST_ASSERT_EQUAL(expected_size, size);
+        TEST_ASSERT_EQUAL_MEMORY(expected, frame, size);
+        free(frame);
+    }
+
+    // The same frame again keeps the generation
+    uint64_t generation = sdk_imodule_get_mdtp_data_info(module)->generation;
+
+    write_processes(chunked, 300, 2);
+    sdk_mdtp_builder_finish(chunked, module);
+
+    TEST_ASSERT_EQUAL_UINT64(generation, sdk_imodule_get_mdtp_data_info(module)->generation);
+
+    sdk_mdtp_crc_disable(module);
+    sdk_mdtp_chunk_disable(module);
+}
+
+
+void test_chunk_builder_large_value(void) {
+    static uint8_t bytes[3 * CHUNK_SIZE];
+    size_t         size;
+
+    memset(bytes, 0xAB, sizeof(bytes));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_chunk_enable(module, CHUNK_SIZE));
+
+    // A value larger than a chunk is split into parts of the chunk size when the frame is finished
+    sdk_mdtp_builder_add_value(chunked, "first", "1", "");
+    sdk_mdtp_builder_add_value_bytes(chunked, "large", bytes, sizeof(bytes), "");
+    sdk_mdtp_builder_add_value(chunked, "last", "2", "");
+
+    const ABI_MODULE_MDTP_DATA *sent = sdk_mdtp_builder_finish(chunked, module);
+    MdtpChunk                   chunk;
+    MdtpReader                  reader;
+    size_t                      length;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_chunk_parse(sent->data, sent->size, &chunk));
+    TEST_ASSERT_TRUE(chunk.count > 4);
+
+    void *frame = receive(module, sent, &size);
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_validate(frame, size));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_init(&reader, frame, size));
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&reader));
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&reader));
+    TEST_ASSERT_EQUAL_MEMORY(bytes, sdk_mdtp_reader_value(&reader, &length), sizeof(bytes));
+    TEST_ASSERT_EQUAL(sizeof(bytes), length);
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&reader));
+    TEST_ASSERT_FALSE(sdk_mdtp_reader_next(&reader));
+    free(frame);
+
+    sdk_mdtp_chunk_disable(module);
+}
+
+
+void test_chunk_builder_v2(void) {
+    size_t     size;
+    MdtpReader reader;
+    MdtpReader rows;
+    MdtpReader row;
+    uint64_t   rss = 0;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_chunk_enable(module, CHUNK_SIZE));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_set_version(chunked, MDTP_VERSION_2));
+
+    write_processes(chunked, 300, 5);
+
+    const ABI_MODULE_MDTP_DATA *sent = sdk_mdtp_builder_finish(chunked, module);
+
+    TEST_ASSERT_TRUE(has_flag(sent, MDTP_FLAG_CHUNK));
+
+    uint8_t *frame = receive(module, sent, &size);
+
+    // Container sizes are padded varints, which readers take as they are
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_validate(frame, size));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_init(&reader, frame, size));
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&reader));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_enter_container(&reader, &rows));
+
+    while (sdk_mdtp_reader_next(&rows)) {
+        TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_enter_container(&rows, &row));
+        TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&row));
+        TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&row));
+        TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_u64(&row, &rss));
+    }
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_status(&rows));
+    TEST_ASSERT_EQUAL_UINT64(5 + 299 * 4096, rss);
+    free(frame);
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_set_version(chunked, MDTP_VERSION));
+    sdk_mdtp_chunk_disable(module);
+}
+
+
+void test_chunk_make_root_after_crc(void) {
+    void  *nodes[100];
+    size_t size;
+    size_t stripped_size;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_chunk_enable(module, CHUNK_SIZE));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_crc_enable(module));
+
+    for (int i = 0; i < 100; ++i) {
+        nodes[i] = sdk_mdtp_make_value("usage", "12", "%");
+    }
+
+    const ABI_MODULE_MDTP_DATA *sent = sdk_mdtp_make_root_v(module, nodes, 100);
+
+    TEST_ASSERT_TRUE(has_flag(sent, MDTP_FLAG_CHUNK));
+
+    void *frame = receive(module, sent, &size);
+    void *stripped = sdk_mdtp_crc_strip(frame, size, &stripped_size);
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_crc_verify(frame, size));
+    TEST_ASSERT_NOT_NULL(stripped);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_validate(stripped, stripped_size));
+
+    free(stripped);
+    free(frame);
+    sdk_mdtp_crc_disable(module);
+    sdk_mdtp_chunk_disable(module);
+}
+
+
+void test_chunk_malformed(void) {
+    static uint8_t       copy[MDTP_CHUNK_HEADER_SIZE + CHUNK_SIZE];
+    ABI_MODULE_MDTP_DATA parts[MAX_PARTS];
+    MdtpChunk            chunk;
+    size_t               size;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_chunk_enable(module, CHUNK_SIZE));
+    make_process_frame(20, 0);
+
+    parts[0] = *sdk_mdtp_chunk_emit(module);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_chunk_parse(parts[0].data, parts[0].size, &chunk));
+    TEST_ASSERT_TRUE(chunk.count > 2);
+
+    for (uint32_t i = 1; i < chunk.count; ++i) {
+        parts[i] = *sdk_mdtp_chunk_get(module, i);
+    }
+
+    // Incomplete and out of order
+    TEST_ASSERT_NULL(sdk_mdtp_chunk_join(parts, chunk.count - 1, &size));
+
+    ABI_MODULE_MDTP_DATA swapped = parts[1];
+
+    parts[1] = parts[2];
+    parts[2] = swapped;
+    TEST_ASSERT_NULL(sdk_mdtp_chunk_join(parts, chunk.count, &size));
+    parts[2] = parts[1];
+    parts[1] = swapped;
+
+    // Truncated part
+    TEST_ASSERT_EQUAL(SDK_ARGUMENT_PROCESSING_ERROR,
+                      sdk_mdtp_chunk_parse(parts[1].data, parts[1].size - 1, &chunk));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_chunk_parse(expected, expected_size, &chunk));
+
+    // Sequence past the count
+    memcpy(copy, parts[1].data, parts[1].size);
+    write_uint32_be(copy, 5, 1000);
+    TEST_ASSERT_EQUAL(SDK_ARGUMENT_PROCESSING_ERROR,
+                      sdk_mdtp_chunk_parse(copy, parts[1].size, &chunk));
+
+    sdk_mdtp_chunk_disable(module);
+}
+
+
+int main(void) {
+    fixture_create(ABI_CAPABILITY_CHUNKED_FRAMES | ABI_CAPABILITY_CRC | ABI_CAPABILITY_MDTP_V2, 0);
+    chunked = sdk_mdtp_builder_create();
+    sdk_mdtp_builder_set_chunk_size(chunked, CHUNK_SIZE);
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_chunk_capability);
+    RUN_TEST(test_chunk_split);
+    RUN_TEST(test_chunk_builder);
+    RUN_TEST(test_chunk_builder_large_value);
+    RUN_TEST(test_chunk_builder_v2);
+    RUN_TEST(test_chunk_make_root_after_crc);
+    RUN_TEST(test_chunk_malformed);
+
+    sdk_mdtp_builder_destroy(chunked);
+    fixture_destroy();
+
+    return UNITY_END();
+}
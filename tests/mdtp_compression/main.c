@@ -0,0 +1,238 @@
+#include <modules/sdk.h>
+#include <modules/internals/memutils.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "../mdtp_fixture.h"
+
+
+// Decompress the sent frame and check that it is the expected one
+static void receive(const ABI_MODULE_MDTP_DATA *sent) {
+    size_t size;
+    void  *frame = sdk_mdtp_compression_decompress(sent->data, sent->size, &size);
+
+    TEST_ASSERT_NOT_NULL(frame);
+    TEST_ASSERT_EQUAL(expected_size, size);
+    TEST_ASSERT_EQUAL_MEMORY(expected, frame, size);
+
+    free(frame);
+}
+
+
+void test_compression_capability(void) {
+    IModule *old = old_module();
+
+    TEST_ASSERT_EQUAL(SDK_OTHER_ERROR, sdk_mdtp_compression_enable(old, 0));
+    check_passthrough(old, sdk_mdtp_compression_emit, MDTP_FLAG_COMPRESSED);
+
+    sdk_imodule_destroy(old);
+}
+
+
+void test_compression_frames(void) {
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_compression_enable(module, 1024));
+
+    make_process_frame(200, 0);
+
+    const ABI_MODULE_MDTP_DATA *sent = sdk_mdtp_compression_emit(module);
+    const void                 *buffer = sent->data;
+
+    TEST_ASSERT_TRUE(has_flag(sent, MDTP_FLAG_COMPRESSED));
+    TEST_ASSERT_TRUE(sent->size * 4 < expected_size);
+    receive(sent);
+
+    // Emitting again returns the same frame
+    TEST_ASSERT_EQUAL_PTR(sent, sdk_mdtp_compression_emit(module));
+    TEST_ASSERT_EQUAL_PTR(buffer, sent->data);
+    receive(sent);
+
+    // The buffers are reused for frames of the same size
+    make_process_frame(200, 7);
+    sent = sdk_mdtp_compression_emit(module);
+
+    TEST_ASSERT_EQUAL_PTR(buffer, sent->data);
+    receive(sent);
+
+    // Frames under the threshold are sent as they are
+    make_process_frame(2, 0);
+    sent = sdk_mdtp_compression_emit(module);
+
+    TEST_ASSERT_TRUE(expected_size < 1024);
+    TEST_ASSERT_FALSE(has_flag(sent, MDTP_FLAG_COMPRESSED));
+    receive(sent);
+
+    // Disabling compression leaves the server with the plain frame
+    make_process_frame(200, 0);
+    sdk_mdtp_compression_emit(module);
+    sdk_mdtp_compression_disable(module);
+    sent = sdk_imodule_get_mdtp_data(module);
+
+    TEST_ASSERT_FALSE(has_flag(sent, MDTP_FLAG_COMPRESSED));
+    TEST_ASSERT_EQUAL(expected_size, sent->size);
+    TEST_ASSERT_EQUAL_MEMORY(expected, sent->data, expected_size);
+}
+
+
+void test_compression_make_root(void) {
+    void *nodes[300];
+
+    for (int i = 0; i < 300; ++i) {
+        nodes[i] = sdk_mdtp_make_value("usage", "12", "%");
+    }
+
+    // Without compression to know the expected frame
+    const ABI_MODULE_MDTP_DATA *sent = sdk_mdtp_make_root_v(module, nodes, 300);
+
+    TEST_ASSERT_FALSE(has_flag(sent, MDTP_FLAG_COMPRESSED));
+    memcpy(expected, sent->data, sent->size);
+    expected_size = sent->size;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_compression_enable(module, 0));
+
+    for (int i = 0; i < 300; ++i) {
+        nodes[i] = sdk_mdtp_make_value("usage", "12", "%");
+    }
+
+    sent = sdk_mdtp_make_root_v(module, nodes, 300);
+
+    TEST_ASSERT_TRUE(has_flag(sent, MDTP_FLAG_COMPRESSED));
+    receive(sent);
+
+    sdk_mdtp_compression_disable(module);
+}
+
+
+void test_compression_incompressible(void) {
+    uint8_t  bytes[8192];
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+
+    for (size_t i = 0; i < sizeof(bytes); ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        bytes[i] = (uint8_t)state;
+    }
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_compression_enable(module, 0));
+    sdk_mdtp_builder_add_value_bytes(builder, "random", bytes, sizeof(bytes), "");
+
+    const ABI_MODULE_MDTP_DATA *stored = sdk_mdtp_builder_finish(builder, module);
+
+    TEST_ASSERT_EQUAL_PTR(stored, sdk_mdtp_compression_emit(module));
+    TEST_ASSERT_FALSE(has_flag(stored, MDTP_FLAG_COMPRESSED));
+
+    sdk_mdtp_compression_disable(module);
+}
+
+
+void test_compression_after_delta_and_dictionary(void) {
+    MdtpDictionaryDecoder *decoder = sdk_mdtp_dictionary_decoder_create();
+    void                  *base = NULL;
+    size_t                 base_size = 0;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_delta_enable(module, 4));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_dictionary_enable(module));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_compression_enable(module, 0));
+
+    for (uint64_t poll = 0; poll < 10; ++poll) {
+        make_process_frame(100, poll % 3 == 0 ? poll : 0);
+
+        // A frame compressed too early is taken back by the steps before compression
+        sdk_mdtp_compression_emit(module);
+        sdk_mdtp_delta_emit(module);
+        sdk_mdtp_dictionary_emit(module);
+
+        const ABI_MODULE_MDTP_DATA *sent = sdk_mdtp_compression_emit(module);
+        size_t                      decompressed_size;
+        size_t                      decoded_size;
+        size_t                      size;
+
+        uint8_t *decompressed =
+            sdk_mdtp_compression_decompress(sent->data, sent->size, &decompressed_size);
+        void    *decoded = decompressed;
+
+        // Delta frames have no dictionary strings
+        TEST_ASSERT_NOT_NULL(decompressed);
+        decoded_size = decompressed_size;
+
+        if ((decompressed[0] & MDTP_FLAG_DICTIONARY) != 0) {
+            decoded =
+                sdk_mdtp_dictionary_decode(decoder, decompressed, decompressed_size, &decoded_size);
+        }
+
+        void *frame = sdk_mdtp_delta_apply(base, base_size, decoded, decoded_size, &size);
+
+        TEST_ASSERT_NOT_NULL(frame);
+        TEST_ASSERT_EQUAL(expected_size, size);
+        TEST_ASSERT_EQUAL_MEMORY(expected, frame, size);
+
+        if (decoded != decompressed) {
+            free(decoded);
+        }
+
+        free(decompressed);
+        free(base);
+        base = frame;
+        base_size = size;
+    }
+
+    free(base);
+    sdk_mdtp_dictionary_decoder_destroy(decoder);
+    sdk_mdtp_compression_disable(module);
+    sdk_mdtp_dictionary_disable(module);
+    sdk_mdtp_delta_disable(module);
+}
+
+
+void test_compression_malformed(void) {
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_compression_enable(module, 0));
+    make_process_frame(50, 0);
+
+    const ABI_MODULE_MDTP_DATA *sent = sdk_mdtp_compression_emit(module);
+    uint8_t                     frame[MAX_FRAME];
+    size_t                      frame_size = sent->size;
+    size_t                      size;
+
+    TEST_ASSERT_TRUE(has_flag(sent, MDTP_FLAG_COMPRESSED));
+    memcpy(frame, sent->data, frame_size);
+
+    // Truncated
+    write_uint32_be(frame, 1, (uint32_t)(frame_size - 6));
+    TEST_ASSERT_NULL(sdk_mdtp_compression_decompress(frame, frame_size - 1, &size));
+    write_uint32_be(frame, 1, (uint32_t)(frame_size - 5));
+
+    // Original size does not match the block
+    uint8_t prefix = frame[5];
+
+    frame[5] = (uint8_t)(prefix + 1);
+    TEST_ASSERT_NULL(sdk_mdtp_compression_decompress(frame, frame_size, &size));
+    frame[5] = prefix;
+
+    // Match before the start of the frame: the first token (after [header] [2 bytes of varint
+    // size]) without literals
+    frame[7] = 0x00;
+    TEST_ASSERT_NULL(sdk_mdtp_compression_decompress(frame, frame_size, &size));
+
+    sdk_mdtp_compression_disable(module);
+}
+
+
+int main(void) {
+    fixture_create(ABI_CAPABILITY_COMPRESSION | ABI_CAPABILITY_DICTIONARY |
+                   ABI_CAPABILITY_DELTA_FRAMES,
+                   0);
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_compression_capability);
+    RUN_TEST(test_compression_frames);
+    RUN_TEST(test_compression_make_root);
+    RUN_TEST(test_compression_incompressible);
+    RUN_TEST(test_compression_after_delta_and_dictionary);
+    RUN_TEST(test_compression_malformed);
+
+    fixture_destroy();
+
+    return UNITY_END();
+}
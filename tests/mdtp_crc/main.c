@@ -0,0 +1,225 @@
+#include <modules/sdk.h>
+#include <modules/internals/memutils.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "../mdtp_fixture.h"
+
+
+// CRC32C bit by bit, as the definition says
+static uint32_t reference_crc32c(const uint8_t *bytes, size_t size) {
+    uint32_t crc = 0xFFFFFFFFu;
+
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= bytes[i];
+
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) != 0 ? (crc >> 1) ^ 0x82F63B78u : crc >> 1;
+        }
+    }
+
+    return ~crc;
+}
+
+
+// Verify and strip the sent frame and check that it is the expected one
+static void receive(const ABI_MODULE_MDTP_DATA *sent) {
+    size_t size;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_crc_verify(sent->data, sent->size));
+
+    void *frame = sdk_mdtp_crc_strip(sent->data, sent->size, &size);
+
+    TEST_ASSERT_NOT_NULL(frame);
+    TEST_ASSERT_EQUAL(expected_size, size);
+    TEST_ASSERT_EQUAL_MEMORY(expected, frame, size);
+
+    free(frame);
+}
+
+
+void test_crc_values(void) {
+    static uint8_t bytes[10000];
+    uint64_t       state = 0x9E3779B97F4A7C15ull;
+
+    TEST_ASSERT_EQUAL_UINT32(0xE3069283u, sdk_mdtp_crc32c(0, "123456789", 9));
+    TEST_ASSERT_EQUAL_UINT32(0, sdk_mdtp_crc32c(0, NULL, 0));
+
+    for (size_t i = 0; i < sizeof(bytes); ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        bytes[i] = (uint8_t)state;
+    }
+
+    // Every length and alignment the implementations treat differently
+    for (size_t size = 0; size < sizeof(bytes); size = size * 3 / 2 + 1) {
+        for (size_t offset = 0; offset < 8 && offset + size <= sizeof(bytes); offset += 3) {
+            uint32_t crc = reference_crc32c(bytes + offset, size);
+
+            TEST_ASSERT_EQUAL_UINT32(crc, sdk_mdtp_crc32c(0, bytes + offset, size));
+
+            // In two parts
+            uint32_t first = sdk_mdtp_crc32c(0, bytes + offset, size / 3);
+
+            TEST_ASSERT_EQUAL_UINT32(
+                crc, sdk_mdtp_crc32c(first, bytes + offset + size / 3, size - size / 3));
+        }
+    }
+}
+
+
+void test_crc_capability(void) {
+    IModule *old = old_module();
+
+    TEST_ASSERT_EQUAL(SDK_OTHER_ERROR, sdk_mdtp_crc_enable(old));
+    check_passthrough(old, sdk_mdtp_crc_emit, MDTP_FLAG_CRC);
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_imodule_get_mdtp_data(old);
+
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_crc_verify(data->data, data->size));
+
+    sdk_imodule_destroy(old);
+}
+
+
+void test_crc_frames(void) {
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_crc_enable(module));
+
+    make_process_frame(100, 0);
+
+    const ABI_MODULE_MDTP_DATA *sent = sdk_mdtp_crc_emit(module);
+    const void                 *buffer = sent->data;
+
+    TEST_ASSERT_TRUE(has_flag(sent, MDTP_FLAG_CRC));
+    TEST_ASSERT_EQUAL(expected_size + 4, sent->size);
+    TEST_ASSERT_EQUAL_UINT32(sent->size - 5, read_uint32_be(sent->data, 1));
+    receive(sent);
+
+    // Emitting again returns the same frame
+    TEST_ASSERT_EQUAL_PTR(sent, sdk_mdtp_crc_emit(module));
+    TEST_ASSERT_EQUAL_PTR(buffer, sent->data);
+    receive(sent);
+
+    // The buffer is reused for frames of the same size
+    make_process_frame(100, 7);
+    sent = sdk_mdtp_crc_emit(module);
+
+    TEST_ASSERT_EQUAL_PTR(buffer, sent->data);
+    receive(sent);
+
+    // Frames without a trailer are copied as they are
+    size_t size;
+    void  *copy = sdk_mdtp_crc_strip(expected, expected_size, &size);
+
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_EQUAL(expected_size, size);
+    TEST_ASSERT_EQUAL_MEMORY(expected, copy, size);
+    free(copy);
+
+    // Disabling trailers leaves the server with the plain frame
+    sdk_mdtp_crc_disable(module);
+    sent = sdk_imodule_get_mdtp_data(module);
+
+    TEST_ASSERT_FALSE(has_flag(sent, MDTP_FLAG_CRC));
+    TEST_ASSERT_EQUAL(expected_size, sent->size);
+    TEST_ASSERT_EQUAL_MEMORY(expected, sent->data, expected_size);
+}
+
+
+void test_crc_corrupted(void) {
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_crc_enable(module));
+    make_process_frame(20, 0);
+
+    const ABI_MODULE_MDTP_DATA *sent = sdk_mdtp_crc_emit(module);
+    uint8_t                     frame[MAX_FRAME];
+    size_t                      frame_size = sent->size;
+    size_t                      size;
+
+    memcpy(frame, sent->data, frame_size);
+
+    // Every single bit flip of the payload and the trailer is detected
+    for (size_t i = 5; i < frame_size; ++i) {
+        for (int bit = 0; bit < 8; ++bit) {
+            frame[i] ^= (uint8_t)(1u << bit);
+            TEST_ASSERT_EQUAL(SDK_ARGUMENT_PROCESSING_ERROR,
+                              sdk_mdtp_crc_verify(frame, frame_size));
+            frame[i] ^= (uint8_t)(1u << bit);
+        }
+    }
+
+    TEST_ASSERT_NULL(sdk_mdtp_crc_strip(frame, frame_size - 1, &size));
+    TEST_ASSERT_EQUAL(SDK_ARGUMENT_PROCESSING_ERROR, sdk_mdtp_crc_verify(frame, frame_size - 1));
+    TEST_ASSERT_EQUAL(SDK_ARGUMENT_PROCESSING_ERROR, sdk_mdtp_crc_verify(frame, 6));
+
+    frame[frame_size - 1] ^= 1;
+    TEST_ASSERT_NULL(sdk_mdtp_crc_strip(frame, frame_size, &size));
+
+    sdk_mdtp_crc_disable(module);
+}
+
+
+void test_crc_make_root(void) {
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_crc_enable(module));
+
+    const ABI_MODULE_MDTP_DATA *sent =
+        sdk_mdtp_make_root(module, sdk_mdtp_make_value("usage", "12", "%"), NULL);
+
+    TEST_ASSERT_TRUE(has_flag(sent, MDTP_FLAG_CRC));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_crc_verify(sent->data, sent->size));
+
+    sdk_mdtp_crc_disable(module);
+}
+
+
+void test_crc_after_compression(void) {
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_crc_enable(module));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_compression_enable(module, 0));
+
+    for (uint64_t poll = 0; poll < 3; ++poll) {
+        make_process_frame(100, poll);
+
+        // A trailer appended too early is taken back by compression
+        sdk_mdtp_crc_emit(module);
+        sdk_mdtp_compression_emit(module);
+
+        const ABI_MODULE_MDTP_DATA *sent = sdk_mdtp_crc_emit(module);
+        size_t                      stripped_size;
+        size_t                      size;
+
+        TEST_ASSERT_TRUE(has_flag(sent, MDTP_FLAG_CRC));
+        TEST_ASSERT_TRUE(has_flag(sent, MDTP_FLAG_COMPRESSED));
+
+        void *stripped = sdk_mdtp_crc_strip(sent->data, sent->size, &stripped_size);
+        void *frame = sdk_mdtp_compression_decompress(stripped, stripped_size, &size);
+
+        TEST_ASSERT_NOT_NULL(frame);
+        TEST_ASSERT_EQUAL(expected_size, size);
+        TEST_ASSERT_EQUAL_MEMORY(expected, frame, size);
+
+        free(frame);
+        free(stripped);
+    }
+
+    sdk_mdtp_compression_disable(module);
+    sdk_mdtp_crc_disable(module);
+}
+
+
+int main(void) {
+    fixture_create(ABI_CAPABILITY_CRC | ABI_CAPABILITY_COMPRESSION, 0);
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_crc_values);
+    RUN_TEST(test_crc_capability);
+    RUN_TEST(test_crc_frames);
+    RUN_TEST(test_crc_corrupted);
+    RUN_TEST(test_crc_make_root);
+    RUN_TEST(test_crc_after_compression);
+
+    fixture_destroy();
+
+    return UNITY_END();
+}
@@ -0,0 +1,247 @@
+#include <modules/sdk.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unity.h>
+
+void tearDown(void) {}
+
+void setUp(void) {}
+
+
+// Stub
+ABI_MODULE_FUNCTIONS module_init(ABI_SERVER_CORE_FUNCTIONS server_functions,
+                                 const char               *json_configuration) {
+    return (ABI_MODULE_FUNCTIONS){0};
+}
+
+
+static uint32_t get_abi_version(const ABI_MODULE_CONTEXT *context) {
+    return 2 | ABI_CAPABILITY_DELTA_FRAMES;
+}
+
+
+static int warnings;
+
+static void log_message(const ABI_MODULE_CONTEXT *context, int log_type, const char *message) {
+    TEST_ASSERT_EQUAL(LOG_WARNING, log_type);
+    TEST_ASSERT_NOT_NULL(strstr(message, "budget"));
+    ++warnings;
+}
+
+
+static IModule         *module;
+static MdtpBuilder     *builder;
+static _Atomic uint64_t collections;
+static _Atomic long     delay_ms; ///< How long the next collections take
+static _Atomic int      failing;  ///< `1` if collections return no frame
+
+
+static void sleep_ms(long milliseconds) {
+    struct timespec time = {.tv_sec = milliseconds / 1000,
+                            .tv_nsec = milliseconds % 1000 * 1000000};
+    nanosleep(&time, NULL);
+}
+
+
+// Frame with the number of the collection
+static const ABI_MODULE_MDTP_DATA *collect(void) {
+    uint64_t number = atomic_fetch_add(&collections, 1) + 1;
+    int      fails = atomic_load(&failing);
+
+    // A failing collection does not touch the builder, so it may outlive the budget
+    sleep_ms(atomic_load(&delay_ms));
+
+    if (fails) {
+        return NULL;
+    }
+
+    sdk_mdtp_builder_add_value_u64(builder, "collection", number, "");
+
+    return sdk_mdtp_builder_finish(builder, module);
+}
+
+
+// Poll and read the number of the collection of the frame returned
+static uint64_t poll(void) {
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_deadline_get_data(module);
+    MdtpReader                  reader;
+    uint64_t                    number;
+
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_init(&reader, data->data, data->size));
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&reader));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_u64(&reader, &number));
+
+    return number;
+}
+
+
+void test_deadline_in_time(void) {
+    TEST_ASSERT_NULL(sdk_mdtp_deadline_get_data(module));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_deadline_enable(module, collect, 50));
+
+    // Every poll collects a new frame
+    for (uint64_t i = 1; i <= 5; ++i) {
+        TEST_ASSERT_EQUAL_UINT64(i, poll());
+        TEST_ASSERT_FALSE(sdk_mdtp_deadline_is_stale(module));
+    }
+
+    TEST_ASSERT_NOT_NULL(sdk_mdtp_deadline_get_data_info(module));
+    TEST_ASSERT_EQUAL(0, warnings);
+}
+
+
+void test_deadline_late(void) {
+    // Late collection: the last good frame, marked stale
+    atomic_store(&delay_ms, 200);
+    TEST_ASSERT_EQUAL_UINT64(5, poll());
+    TEST_ASSERT_TRUE(sdk_mdtp_deadline_is_stale(module));
+    TEST_ASSERT_EQUAL(1, warnings);
+
+    // The late collection is not started again, and the incident is logged once
+    TEST_ASSERT_EQUAL_UINT64(5, poll());
+    TEST_ASSERT_TRUE(sdk_mdtp_deadline_is_stale(module));
+    TEST_ASSERT_EQUAL_UINT64(6, atomic_load(&collections));
+    TEST_ASSERT_EQUAL(1, warnings);
+
+    // Once finished, the late frame is sent while the next collection is late too
+    sleep_ms(400);
+    TEST_ASSERT_EQUAL_UINT64(6, poll());
+    TEST_ASSERT_TRUE(sdk_mdtp_deadline_is_stale(module));
+    TEST_ASSERT_EQUAL(1, warnings);
+
+    // A collection in time ends the incident
+    sleep_ms(400);
+    atomic_store(&delay_ms, 0);
+    TEST_ASSERT_EQUAL_UINT64(8, poll());
+    TEST_ASSERT_FALSE(sdk_mdtp_deadline_is_stale(module));
+
+    // And the next one is logged again
+    atomic_store(&delay_ms, 200);
+    TEST_ASSERT_EQUAL_UINT64(8, poll());
+    TEST_ASSERT_EQUAL(2, warnings);
+
+    sleep_ms(400);
+    atomic_store(&delay_ms, 0);
+}
+
+
+void test_deadline_failed(void) {
+    uint64_t last = poll();
+
+    // A routine without a frame keeps the last good frame, marked stale
+    atomic_store(&failing, 1);
+    TEST_ASSERT_EQUAL_UINT64(last, poll());
+    TEST_ASSERT_TRUE(sdk_mdtp_deadline_is_stale(module));
+
+    atomic_store(&failing, 0);
+    TEST_ASSERT_EQUAL_UINT64(last + 2, poll());
+    TEST_ASSERT_FALSE(sdk_mdtp_deadline_is_stale(module));
+
+    // Without a budget the last frame stays
+    sdk_mdtp_deadline_disable(module);
+    sdk_mdtp_deadline_disable(module);
+    TEST_ASSERT_EQUAL_UINT64(last + 2, poll());
+    TEST_ASSERT_EQUAL_UINT64(last + 2, atomic_load(&collections));
+}
+
+
+void test_deadline_misuse(void) {
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_deadline_enable(module, NULL, 10));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_deadline_enable(module, collect, 0));
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_deadline_enable(module, collect, 10));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_deadline_enable(module, collect, 10));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_sampler_start(module, collect, 10));
+    sdk_mdtp_deadline_disable(module);
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_sampler_start(module, collect, 10));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_deadline_enable(module, collect, 10));
+    sdk_mdtp_sampler_stop(module);
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_delta_enable(module, 10));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_deadline_enable(module, collect, 10));
+    sdk_mdtp_delta_disable(module);
+
+    // Destroying a module waits for its collection
+    ABI_SERVER_CORE_FUNCTIONS server = {.abi_get_abi_version = get_abi_version};
+    IModule                  *other = sdk_imodule_create("other", "other", server, 0, 1);
+
+    atomic_store(&delay_ms, 50);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_deadline_enable(other, collect, 1));
+
+    // Without a logger nothing is logged
+    TEST_ASSERT_NULL(sdk_mdtp_deadline_get_data(other));
+    TEST_ASSERT_TRUE(sdk_mdtp_deadline_is_stale(other));
+    sdk_imodule_destroy(other);
+}
+
+
+void test_deadline_hung(void) {
+    ABI_SERVER_CORE_FUNCTIONS server = {.abi_get_abi_version = get_abi_version};
+    IModule                  *other = sdk_imodule_create("other", "other", server, 0, 1);
+    struct timespec           start;
+    struct timespec           end;
+
+    atomic_store(&delay_ms, 0);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_deadline_enable(other, collect, 50));
+
+    const ABI_MODULE_MDTP_DATA *good = sdk_mdtp_deadline_get_data(other);
+
+    TEST_ASSERT_NOT_NULL(good);
+
+    const void *bytes = good->data;
+
+    // A hung collection is waited for at most the budget, the frames stay with the module
+    atomic_store(&delay_ms, 1000);
+    atomic_store(&failing, 1);
+    TEST_ASSERT_EQUAL_PTR(bytes, sdk_mdtp_deadline_get_data(other)->data);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    sdk_mdtp_deadline_disable(other);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    TEST_ASSERT_LESS_THAN(500, (end.tv_sec - start.tv_sec) * 1000 +
+                                   (end.tv_nsec - start.tv_nsec) / 1000000);
+    TEST_ASSERT_EQUAL_PTR(bytes, sdk_mdtp_deadline_get_data(other)->data);
+    TEST_ASSERT_NOT_NULL(sdk_mdtp_deadline_get_data_info(other));
+
+    // A budget can be set again while the abandoned worker finishes
+    atomic_store(&delay_ms, 0);
+    atomic_store(&failing, 0);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_deadline_enable(other, collect, 50));
+    TEST_ASSERT_NOT_NULL(sdk_mdtp_deadline_get_data(other));
+
+    // Destroying the module waits for the abandoned collection
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    sdk_imodule_destroy(other);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    TEST_ASSERT_GREATER_THAN(300, (end.tv_sec - start.tv_sec) * 1000 +
+                                      (end.tv_nsec - start.tv_nsec) / 1000000);
+}
+
+
+int main(void) {
+    ABI_SERVER_CORE_FUNCTIONS server = {.abi_get_abi_version = get_abi_version,
+                                        .abi_log = log_message};
+
+    module = sdk_imodule_create("test", "test", server, 0, 1);
+    builder = sdk_mdtp_builder_create();
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_deadline_in_time);
+    RUN_TEST(test_deadline_late);
+    RUN_TEST(test_deadline_failed);
+    RUN_TEST(test_deadline_misuse);
+    RUN_TEST(test_deadline_hung);
+
+    sdk_mdtp_builder_destroy(builder);
+    sdk_imodule_destroy(module);
+
+    return UNITY_END();
+}
@@ -0,0 +1,277 @@
+#include <modules/sdk.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "../mdtp_fixture.h"
+
+
+// Frame the server has
+static void  *server_frame;
+static size_t server_size;
+
+
+// Pass the frame to the "server" and check that it now has `expected`
+static void receive(const ABI_MODULE_MDTP_DATA *frame, const ABI_MODULE_MDTP_DATA *expected) {
+    size_t size;
+    void  *result =
+        sdk_mdtp_delta_apply(server_frame, server_size, frame->data, frame->size, &size);
+
+    TEST_ASSERT_NOT_NULL(result);
+    TEST_ASSERT_EQUAL(expected->size, size);
+    TEST_ASSERT_EQUAL_MEMORY(expected->data, result, size);
+
+    free(server_frame);
+    server_frame = result;
+    server_size = size;
+}
+
+
+// Store the frame in the module, send it and check what the server has. Returns the sent frame.
+static ABI_MODULE_MDTP_DATA send(const ABI_MODULE_MDTP_DATA *stored) {
+    ABI_MODULE_MDTP_DATA expected = *stored;
+    uint8_t              copy[1024];
+
+    TEST_ASSERT_LESS_OR_EQUAL(sizeof(copy), expected.size);
+    memcpy(copy, expected.data, expected.size);
+    expected.data = copy;
+
+    ABI_MODULE_MDTP_DATA sent = *sdk_mdtp_delta_emit(module);
+
+    receive(&sent, &expected);
+
+    return sent;
+}
+
+
+static int is_delta(ABI_MODULE_MDTP_DATA frame) {
+    return has_flag(&frame, MDTP_FLAG_DELTA);
+}
+
+
+void test_delta_capability(void) {
+    IModule *old = old_module();
+
+    TEST_ASSERT_FALSE(sdk_utils_server_has_capability(old, ABI_CAPABILITY_DELTA_FRAMES));
+    TEST_ASSERT_EQUAL(SDK_OTHER_ERROR, sdk_mdtp_delta_enable(old, 10));
+
+    // Without delta frames the stored frame is sent
+    check_passthrough(old, sdk_mdtp_delta_emit, MDTP_FLAG_DELTA);
+
+    sdk_imodule_destroy(old);
+
+    TEST_ASSERT_TRUE(sdk_utils_server_has_capability(module, ABI_CAPABILITY_DELTA_FRAMES));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_delta_enable(module, 0));
+}
+
+
+void test_delta_changes(void) {
+    ABI_MODULE_MDTP_DATA sent;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_delta_enable(module, 100));
+
+    // The first frame is a keyframe
+    sent = send(sdk_mdtp_make_root(
+        module,
+        sdk_mdtp_make_container("cpu",
+                                sdk_mdtp_make_value("usage", "12", "%"),
+                                sdk_mdtp_make_value("frequency", "3200", "MHz"),
+                                sdk_mdtp_make_value("temperature", "50", "C"),
+                                NULL),
+        sdk_mdtp_make_value("uptime", "100", "s"),
+        sdk_mdtp_make_value("load", "0.5", ""),
+        NULL));
+    TEST_ASSERT_FALSE(is_delta(sent));
+
+    // Changed values
+    const ABI_MODULE_MDTP_DATA *stored = sdk_mdtp_make_root(
+        module,
+        sdk_mdtp_make_container("cpu",
+                                sdk_mdtp_make_value("usage", "13", "%"),
+                                sdk_mdtp_make_value("frequency", "3200", "MHz"),
+                                sdk_mdtp_make_value("temperature", "50", "C"),
+                                NULL),
+        sdk_mdtp_make_value("uptime", "101", "s"),
+        sdk_mdtp_make_value("load", "0.5", ""),
+        NULL);
+    uint32_t size = stored->size;
+
+    sent = send(stored);
+    TEST_ASSERT_TRUE(is_delta(sent));
+    TEST_ASSERT_TRUE(sent.size < size);
+
+    // Inserted, removed and appended nodes
+    sent = send(sdk_mdtp_make_root(
+        module,
+        sdk_mdtp_make_container("cpu",
+                                sdk_mdtp_make_value("usage", "13", "%"),
+                                sdk_mdtp_make_value("cores", "8", ""),
+                                sdk_mdtp_make_value("temperature", "50", "C"),
+                                NULL),
+        sdk_mdtp_make_value("uptime", "101", "s"),
+        sdk_mdtp_make_value("load", "0.5", ""),
+        sdk_mdtp_make_value("swap", "0", "MB"),
+        NULL));
+    TEST_ASSERT_TRUE(is_delta(sent));
+
+    sent = send(sdk_mdtp_make_root(
+        module,
+        sdk_mdtp_make_value("hostname", "server", ""),
+        sdk_mdtp_make_container("cpu",
+                                sdk_mdtp_make_value("usage", "13", "%"),
+                                sdk_mdtp_make_value("cores", "8", ""),
+                                NULL),
+        sdk_mdtp_make_value("load", "0.5", ""),
+        NULL));
+
+    // Nodes with the same names and a replaced node
+    sent = send(sdk_mdtp_make_root(module,
+                                   sdk_mdtp_make_value("hostname", "server", ""),
+                                   sdk_mdtp_make_value("disk", "1", ""),
+                                   sdk_mdtp_make_value("disk", "2", ""),
+                                   sdk_mdtp_make_container_v("load", NULL, 0),
+                                   NULL));
+
+    sent = send(sdk_mdtp_make_root(module,
+                                   sdk_mdtp_make_value("hostname", "server", ""),
+                                   sdk_mdtp_make_value("disk", "2", ""),
+                                   sdk_mdtp_make_container_v("load", NULL, 0),
+                                   NULL));
+
+    // Nothing new: empty delta
+    sent = *sdk_mdtp_delta_emit(module);
+    TEST_ASSERT_TRUE(is_delta(sent));
+    TEST_ASSERT_EQUAL(5, sent.size);
+
+    ABI_MODULE_MDTP_DATA expected = {.data = server_frame, .size = (uint32_t)server_size};
+    uint8_t              copy[1024];
+
+    memcpy(copy, server_frame, server_size);
+    expected.data = copy;
+    receive(&sent, &expected);
+
+    sdk_mdtp_delta_disable(module);
+}
+
+
+void test_delta_keyframes(void) {
+    char value[16];
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_delta_enable(module, 4));
+
+    for (int i = 0; i < 12; ++i) {
+        snprintf(value, sizeof(value), "%d", i);
+
+        ABI_MODULE_MDTP_DATA sent = send(sdk_mdtp_make_root(
+            module,
+            sdk_mdtp_make_container("memory",
+                                    sdk_mdtp_make_value("total", "16384", "MB"),
+                                    sdk_mdtp_make_value("used", value, "MB"),
+                                    NULL),
+            sdk_mdtp_make_value("uptime", "1", "s"),
+            NULL));
+
+        // Enabling starts with a keyframe
+        TEST_ASSERT_EQUAL(i % 4 != 0, is_delta(sent));
+    }
+
+    // On request
+    sdk_mdtp_delta_request_keyframe(module);
+    TEST_ASSERT_FALSE(is_delta(*sdk_mdtp_delta_emit(module)));
+    TEST_ASSERT_TRUE(is_delta(*sdk_mdtp_delta_emit(module)));
+
+    // A delta as large as the frame is not sent
+    ABI_MODULE_MDTP_DATA sent =
+        send(sdk_mdtp_make_root(module, sdk_mdtp_make_value("other", "1", ""), NULL));
+
+    TEST_ASSERT_FALSE(is_delta(sent));
+
+    // After disabling the module sends full frames
+    sdk_mdtp_delta_disable(module);
+    TEST_ASSERT_FALSE(is_delta(*sdk_mdtp_delta_emit(module)));
+}
+
+
+// Templates keep patching the frame stored in the module
+void test_delta_template(void) {
+    MdtpTemplate *mdtp_template = sdk_mdtp_template_compile(
+        sdk_mdtp_make_container("cpu", sdk_mdtp_make_value("usage", "12", "%"), NULL),
+        sdk_mdtp_make_value("uptime", "100", "s"),
+        NULL);
+    MdtpTemplateSlot *usage = sdk_mdtp_template_slot(mdtp_template, "cpu/usage");
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_delta_enable(module, 10));
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_template_emit(mdtp_template, module);
+    const void                 *frame = data->data;
+
+    TEST_ASSERT_FALSE(is_delta(send(data)));
+
+    for (int i = 20; i < 25; ++i) {
+        char value[4];
+
+        snprintf(value, sizeof(value), "%d", i);
+        sdk_mdtp_template_set(usage, value);
+        data = sdk_mdtp_template_emit(mdtp_template, module);
+
+        TEST_ASSERT_EQUAL_PTR(frame, data->data);
+        TEST_ASSERT_TRUE(is_delta(send(data)));
+    }
+
+    sdk_mdtp_delta_disable(module);
+    sdk_mdtp_template_destroy(mdtp_template);
+}
+
+
+void test_delta_apply_malformed(void) {
+    const ABI_MODULE_MDTP_DATA *data =
+        sdk_mdtp_make_root(module, sdk_mdtp_make_value("uptime", "1", "s"), NULL);
+    size_t                      size;
+
+    // Delta without base
+    uint8_t empty[] = {MDTP_VERSION | MDTP_FLAG_DELTA, 0, 0, 0, 0};
+
+    TEST_ASSERT_NULL(sdk_mdtp_delta_apply(NULL, 0, empty, sizeof(empty), &size));
+
+    // Keeps and removes more nodes than the base has
+    uint8_t keep[] = {MDTP_VERSION | MDTP_FLAG_DELTA, 0, 0, 0, 5, MDTP_DELTA_KEEP, 0, 0, 0, 2};
+    uint8_t remove[] = {MDTP_VERSION | MDTP_FLAG_DELTA, 0, 0, 0, 5, MDTP_DELTA_REMOVE, 0, 0, 0, 2};
+
+    TEST_ASSERT_NULL(sdk_mdtp_delta_apply(data->data, data->size, keep, sizeof(keep), &size));
+    TEST_ASSERT_NULL(sdk_mdtp_delta_apply(data->data, data->size, remove, sizeof(remove), &size));
+
+    // Merges a value
+    uint8_t merge[] = {MDTP_VERSION | MDTP_FLAG_DELTA, 0, 0, 0, 5, MDTP_DELTA_MERGE, 0, 0, 0, 0};
+
+    TEST_ASSERT_NULL(sdk_mdtp_delta_apply(data->data, data->size, merge, sizeof(merge), &size));
+
+    // Unknown operation and wrong payload size
+    uint8_t unknown[] = {MDTP_VERSION | MDTP_FLAG_DELTA, 0, 0, 0, 1, 0x42};
+    uint8_t truncated[] = {MDTP_VERSION | MDTP_FLAG_DELTA, 0, 0, 0, 5, MDTP_DELTA_KEEP, 0, 0};
+
+    TEST_ASSERT_NULL(sdk_mdtp_delta_apply(data->data, data->size, unknown, sizeof(unknown), &size));
+    TEST_ASSERT_NULL(
+        sdk_mdtp_delta_apply(data->data, data->size, truncated, sizeof(truncated), &size));
+
+    // Malformed keyframe
+    TEST_ASSERT_NULL(sdk_mdtp_delta_apply(NULL, 0, data->data, data->size - 1, &size));
+}
+
+
+int main(void) {
+    fixture_create(ABI_CAPABILITY_DELTA_FRAMES, 0);
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_delta_capability);
+    RUN_TEST(test_delta_changes);
+    RUN_TEST(test_delta_keyframes);
+    RUN_TEST(test_delta_template);
+    RUN_TEST(test_delta_apply_malformed);
+
+    free(server_frame);
+    fixture_destroy();
+
+    return UNITY_END();
+}
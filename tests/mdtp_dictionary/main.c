@@ -0,0 +1,287 @@
+#include <modules/sdk.h>
+#include <modules/internals/memutils.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "../mdtp_fixture.h"
+
+static MdtpDictionaryDecoder *decoder;
+
+
+static const ABI_MODULE_MDTP_DATA *make_frame(int interfaces, int counter) {
+    void *nodes[16];
+    char  value[16];
+
+    for (int i = 0; i < interfaces; ++i) {
+        char name[16];
+
+        snprintf(name, sizeof(name), "eth%d", i);
+        snprintf(value, sizeof(value), "%d", counter + i);
+        nodes[i] = sdk_mdtp_make_container(name,
+                                           sdk_mdtp_make_value("rx_bytes", value, "bytes"),
+                                           sdk_mdtp_make_value("tx_bytes", value, "bytes"),
+                                           sdk_mdtp_make_value("usage", "1", "%"),
+                                           NULL);
+    }
+
+    return sdk_mdtp_make_root_v(module, nodes, (size_t)interfaces);
+}
+
+
+// Send the stored frame and check that the server decodes it into `expected`. Returns the sent
+// frame.
+static ABI_MODULE_MDTP_DATA send(const ABI_MODULE_MDTP_DATA *stored) {
+    uint8_t expected[2048];
+    size_t  expected_size = stored->size;
+
+    TEST_ASSERT_LESS_OR_EQUAL(sizeof(expected), expected_size);
+    memcpy(expected, stored->data, expected_size);
+
+    ABI_MODULE_MDTP_DATA sent = *sdk_mdtp_dictionary_emit(module);
+    size_t               size;
+    void *decoded = sdk_mdtp_dictionary_decode(decoder, sent.data, sent.size, &size);
+
+    TEST_ASSERT_NOT_NULL(decoded);
+    TEST_ASSERT_EQUAL(expected_size, size);
+    TEST_ASSERT_EQUAL_MEMORY(expected, decoded, size);
+
+    free(decoded);
+
+    return sent;
+}
+
+
+static int has_dictionary(ABI_MODULE_MDTP_DATA frame) {
+    return has_flag(&frame, MDTP_FLAG_DICTIONARY);
+}
+
+
+void test_dictionary_varint(void) {
+    uint8_t  memory[10];
+    uint64_t value;
+
+    TEST_ASSERT_EQUAL(2, write_varint(memory, 0, 300));
+    TEST_ASSERT_EQUAL_UINT8(0xAC, memory[0]);
+    TEST_ASSERT_EQUAL_UINT8(0x02, memory[1]);
+    TEST_ASSERT_EQUAL(2, read_varint(memory, 0, 2, &value));
+    TEST_ASSERT_EQUAL_UINT64(300, value);
+    TEST_ASSERT_EQUAL(0, read_varint(memory, 0, 1, &value)); // Truncated
+
+    TEST_ASSERT_EQUAL(10, write_varint(memory, 0, UINT64_MAX));
+    TEST_ASSERT_EQUAL(10, varint_size(UINT64_MAX));
+    TEST_ASSERT_EQUAL(10, read_varint(memory, 0, 10, &value));
+    TEST_ASSERT_EQUAL_UINT64(UINT64_MAX, value);
+
+    memory[9] = 0x02; // 65th bit
+    TEST_ASSERT_EQUAL(0, read_varint(memory, 0, 10, &value));
+}
+
+
+void test_dictionary_frames(void) {
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_dictionary_enable(module));
+
+    // The first frame defines the strings, the next ones refer to them
+    const ABI_MODULE_MDTP_DATA *stored = make_frame(8, 0);
+    uint32_t                    plain_size = stored->size;
+    ABI_MODULE_MDTP_DATA        first = send(stored);
+
+    TEST_ASSERT_TRUE(has_dictionary(first));
+    TEST_ASSERT_TRUE(first.size < plain_size);
+
+    stored = make_frame(8, 1000);
+    plain_size = stored->size;
+
+    ABI_MODULE_MDTP_DATA next = send(stored);
+
+    TEST_ASSERT_TRUE(next.size < first.size);
+    TEST_ASSERT_TRUE(next.size * 2 < plain_size);
+
+    // New strings are defined next to known ones
+    send(make_frame(10, 2000));
+
+    // Without a new frame the same frame is sent again, and decoding it again is harmless
+    const ABI_MODULE_MDTP_DATA *again = sdk_mdtp_dictionary_emit(module);
+    uint8_t                     copy[2048];
+    size_t                      size;
+
+    TEST_ASSERT_EQUAL_PTR(sdk_imodule_get_mdtp_data(module), again);
+    memcpy(copy, again->data, again->size);
+
+    void *first_decoded = sdk_mdtp_dictionary_decode(decoder, copy, again->size, &size);
+    void *second_decoded = sdk_mdtp_dictionary_decode(decoder, copy, again->size, &size);
+
+    TEST_ASSERT_NOT_NULL(first_decoded);
+    TEST_ASSERT_NOT_NULL(second_decoded);
+    TEST_ASSERT_EQUAL_MEMORY(first_decoded, second_decoded, size);
+    free(first_decoded);
+    free(second_decoded);
+
+    send(make_frame(3, 3000));
+
+    sdk_mdtp_dictionary_disable(module);
+}
+
+
+void test_dictionary_reset(void) {
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_dictionary_enable(module));
+
+    send(make_frame(4, 0));
+
+    // The server lost the dictionary: it can not decode frames until the module resets
+    sdk_mdtp_dictionary_decoder_destroy(decoder);
+    decoder = sdk_mdtp_dictionary_decoder_create();
+
+    make_frame(4, 1);
+
+    const ABI_MODULE_MDTP_DATA *sent = sdk_mdtp_dictionary_emit(module);
+    size_t                      size;
+
+    TEST_ASSERT_NULL(sdk_mdtp_dictionary_decode(decoder, sent->data, sent->size, &size));
+
+    sdk_mdtp_dictionary_reset(module);
+    send(make_frame(4, 2));
+    send(make_frame(4, 3));
+
+    sdk_mdtp_dictionary_disable(module);
+}
+
+
+void test_dictionary_long_strings(void) {
+    char long_name[300];
+
+    memset(long_name, 'a', sizeof(long_name) - 1);
+    long_name[sizeof(long_name) - 1] = '\0';
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_dictionary_enable(module));
+
+    for (int i = 0; i < 3; ++i) {
+        send(sdk_mdtp_make_root(module,
+                                sdk_mdtp_make_value(long_name, "1", ""),
+                                sdk_mdtp_make_container_v("empty", NULL, 0),
+                                NULL));
+    }
+
+    sdk_mdtp_dictionary_disable(module);
+}
+
+
+// More strings than a dictionary holds
+void test_dictionary_full(void) {
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_dictionary_enable(module));
+
+    for (int frame = 0; frame < 3; ++frame) {
+        void *nodes[1000];
+        char  name[16];
+        char  units[16];
+
+        for (int i = 0; i < 1000; ++i) {
+            snprintf(name, sizeof(name), "n%d", frame * 1000 + i);
+            snprintf(units, sizeof(units), "u%d", frame * 1000 + i);
+            nodes[i] = sdk_mdtp_make_value(name, "1", units);
+        }
+
+        const ABI_MODULE_MDTP_DATA *stored = sdk_mdtp_make_root_v(module, nodes, 1000);
+        uint8_t                    *expected = malloc(stored->size);
+        size_t                      expected_size = stored->size;
+        size_t                      size;
+
+        memcpy(expected, stored->data, expected_size);
+
+        const ABI_MODULE_MDTP_DATA *sent = sdk_mdtp_dictionary_emit(module);
+        void *decoded = sdk_mdtp_dictionary_decode(decoder, sent->data, sent->size, &size);
+
+        TEST_ASSERT_NOT_NULL(decoded);
+        TEST_ASSERT_EQUAL(expected_size, size);
+        TEST_ASSERT_EQUAL_MEMORY(expected, decoded, size);
+
+        free(decoded);
+        free(expected);
+    }
+
+    sdk_mdtp_dictionary_disable(module);
+}
+
+
+// Delta frames are sent as they are, keyframes are encoded
+void test_dictionary_delta(void) {
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_delta_enable(module, 100));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_dictionary_enable(module));
+
+    make_frame(4, 0);
+    sdk_mdtp_delta_emit(module);
+    TEST_ASSERT_TRUE(has_dictionary(*sdk_mdtp_dictionary_emit(module)));
+
+    make_frame(4, 1);
+    sdk_mdtp_delta_emit(module);
+
+    ABI_MODULE_MDTP_DATA sent = *sdk_mdtp_dictionary_emit(module);
+
+    TEST_ASSERT_FALSE(has_dictionary(sent));
+    TEST_ASSERT_TRUE((((const uint8_t *)sent.data)[0] & MDTP_FLAG_DELTA) != 0);
+
+    sdk_mdtp_dictionary_disable(module);
+    sdk_mdtp_delta_disable(module);
+}
+
+
+void test_dictionary_malformed(void) {
+    size_t size;
+
+    // Reference to an unknown entry
+    uint8_t unknown[] = {MDTP_VERSION | MDTP_FLAG_DICTIONARY, 0, 0, 0, 6, 0, 1, 7, 0, 0, 0};
+    // Known entries the decoder does not have
+    uint8_t known[] = {MDTP_VERSION | MDTP_FLAG_DICTIONARY, 0, 0, 0, 1, 5};
+    // Truncated string
+    uint8_t truncated[] = {MDTP_VERSION | MDTP_FLAG_DICTIONARY, 0, 0, 0, 4, 0, 1, 0x0C, 'a'};
+    // Wrong payload size
+    uint8_t wrong_size[] = {MDTP_VERSION | MDTP_FLAG_DICTIONARY, 0, 0, 0, 9, 0};
+
+    TEST_ASSERT_NULL(sdk_mdtp_dictionary_decode(decoder, unknown, sizeof(unknown), &size));
+    TEST_ASSERT_NULL(sdk_mdtp_dictionary_decode(decoder, known, sizeof(known), &size));
+    TEST_ASSERT_NULL(sdk_mdtp_dictionary_decode(decoder, truncated, sizeof(truncated), &size));
+    TEST_ASSERT_NULL(sdk_mdtp_dictionary_decode(decoder, wrong_size, sizeof(wrong_size), &size));
+    TEST_ASSERT_NULL(sdk_mdtp_dictionary_decode(decoder, NULL, 0, &size));
+
+    // An empty container named by a new entry
+    uint8_t empty[] = {MDTP_VERSION | MDTP_FLAG_DICTIONARY, 0, 0, 0, 8, 0, 0, 4, 'a', 0, 0, 0, 0};
+    void   *decoded = sdk_mdtp_dictionary_decode(decoder, empty, sizeof(empty), &size);
+
+    TEST_ASSERT_NOT_NULL(decoded);
+    TEST_ASSERT_EQUAL(5 + 1 + 4 + 1 + 4, size);
+    free(decoded);
+}
+
+
+void test_dictionary_capability(void) {
+    IModule *old = old_module();
+
+    TEST_ASSERT_EQUAL(SDK_OTHER_ERROR, sdk_mdtp_dictionary_enable(old));
+    check_passthrough(old, sdk_mdtp_dictionary_emit, MDTP_FLAG_DICTIONARY);
+
+    sdk_imodule_destroy(old);
+}
+
+
+int main(void) {
+    fixture_create(ABI_CAPABILITY_DICTIONARY | ABI_CAPABILITY_DELTA_FRAMES,
+                   ABI_CAPABILITY_DELTA_FRAMES);
+    decoder = sdk_mdtp_dictionary_decoder_create();
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_dictionary_varint);
+    RUN_TEST(test_dictionary_capability);
+    RUN_TEST(test_dictionary_frames);
+    RUN_TEST(test_dictionary_reset);
+    RUN_TEST(test_dictionary_long_strings);
+    RUN_TEST(test_dictionary_full);
+    RUN_TEST(test_dictionary_delta);
+    RUN_TEST(test_dictionary_malformed);
+
+    sdk_mdtp_dictionary_decoder_destroy(decoder);
+    fixture_destroy();
+
+    return UNITY_END();
+}
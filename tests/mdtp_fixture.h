@@ -0,0 +1,121 @@
+// Fixture shared by the MDTP tests: the Unity hooks, the `module_init` stub, a module on a server
+// with the capabilities under test, modules on an older server and a process table frame factory.
+// Included once, by the `main.c` of a test.
+
+#pragma once
+
+#include <modules/sdk.h>
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+#define MAX_FRAME 65536
+
+void tearDown(void) {}
+
+void setUp(void) {}
+
+
+// Stub
+ABI_MODULE_FUNCTIONS module_init(ABI_SERVER_CORE_FUNCTIONS server_functions,
+                                 const char               *json_configuration) {
+    return (ABI_MODULE_FUNCTIONS){0};
+}
+
+
+static uint32_t     server_capabilities;     // Capabilities of the server of `module`
+static uint32_t     old_server_capabilities; // Capabilities of the servers of `old_module`
+static int          old_server_calls;        // Times the old servers were asked for them
+static IModule     *module;
+static MdtpBuilder *builder;
+static uint8_t      expected[MAX_FRAME]; // Last frame made by `make_process_frame`
+static size_t       expected_size;
+
+
+static uint32_t get_abi_version(const ABI_MODULE_CONTEXT *context) {
+    return 2 | server_capabilities;
+}
+
+
+static uint32_t get_old_abi_version(const ABI_MODULE_CONTEXT *context) {
+    ++old_server_calls;
+    return 2 | old_server_capabilities;
+}
+
+
+// Create `module` and `builder`
+static inline void fixture_create(uint32_t capabilities, uint32_t old_capabilities) {
+    ABI_SERVER_CORE_FUNCTIONS server = {.abi_get_abi_version = get_abi_version};
+
+    server_capabilities = capabilities;
+    old_server_capabilities = old_capabilities;
+    module = sdk_imodule_create("test", "test", server, 0, 1);
+    builder = sdk_mdtp_builder_create();
+}
+
+
+static inline void fixture_destroy(void) {
+    sdk_mdtp_builder_destroy(builder);
+    sdk_imodule_destroy(module);
+}
+
+
+// Module on a server with `old_capabilities` only
+static inline IModule *old_module(void) {
+    ABI_SERVER_CORE_FUNCTIONS server = {.abi_get_abi_version = get_old_abi_version};
+
+    return sdk_imodule_create("old", "old", server, 0, 1);
+}
+
+
+static inline int has_flag(const ABI_MODULE_MDTP_DATA *frame, uint8_t flag) {
+    return (((const uint8_t *)frame->data)[0] & flag) != 0;
+}
+
+
+// Check that `emit` of a stage the server of `old` lacks sends the stored frame as it is
+static inline void check_passthrough(IModule *old,
+                                     const ABI_MODULE_MDTP_DATA *(*emit)(IModule *),
+                                     uint8_t flag) {
+    const ABI_MODULE_MDTP_DATA *data =
+        sdk_mdtp_make_root(old, sdk_mdtp_make_value("uptime", "1", "s"), NULL);
+
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL_PTR(data, emit(old));
+    TEST_ASSERT_FALSE(has_flag(data, flag));
+}
+
+
+// Write a process table of `processes` rows into `to`
+static inline void write_processes(MdtpBuilder *to, int processes, uint64_t counter) {
+    char name[16];
+
+    sdk_mdtp_builder_begin_container(to, "processes");
+
+    for (int i = 0; i < processes; ++i) {
+        snprintf(name, sizeof(name), "%d", 1000 + i);
+        sdk_mdtp_builder_begin_container(to, name);
+        sdk_mdtp_builder_add_value(to, "command", "/usr/bin/worker", "");
+        sdk_mdtp_builder_add_value_u64(to, "rss", counter + (uint64_t)i * 4096, "bytes");
+        sdk_mdtp_builder_add_value_u64(to, "threads", 4, "");
+        sdk_mdtp_builder_add_value_f64(to, "cpu", 0.25, 2, "%");
+        sdk_mdtp_builder_end_container(to);
+    }
+
+    sdk_mdtp_builder_end_container(to);
+}
+
+
+// Store a process table of `processes` rows and remember it as the expected frame
+static inline const ABI_MODULE_MDTP_DATA *make_process_frame(int processes, uint64_t counter) {
+    write_processes(builder, processes, counter);
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_builder_finish(builder, module);
+
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_LESS_OR_EQUAL(MAX_FRAME, data->size);
+    memcpy(expected, data->data, data->size);
+    expected_size = data->size;
+
+    return data;
+}
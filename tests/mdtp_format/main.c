@@ -0,0 +1,374 @@
+#include <inttypes.h>
+#include <locale.h>
+#include <math.h>
+#include <modules/internals/memutils.h>
+#include <modules/sdk.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+void tearDown(void) {}
+
+void setUp(void) {}
+
+
+// Stub
+ABI_MODULE_FUNCTIONS module_init(ABI_SERVER_CORE_FUNCTIONS server_functions,
+                                 const char               *json_configuration) {
+    return (ABI_MODULE_FUNCTIONS){0};
+}
+
+
+static uint64_t random_state = 0x9E3779B97F4A7C15ull;
+
+// Deterministic xorshift, so failures are reproducible
+static uint64_t next_random(void) {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return random_state;
+}
+
+
+static void assert_u64(uint64_t value) {
+    char expected[32];
+    char actual[MDTP_U64_MAX_LENGTH + 1];
+
+    snprintf(expected, sizeof(expected), "%" PRIu64, value);
+    size_t length = sdk_mdtp_format_u64(actual, value);
+    actual[length] = '\0';
+
+    TEST_ASSERT_EQUAL_STRING(expected, actual);
+    TEST_ASSERT_EQUAL(length, sdk_mdtp_format_u64_length(value));
+}
+
+
+static void assert_i64(int64_t value) {
+    char expected[32];
+    char actual[MDTP_I64_MAX_LENGTH + 1];
+
+    snprintf(expected, sizeof(expected), "%" PRId64, value);
+    size_t length = sdk_mdtp_format_i64(actual, value);
+    actual[length] = '\0';
+
+    TEST_ASSERT_EQUAL_STRING(expected, actual);
+}
+
+
+static void assert_f64_fixed(double value, int precision) {
+    char expected[MDTP_F64_MAX_LENGTH + 1];
+    char actual[MDTP_F64_MAX_LENGTH + 1];
+
+    snprintf(expected, sizeof(expected), "%.*f", precision, value);
+    size_t length = sdk_mdtp_format_f64(actual, value, precision);
+    actual[length] = '\0';
+
+    TEST_ASSERT_EQUAL_STRING(expected, actual);
+}
+
+
+static void assert_f64_shortest(double value, const char *expected) {
+    char   actual[MDTP_F64_MAX_LENGTH + 1];
+    size_t length = sdk_mdtp_format_f64(actual, value, MDTP_F64_SHORTEST);
+    actual[length] = '\0';
+
+    TEST_ASSERT_EQUAL_STRING(expected, actual);
+}
+
+
+void test_format_u64(void) {
+    uint64_t power = 1;
+
+    assert_u64(0);
+    assert_u64(UINT64_MAX);
+
+    // Every digit count and its boundaries
+    for (int i = 0; i < 20; ++i) {
+        assert_u64(power);
+        assert_u64(power - 1);
+        assert_u64(power + 1);
+        power *= 10;
+    }
+
+    for (int i = 0; i < 100000; ++i) {
+        uint64_t value = next_random();
+        assert_u64(value >> (value % 64));
+    }
+}
+
+
+void test_format_i64(void) {
+    assert_i64(0);
+    assert_i64(-1);
+    assert_i64(INT64_MAX);
+    assert_i64(INT64_MIN);
+
+    for (int i = 0; i < 100000; ++i) {
+        uint64_t value = next_random();
+        assert_i64((int64_t)(value >> (value % 64)) * ((value & 1) ? -1 : 1));
+    }
+}
+
+
+void test_format_f64_fixed(void) {
+    // Ties are rounded the same way as printf does
+    assert_f64_fixed(0.125, 2);
+    assert_f64_fixed(0.375, 2);
+    assert_f64_fixed(2.5, 0);
+    assert_f64_fixed(3.5, 0);
+    assert_f64_fixed(1.005, 2);
+
+    // Signs, zeros and special values
+    assert_f64_fixed(0.0, 3);
+    assert_f64_fixed(-0.0, 3);
+    assert_f64_fixed(-0.0001, 2);
+    assert_f64_fixed(NAN, 2);
+    assert_f64_fixed(INFINITY, 2);
+    assert_f64_fixed(-INFINITY, 2);
+
+    // Extremes go through the printf fallback
+    assert_f64_fixed(1.7976931348623157e308, 17);
+    assert_f64_fixed(-1.7976931348623157e308, 0);
+    assert_f64_fixed(4.9406564584124654e-324, 17);
+    assert_f64_fixed(9007199254740993.0, 0);
+
+    for (int i = 0; i < 100000; ++i) {
+        uint64_t bits = next_random();
+        int      precision = (int)(bits % (MDTP_F64_MAX_PRECISION + 1));
+        double   value = (double)(int64_t)(bits >> 11) / (double)(1ull << (bits % 60));
+
+        assert_f64_fixed(value, precision);
+    }
+}
+
+
+void test_format_f64_precision_is_clamped(void) {
+    char   expected[MDTP_F64_MAX_LENGTH + 1];
+    char   actual[MDTP_F64_MAX_LENGTH + 1];
+    size_t length = sdk_mdtp_format_f64(actual, 0.1, 40);
+    actual[length] = '\0';
+
+    snprintf(expected, sizeof(expected), "%.*f", MDTP_F64_MAX_PRECISION, 0.1);
+
+    TEST_ASSERT_EQUAL_STRING(expected, actual);
+}
+
+
+// Decimal points of other locales, including multibyte ones, are written as '.'
+void test_format_f64_locale(void) {
+    static const char *const locales[] = {"ps_AF.UTF-8", "fr_FR.UTF-8", "de_DE.UTF-8"};
+    char                     actual[MDTP_F64_MAX_LENGTH + 1];
+
+    for (size_t i = 0; i < sizeof(locales) / sizeof(locales[0]); ++i) {
+        if (setlocale(LC_NUMERIC, locales[i]) == NULL) {
+            continue;
+        }
+
+        // Ties and huge values go through printf
+        size_t length = sdk_mdtp_format_f64(actual, 0.125, 2);
+        TEST_ASSERT_EQUAL_STRING_LEN("0.12", actual, 4);
+        TEST_ASSERT_EQUAL(4, length);
+
+        length = sdk_mdtp_format_f64(actual, -2.5, 0);
+        TEST_ASSERT_EQUAL_STRING_LEN("-2", actual, 2);
+        TEST_ASSERT_EQUAL(2, length);
+
+        length = sdk_mdtp_format_f64(actual, 1e300, 3);
+        TEST_ASSERT_EQUAL(305, length);
+        TEST_ASSERT_EQUAL_STRING_LEN(".000", actual + 301, 4);
+    }
+
+    // Without such a locale installed there is nothing to check
+    setlocale(LC_NUMERIC, "C");
+}
+
+
+void test_format_f64_shortest(void) {
+    assert_f64_shortest(0.0, "0");
+    assert_f64_shortest(-0.0, "-0");
+    assert_f64_shortest(0.1, "0.1");
+    assert_f64_shortest(-2.5, "-2.5");
+    assert_f64_shortest(100.0, "100");
+    assert_f64_shortest(0.3, "0.3");
+    assert_f64_shortest(0.1 + 0.2, "0.30000000000000004");
+    assert_f64_shortest(1e-5, "0.00001");
+    assert_f64_shortest(1e-6, "1e-06");
+    assert_f64_shortest(1e16, "10000000000000000");
+    assert_f64_shortest(1.5e17, "1.5e+17");
+    assert_f64_shortest(1.7976931348623157e308, "1.7976931348623157e+308");
+    assert_f64_shortest(4.9406564584124654e-324, "5e-324");
+    assert_f64_shortest(NAN, "nan");
+    assert_f64_shortest(INFINITY, "inf");
+    assert_f64_shortest(-INFINITY, "-inf");
+}
+
+
+// Significant digits of a decimal text without sign, leading and trailing zeros
+static void significant_digits(const char *text, char *digits) {
+    size_t count = 0;
+
+    for (; *text != '\0' && *text != 'e'; ++text) {
+        if (*text >= '0' && *text <= '9' && (count > 0 || *text != '0')) {
+            digits[count++] = *text;
+        }
+    }
+
+    while (count > 0 && digits[count - 1] == '0') {
+        --count;
+    }
+
+    digits[count] = '\0';
+}
+
+
+// Reference: the shortest correctly rounded "%.*e" output that reads back as `value`
+static void shortest_reference(double value, char *digits) {
+    char text[64];
+
+    for (int precision = 0; precision < 17; ++precision) {
+        snprintf(text, sizeof(text), "%.*e", precision, value);
+
+        if (strtod(text, NULL) == value) {
+            break;
+        }
+    }
+
+    significant_digits(text, digits);
+}
+
+
+static void assert_f64_shortest_matches_reference(double value) {
+    char buffer[MDTP_F64_MAX_LENGTH + 1];
+    char expected[32];
+    char actual[32];
+
+    size_t length = sdk_mdtp_format_f64(buffer, value, MDTP_F64_SHORTEST);
+    buffer[length] = '\0';
+
+    TEST_ASSERT_TRUE(strtod(buffer, NULL) == value);
+
+    shortest_reference(value, expected);
+    significant_digits(buffer, actual);
+
+    // At powers of 2 the rounding interval is asymmetric and can contain a number shorter than
+    // any correctly rounded one. Otherwise both must be the same digits.
+    if (strlen(actual) >= strlen(expected)) {
+        TEST_ASSERT_EQUAL_STRING(expected, actual);
+    }
+}
+
+
+void test_format_f64_shortest_round_trip(void) {
+    // Powers of 2 have an asymmetric rounding interval
+    for (int exponent = -1074; exponent <= 1023; ++exponent) {
+        assert_f64_shortest_matches_reference(ldexp(1.0, exponent));
+    }
+
+    // Integers and short decimals
+    for (int i = 1; i < 10000; ++i) {
+        assert_f64_shortest_matches_reference((double)i);
+        assert_f64_shortest_matches_reference((double)i / 1000);
+    }
+
+    // Random bit patterns cover all exponents including subnormals
+    for (int i = 0; i < 100000; ++i) {
+        uint64_t bits = next_random();
+        double   value;
+
+        memcpy(&value, &bits, sizeof(value));
+
+        if (isnan(value) || isinf(value) || value == 0) {
+            continue;
+        }
+
+        assert_f64_shortest_matches_reference(value);
+    }
+}
+
+
+// Typed nodes must be byte-identical to nodes made from formatted strings
+void test_make_typed_values(void) {
+    void *u64 = sdk_mdtp_make_value_u64("bytes", 18446744073709551615ull, "B");
+    void *i64 = sdk_mdtp_make_value_i64("delta", -42, "B");
+    void *f64 = sdk_mdtp_make_value_f64("load", 0.125, 2, "");
+    void *shortest = sdk_mdtp_make_value_f64("ratio", 0.1, MDTP_F64_SHORTEST, "");
+
+    void *u64_reference = sdk_mdtp_make_value("bytes", "18446744073709551615", "B");
+    void *i64_reference = sdk_mdtp_make_value("delta", "-42", "B");
+    void *f64_reference = sdk_mdtp_make_value("load", "0.12", "");
+    void *shortest_reference = sdk_mdtp_make_value("ratio", "0.1", "");
+
+    TEST_ASSERT_EQUAL_MEMORY(u64_reference, u64, 1 + 4 + 5 + 4 + 1 + 4 + 20);
+    TEST_ASSERT_EQUAL_MEMORY(i64_reference, i64, 1 + 4 + 5 + 4 + 1 + 4 + 3);
+    TEST_ASSERT_EQUAL_MEMORY(f64_reference, f64, 1 + 4 + 4 + 4 + 0 + 4 + 4);
+    TEST_ASSERT_EQUAL_MEMORY(shortest_reference, shortest, 1 + 4 + 5 + 4 + 0 + 4 + 3);
+
+    TEST_ASSERT_NULL(sdk_mdtp_make_value_u64(NULL, 1, "B"));
+    TEST_ASSERT_NULL(sdk_mdtp_make_value_i64("delta", 1, NULL));
+    TEST_ASSERT_NULL(sdk_mdtp_make_value_f64(NULL, 1.0, 2, ""));
+
+    sdk_mdtp_free_value(u64);
+    sdk_mdtp_free_value(i64);
+    sdk_mdtp_free_value(f64);
+    sdk_mdtp_free_value(shortest);
+    sdk_mdtp_free_value(u64_reference);
+    sdk_mdtp_free_value(i64_reference);
+    sdk_mdtp_free_value(f64_reference);
+    sdk_mdtp_free_value(shortest_reference);
+}
+
+
+void test_builder_typed_values(void) {
+    IModule     *module = sdk_imodule_create("test", "test", (ABI_SERVER_CORE_FUNCTIONS){0}, 0, 0);
+    IModule     *reference_module =
+        sdk_imodule_create("reference", "reference", (ABI_SERVER_CORE_FUNCTIONS){0}, 0, 0);
+    MdtpBuilder *builder = sdk_mdtp_builder_create();
+
+    const ABI_MODULE_MDTP_DATA *reference =
+        sdk_mdtp_make_root(reference_module,
+                           sdk_mdtp_make_container("disk",
+                                                   sdk_mdtp_make_value("free", "1048576", "B"),
+                                                   sdk_mdtp_make_value("delta", "-4096", "B"),
+                                                   sdk_mdtp_make_value("usage", "37.50", "%"),
+                                                   NULL),
+                           NULL);
+
+    sdk_mdtp_builder_begin_container(builder, "disk");
+    sdk_mdtp_builder_add_value_u64(builder, "free", 1048576, "B");
+    sdk_mdtp_builder_add_value_i64(builder, "delta", -4096, "B");
+    sdk_mdtp_builder_add_value_f64(builder, "usage", 37.5, 2, "%");
+    sdk_mdtp_builder_end_container(builder);
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_builder_finish(builder, module);
+
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL(reference->size, data->size);
+    TEST_ASSERT_EQUAL_MEMORY(reference->data, data->data, data->size);
+
+    // Invalid arguments are sticky like for other builder calls
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_builder_add_value_u64(builder, NULL, 1, ""));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_builder_add_value_i64(builder, "a", 1, ""));
+    TEST_ASSERT_NULL(sdk_mdtp_builder_finish(builder, module));
+
+    sdk_mdtp_builder_destroy(builder);
+    sdk_imodule_destroy(reference_module);
+    sdk_imodule_destroy(module);
+}
+
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_format_u64);
+    RUN_TEST(test_format_i64);
+    RUN_TEST(test_format_f64_fixed);
+    RUN_TEST(test_format_f64_precision_is_clamped);
+    RUN_TEST(test_format_f64_locale);
+    RUN_TEST(test_format_f64_shortest);
+    RUN_TEST(test_format_f64_shortest_round_trip);
+    RUN_TEST(test_make_typed_values);
+    RUN_TEST(test_builder_typed_values);
+
+    return UNITY_END();
+}
@@ -0,0 +1,325 @@
+#include <modules/sdk.h>
+#include <modules/internals/memutils.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "../mdtp_fixture.h"
+
+
+static const double bounds[] = {0.005, 0.01, 0.05, 0.1, 0.5, 1};
+
+
+// Record the observations every check expects: 2 in every bucket but the fourth, sum 10.543
+static void observe(MdtpHistogram *histogram) {
+    static const double values[] = {0.001, 0.005, 0.007, 0.01, 0.02, 0.05, 0.3, 0.4, 0.75, 1, 3, 5};
+
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+        sdk_mdtp_histogram_observe(histogram, values[i]);
+    }
+}
+
+
+// Check the histogram node of a frame made from `observe`
+static void check_frame(const void *frame, size_t size) {
+    static const uint64_t expected[] = {2, 2, 2, 0, 2, 2, 2};
+
+    MdtpReader reader;
+    size_t     length;
+    double     read_bounds[7];
+    uint64_t   counts[7];
+    double     sum;
+    uint64_t   count;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_validate(frame, size));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_init(&reader, frame, size));
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&reader));
+
+    TEST_ASSERT_EQUAL(MDTP_NODE_HISTOGRAM, sdk_mdtp_reader_type(&reader));
+    TEST_ASSERT_EQUAL_STRING_LEN("latency", sdk_mdtp_reader_name(&reader, &length), 7);
+    TEST_ASSERT_EQUAL_STRING_LEN("s", sdk_mdtp_reader_units(&reader, &length), 1);
+    TEST_ASSERT_EQUAL(7, sdk_mdtp_reader_histogram_buckets(&reader));
+    TEST_ASSERT_EQUAL(SDK_OK,
+                      sdk_mdtp_reader_histogram(&reader, read_bounds, counts, &sum, &count));
+    TEST_ASSERT_EQUAL_MEMORY(bounds, read_bounds, sizeof(bounds));
+    TEST_ASSERT_TRUE(isinf(read_bounds[6]));
+    TEST_ASSERT_EQUAL_MEMORY(expected, counts, sizeof(expected));
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 10.543, sum);
+    TEST_ASSERT_EQUAL(12, count);
+    TEST_ASSERT_EQUAL(0, sdk_mdtp_reader_array_length(&reader));
+
+    TEST_ASSERT_FALSE(sdk_mdtp_reader_next(&reader));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_status(&reader));
+}
+
+
+void test_histogram_make(void) {
+    MdtpHistogram *histogram = sdk_mdtp_histogram_create(bounds, 6);
+
+    TEST_ASSERT_NOT_NULL(histogram);
+    observe(histogram);
+    sdk_mdtp_histogram_observe(histogram, NAN);
+
+    const ABI_MODULE_MDTP_DATA *data =
+        sdk_mdtp_make_root(module, sdk_mdtp_histogram_make(histogram, "latency", "s"), NULL);
+
+    TEST_ASSERT_NOT_NULL(data);
+    check_frame(data->data, data->size);
+
+    // Same bytes as the builder makes
+    void  *made = malloc(data->size);
+    size_t size = data->size;
+
+    memcpy(made, data->data, size);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_histogram_add(histogram, builder, "latency", "s"));
+    data = sdk_mdtp_builder_finish(builder, module);
+    TEST_ASSERT_EQUAL(size, data->size);
+    TEST_ASSERT_EQUAL_MEMORY(made, data->data, size);
+    free(made);
+
+    sdk_mdtp_histogram_destroy(histogram);
+}
+
+
+void test_histogram_interval(void) {
+    MdtpHistogram *histogram = sdk_mdtp_histogram_create(bounds, 6);
+    uint64_t       counts[7];
+    double         sum;
+
+    sdk_mdtp_histogram_set_cumulative(histogram, 0);
+    observe(histogram);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_histogram_add(histogram, builder, "latency", "s"));
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_builder_finish(builder, module);
+
+    TEST_ASSERT_NOT_NULL(data);
+    check_frame(data->data, data->size);
+
+    // The node took the observations out
+    sdk_mdtp_histogram_snapshot(histogram, counts, &sum);
+    for (size_t i = 0; i < 7; ++i) {
+        TEST_ASSERT_EQUAL(0, counts[i]);
+    }
+    TEST_ASSERT_EQUAL_DOUBLE(0, sum);
+
+    // Nodes that could not be made or written put the observations back
+    observe(histogram);
+    TEST_ASSERT_NULL(sdk_mdtp_histogram_make(histogram, "latency", NULL));
+    TEST_ASSERT_NOT_EQUAL(SDK_OK, sdk_mdtp_histogram_add(histogram, builder, "latency", NULL));
+    sdk_mdtp_builder_reset(builder);
+
+    data = sdk_mdtp_make_root(module, sdk_mdtp_histogram_make(histogram, "latency", "s"), NULL);
+    TEST_ASSERT_NOT_NULL(data);
+    check_frame(data->data, data->size);
+
+    // Cumulative again: the snapshot keeps the counts
+    sdk_mdtp_histogram_set_cumulative(histogram, 1);
+    observe(histogram);
+    sdk_mdtp_histogram_add(histogram, builder, "latency", "s");
+    data = sdk_mdtp_builder_finish(builder, module);
+    check_frame(data->data, data->size);
+    sdk_mdtp_histogram_snapshot(histogram, counts, &sum);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 10.543, sum);
+
+    sdk_mdtp_histogram_destroy(histogram);
+}
+
+
+void test_histogram_v2(void) {
+    MdtpHistogram *histogram = sdk_mdtp_histogram_create(bounds, 6);
+
+    observe(histogram);
+    sdk_mdtp_histogram_add(histogram, builder, "latency", "s");
+
+    size_t v1 = sdk_mdtp_builder_finish(builder, module)->size;
+
+    sdk_mdtp_builder_set_version(builder, MDTP_VERSION_2);
+    sdk_mdtp_histogram_add(histogram, builder, "latency", "s");
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_builder_finish(builder, module);
+
+    TEST_ASSERT_NOT_NULL(data);
+    check_frame(data->data, data->size);
+
+    // One byte instead of eight for every count
+    TEST_ASSERT_LESS_OR_EQUAL(v1 - 7 * 7, data->size);
+
+    sdk_mdtp_builder_set_version(builder, MDTP_VERSION);
+    sdk_mdtp_histogram_destroy(histogram);
+}
+
+
+void test_histogram_presets(void) {
+    size_t         count;
+    MdtpHistogram *linear = sdk_mdtp_histogram_create_linear(10, 5, 4);
+    MdtpHistogram *exponential = sdk_mdtp_histogram_create_exponential(0.001, 2, 24);
+
+    TEST_ASSERT_NOT_NULL(linear);
+    TEST_ASSERT_NOT_NULL(exponential);
+
+    const double *values = sdk_mdtp_histogram_bounds(linear, &count);
+
+    TEST_ASSERT_EQUAL(4, count);
+    TEST_ASSERT_EQUAL_DOUBLE(10, values[0]);
+    TEST_ASSERT_EQUAL_DOUBLE(25, values[3]);
+
+    values = sdk_mdtp_histogram_bounds(exponential, &count);
+    TEST_ASSERT_EQUAL(24, count);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 0.001 * 8388608, values[23]);
+
+    // Bucket bounds are inclusive, the last bucket has no bound
+    uint64_t counts[5];
+
+    sdk_mdtp_histogram_observe(linear, 10);
+    sdk_mdtp_histogram_observe(linear, 10.5);
+    sdk_mdtp_histogram_observe(linear, -100);
+    sdk_mdtp_histogram_observe(linear, 1e300);
+    sdk_mdtp_histogram_observe(linear, INFINITY);
+    TEST_ASSERT_EQUAL(5, sdk_mdtp_histogram_snapshot(linear, counts, NULL));
+    TEST_ASSERT_EQUAL(2, counts[0]);
+    TEST_ASSERT_EQUAL(1, counts[1]);
+    TEST_ASSERT_EQUAL(0, counts[3]);
+    TEST_ASSERT_EQUAL(2, counts[4]);
+
+    sdk_mdtp_histogram_reset(linear);
+
+    double sum;
+
+    TEST_ASSERT_EQUAL(0, sdk_mdtp_histogram_snapshot(linear, counts, &sum));
+    TEST_ASSERT_EQUAL_DOUBLE(0, sum);
+
+    sdk_mdtp_histogram_destroy(linear);
+    sdk_mdtp_histogram_destroy(exponential);
+
+    // Invalid bounds
+    static const double unordered[] = {1, 3, 2};
+
+    TEST_ASSERT_NULL(sdk_mdtp_histogram_create(unordered, 3));
+    TEST_ASSERT_NULL(sdk_mdtp_histogram_create(bounds, 0));
+    TEST_ASSERT_NULL(sdk_mdtp_histogram_create_linear(0, 0, 4));
+    TEST_ASSERT_NULL(sdk_mdtp_histogram_create_exponential(0, 2, 4));
+    TEST_ASSERT_NULL(sdk_mdtp_histogram_create_exponential(1, 1, 4));
+    TEST_ASSERT_NULL(sdk_mdtp_histogram_create_exponential(1, 10, 400));
+    TEST_ASSERT_NULL(sdk_mdtp_histogram_create_linear(0, 1, MDTP_HISTOGRAM_MAX_BOUNDS + 1));
+    sdk_mdtp_histogram_destroy(NULL);
+}
+
+
+void test_histogram_misuse(void) {
+    IModule *old = old_module();
+    static const uint64_t     counts[7] = {0};
+    static const double       unordered[] = {1, 1};
+
+    // Histograms are not sent to a server without them, even if it knows arrays
+    sdk_mdtp_builder_add_histogram(builder, "latency", bounds, 6, counts, 0, "s");
+    TEST_ASSERT_NULL(sdk_mdtp_builder_finish(builder, old));
+    sdk_mdtp_builder_add_array_u64(builder, "empty", NULL, 0, "");
+    TEST_ASSERT_NOT_NULL(sdk_mdtp_builder_finish(builder, old));
+
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT,
+                      sdk_mdtp_builder_add_histogram(builder, "latency", unordered, 2, counts, 0,
+                                                     "s"));
+    sdk_mdtp_builder_reset(builder);
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT,
+                      sdk_mdtp_builder_add_histogram(builder, "latency", bounds, 6, NULL, 0, "s"));
+    sdk_mdtp_builder_reset(builder);
+
+    TEST_ASSERT_NULL(sdk_mdtp_make_histogram("latency", unordered, 2, counts, 0, "s"));
+    TEST_ASSERT_NULL(sdk_mdtp_make_histogram("latency", bounds, 6, counts, 0, NULL));
+
+    // A histogram without bounds has one bucket
+    void *node = sdk_mdtp_make_histogram("all", NULL, 0, counts, 0, "");
+
+    TEST_ASSERT_NOT_NULL(node);
+    sdk_mdtp_free_value(node);
+
+    sdk_imodule_destroy(old);
+}
+
+
+void test_histogram_malformed(void) {
+    static const uint64_t counts[3] = {1, 2, 3};
+    uint8_t               frame[256];
+
+    for (uint8_t version = MDTP_VERSION; version <= MDTP_VERSION_2; ++version) {
+        sdk_mdtp_builder_set_version(builder, version);
+        sdk_mdtp_builder_add_histogram(builder, "h", bounds, 2, counts, 6, "");
+
+        const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_builder_finish(builder, module);
+        size_t                      size = data->size;
+
+        memcpy(frame, data->data, size);
+        TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_validate(frame, size));
+
+        // Any cut of the node is found
+        for (size_t cut = 6; cut < size; ++cut) {
+            write_uint32_be(frame, 1, (uint32_t)(cut - 5));
+            TEST_ASSERT_EQUAL(SDK_ARGUMENT_PROCESSING_ERROR, sdk_mdtp_validate(frame, cut));
+        }
+
+        // Bound count over the limit
+        write_uint32_be(frame, 1, (uint32_t)(size - 5));
+
+        size_t bound_count = version == MDTP_VERSION_2 ? 5 + 1 + 2 + 1 : 5 + 1 + 5 + 4;
+
+        if (version == MDTP_VERSION_2) {
+            frame[bound_count] = 0x80 | (MDTP_HISTOGRAM_MAX_BOUNDS & 0x7F);
+        } else {
+            write_uint32_be(frame, bound_count, MDTP_HISTOGRAM_MAX_BOUNDS + 1);
+        }
+
+        TEST_ASSERT_EQUAL(SDK_ARGUMENT_PROCESSING_ERROR, sdk_mdtp_validate(frame, size));
+    }
+
+    sdk_mdtp_builder_set_version(builder, MDTP_VERSION);
+}
+
+
+void test_histogram_dictionary(void) {
+    MdtpDictionaryDecoder *decoder = sdk_mdtp_dictionary_decoder_create();
+    MdtpHistogram         *histogram = sdk_mdtp_histogram_create(bounds, 6);
+
+    observe(histogram);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_dictionary_enable(module));
+
+    for (int poll = 0; poll < 3; ++poll) {
+        sdk_mdtp_histogram_add(histogram, builder, "latency", "s");
+        sdk_mdtp_builder_finish(builder, module);
+
+        const ABI_MODULE_MDTP_DATA *sent = sdk_mdtp_dictionary_emit(module);
+        size_t                      size;
+
+        TEST_ASSERT_TRUE((((const uint8_t *)sent->data)[0] & MDTP_FLAG_DICTIONARY) != 0);
+
+        void *frame = sdk_mdtp_dictionary_decode(decoder, sent->data, sent->size, &size);
+
+        TEST_ASSERT_NOT_NULL(frame);
+        check_frame(frame, size);
+        free(frame);
+    }
+
+    sdk_mdtp_dictionary_disable(module);
+    sdk_mdtp_dictionary_decoder_destroy(decoder);
+    sdk_mdtp_histogram_destroy(histogram);
+}
+
+
+int main(void) {
+    fixture_create(ABI_CAPABILITY_HISTOGRAMS | ABI_CAPABILITY_MDTP_V2 | ABI_CAPABILITY_DICTIONARY,
+                   ABI_CAPABILITY_ARRAYS | ABI_CAPABILITY_MDTP_V2);
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_histogram_make);
+    RUN_TEST(test_histogram_interval);
+    RUN_TEST(test_histogram_v2);
+    RUN_TEST(test_histogram_presets);
+    RUN_TEST(test_histogram_misuse);
+    RUN_TEST(test_histogram_malformed);
+    RUN_TEST(test_histogram_dictionary);
+
+    fixture_destroy();
+
+    return UNITY_END();
+}
@@ -0,0 +1,204 @@
+#include <modules/sdk.h>
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+void tearDown(void) {}
+
+void setUp(void) {}
+
+
+// Stub
+ABI_MODULE_FUNCTIONS module_init(ABI_SERVER_CORE_FUNCTIONS server_functions,
+                                 const char               *json_configuration) {
+    return (ABI_MODULE_FUNCTIONS){0};
+}
+
+
+static IModule   *module;
+static MdtpIndex *mdtp_index;
+
+
+static const ABI_MODULE_MDTP_DATA *make_frame(void) {
+    return sdk_mdtp_make_root(
+        module,
+        sdk_mdtp_make_container(
+            "cpu",
+            sdk_mdtp_make_container("total", sdk_mdtp_make_value("usage", "12", "%"), NULL),
+            sdk_mdtp_make_value("usage", "13", "%"),
+            sdk_mdtp_make_value("usage", "14", "%"),
+            NULL),
+        sdk_mdtp_make_value("uptime", "100", "s"),
+        NULL);
+}
+
+
+// Look up `path` and compare its value
+static void assert_value(const char *path, const char *expected) {
+    MdtpReader  node;
+    size_t      length;
+    const char *value;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_index_lookup(mdtp_index, path, &node));
+    value = sdk_mdtp_reader_value(&node, &length);
+
+    TEST_ASSERT_NOT_NULL(value);
+    TEST_ASSERT_EQUAL(strlen(expected), length);
+    TEST_ASSERT_EQUAL_MEMORY(expected, value, length);
+}
+
+
+void test_index_lookup(void) {
+    const ABI_MODULE_MDTP_DATA *data = make_frame();
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_index_build(mdtp_index, data->data, data->size));
+    TEST_ASSERT_EQUAL(6, sdk_mdtp_index_size(mdtp_index));
+
+    assert_value("cpu/total/usage", "12");
+    assert_value("cpu/usage", "13"); // The first of nodes with the same name
+    assert_value("uptime", "100");
+
+    // Containers can be entered
+    MdtpReader cpu;
+    MdtpReader child;
+    size_t     length;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_index_lookup(mdtp_index, "cpu", &cpu));
+    TEST_ASSERT_EQUAL(MDTP_NODE_CONTAINER, sdk_mdtp_reader_type(&cpu));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_enter_container(&cpu, &child));
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&child));
+    TEST_ASSERT_EQUAL_MEMORY("total", sdk_mdtp_reader_name(&child, &length), 5);
+
+    // The reader continues with the next node of the container
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&cpu));
+    TEST_ASSERT_EQUAL_MEMORY("uptime", sdk_mdtp_reader_name(&cpu, &length), 6);
+    TEST_ASSERT_FALSE(sdk_mdtp_reader_next(&cpu));
+
+    MdtpReader node;
+
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_index_lookup(mdtp_index, "memory", &node));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_index_lookup(mdtp_index, "usage", &node));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_index_lookup(mdtp_index, "cpu/usag", &node));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_index_lookup(mdtp_index, "/cpu/usage", &node));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_index_lookup(mdtp_index, "cpu//usage", &node));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_index_lookup(mdtp_index, "", &node));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_index_lookup(mdtp_index, NULL, &node));
+}
+
+
+void test_index_many_nodes(void) {
+    void *containers[20];
+    char  name[16];
+    char  value[16];
+
+    for (int i = 0; i < 20; ++i) {
+        void *values[10];
+
+        for (int j = 0; j < 10; ++j) {
+            snprintf(name, sizeof(name), "v%d", j);
+            snprintf(value, sizeof(value), "%d", i * 10 + j);
+            values[j] = sdk_mdtp_make_value(name, value, "");
+        }
+
+        snprintf(name, sizeof(name), "c%d", i);
+        containers[i] = sdk_mdtp_make_container_v(name, values, 10);
+    }
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_make_root_v(module, containers, 20);
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_index_build(mdtp_index, data->data, data->size));
+    TEST_ASSERT_EQUAL(220, sdk_mdtp_index_size(mdtp_index));
+
+    for (int i = 0; i < 200; ++i) {
+        char path[32];
+
+        snprintf(path, sizeof(path), "c%d/v%d", i / 10, i % 10);
+        snprintf(value, sizeof(value), "%d", i);
+        assert_value(path, value);
+    }
+}
+
+
+void test_index_malformed_frame(void) {
+    const ABI_MODULE_MDTP_DATA *data = make_frame();
+    uint8_t                     copy[128];
+    MdtpReader                  node;
+
+    TEST_ASSERT_LESS_OR_EQUAL(sizeof(copy), data->size);
+    memcpy(copy, data->data, data->size);
+    copy[9] = 0xFF; // Name length of "cpu"
+
+    TEST_ASSERT_EQUAL(SDK_ARGUMENT_PROCESSING_ERROR,
+                      sdk_mdtp_index_build(mdtp_index, copy, data->size));
+    TEST_ASSERT_EQUAL(0, sdk_mdtp_index_size(mdtp_index));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_index_lookup(mdtp_index, "uptime", &node));
+
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_index_build(mdtp_index, NULL, 0));
+}
+
+
+// Frames of a template keep offsets while its layout does not change
+void test_index_template_rebind(void) {
+    MdtpTemplate *mdtp_template = sdk_mdtp_template_compile(
+        sdk_mdtp_make_container("cpu", sdk_mdtp_make_value("usage", "12", "%"), NULL),
+        sdk_mdtp_make_value("uptime", "100", "s"),
+        NULL);
+    MdtpTemplateSlot *usage = sdk_mdtp_template_slot(mdtp_template, "cpu/usage");
+    MdtpTemplateSlot *uptime = sdk_mdtp_template_slot(mdtp_template, "uptime");
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_template_emit(mdtp_template, module);
+    uint64_t                    layout = sdk_mdtp_template_layout(mdtp_template);
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_index_build(mdtp_index, data->data, data->size));
+
+    sdk_mdtp_template_set(usage, "57");
+    data = sdk_mdtp_template_emit(mdtp_template, module);
+
+    TEST_ASSERT_EQUAL_UINT64(layout, sdk_mdtp_template_layout(mdtp_template));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_index_rebind(mdtp_index, data->data, data->size));
+    assert_value("cpu/usage", "57");
+    assert_value("uptime", "100");
+
+    // New length moves "uptime"
+    sdk_mdtp_template_set(usage, "5");
+    data = sdk_mdtp_template_emit(mdtp_template, module);
+
+    TEST_ASSERT_NOT_EQUAL(layout, sdk_mdtp_template_layout(mdtp_template));
+
+    // Rebinding to a frame of another layout finds nothing wrong and reads nothing outside
+    MdtpReader node;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_index_rebind(mdtp_index, data->data, data->size));
+    assert_value("cpu/usage", "5");
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_index_lookup(mdtp_index, "uptime", &node));
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_index_build(mdtp_index, data->data, data->size));
+    sdk_mdtp_template_set(uptime, "1");
+    data = sdk_mdtp_template_emit(mdtp_template, module);
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_index_rebind(mdtp_index, data->data, 10));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_index_lookup(mdtp_index, "cpu/usage", &node));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_index_lookup(mdtp_index, "uptime", &node));
+
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_index_rebind(mdtp_index, NULL, 0));
+
+    sdk_mdtp_template_destroy(mdtp_template);
+}
+
+
+int main(void) {
+    module = sdk_imodule_create("test", "test", (ABI_SERVER_CORE_FUNCTIONS){0}, 0, 0);
+    mdtp_index = sdk_mdtp_index_create();
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_index_lookup);
+    RUN_TEST(test_index_many_nodes);
+    RUN_TEST(test_index_malformed_frame);
+    RUN_TEST(test_index_template_rebind);
+
+    sdk_mdtp_index_destroy(mdtp_index);
+    sdk_imodule_destroy(module);
+
+    return UNITY_END();
+}
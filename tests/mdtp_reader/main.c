@@ -0,0 +1,249 @@
+#include <modules/internals/memutils.h>
+#include <modules/sdk.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+void tearDown(void) {}
+
+void setUp(void) {}
+
+
+// Stub
+ABI_MODULE_FUNCTIONS module_init(ABI_SERVER_CORE_FUNCTIONS server_functions,
+                                 const char               *json_configuration) {
+    return (ABI_MODULE_FUNCTIONS){0};
+}
+
+
+static IModule *module;
+static char     long_value[300]; // Lengths >= 0x80 must be read as unsigned
+
+
+static const ABI_MODULE_MDTP_DATA *make_frame(void) {
+    return sdk_mdtp_make_root(
+        module,
+        sdk_mdtp_make_container("cpu",
+                                sdk_mdtp_make_value("usage", "12", "%"),
+                                sdk_mdtp_make_container_v("empty", NULL, 0),
+                                sdk_mdtp_make_value("model", long_value, ""),
+                                NULL),
+        sdk_mdtp_make_value("uptime", "100", "s"),
+        NULL);
+}
+
+
+// Compare string returned by `accessor` (name, units or value of the current node)
+static void assert_string(const char *expected,
+                          const char *(*accessor)(const MdtpReader *, size_t *),
+                          const MdtpReader *reader) {
+    size_t      length;
+    const char *actual = accessor(reader, &length);
+
+    TEST_ASSERT_NOT_NULL(actual);
+    TEST_ASSERT_EQUAL(strlen(expected), length);
+    TEST_ASSERT_EQUAL_MEMORY(expected, actual, length);
+}
+
+
+void test_read_uint32_be_high_bytes(void) {
+    const uint8_t memory[] = {0xFF, 0x80, 0x7F, 0x90};
+
+    TEST_ASSERT_EQUAL_UINT32(0xFF807F90u, read_uint32_be(memory, 0));
+    TEST_ASSERT_EQUAL_UINT8(0xFF, read_ubyte_be(memory, 0));
+}
+
+
+void test_reader_walks_frame(void) {
+    const ABI_MODULE_MDTP_DATA *data = make_frame();
+    MdtpReader                  reader;
+    MdtpReader                  cpu;
+    MdtpReader                  empty;
+    size_t                      length;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_validate(data->data, data->size));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_init(&reader, data->data, data->size));
+
+    // cpu
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&reader));
+    TEST_ASSERT_EQUAL(MDTP_NODE_CONTAINER, sdk_mdtp_reader_type(&reader));
+    assert_string("cpu", sdk_mdtp_reader_name, &reader);
+    TEST_ASSERT_NULL(sdk_mdtp_reader_value(&reader, &length));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_enter_container(&reader, &cpu));
+
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&cpu));
+    TEST_ASSERT_EQUAL(MDTP_NODE_VALUE, sdk_mdtp_reader_type(&cpu));
+    assert_string("usage", sdk_mdtp_reader_name, &cpu);
+    assert_string("%", sdk_mdtp_reader_units, &cpu);
+    assert_string("12", sdk_mdtp_reader_value, &cpu);
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_reader_enter_container(&cpu, &empty));
+
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&cpu));
+    assert_string("empty", sdk_mdtp_reader_name, &cpu);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_enter_container(&cpu, &empty));
+    TEST_ASSERT_FALSE(sdk_mdtp_reader_next(&empty));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_status(&empty));
+
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&cpu));
+    assert_string("model", sdk_mdtp_reader_name, &cpu);
+    assert_string(long_value, sdk_mdtp_reader_value, &cpu);
+
+    TEST_ASSERT_FALSE(sdk_mdtp_reader_next(&cpu));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_status(&cpu));
+
+    // uptime
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&reader));
+    assert_string("uptime", sdk_mdtp_reader_name, &reader);
+    assert_string("s", sdk_mdtp_reader_units, &reader);
+    assert_string("100", sdk_mdtp_reader_value, &reader);
+
+    // Raw bytes of the node are the same as of a node made separately
+    void       *uptime = sdk_mdtp_make_value("uptime", "100", "s");
+    const void *node = sdk_mdtp_reader_node(&reader, &length);
+
+    TEST_ASSERT_EQUAL_MEMORY(uptime, node, length);
+    sdk_mdtp_free_value(uptime);
+
+    TEST_ASSERT_FALSE(sdk_mdtp_reader_next(&reader));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_status(&reader));
+}
+
+
+// Truncated frames are rejected, and readers over them never leave them
+void test_reader_truncated_frames(void) {
+    const ABI_MODULE_MDTP_DATA *data = make_frame();
+    uint8_t                    *copy = malloc(data->size);
+
+    for (uint32_t size = 0; size < data->size; ++size) {
+        // Exact-size copy so the sanitizer catches reads past the end
+        memcpy(copy, data->data, size);
+        uint8_t *frame = realloc(copy, size == 0 ? 1 : size);
+
+        TEST_ASSERT_NOT_NULL(frame);
+        copy = frame;
+
+        TEST_ASSERT_NOT_EQUAL(SDK_OK, sdk_mdtp_validate(copy, size));
+
+        // Fix the header so that only the nodes are broken
+        if (size >= 5) {
+            write_uint32_be(copy, 1, size - 5);
+
+            SDKStatus  status = sdk_mdtp_validate(copy, size);
+            MdtpReader reader;
+
+            TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_init(&reader, copy, size));
+
+            while (sdk_mdtp_reader_next(&reader)) {
+            }
+
+            // Cut at a node boundary is a valid frame
+            if (status == SDK_OK) {
+                TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_status(&reader));
+            }
+        }
+
+        frame = realloc(copy, data->size);
+        TEST_ASSERT_NOT_NULL(frame);
+        copy = frame;
+    }
+
+    free(copy);
+}
+
+
+void test_reader_corrupted_frames(void) {
+    const ABI_MODULE_MDTP_DATA *data = make_frame();
+    uint8_t                    *copy = malloc(data->size);
+
+    // Every byte replaced with values that break length fields and types
+    const uint8_t patterns[] = {0x02, 0x80, 0xFF};
+
+    for (uint32_t i = 5; i < data->size; ++i) {
+        for (size_t p = 0; p < sizeof(patterns); ++p) {
+            memcpy(copy, data->data, data->size);
+            copy[i] = patterns[p];
+
+            SDKStatus  status = sdk_mdtp_validate(copy, data->size);
+            MdtpReader reader;
+
+            TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_init(&reader, copy, data->size));
+
+            while (sdk_mdtp_reader_next(&reader)) {
+            }
+
+            // A frame the validation accepts is also read to the end by the reader
+            if (status == SDK_OK) {
+                TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_status(&reader));
+            }
+        }
+    }
+
+    // Unknown version and wrong payload size
+    memcpy(copy, data->data, data->size);
+    copy[0] = MDTP_VERSION + 1;
+    TEST_ASSERT_EQUAL(SDK_ARGUMENT_PROCESSING_ERROR, sdk_mdtp_validate(copy, data->size));
+
+    memcpy(copy, data->data, data->size);
+    TEST_ASSERT_EQUAL(SDK_ARGUMENT_PROCESSING_ERROR, sdk_mdtp_validate(copy, data->size - 1));
+
+    free(copy);
+}
+
+
+void test_validate_depth(void) {
+    void *node = sdk_mdtp_make_value("v", "1", "");
+
+    // MDTP_MAX_DEPTH containers are accepted
+    for (int i = 0; i < MDTP_MAX_DEPTH; ++i) {
+        node = sdk_mdtp_make_container("c", node, NULL);
+    }
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_make_root(module, node, NULL);
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_validate(data->data, data->size));
+
+    node = sdk_mdtp_make_value("v", "1", "");
+
+    for (int i = 0; i < MDTP_MAX_DEPTH + 1; ++i) {
+        node = sdk_mdtp_make_container("c", node, NULL);
+    }
+
+    data = sdk_mdtp_make_root(module, node, NULL);
+
+    TEST_ASSERT_EQUAL(SDK_ARGUMENT_PROCESSING_ERROR, sdk_mdtp_validate(data->data, data->size));
+}
+
+
+void test_reader_invalid_arguments(void) {
+    MdtpReader reader;
+
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_validate(NULL, 5));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_reader_init(&reader, NULL, 5));
+
+    // Not positioned on a node yet
+    const ABI_MODULE_MDTP_DATA *data = make_frame();
+    MdtpReader                  child;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_init(&reader, data->data, data->size));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_reader_enter_container(&reader, &child));
+}
+
+
+int main(void) {
+    module = sdk_imodule_create("test", "test", (ABI_SERVER_CORE_FUNCTIONS){0}, 0, 0);
+
+    memset(long_value, 'x', sizeof(long_value) - 1);
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_read_uint32_be_high_bytes);
+    RUN_TEST(test_reader_walks_frame);
+    RUN_TEST(test_reader_truncated_frames);
+    RUN_TEST(test_reader_corrupted_frames);
+    RUN_TEST(test_validate_depth);
+    RUN_TEST(test_reader_invalid_arguments);
+
+    sdk_imodule_destroy(module);
+
+    return UNITY_END();
+}
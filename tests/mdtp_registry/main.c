@@ -0,0 +1,162 @@
+#include <modules/sdk.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+void tearDown(void) {}
+
+void setUp(void) {}
+
+
+// Stub
+ABI_MODULE_FUNCTIONS module_init(ABI_SERVER_CORE_FUNCTIONS server_functions,
+                                 const char               *json_configuration) {
+    return (ABI_MODULE_FUNCTIONS){0};
+}
+
+
+static uint32_t get_abi_version(const ABI_MODULE_CONTEXT *context) {
+    return 2;
+}
+
+
+#define THREADS 8
+#define UPDATES_PER_THREAD 200000
+
+static IModule     *module;
+static MdtpBuilder *builder;
+static MdtpMetric  *requests;
+static MdtpMetric  *connections;
+static MdtpMetric  *temperature;
+
+
+static void *work(void *argument) {
+    for (int i = 0; i < UPDATES_PER_THREAD; ++i) {
+        sdk_mdtp_metric_add(requests, 1);
+        sdk_mdtp_metric_add_i64(connections, 1);
+        sdk_mdtp_metric_add_i64(connections, -1);
+    }
+
+    // Every thread leaves one connection open
+    sdk_mdtp_metric_add_i64(connections, 1);
+    sdk_mdtp_metric_set(temperature, 36.6);
+
+    return NULL;
+}
+
+
+void test_registry_register(void) {
+    TEST_ASSERT_EQUAL(0, sdk_mdtp_registry_size(module));
+
+    requests = sdk_mdtp_registry_counter(module, "requests", "");
+    connections = sdk_mdtp_registry_updown(module, "connections", "");
+    temperature = sdk_mdtp_registry_gauge(module, "temperature", 1, "C");
+
+    TEST_ASSERT_NOT_NULL(requests);
+    TEST_ASSERT_NOT_NULL(connections);
+    TEST_ASSERT_NOT_NULL(temperature);
+    TEST_ASSERT_EQUAL(3, sdk_mdtp_registry_size(module));
+    TEST_ASSERT_EQUAL(MDTP_METRIC_UPDOWN, sdk_mdtp_metric_kind(connections));
+
+    // Same name and kind is the same metric, another kind is an error
+    TEST_ASSERT_EQUAL_PTR(requests, sdk_mdtp_registry_counter(module, "requests", ""));
+    TEST_ASSERT_NULL(sdk_mdtp_registry_gauge(module, "requests", 0, ""));
+    TEST_ASSERT_NULL(sdk_mdtp_registry_counter(module, NULL, ""));
+    TEST_ASSERT_NULL(sdk_mdtp_registry_counter(module, "bytes", NULL));
+    TEST_ASSERT_EQUAL(3, sdk_mdtp_registry_size(module));
+
+    TEST_ASSERT_EQUAL_UINT64(0, sdk_mdtp_metric_u64(requests));
+    TEST_ASSERT_EQUAL(0, sdk_mdtp_metric_i64(connections));
+    TEST_ASSERT_EQUAL_DOUBLE(0, sdk_mdtp_metric_f64(temperature));
+}
+
+
+void test_registry_threads(void) {
+    pthread_t threads[THREADS];
+
+    for (int i = 0; i < THREADS; ++i) {
+        pthread_create(&threads[i], NULL, work, NULL);
+    }
+
+    for (int i = 0; i < THREADS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    TEST_ASSERT_EQUAL_UINT64((uint64_t)THREADS * UPDATES_PER_THREAD, sdk_mdtp_metric_u64(requests));
+    TEST_ASSERT_EQUAL(THREADS, sdk_mdtp_metric_i64(connections));
+    TEST_ASSERT_EQUAL_DOUBLE(36.6, sdk_mdtp_metric_f64(temperature));
+
+    // Below zero
+    sdk_mdtp_metric_add_i64(connections, -THREADS - 5);
+    TEST_ASSERT_EQUAL(-5, sdk_mdtp_metric_i64(connections));
+}
+
+
+void test_registry_add(void) {
+    MdtpReader reader;
+    size_t     length;
+    uint64_t   count;
+    int64_t    level;
+    double     value;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_begin_container(builder, "stats"));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_registry_add(module, builder));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_end_container(builder));
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_builder_finish(builder, module);
+    MdtpReader                  child;
+
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_init(&reader, data->data, data->size));
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&reader));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_enter_container(&reader, &child));
+
+    // Values in the order of registration
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&child));
+    TEST_ASSERT_EQUAL_STRING_LEN("requests", sdk_mdtp_reader_name(&child, &length), 8);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_u64(&child, &count));
+    TEST_ASSERT_EQUAL_UINT64((uint64_t)THREADS * UPDATES_PER_THREAD, count);
+
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&child));
+    TEST_ASSERT_EQUAL_STRING_LEN("connections", sdk_mdtp_reader_name(&child, &length), 11);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_i64(&child, &level));
+    TEST_ASSERT_EQUAL(-5, level);
+
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&child));
+    TEST_ASSERT_EQUAL_STRING_LEN("temperature", sdk_mdtp_reader_name(&child, &length), 11);
+    TEST_ASSERT_EQUAL_STRING_LEN("36.6", sdk_mdtp_reader_value(&child, &length), 4);
+    TEST_ASSERT_EQUAL_STRING_LEN("C", sdk_mdtp_reader_units(&child, &length), 1);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_f64(&child, &value));
+    TEST_ASSERT_EQUAL_DOUBLE(36.6, value);
+
+    TEST_ASSERT_FALSE(sdk_mdtp_reader_next(&child));
+
+    // A module without metrics writes nothing
+    ABI_SERVER_CORE_FUNCTIONS server = {.abi_get_abi_version = get_abi_version};
+    IModule                  *empty = sdk_imodule_create("empty", "empty", server, 0, 1);
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_registry_add(empty, builder));
+    TEST_ASSERT_EQUAL(5, sdk_mdtp_builder_finish(builder, empty)->size);
+    sdk_imodule_destroy(empty);
+}
+
+
+int main(void) {
+    ABI_SERVER_CORE_FUNCTIONS server = {.abi_get_abi_version = get_abi_version};
+
+    module = sdk_imodule_create("test", "test", server, 0, 1);
+    builder = sdk_mdtp_builder_create();
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_registry_register);
+    RUN_TEST(test_registry_threads);
+    RUN_TEST(test_registry_add);
+
+    sdk_mdtp_builder_destroy(builder);
+    sdk_imodule_destroy(module);
+
+    return UNITY_END();
+}
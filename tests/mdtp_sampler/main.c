@@ -0,0 +1,190 @@
+#include <modules/sdk.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unity.h>
+
+void tearDown(void) {}
+
+void setUp(void) {}
+
+
+// Stub
+ABI_MODULE_FUNCTIONS module_init(ABI_SERVER_CORE_FUNCTIONS server_functions,
+                                 const char               *json_configuration) {
+    return (ABI_MODULE_FUNCTIONS){0};
+}
+
+
+static uint32_t get_abi_version(const ABI_MODULE_CONTEXT *context) {
+    return 2 | ABI_CAPABILITY_DELTA_FRAMES | ABI_CAPABILITY_DICTIONARY;
+}
+
+
+static IModule         *module;
+static MdtpBuilder     *builder;
+static _Atomic uint64_t collections;
+
+
+// Frame with the number of the collection, twice to make it longer than a header
+static const ABI_MODULE_MDTP_DATA *collect(void) {
+    uint64_t number = atomic_fetch_add(&collections, 1) + 1;
+
+    sdk_mdtp_builder_add_value_u64(builder, "collection", number, "");
+    sdk_mdtp_builder_add_value_u64(builder, "copy", number, "");
+
+    return sdk_mdtp_builder_finish(builder, module);
+}
+
+
+// Collect nothing
+static const ABI_MODULE_MDTP_DATA *collect_nothing(void) {
+    return NULL;
+}
+
+
+static void sleep_ms(long milliseconds) {
+    struct timespec time = {.tv_sec = 0, .tv_nsec = milliseconds * 1000000};
+    nanosleep(&time, NULL);
+}
+
+
+// Read the number of the collection and check that both values hold it
+static uint64_t read_collection(const ABI_MODULE_MDTP_DATA *data) {
+    MdtpReader reader;
+    uint64_t   number;
+    uint64_t   copy;
+
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_init(&reader, data->data, data->size));
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&reader));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_u64(&reader, &number));
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&reader));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_u64(&reader, &copy));
+    TEST_ASSERT_EQUAL_UINT64(number, copy);
+
+    return number;
+}
+
+
+void test_sampler_publish(void) {
+    TEST_ASSERT_NULL(sdk_mdtp_sampler_get_data(module));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_sampler_start(module, collect, 2));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_sampler_start(module, collect, 2));
+
+    // No frame was returned yet
+    TEST_ASSERT_NULL(sdk_mdtp_sampler_get_data_info(module));
+
+    // The first frame is there at once
+    uint64_t last = read_collection(sdk_mdtp_sampler_get_data(module));
+
+    TEST_ASSERT_GREATER_OR_EQUAL(1, last);
+
+    // Frames only move forward, and a frame being read is never overwritten
+    for (int poll = 0; poll < 50; ++poll) {
+        const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_sampler_get_data(module);
+        uint8_t                     copy[64];
+
+        TEST_ASSERT_LESS_OR_EQUAL(sizeof(copy), data->size);
+        memcpy(copy, data->data, data->size);
+
+        uint64_t number = read_collection(data);
+
+        TEST_ASSERT_GREATER_OR_EQUAL(last, number);
+        last = number;
+
+        sleep_ms(3);
+        TEST_ASSERT_EQUAL_MEMORY(copy, data->data, data->size);
+    }
+
+    // The info describes the frame returned last, which stays valid
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_sampler_get_data(module);
+    uint8_t                     copy[64];
+
+    memcpy(copy, data->data, data->size);
+    sleep_ms(3);
+
+    const ABI_MODULE_DATA_INFO *info = sdk_mdtp_sampler_get_data_info(module);
+
+    TEST_ASSERT_NOT_NULL(info);
+    TEST_ASSERT_NOT_EQUAL(0, info->generation);
+    TEST_ASSERT_EQUAL_PTR(info, sdk_mdtp_sampler_get_data_info(module));
+    TEST_ASSERT_EQUAL_MEMORY(copy, data->data, data->size);
+
+    sdk_mdtp_sampler_stop(module);
+    sdk_mdtp_sampler_stop(module);
+
+    // Nothing is collected after the stop, the latest frame stays
+    uint64_t published = sdk_mdtp_sampler_published(module);
+    uint64_t number = read_collection(sdk_mdtp_sampler_get_data(module));
+
+    TEST_ASSERT_GREATER_THAN(10, published);
+    TEST_ASSERT_EQUAL_UINT64(published, atomic_load(&collections));
+    TEST_ASSERT_EQUAL_UINT64(published, number);
+
+    sleep_ms(10);
+    TEST_ASSERT_EQUAL_UINT64(published, sdk_mdtp_sampler_published(module));
+    TEST_ASSERT_EQUAL_UINT64(number, read_collection(sdk_mdtp_sampler_get_data(module)));
+}
+
+
+void test_sampler_restart(void) {
+    uint64_t published = sdk_mdtp_sampler_published(module);
+
+    // A routine without frames keeps the previous frame
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_sampler_start(module, collect_nothing, 1));
+    sleep_ms(10);
+    sdk_mdtp_sampler_stop(module);
+
+    TEST_ASSERT_EQUAL_UINT64(published, sdk_mdtp_sampler_published(module));
+    TEST_ASSERT_EQUAL_UINT64(published, read_collection(sdk_mdtp_sampler_get_data(module)));
+
+    // A long interval does not delay the stop
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_sampler_start(module, collect, 60000));
+    TEST_ASSERT_EQUAL_UINT64(published + 1, read_collection(sdk_mdtp_sampler_get_data(module)));
+    sdk_mdtp_sampler_stop(module);
+}
+
+
+void test_sampler_misuse(void) {
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_sampler_start(module, NULL, 1));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_sampler_start(module, collect, 0));
+
+    // Encodings that need every frame
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_delta_enable(module, 10));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_sampler_start(module, collect, 1));
+    sdk_mdtp_delta_disable(module);
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_dictionary_enable(module));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_sampler_start(module, collect, 1));
+    sdk_mdtp_dictionary_disable(module);
+
+    // Destroying a module stops its sampler
+    ABI_SERVER_CORE_FUNCTIONS server = {.abi_get_abi_version = get_abi_version};
+    IModule                  *other = sdk_imodule_create("other", "other", server, 0, 1);
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_sampler_start(other, collect_nothing, 1));
+    TEST_ASSERT_NULL(sdk_mdtp_sampler_get_data(other));
+    sdk_imodule_destroy(other);
+}
+
+
+int main(void) {
+    ABI_SERVER_CORE_FUNCTIONS server = {.abi_get_abi_version = get_abi_version};
+
+    module = sdk_imodule_create("test", "test", server, 0, 1);
+    builder = sdk_mdtp_builder_create();
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_sampler_publish);
+    RUN_TEST(test_sampler_restart);
+    RUN_TEST(test_sampler_misuse);
+
+    sdk_mdtp_builder_destroy(builder);
+    sdk_imodule_destroy(module);
+
+    return UNITY_END();
+}
@@ -0,0 +1,269 @@
+#include <modules/sdk.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+void tearDown(void) {}
+
+void setUp(void) {}
+
+
+// Stub
+ABI_MODULE_FUNCTIONS module_init(ABI_SERVER_CORE_FUNCTIONS server_functions,
+                                 const char               *json_configuration) {
+    return (ABI_MODULE_FUNCTIONS){0};
+}
+
+
+static uint32_t get_abi_version(const ABI_MODULE_CONTEXT *context) {
+    return 2;
+}
+
+
+#define THREADS 8
+#define VALUES_PER_THREAD 100000
+
+static IModule     *module;
+static MdtpBuilder *builder;
+
+
+// Check that every estimate is within the error of the precision
+static void check_quantiles(MdtpSketch *sketch, const double *expected, int precision) {
+    static const double quantiles[] = {0, 0.5, 0.9, 0.99, 1};
+    double              values[5];
+
+    sdk_mdtp_sketch_quantiles(sketch, quantiles, values, 5);
+
+    for (size_t i = 0; i < 5; ++i) {
+        TEST_ASSERT_DOUBLE_WITHIN(expected[i] / (1 << (precision + 1)), expected[i], values[i]);
+    }
+}
+
+
+void test_sketch_accuracy(void) {
+    for (int precision = 1; precision <= MDTP_SKETCH_MAX_PRECISION; precision += 3) {
+        MdtpSketch *sketch = sdk_mdtp_sketch_create(1e-3, 1e6, precision, 4);
+
+        TEST_ASSERT_NOT_NULL(sketch);
+
+        // 1, 2, ..., 10000, so the quantile `q` is about `q * 10000`
+        for (int i = 10000; i >= 1; --i) {
+            sdk_mdtp_sketch_record(sketch, i);
+        }
+
+        sdk_mdtp_sketch_record(sketch, NAN);
+
+        const double expected[] = {1, 5000, 9000, 9900, 10000};
+
+        check_quantiles(sketch, expected, precision);
+        sdk_mdtp_sketch_destroy(sketch);
+    }
+}
+
+
+void test_sketch_range(void) {
+    MdtpSketch *sketch = sdk_mdtp_sketch_create(1, 1000, MDTP_SKETCH_DEFAULT_PRECISION, 1);
+    double      median = -1;
+
+    // Nothing recorded
+    TEST_ASSERT_EQUAL(0, sdk_mdtp_sketch_quantiles(sketch, (const double[]){0.5}, &median, 1));
+    TEST_ASSERT_EQUAL_DOUBLE(0, median);
+
+    // Values out of the range are counted at its ends
+    sdk_mdtp_sketch_record(sketch, -5);
+    sdk_mdtp_sketch_record(sketch, 0);
+    sdk_mdtp_sketch_record(sketch, 1e9);
+    sdk_mdtp_sketch_record(sketch, INFINITY);
+    sdk_mdtp_sketch_record(sketch, 1000);
+
+    const double quantiles[] = {0, 0.25, 0.5, 1};
+    double       values[4];
+
+    TEST_ASSERT_EQUAL(5, sdk_mdtp_sketch_quantiles(sketch, quantiles, values, 4));
+    TEST_ASSERT_EQUAL_DOUBLE(1, values[0]);
+    TEST_ASSERT_EQUAL_DOUBLE(1, values[1]);
+    TEST_ASSERT_EQUAL_DOUBLE(1000, values[2]);
+    TEST_ASSERT_EQUAL_DOUBLE(1000, values[3]);
+
+    sdk_mdtp_sketch_reset(sketch);
+    TEST_ASSERT_EQUAL(0, sdk_mdtp_sketch_quantiles(sketch, quantiles, values, 4));
+    sdk_mdtp_sketch_destroy(sketch);
+
+    // Invalid parameters
+    TEST_ASSERT_NULL(sdk_mdtp_sketch_create(0, 1, 7, 1));
+    TEST_ASSERT_NULL(sdk_mdtp_sketch_create(2, 1, 7, 1));
+    TEST_ASSERT_NULL(sdk_mdtp_sketch_create(1, INFINITY, 7, 1));
+    TEST_ASSERT_NULL(sdk_mdtp_sketch_create(1, 2, 0, 1));
+    TEST_ASSERT_NULL(sdk_mdtp_sketch_create(1, 2, MDTP_SKETCH_MAX_PRECISION + 1, 1));
+    TEST_ASSERT_NULL(sdk_mdtp_sketch_create(1, 2, 7, 0));
+    TEST_ASSERT_NULL(sdk_mdtp_sketch_create(1e-300, 1e300, MDTP_SKETCH_MAX_PRECISION, 1));
+    sdk_mdtp_sketch_destroy(NULL);
+}
+
+
+void test_sketch_merge(void) {
+    MdtpSketch *first = sdk_mdtp_sketch_create(1, 1e4, MDTP_SKETCH_DEFAULT_PRECISION, 2);
+    MdtpSketch *second = sdk_mdtp_sketch_create(1, 1e4, MDTP_SKETCH_DEFAULT_PRECISION, 8);
+    MdtpSketch *other = sdk_mdtp_sketch_create(1, 1e4, 5, 2);
+
+    // Halves of the values in different sketches
+    for (int i = 1; i <= 10000; ++i) {
+        sdk_mdtp_sketch_record(i % 2 ? first : second, i);
+    }
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_sketch_merge(first, second));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_sketch_merge(first, other));
+
+    const double expected[] = {1, 5000, 9000, 9900, 10000};
+
+    check_quantiles(first, expected, MDTP_SKETCH_DEFAULT_PRECISION);
+
+    // The source is left as it was
+    double median;
+
+    TEST_ASSERT_EQUAL(5000, sdk_mdtp_sketch_quantiles(second, (const double[]){0.5}, &median, 1));
+
+    sdk_mdtp_sketch_destroy(first);
+    sdk_mdtp_sketch_destroy(second);
+    sdk_mdtp_sketch_destroy(other);
+}
+
+
+static void *record(void *sketch) {
+    for (int i = 0; i < VALUES_PER_THREAD; ++i) {
+        sdk_mdtp_sketch_record(sketch, 1 + i % 1000);
+    }
+
+    return NULL;
+}
+
+
+// Drain the sketch like get_data does while workers record
+static void *drain(void *sketch) {
+    uint64_t *drained = calloc(1, sizeof(uint64_t));
+
+    for (int i = 0; i < 200; ++i) {
+        const ABI_MODULE_MDTP_DATA *data =
+            sdk_mdtp_make_root(module, sdk_mdtp_sketch_make(sketch, "latency", 3, "ms"), NULL);
+        MdtpReader reader;
+        MdtpReader child;
+        uint64_t   count = 0;
+
+        // Unity asserts only in the main thread, a lost count fails the test there
+        if (data != NULL && sdk_mdtp_reader_init(&reader, data->data, data->size) == SDK_OK &&
+            sdk_mdtp_reader_next(&reader) &&
+            sdk_mdtp_reader_enter_container(&reader, &child) == SDK_OK &&
+            sdk_mdtp_reader_next(&child)) {
+            sdk_mdtp_reader_value_u64(&child, &count);
+        }
+
+        *drained += count;
+    }
+
+    return drained;
+}
+
+
+void test_sketch_threads(void) {
+    MdtpSketch *sketch = sdk_mdtp_sketch_create(1, 1000, 4, MDTP_SKETCH_DEFAULT_SHARDS);
+    pthread_t   threads[THREADS];
+    pthread_t   drainer;
+    uint64_t   *drained;
+    double      median;
+
+    for (int i = 0; i < THREADS; ++i) {
+        pthread_create(&threads[i], NULL, record, sketch);
+    }
+
+    pthread_create(&drainer, NULL, drain, sketch);
+
+    for (int i = 0; i < THREADS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_join(drainer, (void **)&drained);
+
+    // Every value is counted once, either by a drain or after it
+    uint64_t rest = sdk_mdtp_sketch_quantiles(sketch, (const double[]){0.5}, &median, 1);
+
+    TEST_ASSERT_EQUAL_UINT64((uint64_t)THREADS * VALUES_PER_THREAD, *drained + rest);
+
+    free(drained);
+    sdk_mdtp_sketch_destroy(sketch);
+}
+
+
+void test_sketch_add(void) {
+    static const char *const names[] = {"count", "p50", "p90", "p99", "p999"};
+    static const double      expected[] = {1000, 500, 900, 990, 999};
+
+    MdtpSketch *sketch = sdk_mdtp_sketch_create(1, 1e4, MDTP_SKETCH_DEFAULT_PRECISION, 4);
+
+    for (int i = 1; i <= 1000; ++i) {
+        sdk_mdtp_sketch_record(sketch, i);
+    }
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_sketch_add(sketch, builder, "latency", 2, "ms"));
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_builder_finish(builder, module);
+    MdtpReader                  reader;
+    MdtpReader                  child;
+    size_t                      length;
+
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_init(&reader, data->data, data->size));
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&reader));
+    TEST_ASSERT_EQUAL_STRING_LEN("latency", sdk_mdtp_reader_name(&reader, &length), 7);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_enter_container(&reader, &child));
+
+    for (size_t i = 0; i < 5; ++i) {
+        double value;
+
+        TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&child));
+        TEST_ASSERT_EQUAL_STRING_LEN(
+            names[i], sdk_mdtp_reader_name(&child, &length), strlen(names[i]));
+        TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_f64(&child, &value));
+        TEST_ASSERT_DOUBLE_WITHIN(expected[i] / 256, expected[i], value);
+        TEST_ASSERT_EQUAL_STRING_LEN(i == 0 ? "" : "ms", sdk_mdtp_reader_units(&child, &length),
+                                     i == 0 ? 0 : 2);
+    }
+
+    TEST_ASSERT_FALSE(sdk_mdtp_reader_next(&child));
+
+    // The next interval starts empty
+    double median;
+
+    TEST_ASSERT_EQUAL(0, sdk_mdtp_sketch_quantiles(sketch, (const double[]){0.5}, &median, 1));
+
+    // A failed make keeps the values
+    sdk_mdtp_sketch_record(sketch, 42);
+    TEST_ASSERT_NULL(sdk_mdtp_sketch_make(sketch, NULL, 2, "ms"));
+    TEST_ASSERT_EQUAL(1, sdk_mdtp_sketch_quantiles(sketch, (const double[]){0.5}, &median, 1));
+    TEST_ASSERT_DOUBLE_WITHIN(42.0 / 256, 42, median);
+
+    sdk_mdtp_sketch_destroy(sketch);
+}
+
+
+int main(void) {
+    ABI_SERVER_CORE_FUNCTIONS server = {.abi_get_abi_version = get_abi_version};
+
+    module = sdk_imodule_create("test", "test", server, 0, 1);
+    builder = sdk_mdtp_builder_create();
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_sketch_accuracy);
+    RUN_TEST(test_sketch_range);
+    RUN_TEST(test_sketch_merge);
+    RUN_TEST(test_sketch_threads);
+    RUN_TEST(test_sketch_add);
+
+    sdk_mdtp_builder_destroy(builder);
+    sdk_imodule_destroy(module);
+
+    return UNITY_END();
+}
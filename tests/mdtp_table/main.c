@@ -0,0 +1,478 @@
+#include <modules/sdk.h>
+#include <modules/internals/memutils.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "../mdtp_fixture.h"
+
+#define PROCESSES 200
+
+
+static const char *const columns[] = {"pid", "command", "rss", "cpu"};
+static const char *const units[] = {"", "", "bytes", "%"};
+
+
+// Cell of row `row` and column `column` of the process table as text
+static void cell_text(char *text, size_t size, uint64_t row, uint32_t column, uint64_t counter) {
+    switch (column) {
+    case 0:
+        snprintf(text, size, "%llu", (unsigned long long)(1000 + row));
+        break;
+    case 1:
+        snprintf(text, size, "/usr/bin/worker-%llu", (unsigned long long)(row % 3));
+        break;
+    case 2:
+        snprintf(text, size, "%llu", (unsigned long long)(counter + row * 4096));
+        break;
+    default:
+        snprintf(text, size, "%.2f", (double)row / 4);
+        break;
+    }
+}
+
+
+// Build the process table with every kind of cell
+static void build_table(uint32_t rows, uint8_t layout, uint64_t counter) {
+    SDKStatus status =
+        sdk_mdtp_builder_begin_table(builder, "processes", columns, units, 4, layout);
+
+    TEST_ASSERT_EQUAL(SDK_OK, status);
+
+    for (uint32_t row = 0; row < rows; ++row) {
+        char command[32];
+
+        cell_text(command, sizeof(command), row, 1, counter);
+        sdk_mdtp_builder_add_cell_i64(builder, 1000 + (int64_t)row);
+        sdk_mdtp_builder_add_cell(builder, command);
+        sdk_mdtp_builder_add_cell_u64(builder, counter + row * 4096);
+        sdk_mdtp_builder_add_cell_f64(builder, (double)row / 4, 2);
+    }
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_end_table(builder));
+}
+
+
+// Check a frame with a value `count` and the process table built by `build_table`
+static void check_frame(const void *frame, size_t size, uint32_t rows, uint64_t counter) {
+    MdtpReader reader;
+    MdtpReader cells;
+    size_t     length;
+    uint64_t   seen = 0;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_validate(frame, size));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_init(&reader, frame, size));
+
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&reader));
+    TEST_ASSERT_EQUAL(MDTP_NODE_VALUE, sdk_mdtp_reader_type(&reader));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_reader_enter_table(&reader, &cells));
+
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&reader));
+    TEST_ASSERT_EQUAL(MDTP_NODE_TABLE, sdk_mdtp_reader_type(&reader));
+    TEST_ASSERT_EQUAL_MEMORY("processes", sdk_mdtp_reader_name(&reader, &length), 9);
+    TEST_ASSERT_NULL(sdk_mdtp_reader_value(&reader, &length));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_enter_table(&reader, &cells));
+    TEST_ASSERT_EQUAL(rows, sdk_mdtp_reader_table_rows(&cells));
+    TEST_ASSERT_EQUAL(4, sdk_mdtp_reader_table_columns(&cells));
+
+    const char *name;
+    const char *column_units;
+    size_t      units_length;
+
+    TEST_ASSERT_EQUAL(
+        SDK_OK,
+        sdk_mdtp_reader_table_column(&cells, 2, &name, &length, &column_units, &units_length));
+    TEST_ASSERT_EQUAL(3, length);
+    TEST_ASSERT_EQUAL_MEMORY("rss", name, 3);
+    TEST_ASSERT_EQUAL(5, units_length);
+    TEST_ASSERT_EQUAL_MEMORY("bytes", column_units, 5);
+    TEST_ASSERT_EQUAL(
+        SDK_INVALID_ARGUMENT,
+        sdk_mdtp_reader_table_column(&cells, 4, &name, &length, &column_units, &units_length));
+
+    while (sdk_mdtp_reader_next(&cells)) {
+        uint32_t row = sdk_mdtp_reader_cell_row(&cells);
+        uint32_t column = sdk_mdtp_reader_cell_column(&cells);
+        char     expected[32];
+        double   number;
+
+        // Every cell is named after its column
+        name = sdk_mdtp_reader_name(&cells, &length);
+        TEST_ASSERT_EQUAL(strlen(columns[column]), length);
+        TEST_ASSERT_EQUAL_MEMORY(columns[column], name, length);
+        column_units = sdk_mdtp_reader_units(&cells, &length);
+        TEST_ASSERT_EQUAL(strlen(units[column]), length);
+        TEST_ASSERT_EQUAL_MEMORY(units[column], column_units, length);
+
+        if (column == 1) {
+            const char *value = sdk_mdtp_reader_value(&cells, &length);
+
+            cell_text(expected, sizeof(expected), row, column, counter);
+            TEST_ASSERT_EQUAL(strlen(expected), length);
+            TEST_ASSERT_EQUAL_MEMORY(expected, value, length);
+        } else {
+            TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_f64(&cells, &number));
+            cell_text(expected, sizeof(expected), row, column, counter);
+            TEST_ASSERT_TRUE(number == strtod(expected, NULL));
+        }
+
+        ++seen;
+    }
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_status(&cells));
+    TEST_ASSERT_EQUAL_UINT64((uint64_t)rows * 4, seen);
+    TEST_ASSERT_FALSE(sdk_mdtp_reader_next(&reader));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_status(&reader));
+}
+
+
+static const ABI_MODULE_MDTP_DATA *make_frame(uint32_t rows, uint8_t layout, uint64_t counter) {
+    sdk_mdtp_builder_add_value_u64(builder, "count", rows, "");
+    build_table(rows, layout, counter);
+
+    return sdk_mdtp_builder_finish(builder, module);
+}
+
+
+void test_table_layouts(void) {
+    static const uint8_t versions[] = {MDTP_VERSION, MDTP_VERSION_2};
+
+    for (size_t i = 0; i < sizeof(versions); ++i) {
+        sdk_mdtp_builder_set_version(builder, versions[i]);
+
+        for (uint8_t layout = MDTP_TABLE_ROWS; layout <= MDTP_TABLE_COLUMNS; ++layout) {
+            for (uint32_t rows = 0; rows < 20; rows += 7) {
+                const ABI_MODULE_MDTP_DATA *data = make_frame(rows, layout, 7);
+                MdtpReader                  reader;
+                MdtpReader                  cells;
+
+                TEST_ASSERT_NOT_NULL(data);
+                check_frame(data->data, data->size, rows, 7);
+
+                sdk_mdtp_reader_init(&reader, data->data, data->size);
+                sdk_mdtp_reader_next(&reader);
+                sdk_mdtp_reader_next(&reader);
+                sdk_mdtp_reader_enter_table(&reader, &cells);
+                TEST_ASSERT_EQUAL(layout, sdk_mdtp_reader_table_layout(&cells));
+
+                // The second cell is in the next column or in the next row
+                if (rows > 1) {
+                    sdk_mdtp_reader_next(&cells);
+                    sdk_mdtp_reader_next(&cells);
+                    TEST_ASSERT_EQUAL(layout == MDTP_TABLE_ROWS ? 0 : 1,
+                                      sdk_mdtp_reader_cell_row(&cells));
+                    TEST_ASSERT_EQUAL(layout == MDTP_TABLE_ROWS ? 1 : 0,
+                                      sdk_mdtp_reader_cell_column(&cells));
+                }
+            }
+        }
+    }
+
+    sdk_mdtp_builder_set_version(builder, MDTP_VERSION);
+}
+
+
+void test_table_rows(void) {
+    static const char *const text[] = {"1", "init", "4096", "0.5"};
+    uint64_t                 numbers[] = {2, 3, 8192, 1};
+
+    sdk_mdtp_builder_set_version(builder, MDTP_VERSION_2);
+    sdk_mdtp_builder_begin_container(builder, "system");
+    sdk_mdtp_builder_begin_table(builder, "processes", columns, NULL, 4, MDTP_TABLE_COLUMNS);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_add_row(builder, text));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_add_row_u64(builder, numbers));
+    sdk_mdtp_builder_end_table(builder);
+    sdk_mdtp_builder_end_container(builder);
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_builder_finish(builder, module);
+    MdtpReader                  reader;
+    MdtpReader                  system;
+    MdtpReader                  cells;
+    uint64_t                    number;
+    size_t                      length;
+
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_validate(data->data, data->size));
+
+    sdk_mdtp_reader_init(&reader, data->data, data->size);
+    sdk_mdtp_reader_next(&reader);
+    sdk_mdtp_reader_enter_container(&reader, &system);
+    sdk_mdtp_reader_next(&system);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_enter_table(&system, &cells));
+
+    // Column after column: 1, 2, init, 3, ...
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&cells));
+    TEST_ASSERT_EQUAL(MDTP_VALUE_TEXT, sdk_mdtp_reader_value_type(&cells));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_u64(&cells, &number));
+    TEST_ASSERT_EQUAL_UINT64(1, number);
+    TEST_ASSERT_NOT_NULL(sdk_mdtp_reader_units(&cells, &length));
+    TEST_ASSERT_EQUAL(0, length);
+
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&cells));
+    TEST_ASSERT_EQUAL(MDTP_VALUE_U64, sdk_mdtp_reader_value_type(&cells));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_u64(&cells, &number));
+    TEST_ASSERT_EQUAL_UINT64(2, number);
+
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(&cells));
+    TEST_ASSERT_EQUAL_MEMORY("init", sdk_mdtp_reader_value(&cells, &length), 4);
+    TEST_ASSERT_EQUAL(1, sdk_mdtp_reader_cell_column(&cells));
+    TEST_ASSERT_EQUAL(0, sdk_mdtp_reader_cell_row(&cells));
+
+    sdk_mdtp_builder_set_version(builder, MDTP_VERSION);
+}
+
+
+void test_table_smaller(void) {
+    // The same processes as containers
+    for (uint32_t row = 0; row < PROCESSES; ++row) {
+        char text[32];
+
+        snprintf(text, sizeof(text), "%u", 1000 + row);
+        sdk_mdtp_builder_begin_container(builder, text);
+
+        for (uint32_t column = 0; column < 4; ++column) {
+            cell_text(text, sizeof(text), row, column, 0);
+            sdk_mdtp_builder_add_value(builder, columns[column], text, units[column]);
+        }
+
+        sdk_mdtp_builder_end_container(builder);
+    }
+
+    size_t containers = sdk_mdtp_builder_finish(builder, module)->size;
+
+    build_table(PROCESSES, MDTP_TABLE_ROWS, 0);
+
+    size_t table = sdk_mdtp_builder_finish(builder, module)->size;
+
+    printf("%d processes: containers %zu B, table %zu B\n", PROCESSES, containers, table);
+    TEST_ASSERT_LESS_OR_EQUAL(containers / 2, table);
+}
+
+
+void test_table_misuse(void) {
+    uint64_t numbers[] = {1, 2, 3, 4};
+
+    // Cells outside of a table
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_builder_add_cell_u64(builder, 1));
+    TEST_ASSERT_NULL(sdk_mdtp_builder_finish(builder, module));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_builder_add_row_u64(builder, numbers));
+    TEST_ASSERT_NULL(sdk_mdtp_builder_finish(builder, module));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_builder_end_table(builder));
+    TEST_ASSERT_NULL(sdk_mdtp_builder_finish(builder, module));
+
+    // No columns, unknown layout
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT,
+                      sdk_mdtp_builder_begin_table(builder, "t", columns, units, 0, 0));
+    TEST_ASSERT_NULL(sdk_mdtp_builder_finish(builder, module));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT,
+                      sdk_mdtp_builder_begin_table(builder, "t", columns, units, 4, 2));
+    TEST_ASSERT_NULL(sdk_mdtp_builder_finish(builder, module));
+
+    // Other nodes inside of a table
+    sdk_mdtp_builder_begin_table(builder, "t", columns, units, 4, MDTP_TABLE_ROWS);
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_builder_add_value(builder, "a", "1", ""));
+    TEST_ASSERT_NULL(sdk_mdtp_builder_finish(builder, module));
+
+    sdk_mdtp_builder_begin_table(builder, "t", columns, units, 4, MDTP_TABLE_ROWS);
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_builder_end_container(builder));
+    TEST_ASSERT_NULL(sdk_mdtp_builder_finish(builder, module));
+
+    // Incomplete rows
+    sdk_mdtp_builder_begin_table(builder, "t", columns, units, 4, MDTP_TABLE_ROWS);
+    sdk_mdtp_builder_add_cell_u64(builder, 1);
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_builder_add_row_u64(builder, numbers));
+    TEST_ASSERT_NULL(sdk_mdtp_builder_finish(builder, module));
+
+    sdk_mdtp_builder_begin_table(builder, "t", columns, units, 4, MDTP_TABLE_ROWS);
+    sdk_mdtp_builder_add_cell_u64(builder, 1);
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_builder_end_table(builder));
+    TEST_ASSERT_NULL(sdk_mdtp_builder_finish(builder, module));
+
+    // Open table
+    sdk_mdtp_builder_begin_table(builder, "t", columns, units, 4, MDTP_TABLE_ROWS);
+    TEST_ASSERT_NULL(sdk_mdtp_builder_finish(builder, module));
+
+    // Servers without tables
+    IModule *old = old_module();
+
+    build_table(1, MDTP_TABLE_ROWS, 0);
+    TEST_ASSERT_NULL(sdk_mdtp_builder_finish(builder, old));
+
+    sdk_mdtp_builder_add_value(builder, "a", "1", "");
+    TEST_ASSERT_NOT_NULL(sdk_mdtp_builder_finish(builder, old));
+
+    sdk_imodule_destroy(old);
+}
+
+
+void test_table_malformed(void) {
+    static const uint8_t versions[] = {MDTP_VERSION, MDTP_VERSION_2};
+    uint8_t              frame[MAX_FRAME];
+
+    for (size_t i = 0; i < sizeof(versions); ++i) {
+        sdk_mdtp_builder_set_version(builder, versions[i]);
+        build_table(3, MDTP_TABLE_ROWS, 0);
+
+        const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_builder_finish(builder, module);
+        size_t                      size = data->size;
+        uint64_t                    payload;
+
+        // The payload of the table ends the frame and starts with the layout
+        memcpy(frame, data->data, size);
+
+        if (versions[i] == MDTP_VERSION_2) {
+            read_varint(frame, 5 + 1 + 1 + 9, size, &payload);
+        } else {
+            payload = read_uint32_be(frame, 5 + 1 + 4 + 9);
+        }
+
+        size_t layout = size - (size_t)payload;
+
+        TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_validate(frame, size));
+
+        // Unknown layout
+        frame[layout] = 2;
+        TEST_ASSERT_EQUAL(SDK_ARGUMENT_PROCESSING_ERROR, sdk_mdtp_validate(frame, size));
+        frame[layout] = MDTP_TABLE_ROWS;
+
+        // One row more or less than the cells
+        for (int delta = -1; delta <= 1; delta += 2) {
+            frame[layout + (versions[i] == MDTP_VERSION_2 ? 1 : 4)] += (uint8_t)delta;
+            TEST_ASSERT_EQUAL(SDK_ARGUMENT_PROCESSING_ERROR, sdk_mdtp_validate(frame, size));
+            frame[layout + (versions[i] == MDTP_VERSION_2 ? 1 : 4)] -= (uint8_t)delta;
+        }
+
+        TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_validate(frame, size));
+
+        // Any single byte changed never makes the reader leave the frame
+        for (size_t offset = 5; offset < size; ++offset) {
+            uint8_t original = frame[offset];
+
+            for (int value = 0; value < 256; value += 51) {
+                MdtpReader reader;
+                MdtpReader cells;
+
+                frame[offset] = (uint8_t)value;
+                sdk_mdtp_validate(frame, size);
+                sdk_mdtp_reader_init(&reader, frame, size);
+
+                while (sdk_mdtp_reader_next(&reader)) {
+                    if (sdk_mdtp_reader_enter_table(&reader, &cells) == SDK_OK) {
+                        while (sdk_mdtp_reader_next(&cells)) {
+                        }
+                    }
+                }
+            }
+
+            frame[offset] = original;
+        }
+    }
+
+    sdk_mdtp_builder_set_version(builder, MDTP_VERSION);
+}
+
+
+void test_table_chunked(void) {
+    ABI_MODULE_MDTP_DATA parts[64];
+    size_t               size;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_chunk_enable(module, 1024));
+    sdk_mdtp_builder_set_version(builder, MDTP_VERSION_2);
+    sdk_mdtp_builder_set_chunk_size(builder, 1024);
+
+    const ABI_MODULE_MDTP_DATA *data = make_frame(PROCESSES, MDTP_TABLE_COLUMNS, 3);
+    size_t                      count = 0;
+
+    TEST_ASSERT_NOT_NULL(data);
+
+    while (count < 64 && sdk_mdtp_chunk_get(module, (uint32_t)count) != NULL) {
+        parts[count] = *sdk_mdtp_chunk_get(module, (uint32_t)count);
+        ++count;
+    }
+
+    TEST_ASSERT_TRUE(count > 1);
+
+    void      *frame = sdk_mdtp_chunk_join(parts, count, &size);
+    MdtpReader reader;
+    MdtpReader cells;
+
+    TEST_ASSERT_NOT_NULL(frame);
+    check_frame(frame, size, PROCESSES, 3);
+
+    // Cells are not reordered across chunks
+    sdk_mdtp_reader_init(&reader, frame, size);
+    sdk_mdtp_reader_next(&reader);
+    sdk_mdtp_reader_next(&reader);
+    sdk_mdtp_reader_enter_table(&reader, &cells);
+    TEST_ASSERT_EQUAL(MDTP_TABLE_ROWS, sdk_mdtp_reader_table_layout(&cells));
+
+    free(frame);
+    sdk_mdtp_builder_set_chunk_size(builder, 0);
+    sdk_mdtp_builder_set_version(builder, MDTP_VERSION);
+    sdk_mdtp_chunk_disable(module);
+}
+
+
+void test_table_encodings(void) {
+    MdtpDictionaryDecoder *decoder = sdk_mdtp_dictionary_decoder_create();
+    void                  *base = NULL;
+    size_t                 base_size = 0;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_dictionary_enable(module));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_delta_enable(module, 100));
+
+    for (uint64_t poll = 0; poll < 3; ++poll) {
+        make_frame(20, MDTP_TABLE_COLUMNS, poll);
+
+        // Only the value before the table is a dictionary string
+        const ABI_MODULE_MDTP_DATA *sent = sdk_mdtp_dictionary_emit(module);
+        size_t                      size;
+
+        TEST_ASSERT_TRUE((((const uint8_t *)sent->data)[0] & MDTP_FLAG_DICTIONARY) != 0);
+
+        void *frame = sdk_mdtp_dictionary_decode(decoder, sent->data, sent->size, &size);
+
+        TEST_ASSERT_NOT_NULL(frame);
+        check_frame(frame, size, 20, poll);
+        free(frame);
+
+        // A changed table is sent again as a whole
+        sdk_mdtp_dictionary_disable(module);
+        sent = sdk_mdtp_delta_emit(module);
+        frame = sdk_mdtp_delta_apply(base, base_size, sent->data, sent->size, &size);
+
+        TEST_ASSERT_NOT_NULL(frame);
+        check_frame(frame, size, 20, poll);
+        free(base);
+        base = frame;
+        base_size = size;
+        sdk_mdtp_dictionary_enable(module);
+    }
+
+    free(base);
+    sdk_mdtp_delta_disable(module);
+    sdk_mdtp_dictionary_disable(module);
+    sdk_mdtp_dictionary_decoder_destroy(decoder);
+}
+
+
+int main(void) {
+    fixture_create(ABI_CAPABILITY_TABLES | ABI_CAPABILITY_MDTP_V2 | ABI_CAPABILITY_DICTIONARY |
+                   ABI_CAPABILITY_DELTA_FRAMES | ABI_CAPABILITY_CHUNKED_FRAMES,
+                   ABI_CAPABILITY_MDTP_V2);
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_table_layouts);
+    RUN_TEST(test_table_rows);
+    RUN_TEST(test_table_smaller);
+    RUN_TEST(test_table_misuse);
+    RUN_TEST(test_table_malformed);
+    RUN_TEST(test_table_chunked);
+    RUN_TEST(test_table_encodings);
+
+    fixture_destroy();
+
+    return UNITY_END();
+}
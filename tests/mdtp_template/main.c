@@ -0,0 +1,207 @@
+#include <modules/sdk.h>
+#include <string.h>
+#include <unity.h>
+
+void tearDown(void) {}
+
+void setUp(void) {}
+
+
+// Stub
+ABI_MODULE_FUNCTIONS module_init(ABI_SERVER_CORE_FUNCTIONS server_functions,
+                                 const char               *json_configuration) {
+    return (ABI_MODULE_FUNCTIONS){0};
+}
+
+
+static IModule *module;
+static IModule *reference_module;
+
+
+static MdtpTemplate *make_template(void) {
+    return sdk_mdtp_template_compile(
+        sdk_mdtp_make_container("cpu",
+                                sdk_mdtp_make_value("usage", "12", "%"),
+                                sdk_mdtp_make_container("core0",
+                                                        sdk_mdtp_make_value("freq", "2400", "MHz"),
+                                                        NULL),
+                                NULL),
+        sdk_mdtp_make_value("uptime", "100", "s"),
+        NULL);
+}
+
+
+// Frame the template must produce for the given values
+static const ABI_MODULE_MDTP_DATA *make_reference(const char *usage,
+                                                  const char *freq,
+                                                  const char *uptime) {
+    return sdk_mdtp_make_root(
+        reference_module,
+        sdk_mdtp_make_container("cpu",
+                                sdk_mdtp_make_value("usage", usage, "%"),
+                                sdk_mdtp_make_container("core0",
+                                                        sdk_mdtp_make_value("freq", freq, "MHz"),
+                                                        NULL),
+                                NULL),
+        sdk_mdtp_make_value("uptime", uptime, "s"),
+        NULL);
+}
+
+
+static void assert_frame(const ABI_MODULE_MDTP_DATA *reference, const ABI_MODULE_MDTP_DATA *data) {
+    TEST_ASSERT_NOT_NULL(reference);
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL(reference->size, data->size);
+    TEST_ASSERT_EQUAL_MEMORY(reference->data, data->data, data->size);
+}
+
+
+void test_template_emit_matches_make_root(void) {
+    MdtpTemplate *mdtp_template = make_template();
+
+    TEST_ASSERT_NOT_NULL(mdtp_template);
+    TEST_ASSERT_EQUAL(3, sdk_mdtp_template_slot_count(mdtp_template));
+
+    assert_frame(make_reference("12", "2400", "100"),
+                 sdk_mdtp_template_emit(mdtp_template, module));
+
+    sdk_mdtp_template_destroy(mdtp_template);
+}
+
+
+void test_template_slot_lookup(void) {
+    MdtpTemplate *mdtp_template = make_template();
+
+    TEST_ASSERT_EQUAL_PTR(sdk_mdtp_template_slot_at(mdtp_template, 0),
+                          sdk_mdtp_template_slot(mdtp_template, "cpu/usage"));
+    TEST_ASSERT_EQUAL_PTR(sdk_mdtp_template_slot_at(mdtp_template, 1),
+                          sdk_mdtp_template_slot(mdtp_template, "cpu/core0/freq"));
+    TEST_ASSERT_EQUAL_PTR(sdk_mdtp_template_slot_at(mdtp_template, 2),
+                          sdk_mdtp_template_slot(mdtp_template, "uptime"));
+
+    TEST_ASSERT_NULL(sdk_mdtp_template_slot_at(mdtp_template, 3));
+    TEST_ASSERT_NULL(sdk_mdtp_template_slot(mdtp_template, "cpu"));
+    TEST_ASSERT_NULL(sdk_mdtp_template_slot(mdtp_template, "cpu/core0"));
+    TEST_ASSERT_NULL(sdk_mdtp_template_slot(mdtp_template, "cpu/usage/x"));
+    TEST_ASSERT_NULL(sdk_mdtp_template_slot(mdtp_template, "uptime/x"));
+    TEST_ASSERT_NULL(sdk_mdtp_template_slot(mdtp_template, "memory"));
+    TEST_ASSERT_NULL(sdk_mdtp_template_slot(mdtp_template, NULL));
+
+    sdk_mdtp_template_destroy(mdtp_template);
+}
+
+
+// Values of the same length are patched in the frame already held by the module
+void test_template_patches_in_place(void) {
+    MdtpTemplate     *mdtp_template = make_template();
+    MdtpTemplateSlot *usage = sdk_mdtp_template_slot(mdtp_template, "cpu/usage");
+    MdtpTemplateSlot *uptime = sdk_mdtp_template_slot(mdtp_template, "uptime");
+
+    const ABI_MODULE_MDTP_DATA *first = sdk_mdtp_template_emit(mdtp_template, module);
+    const uint8_t              *frame = first->data;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_template_set(usage, "57"));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_template_set_u64(uptime, 101));
+
+    const ABI_MODULE_MDTP_DATA *second = sdk_mdtp_template_emit(mdtp_template, module);
+
+    TEST_ASSERT_EQUAL_PTR(frame, second->data);
+    assert_frame(make_reference("57", "2400", "101"), second);
+
+    // Nothing changed
+    assert_frame(make_reference("57", "2400", "101"),
+                 sdk_mdtp_template_emit(mdtp_template, module));
+
+    sdk_mdtp_template_destroy(mdtp_template);
+}
+
+
+// Values of a new length move the rest of the frame and change payload sizes of their containers
+void test_template_resized_values(void) {
+    MdtpTemplate     *mdtp_template = make_template();
+    MdtpTemplateSlot *usage = sdk_mdtp_template_slot(mdtp_template, "cpu/usage");
+    MdtpTemplateSlot *freq = sdk_mdtp_template_slot(mdtp_template, "cpu/core0/freq");
+    MdtpTemplateSlot *uptime = sdk_mdtp_template_slot(mdtp_template, "uptime");
+
+    sdk_mdtp_template_emit(mdtp_template, module);
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_template_set(usage, "5"));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_template_set_f64(freq, 3200.5, 1));
+    assert_frame(make_reference("5", "3200.5", "100"),
+                 sdk_mdtp_template_emit(mdtp_template, module));
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_template_set_i64(usage, -100));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_template_set(uptime, ""));
+    assert_frame(make_reference("-100", "3200.5", ""),
+                 sdk_mdtp_template_emit(mdtp_template, module));
+
+    // Changed twice before emit, back to the original length
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_template_set(freq, "1"));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_template_set(freq, "800.0"));
+    assert_frame(make_reference("-100", "800.0", ""),
+                 sdk_mdtp_template_emit(mdtp_template, module));
+
+    // Slot lookup keeps working after the layout changed
+    TEST_ASSERT_EQUAL_PTR(uptime, sdk_mdtp_template_slot(mdtp_template, "uptime"));
+
+    sdk_mdtp_template_destroy(mdtp_template);
+}
+
+
+// If something else wrote a frame into the module, the whole frame is written again
+void test_template_foreign_frame(void) {
+    MdtpTemplate     *mdtp_template = make_template();
+    MdtpTemplateSlot *usage = sdk_mdtp_template_slot(mdtp_template, "cpu/usage");
+
+    sdk_mdtp_template_emit(mdtp_template, module);
+    sdk_mdtp_make_root(module, sdk_mdtp_make_value("other", "frame", ""), NULL);
+
+    sdk_mdtp_template_set(usage, "99");
+    assert_frame(make_reference("99", "2400", "100"),
+                 sdk_mdtp_template_emit(mdtp_template, module));
+
+    // Two templates emitting into one module
+    MdtpTemplate *other = make_template();
+
+    sdk_mdtp_template_emit(other, module);
+    sdk_mdtp_template_set(usage, "42");
+    assert_frame(make_reference("42", "2400", "100"),
+                 sdk_mdtp_template_emit(mdtp_template, module));
+
+    sdk_mdtp_template_destroy(other);
+    sdk_mdtp_template_destroy(mdtp_template);
+}
+
+
+void test_template_invalid_arguments(void) {
+    MdtpTemplate *mdtp_template = make_template();
+
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT,
+                      sdk_mdtp_template_set(sdk_mdtp_template_slot_at(mdtp_template, 0), NULL));
+    TEST_ASSERT_NULL(sdk_mdtp_template_compile(NULL));
+    TEST_ASSERT_NULL(sdk_mdtp_template_compile_v(NULL, 1));
+
+    sdk_mdtp_template_destroy(mdtp_template);
+    sdk_mdtp_template_destroy(NULL);
+}
+
+
+int main(void) {
+    module = sdk_imodule_create("test", "test", (ABI_SERVER_CORE_FUNCTIONS){0}, 0, 0);
+    reference_module =
+        sdk_imodule_create("reference", "reference", (ABI_SERVER_CORE_FUNCTIONS){0}, 0, 0);
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_template_emit_matches_make_root);
+    RUN_TEST(test_template_slot_lookup);
+    RUN_TEST(test_template_patches_in_place);
+    RUN_TEST(test_template_resized_values);
+    RUN_TEST(test_template_foreign_frame);
+    RUN_TEST(test_template_invalid_arguments);
+
+    sdk_imodule_destroy(reference_module);
+    sdk_imodule_destroy(module);
+
+    return UNITY_END();
+}
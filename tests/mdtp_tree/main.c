@@ -0,0 +1,253 @@
+#include <modules/sdk.h>
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+void tearDown(void) {}
+
+void setUp(void) {}
+
+
+// Stub
+ABI_MODULE_FUNCTIONS module_init(ABI_SERVER_CORE_FUNCTIONS server_functions,
+                                 const char               *json_configuration) {
+    return (ABI_MODULE_FUNCTIONS){0};
+}
+
+
+static IModule *reference_module;
+
+
+static IModule *make_module(void) {
+    return sdk_imodule_create("test", "test", (ABI_SERVER_CORE_FUNCTIONS){0}, 0, 0);
+}
+
+
+static void assert_frame(const ABI_MODULE_MDTP_DATA *reference, const ABI_MODULE_MDTP_DATA *data) {
+    TEST_ASSERT_NOT_NULL(reference);
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL(reference->size, data->size);
+    TEST_ASSERT_EQUAL_MEMORY(reference->data, data->data, data->size);
+}
+
+
+// Fill the tree used by most tests
+static void fill(IModule *module) {
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_tree_set(module, "net/eth0/rx", "10", "B"));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_tree_set(module, "net/eth0/tx", "20", "B"));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_tree_set(module, "net/lo/rx", "30", "B"));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_tree_set(module, "uptime", "100", "s"));
+}
+
+
+static const ABI_MODULE_MDTP_DATA *make_reference(const char *eth0_rx, const char *lo_rx) {
+    return sdk_mdtp_make_root(
+        reference_module,
+        sdk_mdtp_make_container(
+            "net",
+            sdk_mdtp_make_container("eth0",
+                                    sdk_mdtp_make_value("rx", eth0_rx, "B"),
+                                    sdk_mdtp_make_value("tx", "20", "B"),
+                                    NULL),
+            sdk_mdtp_make_container("lo", sdk_mdtp_make_value("rx", lo_rx, "B"), NULL),
+            NULL),
+        sdk_mdtp_make_value("uptime", "100", "s"),
+        NULL);
+}
+
+
+void test_tree_emit_matches_make_root(void) {
+    IModule *module = make_module();
+
+    fill(module);
+    assert_frame(make_reference("10", "30"), sdk_mdtp_tree_emit(module));
+
+    // Nothing changed
+    assert_frame(make_reference("10", "30"), sdk_mdtp_tree_emit(module));
+
+    sdk_imodule_destroy(module);
+}
+
+
+void test_tree_empty(void) {
+    IModule                    *module = make_module();
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_tree_emit(module);
+
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL(5, data->size);
+    TEST_ASSERT_EQUAL(MDTP_VERSION, ((const uint8_t *)data->data)[0]);
+    TEST_ASSERT_EQUAL(0, ((const uint8_t *)data->data)[4]);
+
+    sdk_imodule_destroy(module);
+}
+
+
+// Changed values are written again, unchanged subtrees are copied from the previous frame
+void test_tree_incremental_updates(void) {
+    IModule *module = make_module();
+
+    fill(module);
+    sdk_mdtp_tree_emit(module);
+
+    // Same length
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_tree_set(module, "net/lo/rx", "31", "B"));
+    assert_frame(make_reference("10", "31"), sdk_mdtp_tree_emit(module));
+
+    // New length, following subtrees move
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_tree_set_u64(module, "net/eth0/rx", 123456, "B"));
+    assert_frame(make_reference("123456", "31"), sdk_mdtp_tree_emit(module));
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_tree_set_i64(module, "net/eth0/rx", -1, "B"));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_tree_set_f64(module, "net/lo/rx", 2.5, 2, "B"));
+    assert_frame(make_reference("-1", "2.50"), sdk_mdtp_tree_emit(module));
+
+    // Same value again
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_tree_set(module, "net/lo/rx", "2.50", "B"));
+    assert_frame(make_reference("-1", "2.50"), sdk_mdtp_tree_emit(module));
+
+    sdk_imodule_destroy(module);
+}
+
+
+void test_tree_remove(void) {
+    IModule *module = make_module();
+
+    fill(module);
+    sdk_mdtp_tree_emit(module);
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_tree_remove(module, "net/eth0"));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_tree_remove(module, "uptime"));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_tree_remove(module, "net/eth0/rx"));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_tree_remove(module, "memory"));
+
+    assert_frame(sdk_mdtp_make_root(reference_module,
+                                    sdk_mdtp_make_container(
+                                        "net",
+                                        sdk_mdtp_make_container(
+                                            "lo", sdk_mdtp_make_value("rx", "30", "B"), NULL),
+                                        NULL),
+                                    NULL),
+                 sdk_mdtp_tree_emit(module));
+
+    // Removed nodes can be created again, they go to the end
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_tree_set(module, "net/eth0/rx", "1", "B"));
+    assert_frame(sdk_mdtp_make_root(
+                     reference_module,
+                     sdk_mdtp_make_container(
+                         "net",
+                         sdk_mdtp_make_container("lo", sdk_mdtp_make_value("rx", "30", "B"), NULL),
+                         sdk_mdtp_make_container("eth0", sdk_mdtp_make_value("rx", "1", "B"), NULL),
+                         NULL),
+                     NULL),
+                 sdk_mdtp_tree_emit(module));
+
+    sdk_imodule_destroy(module);
+}
+
+
+void test_tree_clear(void) {
+    IModule *module = make_module();
+
+    fill(module);
+    sdk_mdtp_tree_emit(module);
+    sdk_mdtp_tree_clear(module);
+
+    TEST_ASSERT_EQUAL(5, sdk_mdtp_tree_emit(module)->size);
+
+    fill(module);
+    assert_frame(make_reference("10", "30"), sdk_mdtp_tree_emit(module));
+
+    sdk_imodule_destroy(module);
+}
+
+
+// If something else wrote a frame into the module, the whole tree is written again
+void test_tree_foreign_frame(void) {
+    IModule *module = make_module();
+
+    fill(module);
+    sdk_mdtp_tree_emit(module);
+    sdk_mdtp_make_root(module, sdk_mdtp_make_value("other", "frame", ""), NULL);
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_tree_set(module, "net/lo/rx", "7", "B"));
+    assert_frame(make_reference("10", "7"), sdk_mdtp_tree_emit(module));
+
+    // Nothing changed, but the frame was replaced
+    sdk_mdtp_make_root(module, sdk_mdtp_make_value("other", "frame", ""), NULL);
+    assert_frame(make_reference("10", "7"), sdk_mdtp_tree_emit(module));
+
+    sdk_imodule_destroy(module);
+}
+
+
+void test_tree_many_nodes(void) {
+    IModule *module = make_module();
+    char     path[32];
+    char     value[32];
+
+    // Enough nodes to grow the index
+    for (int i = 0; i < 300; ++i) {
+        snprintf(path, sizeof(path), "c%d/v%d", i % 7, i);
+        snprintf(value, sizeof(value), "%d", i);
+        TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_tree_set(module, path, value, ""));
+    }
+
+    TEST_ASSERT_NOT_NULL(sdk_mdtp_tree_emit(module));
+
+    for (int i = 0; i < 300; ++i) {
+        snprintf(path, sizeof(path), "c%d/v%d", i % 7, i);
+        TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_tree_remove(module, path));
+    }
+
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_tree_remove(module, "c0/v0"));
+
+    sdk_imodule_destroy(module);
+}
+
+
+void test_tree_invalid_arguments(void) {
+    IModule *module = make_module();
+
+    fill(module);
+
+    // Type conflicts
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_tree_set(module, "net/eth0", "1", ""));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_tree_set(module, "uptime/x", "1", ""));
+
+    // Empty names
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_tree_set(module, "", "1", ""));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_tree_set(module, "/x", "1", ""));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_tree_set(module, "x/", "1", ""));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_tree_set(module, "x//y", "1", ""));
+
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_tree_set(module, NULL, "1", ""));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_tree_set(module, "x", NULL, ""));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_tree_set(module, "x", "1", NULL));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_tree_remove(module, NULL));
+
+    // The tree is not changed
+    assert_frame(make_reference("10", "30"), sdk_mdtp_tree_emit(module));
+
+    sdk_imodule_destroy(module);
+}
+
+
+int main(void) {
+    reference_module =
+        sdk_imodule_create("reference", "reference", (ABI_SERVER_CORE_FUNCTIONS){0}, 0, 0);
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_tree_emit_matches_make_root);
+    RUN_TEST(test_tree_empty);
+    RUN_TEST(test_tree_incremental_updates);
+    RUN_TEST(test_tree_remove);
+    RUN_TEST(test_tree_clear);
+    RUN_TEST(test_tree_foreign_frame);
+    RUN_TEST(test_tree_many_nodes);
+    RUN_TEST(test_tree_invalid_arguments);
+
+    sdk_imodule_destroy(reference_module);
+
+    return UNITY_END();
+}
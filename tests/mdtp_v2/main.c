@@ -0,0 +1,285 @@
+#include <modules/sdk.h>
+#include <modules/internals/memutils.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "../mdtp_fixture.h"
+
+
+// Build a frame with values of every type in the given version
+static const ABI_MODULE_MDTP_DATA *build(uint8_t version) {
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_set_version(builder, version));
+
+    sdk_mdtp_builder_begin_container(builder, "cpu");
+    sdk_mdtp_builder_add_value_u64(builder, "usage", 57, "%");
+    sdk_mdtp_builder_add_value_u64(builder, "cycles", UINT64_MAX, "");
+    sdk_mdtp_builder_add_value_i64(builder, "delta", -1234567, "");
+    sdk_mdtp_builder_add_value_i64(builder, "minimum", INT64_MIN, "");
+    sdk_mdtp_builder_add_value_f64(builder, "load", 0.5, MDTP_F64_SHORTEST, "");
+    sdk_mdtp_builder_add_value_bool(builder, "online", 1, "");
+    sdk_mdtp_builder_end_container(builder);
+    sdk_mdtp_builder_add_value_bytes(builder, "raw", "\x01\x02\x03", 3, "");
+    sdk_mdtp_builder_add_value(builder, "name", "x86", "");
+
+    return sdk_mdtp_builder_finish(builder, module);
+}
+
+
+// Move reader to the next node and check its name
+static void next(MdtpReader *reader, const char *name) {
+    size_t      length;
+    const char *actual;
+
+    TEST_ASSERT_TRUE(sdk_mdtp_reader_next(reader));
+    actual = sdk_mdtp_reader_name(reader, &length);
+    TEST_ASSERT_EQUAL(strlen(name), length);
+    TEST_ASSERT_EQUAL_MEMORY(name, actual, length);
+}
+
+
+// Read the frame made by `build`
+static void check(const ABI_MODULE_MDTP_DATA *data, uint8_t version) {
+    MdtpReader root;
+    MdtpReader cpu;
+    uint64_t   u64;
+    int64_t    i64;
+    double     f64;
+    uint8_t    boolean;
+    size_t     length;
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_validate(data->data, data->size));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_init(&root, data->data, data->size));
+    TEST_ASSERT_EQUAL_UINT8(version, sdk_mdtp_reader_version(&root));
+
+    next(&root, "cpu");
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_enter_container(&root, &cpu));
+    TEST_ASSERT_EQUAL_UINT8(version, sdk_mdtp_reader_version(&cpu));
+
+    next(&cpu, "usage");
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_u64(&cpu, &u64));
+    TEST_ASSERT_EQUAL_UINT64(57, u64);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_i64(&cpu, &i64));
+    TEST_ASSERT_EQUAL(57, i64);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_f64(&cpu, &f64));
+    TEST_ASSERT_TRUE(f64 == 57.0);
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_reader_value_bool(&cpu, &boolean));
+
+    next(&cpu, "cycles");
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_u64(&cpu, &u64));
+    TEST_ASSERT_EQUAL_UINT64(UINT64_MAX, u64);
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_reader_value_i64(&cpu, &i64));
+
+    next(&cpu, "delta");
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_i64(&cpu, &i64));
+    TEST_ASSERT_EQUAL(-1234567, i64);
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_reader_value_u64(&cpu, &u64));
+
+    next(&cpu, "minimum");
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_i64(&cpu, &i64));
+    TEST_ASSERT_TRUE(i64 == INT64_MIN);
+
+    next(&cpu, "load");
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_f64(&cpu, &f64));
+    TEST_ASSERT_TRUE(f64 == 0.5);
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_reader_value_u64(&cpu, &u64));
+
+    next(&cpu, "online");
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_bool(&cpu, &boolean));
+    TEST_ASSERT_EQUAL_UINT8(1, boolean);
+    TEST_ASSERT_FALSE(sdk_mdtp_reader_next(&cpu));
+
+    next(&root, "raw");
+    TEST_ASSERT_EQUAL_MEMORY("\x01\x02\x03", sdk_mdtp_reader_value(&root, &length), 3);
+    TEST_ASSERT_EQUAL(3, length);
+
+    next(&root, "name");
+    TEST_ASSERT_EQUAL_UINT8(MDTP_VALUE_TEXT, sdk_mdtp_reader_value_type(&root));
+    TEST_ASSERT_EQUAL_MEMORY("x86", sdk_mdtp_reader_value(&root, &length), 3);
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_reader_value_f64(&root, &f64));
+    TEST_ASSERT_FALSE(sdk_mdtp_reader_next(&root));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_status(&root));
+}
+
+
+void test_negotiation(void) {
+    IModule *old = old_module();
+
+    TEST_ASSERT_EQUAL_UINT8(MDTP_VERSION_2, sdk_utils_server_mdtp_version(module));
+    TEST_ASSERT_EQUAL_UINT8(MDTP_VERSION, sdk_utils_server_mdtp_version(old));
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_builder_set_version(builder, 3));
+
+    // MDTP v2 frames are not given to servers that cannot read them
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_set_version(builder, MDTP_VERSION_2));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_add_value_u64(builder, "count", 1, ""));
+    TEST_ASSERT_NULL(sdk_mdtp_builder_finish(builder, old));
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_add_value_u64(builder, "count", 1, ""));
+    TEST_ASSERT_NOT_NULL(sdk_mdtp_builder_finish(builder, module));
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_set_version(builder, MDTP_VERSION));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_builder_add_value_u64(builder, "count", 1, ""));
+    TEST_ASSERT_NOT_NULL(sdk_mdtp_builder_finish(builder, old));
+
+    sdk_imodule_destroy(old);
+}
+
+
+void test_both_versions(void) {
+    const ABI_MODULE_MDTP_DATA *data = build(MDTP_VERSION);
+    size_t                      v1_size = data->size;
+
+    TEST_ASSERT_EQUAL_UINT8(MDTP_VERSION, ((const uint8_t *)data->data)[0]);
+    check(data, MDTP_VERSION);
+
+    // Typed values and varint lengths make the same frame smaller
+    data = build(MDTP_VERSION_2);
+
+    TEST_ASSERT_EQUAL_UINT8(MDTP_VERSION_2, ((const uint8_t *)data->data)[0]);
+    TEST_ASSERT_TRUE(data->size < v1_size);
+    check(data, MDTP_VERSION_2);
+
+    // The version is kept for the next frames
+    data = build(MDTP_VERSION_2);
+    check(data, MDTP_VERSION_2);
+}
+
+
+void test_container_sizes(void) {
+    MdtpReader reader;
+    MdtpReader child;
+    char       name[16];
+
+    // Empty, small (1-byte size) and large (3-byte size) containers
+    sdk_mdtp_builder_set_version(builder, MDTP_VERSION_2);
+    sdk_mdtp_builder_begin_container(builder, "empty");
+    sdk_mdtp_builder_end_container(builder);
+    sdk_mdtp_builder_begin_container(builder, "large");
+
+    for (uint64_t i = 0; i < 2000; ++i) {
+        snprintf(name, sizeof(name), "value%d", (int)i);
+        sdk_mdtp_builder_begin_container(builder, name);
+        sdk_mdtp_builder_add_value_u64(builder, "n", i, "");
+        sdk_mdtp_builder_end_container(builder);
+    }
+
+    sdk_mdtp_builder_end_container(builder);
+    sdk_mdtp_builder_add_value_u64(builder, "after", 7, "");
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_builder_finish(builder, module);
+
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_TRUE(data->size > 16384);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_validate(data->data, data->size));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_init(&reader, data->data, data->size));
+
+    next(&reader, "empty");
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_enter_container(&reader, &child));
+    TEST_ASSERT_FALSE(sdk_mdtp_reader_next(&child));
+
+    next(&reader, "large");
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_enter_container(&reader, &child));
+
+    for (uint64_t i = 0; i < 2000; ++i) {
+        MdtpReader value;
+        uint64_t   n;
+
+        snprintf(name, sizeof(name), "value%d", (int)i);
+        next(&child, name);
+        sdk_mdtp_reader_enter_container(&child, &value);
+        next(&value, "n");
+        TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_u64(&value, &n));
+        TEST_ASSERT_EQUAL_UINT64(i, n);
+    }
+
+    TEST_ASSERT_FALSE(sdk_mdtp_reader_next(&child));
+    next(&reader, "after");
+    TEST_ASSERT_FALSE(sdk_mdtp_reader_next(&reader));
+}
+
+
+void test_malformed(void) {
+    sdk_mdtp_builder_set_version(builder, MDTP_VERSION_2);
+    sdk_mdtp_builder_add_value_bool(builder, "on", 0, "");
+
+    const ABI_MODULE_MDTP_DATA *data = sdk_mdtp_builder_finish(builder, module);
+    uint8_t                     frame[64];
+    size_t                      size = data->size;
+
+    // [header] [1 type] [1 name length] "on" [1 units length] [1 value type] [1 value]
+    TEST_ASSERT_EQUAL(12, size);
+    memcpy(frame, data->data, size);
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_validate(frame, size));
+
+    frame[11] = 2; // Not a boolean
+    TEST_ASSERT_EQUAL(SDK_ARGUMENT_PROCESSING_ERROR, sdk_mdtp_validate(frame, size));
+
+    frame[11] = 0;
+    frame[10] = 0x42; // Unknown value type
+    TEST_ASSERT_EQUAL(SDK_ARGUMENT_PROCESSING_ERROR, sdk_mdtp_validate(frame, size));
+
+    frame[10] = MDTP_VALUE_F64; // Value crosses the end
+    TEST_ASSERT_EQUAL(SDK_ARGUMENT_PROCESSING_ERROR, sdk_mdtp_validate(frame, size));
+
+    frame[10] = MDTP_VALUE_BOOL;
+    frame[6] = 0x80; // Varint name length crosses the end
+    TEST_ASSERT_EQUAL(SDK_ARGUMENT_PROCESSING_ERROR, sdk_mdtp_validate(frame, size));
+}
+
+
+void test_index(void) {
+    MdtpIndex *mdtp_index = sdk_mdtp_index_create();
+    MdtpReader node;
+    int64_t    value;
+
+    const ABI_MODULE_MDTP_DATA *data = build(MDTP_VERSION_2);
+
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_index_build(mdtp_index, data->data, data->size));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_index_lookup(mdtp_index, "cpu/delta", &node));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_reader_value_i64(&node, &value));
+    TEST_ASSERT_EQUAL(-1234567, value);
+    TEST_ASSERT_EQUAL(SDK_INVALID_ARGUMENT, sdk_mdtp_index_lookup(mdtp_index, "cpu/raw", &node));
+
+    sdk_mdtp_index_destroy(mdtp_index);
+}
+
+
+void test_delta_and_dictionary(void) {
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_delta_enable(module, 100));
+    TEST_ASSERT_EQUAL(SDK_OK, sdk_mdtp_dictionary_enable(module));
+
+    // MDTP v2 frames are sent as they are
+    for (int i = 0; i < 3; ++i) {
+        const ABI_MODULE_MDTP_DATA *data = build(MDTP_VERSION_2);
+        const void                 *frame = data->data;
+
+        sdk_mdtp_delta_emit(module);
+        data = sdk_mdtp_dictionary_emit(module);
+
+        TEST_ASSERT_EQUAL_PTR(frame, data->data);
+        check(data, MDTP_VERSION_2);
+    }
+
+    sdk_mdtp_dictionary_disable(module);
+    sdk_mdtp_delta_disable(module);
+}
+
+
+int main(void) {
+    fixture_create(ABI_CAPABILITY_MDTP_V2 | ABI_CAPABILITY_DELTA_FRAMES | ABI_CAPABILITY_DICTIONARY,
+                   0);
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_negotiation);
+    RUN_TEST(test_both_versions);
+    RUN_TEST(test_container_sizes);
+    RUN_TEST(test_malformed);
+    RUN_TEST(test_index);
+    RUN_TEST(test_delta_and_dictionary);
+
+    fixture_destroy();
+
+    return UNITY_END();
+}
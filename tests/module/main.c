@@ -23,6 +23,7 @@ static struct
     int destroy_calls;
     int get_conf_calls;
     int get_data_calls;
+    int get_data_info_calls;
     int enable_calls;
     int disable_calls;
     int is_enabled_calls;
@@ -105,6 +106,15 @@ static const ABI_MODULE_MDTP_DATA *stub_get_data(void)
     return sdk_mdtp_make_root(g_module, container, NULL);
 }
 
+/**
+ * @brief Report hash and generation of the stored MDTP data.
+ */
+static const ABI_MODULE_DATA_INFO *stub_get_data_info(void)
+{
+    g_calls.get_data_info_calls++;
+    return sdk_imodule_get_mdtp_data_info(g_module);
+}
+
 /**
  * @brief Enable: flip SDK state.
  */
@@ -207,6 +217,7 @@ static void assert_callbacks_are_wired(void)
 
     TEST_ASSERT_EQUAL_PTR(stub_get_configuration,      g_abi->module_get_configuration);
     TEST_ASSERT_EQUAL_PTR(stub_get_data,               g_abi->module_get_data);
+    TEST_ASSERT_EQUAL_PTR(stub_get_data_info,          g_abi->module_get_data_info);
     TEST_ASSERT_EQUAL_PTR(stub_enable,                 g_abi->module_enable);
     TEST_ASSERT_EQUAL_PTR(stub_disable,                g_abi->module_disable);
     TEST_ASSERT_EQUAL_PTR(stub_is_enabled,             g_abi->module_is_enabled);
@@ -263,6 +274,46 @@ static void test_get_mdtp_data_nonnull_and_sized(void)
     TEST_ASSERT_EQUAL_INT(1, g_calls.get_data_calls);
 }
 
+/**
+ * @brief Generation changes only when the contents of the frame change.
+ */
+static void test_data_info_generation(void)
+{
+    g_abi->module_get_data();
+    const ABI_MODULE_DATA_INFO *info = g_abi->module_get_data_info();
+    TEST_ASSERT_NOT_NULL(info);
+    TEST_ASSERT_TRUE(info->generation > 0u);
+
+    uint64_t generation = info->generation;
+    uint64_t hash       = info->hash;
+
+    /* Rebuilt, but byte-identical */
+    g_abi->module_get_data();
+    TEST_ASSERT_EQUAL_UINT64(generation, g_abi->module_get_data_info()->generation);
+    TEST_ASSERT_EQUAL_UINT64(hash,       g_abi->module_get_data_info()->hash);
+
+    /* Different value */
+    sdk_mdtp_make_root(g_module,
+                       sdk_mdtp_make_container("metrics", sdk_mdtp_make_value("foo", "2", "u"), NULL),
+                       NULL);
+    info = sdk_imodule_get_mdtp_data_info(g_module);
+    TEST_ASSERT_EQUAL_UINT64(generation + 1u, info->generation);
+    TEST_ASSERT_NOT_EQUAL(hash, info->hash);
+
+    /* Same frame in place */
+    sdk_imodule_commit_mdtp_data(g_module, sdk_imodule_get_mdtp_data(g_module)->size);
+    info = sdk_imodule_get_mdtp_data_info(g_module);
+    TEST_ASSERT_EQUAL_UINT64(generation + 1u, info->generation);
+
+    /* Back to the first frame */
+    g_abi->module_get_data();
+    info = sdk_imodule_get_mdtp_data_info(g_module);
+    TEST_ASSERT_EQUAL_UINT64(generation + 2u, info->generation);
+    TEST_ASSERT_EQUAL_UINT64(hash,            info->hash);
+    TEST_ASSERT_EQUAL_INT(3, g_calls.get_data_calls);
+    TEST_ASSERT_EQUAL_INT(3, g_calls.get_data_info_calls);
+}
+
 /**
  * @brief Enable/disable flow flips the state visible via module_is_enabled().
  */
@@ -335,6 +386,7 @@ static void test_null_registration_has_no_effect(void)
     /* NULL module -> no effect */
     sdk_module_register_get_configuration(NULL, stub_get_configuration);
     sdk_module_register_get_data(NULL, stub_get_data);
+    sdk_module_register_get_data_info(NULL, stub_get_data_info);
     sdk_module_register_enable(NULL, stub_enable);
     sdk_module_register_disable(NULL, stub_disable);
     sdk_module_register_is_enabled(NULL, stub_is_enabled);
@@ -347,6 +399,7 @@ static void test_null_registration_has_no_effect(void)
     /* NULL callback -> no effect */
     sdk_module_register_get_configuration(g_module, NULL);
     sdk_module_register_get_data(g_module, NULL);
+    sdk_module_register_get_data_info(g_module, NULL);
     sdk_module_register_enable(g_module, NULL);
     sdk_module_register_disable(g_module, NULL);
     sdk_module_register_is_enabled(g_module, NULL);
@@ -392,6 +445,7 @@ int main(void)
     /* Wire all callbacks for this module instance. */
     sdk_module_register_get_configuration(g_module,      stub_get_configuration);
     sdk_module_register_get_data(g_module,               stub_get_data);
+    sdk_module_register_get_data_info(g_module,          stub_get_data_info);
     sdk_module_register_enable(g_module,                 stub_enable);
     sdk_module_register_disable(g_module,                stub_disable);
     sdk_module_register_is_enabled(g_module,             stub_is_enabled);
@@ -410,6 +464,7 @@ int main(void)
     RUN_TEST(test_registration_wires_callbacks);
     RUN_TEST(test_get_configuration);
     RUN_TEST(test_get_mdtp_data_nonnull_and_sized);
+    RUN_TEST(test_data_info_generation);
     RUN_TEST(test_enable_disable_flow);
     RUN_TEST(test_poll_ratio_roundtrip);
     RUN_TEST(test_name_and_description);